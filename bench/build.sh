@@ -0,0 +1 @@
+g++ -O2 -DRIFF_USE_READAHEAD -I ../src ../src/RIFF.cpp ../src/RIFFIO.cpp main.cpp -o bench -pthread
@@ -0,0 +1,814 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is a benchmark for the RIFF class.  It writes and reads back
+ *    files with different chunk sizes, group depths, RIFF/IFF and I/O types
+ *    and prints the results as JSON.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*** DEFINES                  ***/
+#define IO_BUFFER_SIZE          (1024*1024)
+#define HIST_SUB_BUCKETS        8
+#define HIST_BUCKETS            (64*HIST_SUB_BUCKETS)
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+struct BenchCase
+{
+    uint32_t ChunkSize;
+    unsigned Depth;
+    bool IFF;
+    e_RIFFIOType WriteIO;
+    e_RIFFIOType ReadIO;
+};
+
+struct LatencyHist
+{
+    uint64_t Counts[HIST_BUCKETS];
+    uint64_t Max;
+    uint64_t Samples;
+};
+
+struct PhaseResult
+{
+    double Seconds;
+    uint64_t Bytes;
+    uint64_t Chunks;
+    int64_t ReadSyscalls;
+    int64_t WriteSyscalls;
+    uint64_t NewCalls;
+    struct LatencyHist Latency;
+};
+
+struct IOCounters
+{
+    int64_t ReadSyscalls;
+    int64_t WriteSyscalls;
+};
+
+typedef std::chrono::steady_clock t_Clock;
+
+/*** FUNCTION PROTOTYPES      ***/
+static void ShowHelp(void);
+static bool ParseSize(const char *Str,uint64_t &Size);
+static bool ParseSizeList(const char *Str,std::vector<uint32_t> &List);
+static bool ParseDepthList(const char *Str,std::vector<unsigned> &List);
+static bool ParseIOList(const char *Str,std::vector<e_RIFFIOType> &List);
+static bool ParseModeList(const char *Str,std::vector<bool> &List);
+static bool NextToken(const char *&Str,std::string &Token);
+static const char *IOName(e_RIFFIOType IO);
+static void AddCase(std::vector<struct BenchCase> &Cases,
+        const struct BenchCase &Case);
+static void RunCase(const struct BenchCase &Case,FILE *Out,bool First);
+static void WriteTest(const struct BenchCase &Case,const char *Filename,
+        uint64_t Chunks,struct PhaseResult &Result);
+static void ReadTest(const struct BenchCase &Case,const char *Filename,
+        struct PhaseResult &Result);
+static void ReadGroup(class RIFF &RIFF,struct PhaseResult &Result);
+static void DropCache(const char *Filename);
+static void GetIOCounters(struct IOCounters &Counters);
+static void HistClear(struct LatencyHist &Hist);
+static void HistAdd(struct LatencyHist &Hist,uint64_t ns);
+static uint64_t HistPercentile(const struct LatencyHist &Hist,double Percent);
+static void PrintPhase(FILE *Out,const char *Name,
+        const struct PhaseResult &Result);
+
+/*** VARIABLE DEFINITIONS     ***/
+static std::atomic<uint64_t> g_NewCalls(0);
+static uint8_t g_IOBuffer[IO_BUFFER_SIZE];
+static uint64_t g_TotalBytes=64*1024*1024;
+static const char *g_Dir=".";
+static bool g_Cold=false;
+
+/* Count the times the library calls new (malloc() isn't counted) */
+void *operator new(size_t Size)
+{
+    void *Mem;
+
+    g_NewCalls++;
+    Mem=malloc(Size==0?1:Size);
+    if(Mem==NULL)
+        throw std::bad_alloc();
+    return Mem;
+}
+
+void operator delete(void *Mem) noexcept
+{
+    free(Mem);
+}
+
+void operator delete(void *Mem,size_t /*Size*/) noexcept
+{
+    free(Mem);
+}
+
+int main(int argc,char **argv)
+{
+    std::vector<uint32_t> Sizes;
+    std::vector<unsigned> Depths;
+    std::vector<e_RIFFIOType> WriteIOs;
+    std::vector<e_RIFFIOType> ReadIOs;
+    std::vector<bool> Modes;
+    std::vector<struct BenchCase> Cases;
+    struct BenchCase Case;
+    const char *OutFilename;
+    FILE *Out;
+    bool Full;
+    unsigned s,d,m,w,r;
+    int arg;
+
+    ParseSizeList("8,64,512,4K,32K,256K,2M,16M,128M,1G",Sizes);
+    ParseDepthList("0,1,4,16,64",Depths);
+    WriteIOs.push_back(e_RIFFIO_Buffered);
+    WriteIOs.push_back(e_RIFFIO_MMap);
+    WriteIOs.push_back(e_RIFFIO_Direct);
+    ReadIOs.push_back(e_RIFFIO_Buffered);
+    ReadIOs.push_back(e_RIFFIO_ReadAhead);
+    Modes.push_back(false);
+    Modes.push_back(true);
+    OutFilename=NULL;
+    Full=false;
+
+    for(arg=1;arg<argc;arg++)
+    {
+        if(strcmp(argv[arg],"--full")==0)
+            Full=true;
+        else if(strcmp(argv[arg],"--cold")==0)
+            g_Cold=true;
+        else if(arg+1>=argc)
+            break;
+        else if(strcmp(argv[arg],"--dir")==0)
+            g_Dir=argv[++arg];
+        else if(strcmp(argv[arg],"--out")==0)
+            OutFilename=argv[++arg];
+        else if(strcmp(argv[arg],"--total")==0)
+        {
+            if(!ParseSize(argv[++arg],g_TotalBytes) || g_TotalBytes==0)
+                break;
+        }
+        else if(strcmp(argv[arg],"--sizes")==0)
+        {
+            if(!ParseSizeList(argv[++arg],Sizes))
+                break;
+        }
+        else if(strcmp(argv[arg],"--depths")==0)
+        {
+            if(!ParseDepthList(argv[++arg],Depths))
+                break;
+        }
+        else if(strcmp(argv[arg],"--write-io")==0)
+        {
+            if(!ParseIOList(argv[++arg],WriteIOs))
+                break;
+        }
+        else if(strcmp(argv[arg],"--read-io")==0)
+        {
+            if(!ParseIOList(argv[++arg],ReadIOs))
+                break;
+        }
+        else if(strcmp(argv[arg],"--modes")==0)
+        {
+            if(!ParseModeList(argv[++arg],Modes))
+                break;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if(arg<argc)
+    {
+        ShowHelp();
+        return 1;
+    }
+
+    if(Full)
+    {
+        /* Every combination */
+        for(s=0;s<Sizes.size();s++)
+        for(d=0;d<Depths.size();d++)
+        for(m=0;m<Modes.size();m++)
+        for(w=0;w<WriteIOs.size();w++)
+        for(r=0;r<ReadIOs.size();r++)
+        {
+            Case.ChunkSize=Sizes[s];
+            Case.Depth=Depths[d];
+            Case.IFF=Modes[m];
+            Case.WriteIO=WriteIOs[w];
+            Case.ReadIO=ReadIOs[r];
+            AddCase(Cases,Case);
+        }
+    }
+    else
+    {
+        /* Change one thing at a time from 4K chunks (if tested) and the
+           first of each of the other lists */
+        Case.ChunkSize=Sizes[0];
+        for(s=0;s<Sizes.size();s++)
+            if(Sizes[s]==4096)
+                Case.ChunkSize=4096;
+        Case.Depth=Depths[0];
+        Case.IFF=Modes[0];
+        Case.WriteIO=WriteIOs[0];
+        Case.ReadIO=ReadIOs[0];
+
+        for(s=0;s<Sizes.size();s++)
+        {
+            struct BenchCase Tmp=Case;
+            Tmp.ChunkSize=Sizes[s];
+            AddCase(Cases,Tmp);
+        }
+        for(d=0;d<Depths.size();d++)
+        {
+            struct BenchCase Tmp=Case;
+            Tmp.Depth=Depths[d];
+            AddCase(Cases,Tmp);
+        }
+        for(m=0;m<Modes.size();m++)
+        {
+            struct BenchCase Tmp=Case;
+            Tmp.IFF=Modes[m];
+            AddCase(Cases,Tmp);
+        }
+        for(w=0;w<WriteIOs.size();w++)
+        {
+            struct BenchCase Tmp=Case;
+            Tmp.WriteIO=WriteIOs[w];
+            AddCase(Cases,Tmp);
+        }
+        for(r=0;r<ReadIOs.size();r++)
+        {
+            struct BenchCase Tmp=Case;
+            Tmp.ReadIO=ReadIOs[r];
+            AddCase(Cases,Tmp);
+        }
+    }
+
+    Out=stdout;
+    if(OutFilename!=NULL)
+    {
+        Out=fopen(OutFilename,"w");
+        if(Out==NULL)
+        {
+            fprintf(stderr,"Failed to open %s\n",OutFilename);
+            return 1;
+        }
+    }
+
+    for(s=0;s<IO_BUFFER_SIZE;s++)
+        g_IOBuffer[s]=(uint8_t)(s*31+7);
+
+    try
+    {
+        fprintf(Out,"{\n");
+        fprintf(Out,"  \"benchmark\": \"SimpleRIFF\",\n");
+        fprintf(Out,"  \"total_bytes\": %llu,\n",
+                (unsigned long long)g_TotalBytes);
+        fprintf(Out,"  \"cold_cache\": %s,\n",g_Cold?"true":"false");
+        fprintf(Out,"  \"results\": [\n");
+        for(s=0;s<Cases.size();s++)
+        {
+            fprintf(stderr,"Case %u of %u\n",s+1,(unsigned)Cases.size());
+            RunCase(Cases[s],Out,s==0);
+            fflush(Out);
+        }
+        fprintf(Out,"\n  ]\n");
+        fprintf(Out,"}\n");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        fprintf(stderr,"Error:%d, %s\n",err,RIFF::Error2Str(err));
+        return 1;
+    }
+
+    if(Out!=stdout)
+        fclose(Out);
+
+    return 0;
+}
+
+static void ShowHelp(void)
+{
+    printf("USAGE:\n");
+    printf("    bench [options]\n");
+    printf("WHERE:\n");
+    printf("    --dir DIR -- Where to write the test files (default .)\n");
+    printf("    --out FILE -- Write the JSON here instead of stdout\n");
+    printf("    --total SIZE -- Bytes of chunk data per test (default 64M).\n");
+    printf("                    At least 1 chunk is always written.\n");
+    printf("    --sizes LIST -- Chunk sizes to test (default 8,64,512,4K,\n");
+    printf("                    32K,256K,2M,16M,128M,1G)\n");
+    printf("    --depths LIST -- Group depths to test (default 0,1,4,16,64)\n");
+    printf("    --modes LIST -- riff,iff (default both)\n");
+    printf("    --write-io LIST -- buffered,mmap,direct (default all)\n");
+    printf("    --read-io LIST -- buffered,readahead (default all)\n");
+    printf("    --full -- Test every combination instead of changing one\n");
+    printf("              thing at a time from the first of each list\n");
+    printf("              (and 4K chunks)\n");
+    printf("    --cold -- Drop the file from the cache before reading\n");
+}
+
+static bool ParseSize(const char *Str,uint64_t &Size)
+{
+    char *End;
+
+    Size=strtoull(Str,&End,10);
+    if(End==Str)
+        return false;
+    switch(*End)
+    {
+        case 0:
+        case ',':
+            return true;
+        case 'K':
+        case 'k':
+            Size*=1024;
+            return true;
+        case 'M':
+        case 'm':
+            Size*=1024*1024;
+            return true;
+        case 'G':
+        case 'g':
+            Size*=1024*1024*1024;
+            return true;
+    }
+    return false;
+}
+
+static bool ParseSizeList(const char *Str,std::vector<uint32_t> &List)
+{
+    uint64_t Size;
+
+    List.clear();
+    while(*Str!=0)
+    {
+        if(!ParseSize(Str,Size) || Size==0 || Size>0x7FFFFFFF)
+            return false;
+        List.push_back(Size);
+        Str=strchr(Str,',');
+        if(Str==NULL)
+            break;
+        Str++;
+    }
+    return !List.empty();
+}
+
+static bool ParseDepthList(const char *Str,std::vector<unsigned> &List)
+{
+    char *End;
+
+    List.clear();
+    while(*Str!=0)
+    {
+        List.push_back(strtoul(Str,&End,10));
+        if(End==Str)
+            return false;
+        if(*End==0)
+            break;
+        Str=End+1;
+    }
+    return !List.empty();
+}
+
+static bool ParseIOList(const char *Str,std::vector<e_RIFFIOType> &List)
+{
+    std::string Token;
+
+    List.clear();
+    while(NextToken(Str,Token))
+    {
+        if(strcmp(Token.c_str(),"buffered")==0)
+            List.push_back(e_RIFFIO_Buffered);
+        else if(strcmp(Token.c_str(),"readahead")==0)
+            List.push_back(e_RIFFIO_ReadAhead);
+        else if(strcmp(Token.c_str(),"mmap")==0)
+            List.push_back(e_RIFFIO_MMap);
+        else if(strcmp(Token.c_str(),"direct")==0)
+            List.push_back(e_RIFFIO_Direct);
+        else
+            return false;
+    }
+    return !List.empty();
+}
+
+/* 'List' is true for IFF */
+static bool ParseModeList(const char *Str,std::vector<bool> &List)
+{
+    std::string Token;
+
+    List.clear();
+    while(NextToken(Str,Token))
+    {
+        if(strcmp(Token.c_str(),"riff")==0)
+            List.push_back(false);
+        else if(strcmp(Token.c_str(),"iff")==0)
+            List.push_back(true);
+        else
+            return false;
+    }
+    return !List.empty();
+}
+
+/* Pull the next ',' separated item off the front of 'Str' */
+static bool NextToken(const char *&Str,std::string &Token)
+{
+    const char *End;
+
+    if(*Str==0)
+        return false;
+
+    End=strchr(Str,',');
+    if(End==NULL)
+        End=Str+strlen(Str);
+    Token.assign(Str,End-Str);
+    Str=*End==0?End:End+1;
+
+    return true;
+}
+
+static const char *IOName(e_RIFFIOType IO)
+{
+    switch(IO)
+    {
+        case e_RIFFIO_Buffered:
+            return "buffered";
+        case e_RIFFIO_ReadAhead:
+            return "readahead";
+        case e_RIFFIO_MMap:
+            return "mmap";
+        case e_RIFFIO_Direct:
+            return "direct";
+    }
+    return "unknown";
+}
+
+/* Add a case if we don't already have it */
+static void AddCase(std::vector<struct BenchCase> &Cases,
+        const struct BenchCase &Case)
+{
+    unsigned r;
+
+    for(r=0;r<Cases.size();r++)
+    {
+        if(Cases[r].ChunkSize==Case.ChunkSize && Cases[r].Depth==Case.Depth &&
+                Cases[r].IFF==Case.IFF && Cases[r].WriteIO==Case.WriteIO &&
+                Cases[r].ReadIO==Case.ReadIO)
+        {
+            return;
+        }
+    }
+    Cases.push_back(Case);
+}
+
+static void RunCase(const struct BenchCase &Case,FILE *Out,bool First)
+{
+    struct PhaseResult WriteResult;
+    struct PhaseResult ReadResult;
+    std::string Filename;
+    uint64_t Chunks;
+
+    Chunks=g_TotalBytes/Case.ChunkSize;
+    if(Chunks==0)
+        Chunks=1;
+
+    Filename=std::string(g_Dir)+"/bench.riff";
+
+    WriteTest(Case,Filename.c_str(),Chunks,WriteResult);
+    if(g_Cold)
+        DropCache(Filename.c_str());
+    ReadTest(Case,Filename.c_str(),ReadResult);
+    remove(Filename.c_str());
+
+    if(ReadResult.Bytes!=WriteResult.Bytes ||
+            ReadResult.Chunks!=WriteResult.Chunks)
+    {
+        fprintf(stderr,"Read back did not match what was written\n");
+        exit(1);
+    }
+
+    fprintf(Out,"%s    {\n",First?"":",\n");
+    fprintf(Out,"      \"chunk_size\": %u,\n",Case.ChunkSize);
+    fprintf(Out,"      \"chunks\": %llu,\n",(unsigned long long)Chunks);
+    fprintf(Out,"      \"depth\": %u,\n",Case.Depth);
+    fprintf(Out,"      \"mode\": \"%s\",\n",Case.IFF?"iff":"riff");
+    fprintf(Out,"      \"write_io\": \"%s\",\n",IOName(Case.WriteIO));
+    fprintf(Out,"      \"read_io\": \"%s\",\n",IOName(Case.ReadIO));
+    PrintPhase(Out,"write",WriteResult);
+    fprintf(Out,",\n");
+    PrintPhase(Out,"read",ReadResult);
+    fprintf(Out,"\n    }");
+}
+
+static void WriteTest(const struct BenchCase &Case,const char *Filename,
+        uint64_t Chunks,struct PhaseResult &Result)
+{
+    class RIFF RIFF(Case.IFF);
+    struct IOCounters Before;
+    struct IOCounters After;
+    t_Clock::time_point Start;
+    t_Clock::time_point ChunkStart;
+    t_Clock::time_point End;
+    uint64_t NewCallsBefore;
+    uint32_t Left;
+    uint32_t Bytes;
+    uint64_t c;
+    unsigned d;
+
+    HistClear(Result.Latency);
+    Result.Bytes=0;
+    Result.Chunks=0;
+
+    GetIOCounters(Before);
+    NewCallsBefore=g_NewCalls;
+    Start=t_Clock::now();
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"BNCH",Case.WriteIO);
+    for(d=0;d<Case.Depth;d++)
+        RIFF.StartGroup("NEST");
+
+    for(c=0;c<Chunks;c++)
+    {
+        ChunkStart=t_Clock::now();
+
+        RIFF.StartDataBlock("DATA");
+        Left=Case.ChunkSize;
+        while(Left>0)
+        {
+            Bytes=Left;
+            if(Bytes>IO_BUFFER_SIZE)
+                Bytes=IO_BUFFER_SIZE;
+            RIFF.Write(g_IOBuffer,Bytes);
+            Left-=Bytes;
+        }
+        RIFF.EndDataBlock();
+
+        HistAdd(Result.Latency,std::chrono::duration_cast<
+                std::chrono::nanoseconds>(t_Clock::now()-ChunkStart).count());
+        Result.Bytes+=Case.ChunkSize;
+        Result.Chunks++;
+    }
+
+    for(d=0;d<Case.Depth;d++)
+        RIFF.EndGroup();
+    RIFF.Close();
+
+    End=t_Clock::now();
+    Result.NewCalls=g_NewCalls-NewCallsBefore;
+    GetIOCounters(After);
+
+    Result.Seconds=std::chrono::duration<double>(End-Start).count();
+    Result.ReadSyscalls=-1;
+    Result.WriteSyscalls=-1;
+    if(Before.ReadSyscalls>=0 && After.ReadSyscalls>=0)
+    {
+        Result.ReadSyscalls=After.ReadSyscalls-Before.ReadSyscalls;
+        Result.WriteSyscalls=After.WriteSyscalls-Before.WriteSyscalls;
+    }
+}
+
+static void ReadTest(const struct BenchCase &Case,const char *Filename,
+        struct PhaseResult &Result)
+{
+    class RIFF RIFF(Case.IFF);
+    struct IOCounters Before;
+    struct IOCounters After;
+    t_Clock::time_point Start;
+    t_Clock::time_point End;
+    uint64_t NewCallsBefore;
+
+    HistClear(Result.Latency);
+    Result.Bytes=0;
+    Result.Chunks=0;
+
+    GetIOCounters(Before);
+    NewCallsBefore=g_NewCalls;
+    Start=t_Clock::now();
+
+    RIFF.Open(Filename,e_RIFFOpen_Read,"BNCH",Case.ReadIO);
+    ReadGroup(RIFF,Result);
+    RIFF.Close();
+
+    End=t_Clock::now();
+    Result.NewCalls=g_NewCalls-NewCallsBefore;
+    GetIOCounters(After);
+
+    Result.Seconds=std::chrono::duration<double>(End-Start).count();
+    Result.ReadSyscalls=-1;
+    Result.WriteSyscalls=-1;
+    if(Before.ReadSyscalls>=0 && After.ReadSyscalls>=0)
+    {
+        Result.ReadSyscalls=After.ReadSyscalls-Before.ReadSyscalls;
+        Result.WriteSyscalls=After.WriteSyscalls-Before.WriteSyscalls;
+    }
+}
+
+static void ReadGroup(class RIFF &RIFF,struct PhaseResult &Result)
+{
+    t_Clock::time_point ChunkStart;
+    e_RIFFDataType DataType;
+    char ChunkID[5];
+    uint32_t ChunkLen;
+    uint32_t Bytes;
+
+    for(;;)
+    {
+        ChunkStart=t_Clock::now();
+        if(!RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+            break;
+
+        if(DataType==e_RIFFData_Group)
+        {
+            RIFF.StartReadingGroup();
+            ReadGroup(RIFF,Result);
+            RIFF.DoneReadingGroup();
+            continue;
+        }
+
+        Result.Bytes+=ChunkLen;
+        while(ChunkLen>0)
+        {
+            Bytes=ChunkLen;
+            if(Bytes>IO_BUFFER_SIZE)
+                Bytes=IO_BUFFER_SIZE;
+            RIFF.Read(g_IOBuffer,Bytes);
+            ChunkLen-=Bytes;
+        }
+
+        HistAdd(Result.Latency,std::chrono::duration_cast<
+                std::chrono::nanoseconds>(t_Clock::now()-ChunkStart).count());
+        Result.Chunks++;
+    }
+}
+
+/* Try to get the file out of the page cache so we read from the disk */
+static void DropCache(const char *Filename)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int fd;
+
+    fd=open(Filename,O_RDONLY);
+    if(fd<0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+    close(fd);
+#endif
+}
+
+/* Get the number of read / write system calls we have made (Linux only) */
+static void GetIOCounters(struct IOCounters &Counters)
+{
+    FILE *in;
+    char Line[100];
+    long long Value;
+
+    Counters.ReadSyscalls=-1;
+    Counters.WriteSyscalls=-1;
+
+    in=fopen("/proc/self/io","r");
+    if(in==NULL)
+        return;
+
+    while(fgets(Line,sizeof(Line),in)!=NULL)
+    {
+        if(sscanf(Line,"syscr: %lld",&Value)==1)
+            Counters.ReadSyscalls=Value;
+        else if(sscanf(Line,"syscw: %lld",&Value)==1)
+            Counters.WriteSyscalls=Value;
+    }
+    fclose(in);
+}
+
+static void HistClear(struct LatencyHist &Hist)
+{
+    memset(&Hist,0,sizeof(Hist));
+}
+
+/* Log / linear buckets: 8 buckets for each power of 2 */
+static void HistAdd(struct LatencyHist &Hist,uint64_t ns)
+{
+    unsigned Bit;
+    unsigned Sub;
+
+    if(ns>Hist.Max)
+        Hist.Max=ns;
+    Hist.Samples++;
+
+    if(ns<HIST_SUB_BUCKETS)
+    {
+        Hist.Counts[ns]++;
+        return;
+    }
+
+    Bit=63-__builtin_clzll(ns);
+    Sub=(ns>>(Bit-3))&(HIST_SUB_BUCKETS-1);
+    Hist.Counts[(Bit-2)*HIST_SUB_BUCKETS+Sub]++;
+}
+
+static uint64_t HistPercentile(const struct LatencyHist &Hist,double Percent)
+{
+    uint64_t Want;
+    uint64_t Count;
+    unsigned Bucket;
+    unsigned Bit;
+
+    if(Hist.Samples==0)
+        return 0;
+
+    Want=(uint64_t)(Hist.Samples*Percent/100.0);
+    if(Want>=Hist.Samples)
+        Want=Hist.Samples-1;
+
+    Count=0;
+    for(Bucket=0;Bucket<HIST_BUCKETS;Bucket++)
+    {
+        Count+=Hist.Counts[Bucket];
+        if(Count>Want)
+            break;
+    }
+
+    if(Bucket<HIST_SUB_BUCKETS)
+        return Bucket;
+
+    /* Return the middle of the bucket */
+    Bit=Bucket/HIST_SUB_BUCKETS+2;
+    return ((uint64_t)(HIST_SUB_BUCKETS+Bucket%HIST_SUB_BUCKETS)<<(Bit-3))+
+            ((1ULL<<(Bit-3))/2);
+}
+
+static void PrintPhase(FILE *Out,const char *Name,
+        const struct PhaseResult &Result)
+{
+    double Seconds;
+
+    Seconds=Result.Seconds;
+    if(Seconds<=0)
+        Seconds=1e-9;
+
+    fprintf(Out,"      \"%s\": {\n",Name);
+    fprintf(Out,"        \"seconds\": %.6f,\n",Result.Seconds);
+    fprintf(Out,"        \"bytes\": %llu,\n",(unsigned long long)Result.Bytes);
+    fprintf(Out,"        \"mb_per_s\": %.3f,\n",
+            Result.Bytes/Seconds/(1024*1024));
+    fprintf(Out,"        \"chunks_per_s\": %.1f,\n",Result.Chunks/Seconds);
+    fprintf(Out,"        \"chunk_latency_ns\": {\"p50\": %llu, \"p99\": %llu, "
+            "\"p999\": %llu, \"max\": %llu},\n",
+            (unsigned long long)HistPercentile(Result.Latency,50),
+            (unsigned long long)HistPercentile(Result.Latency,99),
+            (unsigned long long)HistPercentile(Result.Latency,99.9),
+            (unsigned long long)Result.Latency.Max);
+    fprintf(Out,"        \"read_syscalls\": %lld,\n",
+            (long long)Result.ReadSyscalls);
+    fprintf(Out,"        \"write_syscalls\": %lld,\n",
+            (long long)Result.WriteSyscalls);
+    fprintf(Out,"        \"new_calls\": %llu\n",
+            (unsigned long long)Result.NewCalls);
+    fprintf(Out,"      }");
+}
@@ -0,0 +1 @@
+g++ -g -I ../../src ../../src/RIFF.cpp ../../src/RIFFIO.cpp main.cpp -o main
@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of using the data type returned by
+ *    ReadNextDataBlock() to tell groups from data blocks.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*** DEFINES                  ***/
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static int ReadFile(const char *Filename);
+static int CheckType(const char *ChunkID,e_RIFFDataType DataType,
+        const char *Expected,e_RIFFDataType ExpectedType,int Depth);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    int Errors;
+
+    Errors=0;
+    try
+    {
+        WriteFile("Types.RIFF");
+
+        /* Read it back and check what type each chunk comes back as */
+        Errors=ReadFile("Types.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+        return 1;
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+        return 1;
+    }
+
+    if(Errors!=0)
+    {
+        printf("FAILED: %d chunk(s) had the wrong type\n",Errors);
+        return 1;
+    }
+
+    printf("All chunk types OK\n");
+    return 0;
+}
+
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"TYPE");
+
+    RIFF.StartDataBlock("HEAD");
+    RIFF.Write("header",7);
+    RIFF.EndDataBlock();
+    RIFF.StartGroup("META");
+        RIFF.StartDataBlock("AUTH");
+        RIFF.Write("Row",4);
+        RIFF.EndDataBlock();
+        RIFF.StartGroup("DATE");
+            RIFF.StartDataBlock("TIME");
+            RIFF.Write("4:00pm",7);
+            RIFF.EndDataBlock();
+        RIFF.EndGroup();
+    RIFF.EndGroup();
+    RIFF.StartDataBlock("BODY");
+    RIFF.Write("body",5);
+    RIFF.EndDataBlock();
+
+    RIFF.Close();
+}
+
+/* Print the chunk and check it is what we wrote.  Returns 1 if it isn't */
+int CheckType(const char *ChunkID,e_RIFFDataType DataType,
+        const char *Expected,e_RIFFDataType ExpectedType,int Depth)
+{
+    bool Match;
+
+    Match=strcmp(ChunkID,Expected)==0 && DataType==ExpectedType;
+    printf("%*s%s %s%s\n",Depth*4,"",ChunkID,
+            DataType==e_RIFFData_Group?"(group)":"(data block)",
+            Match?"":"  <-- WRONG");
+
+    return Match?0:1;
+}
+
+int ReadFile(const char *Filename)
+{
+    /* The chunks we wrote, in file order.  Groups are followed by
+       what is inside them. */
+    static const struct
+    {
+        const char *ChunkID;
+        e_RIFFDataType Type;
+        int Depth;
+    } Expected[]=
+    {
+        {"HEAD",e_RIFFData_DataBlock,0},
+        {"META",e_RIFFData_Group,0},
+        {"AUTH",e_RIFFData_DataBlock,1},
+        {"DATE",e_RIFFData_Group,1},
+        {"TIME",e_RIFFData_DataBlock,2},
+        {"BODY",e_RIFFData_DataBlock,0},
+    };
+    class RIFF RIFF;
+    char ChunkID[5];
+    uint32_t ChunkLen;
+    e_RIFFDataType DataType;
+    unsigned Next;
+    int Depth;
+    int Errors;
+
+    Errors=0;
+    Depth=0;
+    Next=0;
+    RIFF.Open(Filename,e_RIFFOpen_Read,"TYPE");
+    while(Next<sizeof(Expected)/sizeof(Expected[0]))
+    {
+        /* Pop out of the groups we have finished */
+        while(Depth>Expected[Next].Depth)
+        {
+            if(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+                throw("Extra chunk at the end of a group");
+            RIFF.DoneReadingGroup();
+            Depth--;
+        }
+
+        if(!RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+            throw("File ended early");
+        Errors+=CheckType(ChunkID,DataType,Expected[Next].ChunkID,
+                Expected[Next].Type,Depth);
+
+        if(Expected[Next].Type==e_RIFFData_Group)
+        {
+            RIFF.StartReadingGroup();
+            Depth++;
+        }
+        Next++;
+    }
+    if(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+        throw("Extra chunk at the end of the file");
+    RIFF.Close();
+
+    return Errors;
+}
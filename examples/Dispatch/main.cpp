@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of reading a file with the RIFFDispatcher class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFDispatcher.h"
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static void ReadFile(const char *Filename);
+static void ShowText(class RIFF &RIFF,const struct RIFFDispatchInfo *Info,
+        void *UserData);
+static void ShowGroup(class RIFF &RIFF,const struct RIFFDispatchInfo *Info,
+        void *UserData);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Dispatch.RIFF");
+        ReadFile("Dispatch.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"ART ");
+
+    RIFF.StartGroup("META");
+        RIFF.WriteDataBlock("AUTH","Row",4);
+        RIFF.WriteDataBlock("DESC","Dispatcher example",19);
+        RIFF.StartGroup("DATE");
+            RIFF.WriteDataBlock("TIME","4:00pm",7);
+            RIFF.WriteDataBlock("DATE","08 Aug 2021",12);
+        RIFF.EndGroup();
+    RIFF.EndGroup();
+
+    /* Nothing wants this group so it is skipped without being read */
+    RIFF.StartGroup("JUNK");
+        RIFF.WriteDataBlock("TIME","Not this time",14);
+    RIFF.EndGroup();
+
+    RIFF.WriteDataBlock("BODY","  /\\_/\\\n ( o.o )\n  > ^ <",25);
+
+    RIFF.Close();
+}
+
+void ReadFile(const char *Filename)
+{
+    class RIFF RIFF;
+    class RIFFDispatcher Dispatcher;
+
+    Dispatcher.AddPathHandler("META",ShowGroup,NULL);
+    Dispatcher.AddPathHandler("META/AUTH",ShowText,(void *)"Author");
+    Dispatcher.AddPathHandler("META/DESC",ShowText,(void *)"Description");
+    Dispatcher.AddPathHandler("META/DATE/TIME",ShowText,(void *)"Time");
+    Dispatcher.AddPathHandler("META/DATE/DATE",ShowText,(void *)"Date");
+    Dispatcher.AddPathHandler("BODY",ShowText,(void *)"Body");
+
+    RIFF.Open(Filename,e_RIFFOpen_Read,"ART ");
+    Dispatcher.Dispatch(RIFF);
+    RIFF.Close();
+}
+
+void ShowText(class RIFF &RIFF,const struct RIFFDispatchInfo *Info,
+        void *UserData)
+{
+    char buff[100];
+
+    if(Info->ChunkSize>=sizeof(buff))
+        throw("Read buffer too small");
+
+    RIFF.Read(buff,Info->ChunkSize);
+    buff[Info->ChunkSize]=0;
+
+    printf("%*s%s:%s\n",Info->Depth*4,"",(const char *)UserData,buff);
+}
+
+void ShowGroup(class RIFF & /*RIFF*/,const struct RIFFDispatchInfo *Info,
+        void * /*UserData*/)
+{
+    printf("%*sReading %s\n",Info->Depth*4,"",Info->Path);
+}
@@ -1 +1 @@
-g++ -I ../../src ../../src/RIFF.cpp main.cpp -o main
+g++ -I ../../src ../../src/RIFF.cpp ../../src/RIFFIO.cpp main.cpp -o main
@@ -51,6 +51,9 @@ struct UserData
     uint8_t Age;
 };
 
+RIFF_STRUCT(UserData,RIFF_FIELD(UserData,Name),RIFF_FIELD(UserData,Password),
+        RIFF_FIELD(UserData,Age));
+
 struct BankData
 {
     uint32_t BankAccountNumber;
@@ -58,6 +61,9 @@ struct BankData
     char CreditRating;
 };
 
+RIFF_STRUCT(BankData,RIFF_FIELD(BankData,BankAccountNumber),
+        RIFF_FIELD(BankData,Balance),RIFF_FIELD(BankData,CreditRating));
+
 /*** FUNCTION PROTOTYPES      ***/
 static void ReadFile(const char *Filename,bool IFFMode);
 static void WriteFile(const char *Filename,bool IFFMode);
@@ -118,14 +124,10 @@ void WriteFile(const char *Filename,bool IFFMode)
     RIFF.Open(Filename,e_RIFFOpen_Write,"TEST");
 
     /* User chunk */
-    RIFF.StartDataBlock("USER");
-    RIFF.Write(&User,sizeof(User));
-    RIFF.EndDataBlock();
+    RIFF.WriteDataBlock("USER",User);
 
-    /* Bank chunk */
-    RIFF.StartDataBlock("BANK");
-    RIFF.Write(&Bank,sizeof(Bank));
-    RIFF.EndDataBlock();
+    /* Bank chunk (written packed and in the file's byte order) */
+    RIFF.WriteDataBlock("BANK",Bank);
 
     RIFF.Close();
 }
@@ -147,9 +149,9 @@ void ReadFile(const char *Filename,bool IFFMode)
         if(strcmp(ChunkID,"USER")==0)
         {
             printf("Reading USER\n");
-            if(ChunkLen!=sizeof(User))
+            if(ChunkLen!=RIFFStructLayout<UserData>::Size)
                 throw("Data error");
-            RIFF.Read(&User,sizeof(User));
+            RIFF.ReadStruct(User);
 
             /* Print the data */
             SAFTY_STRINGIZE(User.Name);
@@ -163,9 +165,10 @@ void ReadFile(const char *Filename,bool IFFMode)
         if(strcmp(ChunkID,"BANK")==0)
         {
             printf("Reading BANK\n");
-            if(ChunkLen!=sizeof(Bank))
+            if(ChunkLen!=RIFFStructLayout<BankData>::Size)
                 throw("Data error");
-            RIFF.Read(&Bank,sizeof(Bank));
+            memset(&Bank,0x00,sizeof(Bank));
+            RIFF.ReadStruct(Bank);
 
             /* Print the data */
             printf("    Account #%d\n",Bank.BankAccountNumber);
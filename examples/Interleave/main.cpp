@@ -0,0 +1,204 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ *    This file is an example of writing packets from a number of streams
+ *    with the RIFFInterleaver class and reading one stream back with the
+ *    RIFFInterleaveReader class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFInterleave.h"
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+#define SECONDS                 10
+#define VIDEO_US                33333   // 30 frames a second
+#define VIDEO_SIZE              20000
+#define AUDIO_US                20000   // 20ms of 48000Hz 16 bit stereo
+#define AUDIO_SIZE              3840
+#define SENSOR_US               1000    // A 12 byte reading every 1ms...
+#define SENSOR_SIZE             12
+#define SENSOR_BURST_US         10000   // ...that we get 10ms at a time
+#define WINDOW_US               20000
+#define SEGMENT_BYTES           (2*1024*1024)
+#define INDEX_RESERVE           (200*1024) // 16 bytes for each of ~11000 packets
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename,bool Segments);
+static void ReadFile(const char *Filename);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Interleave.RIFF",false);
+        ReadFile("Interleave.RIFF");
+
+        printf("\n");
+        WriteFile("Segments.RIFF",true);
+        ReadFile("Segments.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+/* Makes up 10 seconds of video, audio and sensor packets, with the time
+   stamps in us.  The sensor readings come in late (10ms at a time) so they
+   have to be put in order with the others.  With 'Segments' a new form is
+   started every 2M, without them room is saved at the front of the file for
+   the index. */
+void WriteFile(const char *Filename,bool Segments)
+{
+    class RIFF RIFF;
+    class RIFFInterleaver Interleaver;
+    struct RIFFStats Stats;
+    static uint8_t Video[VIDEO_SIZE];
+    static uint8_t Audio[AUDIO_SIZE];
+    uint8_t Sensor[SENSOR_SIZE];
+    unsigned VideoStream;
+    unsigned AudioStream;
+    unsigned SensorStream;
+    uint64_t Now;
+    uint64_t NextVideo;
+    uint64_t NextAudio;
+    uint64_t NextSensor;
+
+    memset(&Stats,0x00,sizeof(Stats));
+    RIFF.SetStats(&Stats);
+    RIFF.AddFrontChunk("ix00");
+    RIFF.AddFrontChunk("ix01");
+    RIFF.AddFrontChunk("ix02");
+    RIFF.Open(Filename,e_RIFFOpen_Write,"DEMO");
+    if(!Segments)
+        RIFF.ReserveFront(INDEX_RESERVE);
+
+    VideoStream=Interleaver.AddStream("00dc");
+    AudioStream=Interleaver.AddStream("01wb");
+    SensorStream=Interleaver.AddStream("02sd");
+    if(Segments)
+        Interleaver.SetSegments(SEGMENT_BYTES);
+    Interleaver.Open(RIFF,WINDOW_US);
+
+    NextVideo=0;
+    NextAudio=0;
+    NextSensor=0;
+    for(Now=0;Now<SECONDS*1000000;Now+=1000)
+    {
+        for(;NextVideo<=Now;NextVideo+=VIDEO_US)
+        {
+            memset(Video,NextVideo/VIDEO_US,sizeof(Video));
+            Interleaver.Write(VideoStream,NextVideo,Video,sizeof(Video));
+        }
+        for(;NextAudio<=Now;NextAudio+=AUDIO_US)
+        {
+            memset(Audio,NextAudio/AUDIO_US,sizeof(Audio));
+            Interleaver.Write(AudioStream,NextAudio,Audio,sizeof(Audio));
+        }
+        if(Now%SENSOR_BURST_US==SENSOR_BURST_US-1000)
+        {
+            for(;NextSensor<=Now;NextSensor+=SENSOR_US)
+            {
+                memset(Sensor,NextSensor/SENSOR_US,sizeof(Sensor));
+                Interleaver.Write(SensorStream,NextSensor,Sensor,
+                        sizeof(Sensor));
+            }
+        }
+    }
+    Interleaver.Close();
+
+    RIFF.Close();
+
+    printf("Wrote %llu data blocks in %u segment(s) with %llu writes and "
+            "%llu size fix ups\n",(unsigned long long)Stats.DataBlocks,
+            Interleaver.GetSegmentCount(),
+            (unsigned long long)Stats.IOWrite.Calls,
+            (unsigned long long)Stats.IOPatch.Calls);
+}
+
+/* Reads the sensor stream without reading the video or audio */
+void ReadFile(const char *Filename)
+{
+    class RIFFTree Tree;
+    class RIFFInterleaveReader Reader;
+    uint8_t Sensor[SENSOR_SIZE];
+    uint64_t LastTime;
+    uint32_t Packets;
+    uint32_t p;
+    unsigned s;
+
+    Tree.Open(Filename,"DEMO");
+    Reader.Open(Tree);
+    printf("%u segment(s)\n",Reader.GetSegmentCount());
+
+    for(s=0;s<Reader.GetStreamCount();s++)
+    {
+        printf("Stream %u (%s): %u packets\n",s,Reader.GetStreamID(s),
+                Reader.GetPacketCount(s));
+    }
+
+    Packets=Reader.GetPacketCount(2);
+    LastTime=0;
+    for(p=0;p<Packets;p++)
+    {
+        const struct RIFFInterleaveEntry &Entry=Reader.GetPacket(2,p);
+        if(Entry.Bytes!=sizeof(Sensor) || Entry.Time<LastTime)
+            throw("Bad sensor packet");
+        Reader.ReadPacket(2,p,Sensor);
+        if(Sensor[0]!=(uint8_t)(Entry.Time/SENSOR_US))
+            throw("Bad sensor data");
+        LastTime=Entry.Time;
+    }
+    printf("Checked %u sensor packets\n",Packets);
+
+    /* Jump to 5 seconds in the video */
+    p=Reader.FindPacket(0,5000000);
+    printf("Video frame at 5s is packet %u (%lluus)\n",p,
+            (unsigned long long)Reader.GetPacket(0,p).Time);
+
+    Tree.Close();
+}
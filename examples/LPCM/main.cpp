@@ -0,0 +1,216 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of storing WAV samples with the lossless PCM
+ *    codec (RIFFLPCMWriter / RIFFLPCMReader).
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFLPCM.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+/*** DEFINES                  ***/
+#define SAMPLE_RATE     44100
+#define CHANNELS        2
+#define FRAMES          (SAMPLE_RATE*5)
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+struct fmt
+{
+    uint16_t AudioFormat;
+    uint16_t NumChannels;
+    uint32_t SampleRate;
+    uint32_t ByteRate;
+    uint16_t BlockAlign;
+    uint16_t BitsPerSample;
+};
+RIFF_STRUCT(fmt,
+    RIFF_FIELD(fmt,AudioFormat),
+    RIFF_FIELD(fmt,NumChannels),
+    RIFF_FIELD(fmt,SampleRate),
+    RIFF_FIELD(fmt,ByteRate),
+    RIFF_FIELD(fmt,BlockAlign),
+    RIFF_FIELD(fmt,BitsPerSample));
+
+/*** FUNCTION PROTOTYPES      ***/
+static void MakeSamples(std::vector<int16_t> &Samples);
+static uint32_t WriteFile(const char *Filename,
+        const std::vector<int16_t> &Samples,bool Compress);
+static void ReadFile(const char *Filename,const std::vector<int16_t> &Samples);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    std::vector<int16_t> Samples;
+    uint32_t PlainSize;
+    uint32_t LPCMSize;
+
+    try
+    {
+        MakeSamples(Samples);
+
+        PlainSize=WriteFile("Plain.wav",Samples,false);
+        LPCMSize=WriteFile("LPCM.wav",Samples,true);
+        printf("\"data\" chunk:%u bytes\n",PlainSize);
+        printf("\"LPCM\" chunk:%u bytes (%.1f%%)\n",LPCMSize,
+                LPCMSize*100.0/PlainSize);
+
+        ReadFile("LPCM.wav",Samples);
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+/* A chord with a little noise on it, a bit different on each side */
+void MakeSamples(std::vector<int16_t> &Samples)
+{
+    uint32_t f;
+    double t;
+    double Left;
+    double Right;
+
+    srand(1);
+    Samples.resize(FRAMES*CHANNELS);
+    for(f=0;f<FRAMES;f++)
+    {
+        t=(double)f/SAMPLE_RATE;
+        Left=sin(2*M_PI*220*t)*6000+sin(2*M_PI*277*t)*4000;
+        Right=Left*0.8+sin(2*M_PI*330*t)*3000;
+        Samples[f*CHANNELS+0]=(int16_t)Left+rand()%16-8;
+        Samples[f*CHANNELS+1]=(int16_t)Right+rand()%16-8;
+    }
+}
+
+uint32_t WriteFile(const char *Filename,const std::vector<int16_t> &Samples,
+        bool Compress)
+{
+    class RIFF RIFF;
+    class RIFFLPCMWriter LPCM;
+    struct fmt fmt;
+    char ChunkID[5];
+    uint32_t ChunkSize;
+    uint32_t f;
+    uint32_t Size;
+
+    fmt.AudioFormat=1;
+    fmt.NumChannels=CHANNELS;
+    fmt.SampleRate=SAMPLE_RATE;
+    fmt.ByteRate=SAMPLE_RATE*CHANNELS*sizeof(int16_t);
+    fmt.BlockAlign=CHANNELS*sizeof(int16_t);
+    fmt.BitsPerSample=16;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"WAVE");
+    RIFF.StartDataBlock("fmt ");
+    RIFF.WriteStruct(fmt);
+    RIFF.EndDataBlock();
+
+    if(Compress)
+    {
+        /* The samples are written as they would be in a "data" chunk */
+        LPCM.Start(RIFF,CHANNELS,16);
+        for(f=0;f<FRAMES;f+=1000)
+            LPCM.Write(&Samples[f*CHANNELS],FRAMES-f<1000?FRAMES-f:1000);
+        LPCM.End();
+    }
+    else
+    {
+        RIFF.WriteDataBlock("data",Samples.data(),
+                Samples.size()*sizeof(int16_t));
+    }
+    RIFF.Close();
+
+    /* Find out how big the sample chunk was */
+    RIFF.Open(Filename,e_RIFFOpen_Read,"WAVE");
+    Size=0;
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkSize))
+        if(strcmp(ChunkID,"fmt ")!=0)
+            Size=ChunkSize;
+    RIFF.Close();
+
+    return Size;
+}
+
+void ReadFile(const char *Filename,const std::vector<int16_t> &Samples)
+{
+    class RIFF RIFF;
+    class RIFFLPCMReader LPCM;
+    char ChunkID[5];
+    uint32_t ChunkSize;
+    std::vector<int16_t> Buffer;
+    uint32_t Frames;
+    uint32_t Frame;
+
+    RIFF.Open(Filename,e_RIFFOpen_Read,"WAVE");
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkSize))
+    {
+        if(strcmp(ChunkID,RIFFLPCM_CHUNK_ID)!=0)
+            continue;
+
+        LPCM.Start(RIFF,ChunkSize);
+        printf("%u channels, %u bits, %u frames\n",LPCM.GetChannels(),
+                LPCM.GetBitsPerSample(),LPCM.GetFrames());
+
+        Buffer.resize(LPCM.GetFrames()*LPCM.GetChannels());
+        Frames=LPCM.Read(Buffer.data(),LPCM.GetFrames());
+        if(Frames!=FRAMES || Buffer!=Samples)
+            throw("Samples did not match");
+        printf("Read back all the samples and they match\n");
+
+        /* Only the block with the frame in it is decoded */
+        Frame=SAMPLE_RATE*3+123;
+        LPCM.SeekFrame(Frame);
+        LPCM.Read(Buffer.data(),1);
+        if(memcmp(Buffer.data(),&Samples[Frame*CHANNELS],
+                CHANNELS*sizeof(int16_t))!=0)
+        {
+            throw("Seek did not match");
+        }
+        printf("Seek to frame %u matches\n",Frame);
+    }
+    RIFF.Close();
+}
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of reading a file with the RIFFTree class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFTree.h"
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+#define FRAMES_TO_WRITE         100
+#define FRAME_SIZE              10000
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static void ReadFile(const char *Filename);
+static void ShowNode(class RIFFNode *Node,int Depth);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Tree.RIFF");
+        ReadFile("Tree.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+    static uint8_t Frame[FRAME_SIZE];
+    int f;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"TREE");
+
+    RIFF.StartGroup("INFO");
+        RIFF.StartDataBlock("INAM");
+        RIFF.Write("Lazy tree example",18);
+        RIFF.EndDataBlock();
+
+        RIFF.StartDataBlock("ICMT");
+        RIFF.Write("Only what you look at is read",30);
+        RIFF.EndDataBlock();
+    RIFF.EndGroup();
+
+    RIFF.StartGroup("movi");
+    for(f=0;f<FRAMES_TO_WRITE;f++)
+    {
+        memset(Frame,f,sizeof(Frame));
+        RIFF.StartDataBlock("FRAM");
+        RIFF.Write(Frame,sizeof(Frame));
+        RIFF.EndDataBlock();
+    }
+    RIFF.EndGroup();
+
+    RIFF.Close();
+}
+
+void ReadFile(const char *Filename)
+{
+    class RIFFTree Tree;
+    class RIFFNode *Node;
+    class RIFFNode *Movi;
+    uint8_t Byte;
+    unsigned r;
+
+    Tree.Open(Filename,"TREE");
+
+    /* Get a chunk by path.  Only the INFO group is read, not movi */
+    Node=Tree.GetRoot()->Find("INFO/INAM");
+    if(Node==NULL)
+        throw("INAM not found");
+    printf("Name:%s\n",(const char *)Node->GetData());
+
+    /* Keep at most 5 frames in memory */
+    Tree.SetCacheLimit(FRAME_SIZE*5);
+
+    Movi=Tree.GetRoot()->FindChild("movi");
+    if(Movi==NULL)
+        throw("movi not found");
+    for(r=0;r<Movi->GetChildCount();r++)
+    {
+        Node=Movi->GetChild(r);
+        if(Node->GetData()[FRAME_SIZE-1]!=(uint8_t)r)
+            throw("Bad frame data");
+    }
+    printf("Checked %u frames, %llu bytes loaded\n",Movi->GetChildCount(),
+            (unsigned long long)Tree.GetCachedBytes());
+
+    /* Read one byte from a frame without loading it */
+    Movi->GetChild(0)->Read(&Byte,0,1);
+    printf("First byte of frame 0:%d\n",Byte);
+
+    printf("\n");
+    ShowNode(Tree.GetRoot(),0);
+
+    Tree.Close();
+}
+
+void ShowNode(class RIFFNode *Node,int Depth)
+{
+    unsigned r;
+
+    printf("%*s%s %s @ %llu, %u bytes\n",Depth*4,"",
+            Node->IsGroup()?"LIST":"Chunk",Node->GetID(),
+            (unsigned long long)Node->GetOffset(),Node->GetSize());
+
+    for(r=0;r<Node->GetChildCount() && r<4;r++)
+        ShowNode(Node->GetChild(r),Depth+1);
+    if(r<Node->GetChildCount())
+        printf("%*s... %u more\n",(Depth+1)*4,"",Node->GetChildCount()-r);
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of processing chunks on all cores with the
+ *    RIFFVisitor class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFVisitor.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*** DEFINES                  ***/
+#define BLOCKS_TO_WRITE         10
+#define BLOCK_SIZE              100000
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static void ReadFile(const char *Filename);
+static void *SumHandler(const struct RIFFVisitJob *Job,const uint8_t *Data,
+        void *UserData);
+static void *TextHandler(const struct RIFFVisitJob *Job,const uint8_t *Data,
+        void *UserData);
+static void ShowResult(const struct RIFFVisitJob *Job,void *Result,
+        void *UserData);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Visit.RIFF");
+        ReadFile("Visit.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+    uint8_t *Block;
+    int b;
+    int r;
+
+    Block=(uint8_t *)malloc(BLOCK_SIZE);
+    if(Block==NULL)
+        throw("Out of memory");
+
+    /* Add a checksum for each data block */
+    RIFF.SetChecksums(true);
+    RIFF.Open(Filename,e_RIFFOpen_Write,"VIST");
+
+    RIFF.StartGroup("INFO");
+        RIFF.StartDataBlock("INAM");
+        RIFF.Write("Parallel visit",15);
+        RIFF.EndDataBlock();
+    RIFF.EndGroup();
+
+    for(b=0;b<BLOCKS_TO_WRITE;b++)
+    {
+        for(r=0;r<BLOCK_SIZE;r++)
+            Block[r]=(uint8_t)(r*b);
+
+        RIFF.StartDataBlock("BLCK");
+        RIFF.Write(Block,BLOCK_SIZE);
+        RIFF.EndDataBlock();
+    }
+
+    RIFF.Close();
+
+    free(Block);
+}
+
+void ReadFile(const char *Filename)
+{
+    class RIFFVisitor Visitor;
+
+    Visitor.AddHandler("BLCK",SumHandler,NULL);
+    Visitor.AddPathHandler("INFO/INAM",TextHandler,NULL);
+    Visitor.SetResultHandler(ShowResult,NULL);
+
+    /* Let the threads work on a quarter of a block at a time */
+    Visitor.SetSplitSize(BLOCK_SIZE/4);
+
+    Visitor.Visit(Filename,"VIST");
+
+    printf("Bad chunks: %u\n",Visitor.VerifyChecksums(Filename,"VIST"));
+}
+
+/* Called from the worker threads */
+void *SumHandler(const struct RIFFVisitJob *Job,const uint8_t *Data,
+        void * /*UserData*/)
+{
+    uintptr_t Sum;
+    uint32_t r;
+
+    Sum=0;
+    for(r=0;r<Job->RangeBytes;r++)
+        Sum+=Data[r];
+
+    return (void *)Sum;
+}
+
+/* Called from the worker threads */
+void *TextHandler(const struct RIFFVisitJob *Job,const uint8_t *Data,
+        void * /*UserData*/)
+{
+    char *Str;
+
+    Str=(char *)malloc(Job->RangeBytes+1);
+    if(Str==NULL)
+        throw("Out of memory");
+    memcpy(Str,Data,Job->RangeBytes);
+    Str[Job->RangeBytes]=0;
+
+    return Str;
+}
+
+/* Called in file order from the thread that called Visit() */
+void ShowResult(const struct RIFFVisitJob *Job,void *Result,
+        void * /*UserData*/)
+{
+    if(strcmp(Job->ChunkID,"INAM")==0)
+    {
+        printf("%s: %s\n",Job->Path,(char *)Result);
+        free(Result);
+        return;
+    }
+
+    printf("%s @ %u [%u-%u]: sum %lu\n",Job->Path,Job->ChunkOffset,
+            Job->RangeStart,Job->RangeStart+Job->RangeBytes,
+            (unsigned long)(uintptr_t)Result);
+}
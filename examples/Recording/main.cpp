@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of committing the sizes in a file while it is
+ *    being written, so the file can be read before it is closed.
+ *
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/*** DEFINES                  ***/
+#define LINES_PER_COMMIT        100
+#define BLOB_SIZE               (200*1024)
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static void WriteLines(class RIFF &RIFF,unsigned First,unsigned Count);
+static void CopyFile(const char *From,const char *To);
+static void ReadFile(const char *Filename);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Recording.RIFF");
+
+        ReadFile("Commit1.RIFF");
+        ReadFile("Commit2.RIFF");
+        ReadFile("Commit3.RIFF");
+        ReadFile("Recording.RIFF");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+/* Writes log lines into a "logs" group with a compressed "blob" data block
+   in the middle.  After each step the file is committed and copied, which
+   is what another program (or the disk after a crash) would see if the
+   writer stopped right there. */
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+    std::vector<uint8_t> Blob;
+    unsigned r;
+
+    /* Commit every 64K or 1/2 a second, whichever comes first */
+    RIFF.SetCommitInterval(64*1024,500);
+    RIFF.Open(Filename,e_RIFFOpen_Write,"RECD");
+    RIFF.StartGroup("logs");
+
+    WriteLines(RIFF,0,LINES_PER_COMMIT);
+    RIFF.Commit();
+    CopyFile(Filename,"Commit1.RIFF");
+
+    /* An open compressed data block is left out of a commit */
+    Blob.resize(BLOB_SIZE);
+    for(r=0;r<Blob.size();r++)
+        Blob[r]=r/1000;
+    RIFF.StartDataBlock("blob",e_RIFFCompress_LZ);
+    RIFF.Write(Blob.data(),Blob.size());
+    RIFF.Commit();
+    CopyFile(Filename,"Commit2.RIFF");
+    RIFF.EndDataBlock();
+
+    WriteLines(RIFF,LINES_PER_COMMIT,LINES_PER_COMMIT);
+    RIFF.Commit();
+    CopyFile(Filename,"Commit3.RIFF");
+
+    /* This line is never committed by hand, Close() finishes it */
+    WriteLines(RIFF,2*LINES_PER_COMMIT,1);
+
+    RIFF.EndGroup();
+    RIFF.Close();
+}
+
+static void WriteLines(class RIFF &RIFF,unsigned First,unsigned Count)
+{
+    char Line[100];
+    unsigned r;
+
+    for(r=First;r<First+Count;r++)
+    {
+        /* No '\0', so some lines are an odd size */
+        snprintf(Line,sizeof(Line),"Log line %u",r);
+        RIFF.WriteDataBlock("line",Line,strlen(Line));
+    }
+}
+
+static void CopyFile(const char *From,const char *To)
+{
+    FILE *In;
+    FILE *Out;
+    char Buffer[4096];
+    size_t Bytes;
+
+    In=fopen(From,"rb");
+    if(In==NULL)
+        throw("Failed to open the file to copy");
+    Out=fopen(To,"wb");
+    if(Out==NULL)
+    {
+        fclose(In);
+        throw("Failed to make the copy");
+    }
+    while((Bytes=fread(Buffer,1,sizeof(Buffer),In))>0)
+        fwrite(Buffer,1,Bytes,Out);
+    fclose(Out);
+    fclose(In);
+}
+
+/* Reads back everything in the "logs" group */
+void ReadFile(const char *Filename)
+{
+    class RIFF RIFF;
+    char ChunkID[5];
+    uint32_t ChunkLen;
+    e_RIFFDataType DataType;
+    std::vector<uint8_t> Data;
+    unsigned Lines;
+    unsigned Blobs;
+    uint32_t r;
+
+    Lines=0;
+    Blobs=0;
+    RIFF.Open(Filename,e_RIFFOpen_Read,"RECD");
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+    {
+        if(DataType!=e_RIFFData_Group || strcmp(ChunkID,"logs")!=0)
+            continue;
+
+        RIFF.StartReadingGroup();
+        while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen))
+        {
+            Data.resize(ChunkLen);
+            RIFF.Read(Data.data(),ChunkLen);
+            if(strcmp(ChunkID,"line")==0)
+            {
+                Lines++;
+            }
+            else if(strcmp(ChunkID,"blob")==0)
+            {
+                for(r=0;r<ChunkLen;r++)
+                    if(Data[r]!=(uint8_t)(r/1000))
+                        throw("The blob didn't read back right");
+                Blobs++;
+            }
+        }
+        RIFF.DoneReadingGroup();
+    }
+    RIFF.Close();
+
+    printf("%s: %u lines, %u blobs\n",Filename,Lines,Blobs);
+}
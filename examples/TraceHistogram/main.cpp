@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of timing chunks with a trace handler and the
+ *    RIFFTraceHistogram class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFTraceHistogram.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*** DEFINES                  ***/
+#define FRAMES_TO_WRITE         1000
+#define FRAME_SIZE              10000
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename,class RIFFTraceHistogram &Hist);
+static void ReadFile(const char *Filename,class RIFFTraceHistogram &Hist);
+static void ShowEvent(const struct RIFFTraceEvent *Event,void *UserData);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    class RIFFTraceHistogram Hist;
+
+    try
+    {
+        WriteFile("Trace.RIFF",Hist);
+        ReadFile("Trace.RIFF",Hist);
+
+        printf("\n");
+        Hist.Dump(stdout);
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+void WriteFile(const char *Filename,class RIFFTraceHistogram &Hist)
+{
+    class RIFF RIFF;
+    uint8_t *Frame;
+    int f;
+
+    Frame=(uint8_t *)malloc(FRAME_SIZE);
+    if(Frame==NULL)
+        throw("Out of memory");
+    memset(Frame,0x55,FRAME_SIZE);
+
+    RIFF.SetTraceHandler(RIFFTraceHistogram::TraceHandler,&Hist);
+    RIFF.Open(Filename,e_RIFFOpen_Write,"TRCE");
+
+    RIFF.StartGroup("INFO");
+        RIFF.StartDataBlock("INAM");
+        RIFF.Write("Trace example",14);
+        RIFF.EndDataBlock();
+    RIFF.EndGroup();
+
+    for(f=0;f<FRAMES_TO_WRITE;f++)
+    {
+        RIFF.StartDataBlock("FRAM");
+        RIFF.Write(Frame,FRAME_SIZE);
+        RIFF.EndDataBlock();
+
+        RIFF.StartDataBlock("TIME");
+        RIFF.Write(&f,sizeof(f));
+        RIFF.EndDataBlock();
+    }
+
+    RIFF.Close();
+
+    free(Frame);
+}
+
+void ReadFile(const char *Filename,class RIFFTraceHistogram &Hist)
+{
+    class RIFF RIFF;
+    char ChunkID[5];
+    uint32_t ChunkLen;
+    e_RIFFDataType DataType;
+    uint8_t Buffer[100];
+
+    /* Show the events for the first few chunks */
+    RIFF.SetTraceHandler(ShowEvent,NULL);
+    RIFF.Open(Filename,e_RIFFOpen_Read,"TRCE");
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+    {
+        if(DataType==e_RIFFData_Group)
+        {
+            RIFF.StartReadingGroup();
+            while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen))
+                RIFF.Read(Buffer,ChunkLen<sizeof(Buffer)?ChunkLen:
+                        sizeof(Buffer));
+            RIFF.DoneReadingGroup();
+        }
+        else if(strcmp(ChunkID,"FRAM")==0)
+        {
+            break;
+        }
+    }
+    RIFF.Close();
+
+    /* Then time all of them */
+    RIFF.SetTraceHandler(RIFFTraceHistogram::TraceHandler,&Hist);
+    RIFF.Open(Filename,e_RIFFOpen_Read,"TRCE");
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen))
+    {
+        /* Only read the first bit of each frame, the rest is skipped */
+        if(strcmp(ChunkID,"FRAM")==0)
+            RIFF.Read(Buffer,sizeof(Buffer));
+    }
+    RIFF.Close();
+}
+
+void ShowEvent(const struct RIFFTraceEvent *Event,void * /*UserData*/)
+{
+    static const char *Types[]={"Chunk start","Chunk end","Group start",
+            "Group end"};
+
+    printf("%*s%-11s %s @ %llu, %u bytes",Event->Depth*4,"",Types[Event->Type],
+            Event->ChunkID,(unsigned long long)Event->Offset,Event->Size);
+    if(Event->EndTime!=0)
+    {
+        printf(", %.1f us",(Event->EndTime-Event->StartTime)/1000.0);
+    }
+    printf("\n");
+}
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file is an example of writing and reading the samples in a WAV
+ *    file with the RIFFWavWriter and RIFFWavReader classes.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include "RIFFWav.h"
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*** DEFINES                  ***/
+#define SAMPLE_RATE     48000
+#define CHANNELS        2
+#define FRAMES          (SAMPLE_RATE*10)
+#define READ_FRAMES     1024
+#define SEEK_FRAME      (SAMPLE_RATE*5/2+25)
+#define PIXELS          10
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WriteFile(const char *Filename);
+static void ReadFile(const char *Filename);
+static void ShowOverview(const char *Filename);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+int main(void)
+{
+    try
+    {
+        WriteFile("Stream.wav");
+        ReadFile("Stream.wav");
+        ShowOverview("Stream.wav");
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+    }
+
+    return 0;
+}
+
+/* Writes 10 seconds of 24 bit stereo (a 440Hz tone on the left and a quieter
+   660Hz tone on the right) */
+void WriteFile(const char *Filename)
+{
+    class RIFF RIFF;
+    class RIFFWavWriter Wav;
+    float Left[READ_FRAMES];
+    float Right[READ_FRAMES];
+    const float *Planes[CHANNELS]={Left,Right};
+    uint32_t Frames;
+    uint32_t f;
+    uint32_t r;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,RIFFWAV_FORM_TYPE);
+    Wav.SetOverview(true);
+    Wav.Open(RIFF,CHANNELS,SAMPLE_RATE,24);
+
+    /* The samples are made (and written) a buffer at a time */
+    for(f=0;f<FRAMES;f+=Frames)
+    {
+        Frames=FRAMES-f<READ_FRAMES?FRAMES-f:READ_FRAMES;
+        for(r=0;r<Frames;r++)
+        {
+            Left[r]=sin(2*M_PI*440*(f+r)/SAMPLE_RATE)*0.95;
+            Right[r]=sin(2*M_PI*660*(f+r)/SAMPLE_RATE)*0.24;
+        }
+        Wav.WriteFloat(Planes,Frames);
+    }
+    Wav.Close();
+
+    RIFF.Close();
+}
+
+void ReadFile(const char *Filename)
+{
+    class RIFF RIFF;
+    class RIFFWavReader Wav;
+    float Samples[READ_FRAMES*CHANNELS];
+    double Sum[CHANNELS];
+    float Peak[CHANNELS];
+    uint32_t Frames;
+    uint32_t Total;
+    uint32_t f;
+    unsigned c;
+
+    RIFF.Open(Filename,e_RIFFOpen_Read,RIFFWAV_FORM_TYPE);
+    Wav.Open(RIFF);
+
+    const struct RIFFWavFormat &Format=Wav.GetFormat();
+    printf("%u channels, %uHz, %u bits (%u valid), %s, %u frames\n",
+            Format.Channels,Format.SampleRate,Format.BitsPerSample,
+            Format.ValidBits,Format.Float?"float":"int",Format.Frames);
+    if(Format.Channels!=CHANNELS)
+        throw("Wrong number of channels");
+
+    for(c=0;c<CHANNELS;c++)
+    {
+        Sum[c]=0;
+        Peak[c]=0;
+    }
+
+    /* Only READ_FRAMES are in memory at a time */
+    Total=0;
+    while((Frames=Wav.ReadFloat(Samples,READ_FRAMES))>0)
+    {
+        for(f=0;f<Frames;f++)
+        {
+            for(c=0;c<CHANNELS;c++)
+            {
+                Sum[c]+=Samples[f*CHANNELS+c]*Samples[f*CHANNELS+c];
+                if(fabsf(Samples[f*CHANNELS+c])>Peak[c])
+                    Peak[c]=fabsf(Samples[f*CHANNELS+c]);
+            }
+        }
+        Total+=Frames;
+    }
+
+    /* Jump back to 2.5 seconds in (only that part of the file is read) */
+    Wav.SeekToFrame(SEEK_FRAME);
+    Wav.ReadFloat(Samples,1);
+    printf("Frame %u: %.3f %.3f\n",SEEK_FRAME,Samples[0],Samples[1]);
+
+    RIFF.Close();
+
+    printf("Read %u frames\n",Total);
+    for(c=0;c<CHANNELS;c++)
+    {
+        printf("Channel %u: peak %.3f, RMS %.3f\n",c,Peak[c],
+                sqrt(Sum[c]/Total));
+    }
+}
+
+/* Draws the left channel 1 second per pixel from the "OVRV" chunk (without
+   reading any samples) */
+void ShowOverview(const char *Filename)
+{
+    class RIFF RIFF;
+    class RIFFWavOverview Overview;
+    struct RIFFWavPeak Peaks[PIXELS];
+    unsigned p;
+
+    RIFF.Open(Filename,e_RIFFOpen_Read,RIFFWAV_FORM_TYPE);
+    if(!Overview.Load(RIFF))
+        throw("No overview");
+    RIFF.Close();
+
+    Overview.Get(0,0,Overview.GetFrames(),PIXELS,Peaks);
+    for(p=0;p<PIXELS;p++)
+    {
+        printf("Second %u: min %.3f, max %.3f, RMS %.3f\n",p,Peaks[p].Min,
+                Peaks[p].Max,Peaks[p].RMS);
+    }
+}
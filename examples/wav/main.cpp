@@ -58,6 +58,10 @@ struct fmt
     uint16_t BitsPerSample;
 };
 
+RIFF_STRUCT(fmt,RIFF_FIELD(fmt,AudioFormat),RIFF_FIELD(fmt,NumChannels),
+        RIFF_FIELD(fmt,SampleRate),RIFF_FIELD(fmt,ByteRate),
+        RIFF_FIELD(fmt,BlockAlign),RIFF_FIELD(fmt,BitsPerSample));
+
 /*** FUNCTION PROTOTYPES      ***/
 static void ReadFile(const char *Filename);
 static void WriteFile(const char *Filename);
@@ -135,9 +139,7 @@ void WriteFile(const char *Filename)
     fmtblock.ByteRate=20000;
     fmtblock.BlockAlign=2;
     fmtblock.BitsPerSample=16;
-    RIFF.StartDataBlock("fmt ");
-    RIFF.Write(&fmtblock,sizeof(fmtblock));
-    RIFF.EndDataBlock();
+    RIFF.WriteDataBlock("fmt ",fmtblock);
 
     RIFF.StartGroup("INFO");
         RIFF.StartDataBlock("INAM");
@@ -194,7 +196,7 @@ void ReadFile(const char *Filename)
         {
             if(ChunkLen>sizeof(fmtblock))
                 throw("Data error");
-            RIFF.Read(&fmtblock,sizeof(fmtblock));
+            RIFF.ReadStruct(fmtblock);
         }
         else if(strcmp(ChunkID,"data")==0)
         {
@@ -35,17 +35,74 @@
 
 /*** HEADER FILES TO INCLUDE  ***/
 #include "RIFF.h"
+#include "RIFFIO.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdint.h>
+#include <chrono>
+#include <algorithm>
 
 /*** DEFINES                  ***/
+#define DEFAULT_HINT_WINDOW             (4*1024*1024)
+#define SWAP_BUFFER_SIZE                4096
+#define VERIFY_BUFFER_SIZE              4096
+#define CHECKSUM_ALGO_CRC32C            1
+#define CHECKSUM_CHUNK_ID               "CSUM"
+#define COMPRESS_CHUNK_ID               RIFF_PACK_CHUNK_ID
+#define DEFAULT_COMPRESS_BLOCK_SIZE     65536
+#define MAX_COMPRESS_BLOCK_SIZE         (16*1024*1024)
+#define PACK_STORED_FLAG                0x80000000  // Block wasn't compressed
+#define LZ_MIN_MATCH                    4
+#define LZ_MAX_OFFSET                   0xFFFF
+#define LZ_HASH_BITS                    14
+#define ZSTD_LEVEL                      3
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RIFF_SWAP_X86                   1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define RIFF_SWAP_NEON                  1
+#include <arm_neon.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+#ifdef RIFF_USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef RIFF_USE_ZSTD
+#include <zstd.h>
+#endif
 
 /*** MACROS                   ***/
 
 /*** TYPE DEFINITIONS         ***/
 
 /*** FUNCTION PROTOTYPES      ***/
+static uint64_t RIFF_TraceNow(void);
+static void RIFF_SwapScalar(uint8_t *Data,unsigned Size,uint32_t Count);
+static uint32_t RIFF_SwapSIMD(uint8_t *Data,unsigned Size,uint32_t Count);
+static uint32_t RIFF_CRC32CScalar(uint32_t CRC,const uint8_t *Data,
+        size_t Bytes);
+static uint32_t RIFF_GF2Times(const uint32_t *Matrix,uint32_t Vector);
+static void RIFF_GF2Square(uint32_t *Square,const uint32_t *Matrix);
+static uint32_t RIFF_CRC32CCombine(uint32_t CRC1,uint32_t CRC2,
+        uint32_t Bytes2);
+static bool RIFF_CompressSupported(e_RIFFCompressType Type);
+static uint32_t RIFF_PackBound(e_RIFFCompressType Type,uint32_t Bytes);
+static uint32_t RIFF_Pack(e_RIFFCompressType Type,const uint8_t *Src,
+        uint32_t SrcBytes,uint8_t *Dest,uint32_t DestSize);
+static bool RIFF_Unpack(e_RIFFCompressType Type,const uint8_t *Src,
+        uint32_t SrcBytes,uint8_t *Dest,uint32_t DestBytes);
+static void RIFF_ParsePackHeader(const uint8_t *Header,uint32_t RawSize,
+        bool IFF,uint32_t *Fields);
+static uint32_t RIFF_LZPack(const uint8_t *Src,uint32_t SrcBytes,
+        uint8_t *Dest,uint32_t DestSize);
+static bool RIFF_LZUnpack(const uint8_t *Src,uint32_t SrcBytes,uint8_t *Dest,
+        uint32_t DestBytes);
+static bool RIFF_ChecksumBefore(const struct RIFFChecksum &A,
+        const struct RIFFChecksum &B);
 
 /*** VARIABLE DEFINITIONS     ***/
 
@@ -85,6 +142,14 @@
  *              match the type you sent into Open()
  *      e_RIFFError_UnsupportedFileMod -- You tried to open a file with a mode
  *              that this class does not support.
+ *      e_RIFFError_UnsupportedIOType -- You tried to open a file with an
+ *              I/O type that can not be used with that mode.
+ *      e_RIFFError_OutOfMemory -- A RIFFArena could not get more memory.
+ *      e_RIFFError_BadChecksum -- A chunk did not match its checksum.
+ *      e_RIFFError_UnsupportedCompression -- The compression type was not
+ *              built into the library.
+ *      e_RIFFError_UnsupportedSampleFormat -- The samples in a WAV file are
+ *              in a format that can't be converted.
  *
  * LIMITATIONS:
  *    Does not support all the IFF / RIFF spec.  It does not support
@@ -96,6 +161,37 @@
 RIFF::RIFF(bool UseIFF)
 {
     IFFMode=UseIFF;
+    IO=NULL;
+    Opened4Read=false;
+    IOOptions.ReadAheadBufferSize=0;
+    IOOptions.ReadAheadBuffers=0;
+    IOOptions.MMapExtent=0;
+    IOOptions.DirectBlockSize=0;
+    InPlaceBytes=0;
+    AccessHints=e_RIFFHint_None;
+    HintWindow=DEFAULT_HINT_WINDOW;
+    HintChunkRead=false;
+    Stats=NULL;
+    StatsDump=NULL;
+    TraceHandler=NULL;
+    TraceUserData=NULL;
+    TraceChunkOpen=false;
+    Checksums=false;
+    ChecksumPending=false;
+    InPlacePtr=NULL;
+    CompressBlockSize=DEFAULT_COMPRESS_BLOCK_SIZE;
+    Decompress=true;
+    ChunkCompress=e_RIFFCompress_None;
+    FrontIO=NULL;
+    FrontOffset=0;
+    FrontSize=0;
+    FrontChecksumStart=0;
+    DataBlockOpen=false;
+    CommitBytes=0;
+    CommitMilliseconds=0;
+    CommitSync=false;
+    UncommittedBytes=0;
+    LastCommit=0;
 }
 
 /*******************************************************************************
@@ -119,8 +215,7 @@ RIFF::RIFF(bool UseIFF)
  ******************************************************************************/
 RIFF::~RIFF()
 {
-    if(FileHandle!=NULL)
-        fclose(FileHandle);
+    CloseIO();
 }
 
 /*******************************************************************************
@@ -167,6 +262,16 @@ const char *RIFF::Error2Str(e_RIFFErrorType err)
             return "The form type in the file did not match the requested form type";
         case e_RIFFError_UnsupportedFileMode:
             return "Open() was called with an invalid 'Mode'";
+        case e_RIFFError_UnsupportedIOType:
+            return "Open() was called with an 'IOType' that can't be used with this 'Mode'";
+        case e_RIFFError_OutOfMemory:
+            return "Out of memory";
+        case e_RIFFError_BadChecksum:
+            return "Chunk data does not match its checksum";
+        case e_RIFFError_UnsupportedCompression:
+            return "The compression type was not built into the library";
+        case e_RIFFError_UnsupportedSampleFormat:
+            return "The sample format is not supported";
     }
     return "Internal Error.  Can not convert error code to text";
 }
@@ -197,818 +302,5086 @@ void RIFF::SetIFFMode(bool UseIFF)
 
 /*******************************************************************************
  * NAME:
- *    RIFF::Open
+ *    RIFF::GetIFFMode
  *
  * SYNOPSIS:
- *    void RIFF::Open(const char *Filename,e_RIFFOpenType Mode,
- *          const char *FormType);
+ *    bool RIFF::GetIFFMode(void);
  *
  * PARAMETERS:
- *    Filename [I] -- The filename to open for read/write
- *    Mode [I] -- Open for read or writing a file.  Supported values:
- *                  e_RIFFOpen_Read -- Read an existing RIFF file.
- *                  e_RIFFOpen_Write -- Write a new RIFF file.
- *    FormType [I] -- The type of the file we are going to be opening / creating
+ *    NONE
  *
  * FUNCTION:
- *    This function opens an RIFF file for loading or saving.  If the file
- *    does not exist a new one will be made if you are saving.
+ *    This function gets if we are working with IFF (big endian) or RIFF
+ *    (little endian).
  *
  * RETURNS:
- *    NONE
+ *    true -- IFF mode
+ *    false -- RIFF mode
  *
  * SEE ALSO:
- *    
+ *    RIFF::SetIFFMode()
  ******************************************************************************/
-void RIFF::Open(const char *Filename,e_RIFFOpenType Mode,const char *FormType)
+bool RIFF::GetIFFMode(void)
 {
-    if(Mode==e_RIFFOpen_Write)
-        OpenWrite(Filename,FormType);
-    else if(Mode==e_RIFFOpen_Read)
-        OpenRead(Filename,FormType);
-    else
-        throw(e_RIFFError_UnsupportedFileMode);
+    return IFFMode;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::Close
+ *    RIFF::SetStats
  *
  * SYNOPSIS:
- *    void RIFF::Close(void);
+ *    void RIFF::SetStats(struct RIFFStats *Stats,FILE *DumpAtClose=NULL);
  *
  * PARAMETERS:
- *    NONE
+ *    Stats [I] -- Where to count what this class does.  NULL to turn
+ *                 stats off (the default).  This is cleared and must stay
+ *                 around until the stats are turned off or the class is
+ *                 freed.
+ *    DumpAtClose [I] -- If this is not NULL then the stats are printed to
+ *                       this file every time Close() is called.
  *
  * FUNCTION:
- *    This function closes the file opened with Open().  It will finalize
- *    the file if opened for writing.
+ *    This function turns on counting of the calls made to this class and
+ *    the calls we make to the file (reads, writes, seeks to skip data or
+ *    fix sizes, bytes skipped, padding, deepest group, and time spent
+ *    waiting on the file).  The counts are added up over every file opened
+ *    until SetStats() is called again, and you can look at them any time.
+ *
+ *    This must be called before Open().  When stats are off nothing is
+ *    counted or timed.
  *
  * RETURNS:
  *    NONE
  *
  * SEE ALSO:
- *    
+ *    RIFF::DumpStats()
  ******************************************************************************/
-void RIFF::Close(void)
+void RIFF::SetStats(struct RIFFStats *Stats,FILE *DumpAtClose)
 {
-    if(Opened4Read)
-        CloseRead();
-    else
-        CloseWrite();
+    this->Stats=Stats;
+    StatsDump=DumpAtClose;
+    if(Stats!=NULL)
+        memset(Stats,0,sizeof(struct RIFFStats));
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::OpenRead
+ *    RIFF::DumpStats
  *
  * SYNOPSIS:
- *    void RIFF::OpenRead(const char *Filename,const char *FormType);
+ *    static void RIFF::DumpStats(const struct RIFFStats *Stats,FILE *Out);
  *
  * PARAMETERS:
- *    Filename [I] -- The filename to open.
- *    FormType [I] -- Form type of this file.  This will be checked against
- *                    the form type in the file.
+ *    Stats [I] -- The stats to print
+ *    Out [I] -- Where to print them (stdout, stderr, a log file)
  *
  * FUNCTION:
- *    This function opens a file for reading and does some basic checking of
- *    the file.
+ *    This function prints the stats counted because of SetStats() in a
+ *    human readable form.
  *
  * RETURNS:
  *    NONE
  *
  * SEE ALSO:
- *    
+ *    RIFF::SetStats()
  ******************************************************************************/
-void RIFF::OpenRead(const char *Filename,const char *FormType)
+void RIFF::DumpStats(const struct RIFFStats *Stats,FILE *Out)
 {
-    char ChunkID[5];
-    const char *FORMName;
-
-    ChunkID[4]=0;
-
-    FORMName="RIFF";
-    if(IFFMode)
-        FORMName="FORM";
-
-    FileHandle=fopen(Filename,"rb");
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FailedToOpenFile);
-
-    if(fread(ChunkID,4,1,FileHandle)!=1)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_ReadError);
-    }
-
-    if(strcmp(ChunkID,FORMName)!=0)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_BadFormat);
-    }
-
-    TotalFileSize=ReadSize();
-
-    if(fread(ChunkID,4,1,FileHandle)!=1)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_ReadError);
-    }
-
-    if(strcmp(ChunkID,FormType)!=0)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_FormTypeMismatch);
-    }
-
-    Opened4Read=true;
-
-    BlockSize=TotalFileSize-4;   // Total file size - the FormType
-    DataLeft=0;
-    ReadFromBlock=0;
+    fprintf(Out,"RIFF stats:\n");
+    fprintf(Out,"    Read():              %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->Read.Calls,
+            (unsigned long long)Stats->Read.Bytes);
+    fprintf(Out,"    Write():             %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->Write.Calls,
+            (unsigned long long)Stats->Write.Bytes);
+    fprintf(Out,"    ReadNextDataBlock(): %llu calls, %llu bytes of chunks\n",
+            (unsigned long long)Stats->ReadNextDataBlock.Calls,
+            (unsigned long long)Stats->ReadNextDataBlock.Bytes);
+    fprintf(Out,"    Skipped:             %llu times, %llu bytes\n",
+            (unsigned long long)Stats->Skipped.Calls,
+            (unsigned long long)Stats->Skipped.Bytes);
+    fprintf(Out,"    Data blocks:         %llu\n",
+            (unsigned long long)Stats->DataBlocks);
+    fprintf(Out,"    Groups:              %llu (max depth %u)\n",
+            (unsigned long long)Stats->Groups,Stats->MaxDepth);
+    fprintf(Out,"    Padding:             %llu bytes\n",
+            (unsigned long long)Stats->PadBytes);
+    fprintf(Out,"    Commits:             %llu\n",
+            (unsigned long long)Stats->Commits);
+    fprintf(Out,"    File reads:          %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->IORead.Calls,
+            (unsigned long long)Stats->IORead.Bytes);
+    fprintf(Out,"    File writes:         %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->IOWrite.Calls,
+            (unsigned long long)Stats->IOWrite.Bytes);
+    fprintf(Out,"    File skips:          %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->IOSkip.Calls,
+            (unsigned long long)Stats->IOSkip.Bytes);
+    fprintf(Out,"    File size patches:   %llu calls, %llu bytes\n",
+            (unsigned long long)Stats->IOPatch.Calls,
+            (unsigned long long)Stats->IOPatch.Bytes);
+    fprintf(Out,"    File seeks:          %llu\n",
+            (unsigned long long)Stats->IOSeek);
+    fprintf(Out,"    Time in file calls:  %.6f seconds\n",
+            Stats->IONanoseconds/1000000000.0);
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::CloseRead
+ *    RIFF::SetTraceHandler
  *
  * SYNOPSIS:
- *    void RIFF::CloseRead(void);
+ *    void RIFF::SetTraceHandler(t_RIFFTraceHandler Handler,void *UserData);
  *
  * PARAMETERS:
- *    NONE
+ *    Handler [I] -- The function to call at the start and end of every
+ *                   chunk and group.  NULL to turn tracing off (the
+ *                   default).
+ *    UserData [I] -- Passed to 'Handler'
  *
  * FUNCTION:
- *    This closes a file opened with OpenRead().
+ *    This function sets a function to call as chunks and groups are
+ *    started and ended, when reading or writing.  The handler is passed the
+ *    ID, where it is in the file, its size, how deep it is, and when it
+ *    started (and ended) so you can see where the time is going for each
+ *    type of chunk.  See RIFFTraceHistogram for a handler that does this.
+ *
+ *    When writing a chunk starts at StartDataBlock() / StartGroup() and ends
+ *    at EndDataBlock() / EndGroup().
+ *
+ *    When reading a chunk starts when ReadNextDataBlock() finds it and ends
+ *    when you move on to the next chunk (after it has been skipped).  A
+ *    group you go into ends at DoneReadingGroup().
  *
  * RETURNS:
  *    NONE
  *
  * SEE ALSO:
- *    
+ *    RIFFTraceHistogram
  ******************************************************************************/
-void RIFF::CloseRead(void)
+void RIFF::SetTraceHandler(t_RIFFTraceHandler Handler,void *UserData)
 {
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
-
-    fclose(FileHandle);
-    FileHandle=NULL;
+    TraceHandler=Handler;
+    TraceUserData=UserData;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::ReadNextDataBlock
+ *    RIFF::SetChecksums
  *
  * SYNOPSIS:
- *    bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize);
- *    bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize,
- *              e_RIFFDataType &DataType);
+ *    void RIFF::SetChecksums(bool On);
  *
  * PARAMETERS:
- *    ChunkID [O] -- A buffer at least 5 bytes in size.  This is where
- *                   the name of the next chunk we find the file is copyed.
- *                   A '\0' is added so you can do a strcmp() on it.
- *    ChunkSize [O] -- The number of bytes in the chunk.
- *    DataType [O] -- The type of block we just read.
- *                      e_RIFFData_DataBlock -- A normal chunk type
- *                      e_RIFFData_Group -- It a group.
+ *    On [I] -- true to use checksums, false to turn them off (the default)
  *
  * FUNCTION:
- *    This function finds and reads the next data block (chunk) in the file
- *    opened for reading.
+ *    This function turns on chunk checksums.  It must be called before
+ *    Open().
  *
- *    If you want to skip the returned chunk just call ReadNextDataBlock()
- *    again.
- *
- * RETURNS:
- *    true -- Another chunk was found.  'ChunkID' and 'ChunkSize' have
- *            been set.
- *    false -- We are at the end of the file.  No chunk found.
+ *    When writing, a CRC32C of each data block is worked out as it is
+ *    written and they are all stored in a "CSUM" chunk at the end of the
+ *    file when it is closed.
  *
- * EXAMPLE:
- *    char Chunk[5];
- *    uint32_t Size;
+ *    When reading, the "CSUM" chunk is loaded at Open() and each data block
+ *    you Read() all of is checked when you move on to the next chunk.  If
+ *    it doesn't match e_RIFFError_BadChecksum is thrown.  Chunks you don't
+ *    read all of are not checked (use VerifyChunk() for those).  Files
+ *    without a "CSUM" chunk read as normal.
  *
- *    while(RIFF.ReadNextDataBlock(Chunk,&Size))
- *    {
- *        if(strcmp(Chunk,"fmt ")==0)
- *            RIFF.Read(&WaveFormatHeader,sizeof(WaveFormatHeader));
- *        else if(strcmp(Chunk,"AUTH")==0)
- *            RIFF.Read(&Author,sizeof(Author));
- *        // More strcmp's here for more chunks we support
- *        RIFF.FinishReadChunk();
- *    }
+ * RETURNS:
+ *    NONE
  *
  * SEE ALSO:
- *    FinishReadChunk()
+ *    RIFF::VerifyChunk(), RIFF::GetChecksums(),
+ *    RIFFVisitor::VerifyChecksums()
  ******************************************************************************/
-bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize,e_RIFFDataType &DataType)
-{
-    ChunkID[4]=0;
-
-    DataType=e_RIFFData_DataBlock;
-
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
-
-    if(DataLeft>0)
-    {
-        fseek(FileHandle,DataLeft,SEEK_CUR);
-        ReadFromBlock+=DataLeft;
-    }
-
-    /* See if we are at the end of the file */
-    if(ReadFromBlock>=BlockSize)
-        return false;
-
-    if(fread(ChunkID,4,1,FileHandle)!=1)
-        throw(e_RIFFError_ReadError);
-    ReadFromBlock+=4;
-
-    CurrentChunkSize=ReadSize();
-    ReadFromBlock+=4;
-
-    *ChunkSize=CurrentChunkSize;
-
-    if(CurrentChunkSize&1)
-    {
-        /* Add in the padding 0 */
-        CurrentChunkSize++;
-    }
-
-    DataLeft=CurrentChunkSize;
-
-    if(strcmp(ChunkID,"LIST")==0)
-    {
-        DataType=e_RIFFData_DataBlock;
-
-        if(fread(ChunkID,4,1,FileHandle)!=1)
-            throw(e_RIFFError_ReadError);
-        ReadFromBlock+=4;
-
-        DataLeft-=4;
-    }
-
-    return true;
-}
-bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize)
+void RIFF::SetChecksums(bool On)
 {
-    e_RIFFDataType DataType;
-
-    return ReadNextDataBlock(ChunkID,ChunkSize,DataType);
+    Checksums=On;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::StartReadingGroup
+ *    RIFF::GetChecksums
  *
  * SYNOPSIS:
- *    void RIFF::StartReadingGroup(void);
+ *    const t_RIFFChecksums &RIFF::GetChecksums(void);
  *
  * PARAMETERS:
  *    NONE
  *
  * FUNCTION:
- *    This function needs to be called when you are about to start reading
- *    in a group.
+ *    This function gets the checksums loaded from the file (when reading) or
+ *    made so far (when writing).  They are in file order.
  *
  * RETURNS:
- *    NONE
+ *    The list of checksums.  Empty if checksums are off or the file doesn't
+ *    have any.
  *
  * SEE ALSO:
- *    RIFF::DoneReadingGroup()
+ *    RIFF::SetChecksums()
  ******************************************************************************/
-void RIFF::StartReadingGroup(void)
+const t_RIFFChecksums &RIFF::GetChecksums(void)
 {
-    struct ListHistory Old;
-
-    Old.BlockSize=BlockSize;
-    Old.ReadFromBlock=ReadFromBlock;
-    Old.DataLeft=DataLeft;  //??
-
-    PrevPos.push(Old);
-
-    BlockSize=CurrentChunkSize-4;   // We have already removed 'type'
-    ReadFromBlock=0;
-    DataLeft=0;
+    return ChecksumTable;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::DoneReadingGroup
+ *    RIFF::Open
  *
  * SYNOPSIS:
- *    void RIFF::DoneReadingGroup(void);
+ *    void RIFF::Open(const char *Filename,e_RIFFOpenType Mode,
+ *          const char *FormType,e_RIFFIOType IOType=e_RIFFIO_Buffered);
  *
  * PARAMETERS:
- *    NONE
+ *    Filename [I] -- The filename to open for read/write
+ *    Mode [I] -- Open for read or writing a file.  Supported values:
+ *                  e_RIFFOpen_Read -- Read an existing RIFF file.
+ *                  e_RIFFOpen_Write -- Write a new RIFF file.
+ *    FormType [I] -- The type of the file we are going to be opening / creating
+ *    IOType [I] -- How we get at the file.  Supported values:
+ *                  e_RIFFIO_Buffered -- Normal stdio buffered file access.
+ *                  e_RIFFIO_ReadAhead -- (read only) A thread reads the
+ *                      file ahead of you into a ring of buffers so the disk
+ *                      is busy while you work on the data.  Good for
+ *                      streaming through big files.  See SetReadAhead().
+ *                      Only there if built with RIFF_USE_READAHEAD.
+ *                  e_RIFFIO_MMap -- (write only, not on Windows) The file is
+ *                      allocated in big extents and memory mapped.  Writes
+ *                      are a memcpy() with no system call, and
+ *                      StartWriteInPlace() lets you fill the file with no
+ *                      copy at all.  The file is cut down to size at
+ *                      Close().  See SetMMapExtent().
+ *                  e_RIFFIO_Direct -- (write only, not on Windows) The file
+ *                      is written with O_DIRECT in big aligned blocks so it
+ *                      doesn't go through the page cache.  Good for writing
+ *                      lots of data you are not going to read back soon.
+ *                      See SetDirectBlockSize().
  *
  * FUNCTION:
- *    This function is called after you are done reading in a group.
- *    It moves up 1 group.  Any unread data / chunks will be skipped.
+ *    This function opens an RIFF file for loading or saving.  If the file
+ *    does not exist a new one will be made if you are saving.
  *
  * RETURNS:
  *    NONE
  *
  * SEE ALSO:
- *    RIFF::StartReadingGroup()
+ *    
  ******************************************************************************/
-void RIFF::DoneReadingGroup(void)
+void RIFF::Open(const char *Filename,e_RIFFOpenType Mode,const char *FormType,
+        e_RIFFIOType IOType)
 {
-    struct ListHistory Old;
-    uint32_t BytesInBlockLeft;
-
-    /* Ok, we need to skip whatever wasn't read */
-    BytesInBlockLeft=BlockSize-ReadFromBlock;
-    if(BytesInBlockLeft>0)
-    {
-        fseek(FileHandle,BytesInBlockLeft,SEEK_CUR);
-        ReadFromBlock+=BytesInBlockLeft;
-
-        if(BlockSize&1)
-        {
-            /* We need to skip the padding byte */
-            fseek(FileHandle,1,SEEK_CUR);
-            ReadFromBlock+=1;
-        }
-    }
-
-    Old=PrevPos.top();
-    PrevPos.pop();
-
-    BlockSize=Old.BlockSize;
-    ReadFromBlock+=Old.ReadFromBlock;
-    DataLeft=0;
+    if(Mode==e_RIFFOpen_Write)
+        OpenWrite(Filename,FormType,IOType);
+    else if(Mode==e_RIFFOpen_Read)
+        OpenRead(Filename,FormType,IOType);
+    else
+        throw(e_RIFFError_UnsupportedFileMode);
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::Read
+ *    RIFF::NextForm
  *
  * SYNOPSIS:
- *    void RIFF::Read(void *Data,uint32_t Bytes);
+ *    void RIFF::NextForm(const char *FormType);
  *
  * PARAMETERS:
- *    Data [I] -- The buffer to read the data from the file into
- *    Bytes [I] -- The number of bytes to read from the file.
+ *    FormType [I] -- The form type for the new form.  This must be 4
+ *                    letters long (AVI files use "AVIX").
  *
  * FUNCTION:
- *    This function reads bytes from the file opened with Open().  It will
- *    read from the current chunk only.  If there isn't enough bytes left in
- *    the chunk to full fill this request then a 'e_RIFFError_ChunkToSmall'
- *    exception is thrown.
+ *    When writing a file this function ends the current form ("RIFF" or
+ *    "FORM" chunk) and starts another one after it in the same file.  This
+ *    is how AVI files get past the 4G size of a RIFF chunk: each form has
+ *    its own 32bit size but the file can be any size.
+ *
+ *    The RIFF class only reads the first form.  Use RIFFTree::GetForm() to
+ *    get at the rest.
  *
  * RETURNS:
  *    NONE
  *
+ * NOTES:
+ *    This can not be called with a data block or group open.
+ *
+ *    If checksums are on (see SetChecksums()) they are written at the end
+ *    of the first form and then turned off (only the first form is
+ *    checked when reading).
+ *
  * SEE ALSO:
- *    
+ *    RIFF::Open(), RIFFTree::GetForm()
  ******************************************************************************/
-void RIFF::Read(void *Data,uint32_t Bytes)
+void RIFF::NextForm(const char *FormType)
 {
-    if(FileHandle==NULL)
+    const char *FORMName;
+
+    if(IO==NULL)
         throw(e_RIFFError_FileNotOpen);
 
-    if(Bytes>DataLeft)
-        throw(e_RIFFError_ChunkToSmall);
+    if(Opened4Read)
+        throw(e_RIFFError_UnsupportedFileMode);
 
-    if(fread(Data,Bytes,1,FileHandle)!=1)
-        throw(e_RIFFError_ReadError);
+    if(strlen(FormType)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
 
-    DataLeft-=Bytes;
-    ReadFromBlock+=Bytes;
-}
+    if(Checksums)
+    {
+        WriteChecksums();
+        ChecksumTable.clear();
+        Checksums=false;
+    }
 
-/*******************************************************************************
+    PatchSize(FormStart+4,TotalFileSize);
+
+    /* The space from ReserveFront() was in the form we just closed */
+    FrontSize=0;
+
+    FormStart=IO->Tell();
+    FORMName="RIFF";
+    if(IFFMode)
+        FORMName="FORM";
+    if(!IO->Write(FORMName,4))
+        throw(e_RIFFError_WriteError);
+    TotalFileSize=0;
+    WriteSize(TotalFileSize);
+    if(!IO->Write(FormType,4))
+        throw(e_RIFFError_WriteError);
+
+    TotalFileSize=4;    // The FormType counts
+}
+
+/*******************************************************************************
  * NAME:
- *    RIFF::OpenWrite
+ *    RIFF::SetReadAhead
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetReadAhead(uint32_t BufferSize,unsigned Buffers);
+ *
+ * PARAMETERS:
+ *    BufferSize [I] -- The size of each read ahead buffer.  0 for the
+ *                      default (1M).
+ *    Buffers [I] -- The number of buffers to read ahead into.  2 is double
+ *                   buffering, 3 is triple buffering, etc.  0 for the
+ *                   default (3).
+ *
+ * FUNCTION:
+ *    This function sets up the buffers used by the e_RIFFIO_ReadAhead
+ *    I/O type.  It must be called before Open().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    The read ahead backend is only built in if RIFF_USE_READAHEAD is
+ *    defined (it needs threads, -pthread with gcc / clang).
+ *
+ * SEE ALSO:
+ *    RIFF::Open()
+ ******************************************************************************/
+void RIFF::SetReadAhead(uint32_t BufferSize,unsigned Buffers)
+{
+    IOOptions.ReadAheadBufferSize=BufferSize;
+    IOOptions.ReadAheadBuffers=Buffers;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetMMapExtent
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetMMapExtent(uint64_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- How many bytes to allocate on disk (and map) each time
+ *                 the file needs to grow.  0 for the default (64M).
+ *
+ * FUNCTION:
+ *    This function sets how big a step the e_RIFFIO_MMap I/O type grows the
+ *    file by.  Bigger steps mean fewer remaps and less fragmentation on disk.
+ *    It must be called before Open().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Open()
+ ******************************************************************************/
+void RIFF::SetMMapExtent(uint64_t Bytes)
+{
+    IOOptions.MMapExtent=Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetDirectBlockSize
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetDirectBlockSize(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The size of the blocks the e_RIFFIO_Direct I/O type
+ *                 writes.  This is rounded up to a multiple of 4K.  0 for
+ *                 the default (1M).
+ *
+ * FUNCTION:
+ *    This function sets the block size for direct I/O.  It must be called
+ *    before Open().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Open()
+ ******************************************************************************/
+void RIFF::SetDirectBlockSize(uint32_t Bytes)
+{
+    IOOptions.DirectBlockSize=Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetCompressBlockSize
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetCompressBlockSize(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes of data to compress as one block.  0
+ *                 for the default (64K).  The max is 16M.
+ *
+ * FUNCTION:
+ *    This function sets the block size for compressed data blocks (see
+ *    StartDataBlock()).  Each block can be uncompressed on its own, so
+ *    smaller blocks make SeekInChunk() cheaper and bigger blocks compress
+ *    better.  This is used for data blocks started after it is called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartDataBlock()
+ ******************************************************************************/
+void RIFF::SetCompressBlockSize(uint32_t Bytes)
+{
+    if(Bytes==0)
+        Bytes=DEFAULT_COMPRESS_BLOCK_SIZE;
+    if(Bytes>MAX_COMPRESS_BLOCK_SIZE)
+        Bytes=MAX_COMPRESS_BLOCK_SIZE;
+    CompressBlockSize=Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetDecompress
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetDecompress(bool On);
+ *
+ * PARAMETERS:
+ *    On [I] -- true to uncompress compressed data blocks as they are read
+ *              (the default), false to return them as is.
+ *
+ * FUNCTION:
+ *    This function sets if compressed data blocks are uncompressed when
+ *    reading.  When this is off they are returned the same as an older
+ *    version of the library would see them (a "CMPR" data block).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartDataBlock()
+ ******************************************************************************/
+void RIFF::SetDecompress(bool On)
+{
+    Decompress=On;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetCommitInterval
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetCommitInterval(uint32_t Bytes,uint32_t Milliseconds,
+ *              bool Sync=false);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- Commit after this many bytes have been written.  0 to
+ *                 not commit by size.
+ *    Milliseconds [I] -- Commit when this long has gone by since the last
+ *                        commit.  0 to not commit by time.
+ *    Sync [I] -- Also wait for the file to get to the disk at each commit
+ *                (fdatasync()).
+ *
+ * FUNCTION:
+ *    This function sets how often the sizes in the file are fixed up while
+ *    it is being written (see Commit()).  Normally the sizes of the form,
+ *    the groups and the data block being written are only filled in when
+ *    they are ended, so if the program stops before Close() the file looks
+ *    empty.  With this set the file is always good up to the last commit,
+ *    which is what you want for long recordings or a file that another
+ *    program is reading while it is written.
+ *
+ *    The time is only checked when something is written.
+ *
+ *    With 'Sync' the data is synced before the sizes are fixed up, and the
+ *    sizes are synced by the next commit, so what is on the disk is always
+ *    good up to one of the commits.  This is one sync for each commit.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Each commit costs a patch for each open group and a flush, so don't
+ *    make it too often.
+ *
+ * SEE ALSO:
+ *    RIFF::Commit()
+ ******************************************************************************/
+void RIFF::SetCommitInterval(uint32_t Bytes,uint32_t Milliseconds,bool Sync)
+{
+    CommitBytes=Bytes;
+    CommitMilliseconds=Milliseconds;
+    CommitSync=Sync;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SetAccessHints
+ *
+ * SYNOPSIS:
+ *    void RIFF::SetAccessHints(e_RIFFAccessHintType Hints,uint32_t Window=0);
+ *
+ * PARAMETERS:
+ *    Hints [I] -- How you are going to be reading the file:
+ *                  e_RIFFHint_None -- Don't give the OS any hints.  This is
+ *                      the default.
+ *                  e_RIFFHint_Sequential -- You are walking the file in order.
+ *                      When you Read() from a chunk the OS is told to start
+ *                      loading the rest of the chunk (a 'Window' at a time)
+ *                      and when you are done with it the OS is told it can
+ *                      drop it from the cache.  The header for the next
+ *                      chunk is always asked for ahead of time.
+ *                  e_RIFFHint_Random -- Same as e_RIFFHint_Sequential but the
+ *                      OS is also told not to read ahead on its own.  Use
+ *                      this if you skip most of the file (big JUNK or video
+ *                      chunks you don't care about) or jump around using
+ *                      an index.
+ *    Window [I] -- How many bytes of a chunk to ask for ahead of where you
+ *                  are reading (and how much to read before dropping what
+ *                  you have read from the cache).  0 for the default (4M).
+ *
+ * FUNCTION:
+ *    This function turns on hints to the OS about what parts of the file
+ *    you are going to read next.  Because we know where the chunks are we
+ *    can tell the OS what to load before you ask for it, and tell it to
+ *    throw away chunks once you are done with them so scanning a big file
+ *    doesn't push everything else out of the cache.
+ *
+ *    This must be called before Open().  It only does something when
+ *    reading and on systems that have posix_fadvise().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Open()
+ ******************************************************************************/
+void RIFF::SetAccessHints(e_RIFFAccessHintType Hints,uint32_t Window)
+{
+    AccessHints=Hints;
+    HintWindow=Window;
+    if(HintWindow==0)
+        HintWindow=DEFAULT_HINT_WINDOW;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::Close
+ *
+ * SYNOPSIS:
+ *    void RIFF::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function closes the file opened with Open().  It will finalize
+ *    the file if opened for writing.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::Close(void)
+{
+    if(Opened4Read)
+        CloseRead();
+    else
+        CloseWrite();
+
+    if(StatsDump!=NULL)
+        DumpStats(Stats,StatsDump);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::OpenRead
  *
  * SYNOPSIS:
- *    void RIFF::OpenWrite(const char *Filename,const char *FormType);
+ *    void RIFF::OpenRead(const char *Filename,const char *FormType,
+ *          e_RIFFIOType IOType);
  *
  * PARAMETERS:
  *    Filename [I] -- The filename to open.
- *    FormType [I] -- Form type of this file.
+ *    FormType [I] -- Form type of this file.  This will be checked against
+ *                    the form type in the file.
+ *    IOType [I] -- The backend to use to read the file
+ *
+ * FUNCTION:
+ *    This function opens a file for reading and does some basic checking of
+ *    the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::OpenRead(const char *Filename,const char *FormType,
+        e_RIFFIOType IOType)
+{
+    char ChunkID[5];
+    const char *FORMName;
+
+    ChunkID[4]=0;
+
+    FORMName="RIFF";
+    if(IFFMode)
+        FORMName="FORM";
+
+    CloseIO();
+    IO=RIFFIO_Create(IOType,false,&IOOptions);
+    if(IO==NULL)
+        throw(e_RIFFError_UnsupportedIOType);
+    if(Stats!=NULL)
+        IO=RIFFIO_CreateStats(IO,Stats);
+
+    if(!IO->Open(Filename,false))
+    {
+        CloseIO();
+        throw(e_RIFFError_FailedToOpenFile);
+    }
+
+    if(!IO->Read(ChunkID,4))
+    {
+        CloseIO();
+        throw(e_RIFFError_ReadError);
+    }
+
+    if(strcmp(ChunkID,FORMName)!=0)
+    {
+        CloseIO();
+        throw(e_RIFFError_BadFormat);
+    }
+
+    TotalFileSize=ReadSize();
+
+    if(!IO->Read(ChunkID,4))
+    {
+        CloseIO();
+        throw(e_RIFFError_ReadError);
+    }
+
+    if(strcmp(ChunkID,FormType)!=0)
+    {
+        CloseIO();
+        throw(e_RIFFError_FormTypeMismatch);
+    }
+
+    if(AccessHints==e_RIFFHint_Random)
+        IO->Advise(0,0,e_RIFFIOAdvice_Random);
+    HintChunkRead=false;
+    TraceChunkOpen=false;
+    TraceGroups.clear();
+
+    Opened4Read=true;
+
+    ChecksumTable.clear();
+    NextChecksum=0;
+    ChecksumPending=false;
+    ChunkCompress=e_RIFFCompress_None;
+    if(Checksums)
+        LoadChecksums();
+
+    BlockSize=TotalFileSize-4;   // Total file size - the FormType
+    DataLeft=0;
+    CurrentChunkPad=0;
+    ReadFromBlock=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::CloseRead
+ *
+ * SYNOPSIS:
+ *    void RIFF::CloseRead(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This closes a file opened with OpenRead().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::CloseRead(void)
+{
+    bool BadChecksum;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    HintChunkDone();
+
+    BadChecksum=ChecksumPending && !ChecksumChunkDone();
+
+    if(TraceHandler!=NULL)
+    {
+        TraceChunkDone(0);
+        while(!TraceGroups.empty())
+            TraceGroupDone(0);
+    }
+
+    CloseIO();
+
+    if(BadChecksum)
+        throw(e_RIFFError_BadChecksum);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadNextDataBlock
+ *
+ * SYNOPSIS:
+ *    bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize);
+ *    bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize,
+ *              e_RIFFDataType &DataType);
+ *
+ * PARAMETERS:
+ *    ChunkID [O] -- A buffer at least 5 bytes in size.  This is where
+ *                   the name of the next chunk we find the file is copyed.
+ *                   A '\0' is added so you can do a strcmp() on it.
+ *    ChunkSize [O] -- The number of bytes in the chunk.
+ *    DataType [O] -- The type of block we just read.
+ *                      e_RIFFData_DataBlock -- A normal chunk type
+ *                      e_RIFFData_Group -- It a group.
+ *
+ * FUNCTION:
+ *    This function finds and reads the next data block (chunk) in the file
+ *    opened for reading.
+ *
+ *    If you want to skip the returned chunk just call ReadNextDataBlock()
+ *    again.
+ *
+ * RETURNS:
+ *    true -- Another chunk was found.  'ChunkID' and 'ChunkSize' have
+ *            been set.
+ *    false -- We are at the end of the file.  No chunk found.
+ *
+ * EXAMPLE:
+ *    char Chunk[5];
+ *    uint32_t Size;
+ *
+ *    while(RIFF.ReadNextDataBlock(Chunk,&Size))
+ *    {
+ *        if(strcmp(Chunk,"fmt ")==0)
+ *            RIFF.Read(&WaveFormatHeader,sizeof(WaveFormatHeader));
+ *        else if(strcmp(Chunk,"AUTH")==0)
+ *            RIFF.Read(&Author,sizeof(Author));
+ *        // More strcmp's here for more chunks we support
+ *        RIFF.FinishReadChunk();
+ *    }
+ *
+ * SEE ALSO:
+ *    FinishReadChunk()
+ ******************************************************************************/
+bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize,e_RIFFDataType &DataType)
+{
+    ChunkID[4]=0;
+
+    DataType=e_RIFFData_DataBlock;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    HintChunkDone();
+
+    if(ChecksumPending && !ChecksumChunkDone())
+        throw(e_RIFFError_BadChecksum);
+
+    ChunkCompress=e_RIFFCompress_None;
+
+    if(DataLeft>0)
+    {
+        if(!IO->Skip(DataLeft))
+            throw(e_RIFFError_ReadError);
+        ReadFromBlock+=DataLeft;
+
+        if(Stats!=NULL)
+        {
+            Stats->Skipped.Calls++;
+            Stats->Skipped.Bytes+=DataLeft;
+        }
+    }
+
+    if(TraceHandler!=NULL)
+        TraceChunkDone(0);
+
+    /* See if we are at the end of the file */
+    if(ReadFromBlock>=BlockSize)
+        return false;
+
+    if(!IO->Read(ChunkID,4))
+        throw(e_RIFFError_ReadError);
+    ReadFromBlock+=4;
+
+    CurrentChunkSize=ReadSize();
+    ReadFromBlock+=4;
+
+    *ChunkSize=CurrentChunkSize;
+
+    CurrentChunkPad=CurrentChunkSize&1;
+    if(CurrentChunkSize&1)
+    {
+        /* Add in the padding 0 */
+        CurrentChunkSize++;
+    }
+
+    DataLeft=CurrentChunkSize;
+
+    if(strcmp(ChunkID,"LIST")==0)
+    {
+        DataType=e_RIFFData_Group;
+
+        if(!IO->Read(ChunkID,4))
+            throw(e_RIFFError_ReadError);
+        ReadFromBlock+=4;
+
+        DataLeft-=4;
+    }
+
+    if(Stats!=NULL)
+    {
+        Stats->ReadNextDataBlock.Calls++;
+        Stats->ReadNextDataBlock.Bytes+=*ChunkSize;
+        if(DataType==e_RIFFData_Group)
+            Stats->Groups++;
+        else
+            Stats->DataBlocks++;
+        Stats->PadBytes+=*ChunkSize&1;
+    }
+
+    CurrentChunkOffset=IO->Tell();
+
+    if(!ChecksumTable.empty() && DataType==e_RIFFData_DataBlock)
+    {
+        /* Chunks are read in file order so we just walk the table */
+        while(NextChecksum<ChecksumTable.size() &&
+                ChecksumTable[NextChecksum].Offset<CurrentChunkOffset)
+        {
+            NextChecksum++;
+        }
+        if(NextChecksum<ChecksumTable.size() &&
+                ChecksumTable[NextChecksum].Offset==CurrentChunkOffset)
+        {
+            if(ChecksumTable[NextChecksum].Size!=*ChunkSize)
+                throw(e_RIFFError_BadChecksum);
+
+            ChecksumPending=true;
+            ChecksumExpected=ChecksumTable[NextChecksum].CRC;
+            ChunkCRC=0;
+            ChunkCRCBytes=0;
+            ChunkDataSize=*ChunkSize;
+        }
+    }
+
+    if(AccessHints!=e_RIFFHint_None)
+        HintChunkStarted();
+
+    if(Decompress && DataType==e_RIFFData_DataBlock &&
+            strcmp(ChunkID,COMPRESS_CHUNK_ID)==0)
+    {
+        StartDecompress(ChunkID,ChunkSize);
+    }
+
+    if(TraceHandler!=NULL)
+    {
+        TraceStart(DataType==e_RIFFData_Group?e_RIFFTrace_GroupStart:
+                e_RIFFTrace_ChunkStart,ChunkID,CurrentChunkOffset,*ChunkSize);
+    }
+
+    return true;
+}
+bool RIFF::ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize)
+{
+    e_RIFFDataType DataType;
+
+    return ReadNextDataBlock(ChunkID,ChunkSize,DataType);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::GetChunkOffset
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFF::GetChunkOffset(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the offset in the file of the data for the chunk
+ *    that was last returned by ReadNextDataBlock().  For groups this is the
+ *    offset of the first chunk in the group (just after the group ID).
+ *
+ *    This can be used to build an index of the file so chunks can be read
+ *    back later without walking the file again.
+ *
+ * RETURNS:
+ *    The offset from the start of the file to the data of the current chunk.
+ *
+ * SEE ALSO:
+ *    ReadNextDataBlock()
+ ******************************************************************************/
+uint32_t RIFF::GetChunkOffset(void)
+{
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    return CurrentChunkOffset;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::VerifyChunk
+ *
+ * SYNOPSIS:
+ *    bool RIFF::VerifyChunk(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function checks the current chunk against its checksum.  Whatever
+ *    you haven't read of the chunk is read (and thrown away) to do this, so
+ *    you can't Read() any more from this chunk after calling this.
+ *
+ *    Checksums must have been turned on with SetChecksums() before Open().
+ *
+ * RETURNS:
+ *    true -- The chunk is good (or it has no checksum)
+ *    false -- The chunk does not match its checksum
+ *
+ * SEE ALSO:
+ *    RIFF::SetChecksums()
+ ******************************************************************************/
+bool RIFF::VerifyChunk(void)
+{
+    uint8_t Buffer[VERIFY_BUFFER_SIZE];
+    uint32_t Bytes;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(!ChecksumPending)
+        return true;
+
+    while(ChunkCRCBytes<ChunkDataSize)
+    {
+        Bytes=ChunkDataSize-ChunkCRCBytes;
+        if(Bytes>sizeof(Buffer))
+            Bytes=sizeof(Buffer);
+        ReadRaw(Buffer,Bytes);
+    }
+
+    /* We read past what was uncompressed */
+    ChunkCompress=e_RIFFCompress_None;
+
+    return ChecksumChunkDone();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::StartReadingGroup
+ *
+ * SYNOPSIS:
+ *    void RIFF::StartReadingGroup(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function needs to be called when you are about to start reading
+ *    in a group.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::DoneReadingGroup()
+ ******************************************************************************/
+void RIFF::StartReadingGroup(void)
+{
+    struct ListHistory Old;
+
+    Old.BlockSize=BlockSize;
+    Old.ReadFromBlock=ReadFromBlock;
+    Old.DataLeft=DataLeft;  //??
+
+    PrevPos.push(Old);
+
+    BlockSize=CurrentChunkSize-4;   // We have already removed 'type'
+    ReadFromBlock=0;
+    DataLeft=0;
+
+    if(Stats!=NULL && PrevPos.size()>Stats->MaxDepth)
+        Stats->MaxDepth=PrevPos.size();
+
+    /* The group we found is now open until DoneReadingGroup() */
+    if(TraceChunkOpen)
+    {
+        TraceGroups.push_back(TraceChunk);
+        TraceChunkOpen=false;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::DoneReadingGroup
+ *
+ * SYNOPSIS:
+ *    void RIFF::DoneReadingGroup(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called after you are done reading in a group.
+ *    It moves up 1 group.  Any unread data / chunks will be skipped.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartReadingGroup()
+ ******************************************************************************/
+void RIFF::DoneReadingGroup(void)
+{
+    struct ListHistory Old;
+    uint32_t BytesInBlockLeft;
+
+    HintChunkDone();
+
+    if(ChecksumPending && !ChecksumChunkDone())
+        throw(e_RIFFError_BadChecksum);
+
+    /* Ok, we need to skip whatever wasn't read */
+    BytesInBlockLeft=BlockSize-ReadFromBlock;
+    if(BytesInBlockLeft>0)
+    {
+        if(!IO->Skip(BytesInBlockLeft))
+            throw(e_RIFFError_ReadError);
+        ReadFromBlock+=BytesInBlockLeft;
+
+        if(Stats!=NULL)
+        {
+            Stats->Skipped.Calls++;
+            Stats->Skipped.Bytes+=BytesInBlockLeft;
+        }
+
+        if(BlockSize&1)
+        {
+            /* We need to skip the padding byte */
+            if(!IO->Skip(1))
+                throw(e_RIFFError_ReadError);
+            ReadFromBlock+=1;
+        }
+    }
+
+    if(TraceHandler!=NULL)
+    {
+        TraceChunkDone(0);
+        TraceGroupDone(0);
+    }
+
+    Old=PrevPos.top();
+    PrevPos.pop();
+
+    BlockSize=Old.BlockSize;
+    ReadFromBlock+=Old.ReadFromBlock;
+    DataLeft=0;
+    ChunkCompress=e_RIFFCompress_None;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::Read
+ *
+ * SYNOPSIS:
+ *    void RIFF::Read(void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The buffer to read the data from the file into
+ *    Bytes [I] -- The number of bytes to read from the file.
+ *
+ * FUNCTION:
+ *    This function reads bytes from the file opened with Open().  It will
+ *    read from the current chunk only.  If there isn't enough bytes left in
+ *    the chunk to full fill this request then a 'e_RIFFError_ChunkToSmall'
+ *    exception is thrown.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::Read(void *Data,uint32_t Bytes)
+{
+    uint8_t *Dest;
+    uint32_t Left;
+    uint32_t Copy;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(ChunkCompress==e_RIFFCompress_None)
+    {
+        ReadRaw(Data,Bytes);
+    }
+    else
+    {
+        if(Bytes>UnpackedLeft)
+            throw(e_RIFFError_ChunkToSmall);
+
+        Dest=(uint8_t *)Data;
+        Left=Bytes;
+        while(Left>0)
+        {
+            if(UnpackPos>=UnpackBuffer.size())
+                ReadPackedBlock();
+
+            Copy=UnpackBuffer.size()-UnpackPos;
+            if(Copy>Left)
+                Copy=Left;
+            memcpy(Dest,UnpackBuffer.data()+UnpackPos,Copy);
+
+            UnpackPos+=Copy;
+            UnpackedLeft-=Copy;
+            Dest+=Copy;
+            Left-=Copy;
+        }
+    }
+
+    if(Stats!=NULL)
+    {
+        Stats->Read.Calls++;
+        Stats->Read.Bytes+=Bytes;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadRaw
+ *
+ * SYNOPSIS:
+ *    void RIFF::ReadRaw(void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The buffer to read the data from the file into
+ *    Bytes [I] -- The number of bytes to read from the file.
+ *
+ * FUNCTION:
+ *    This function reads bytes from the current chunk as they are in the
+ *    file (without uncompressing them).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Read()
+ ******************************************************************************/
+void RIFF::ReadRaw(void *Data,uint32_t Bytes)
+{
+    uint32_t CRCBytes;
+
+    if(Bytes>DataLeft)
+        throw(e_RIFFError_ChunkToSmall);
+
+    if(AccessHints!=e_RIFFHint_None)
+        HintRead(Bytes);
+
+    if(!IO->Read(Data,Bytes))
+        throw(e_RIFFError_ReadError);
+
+    if(ChecksumPending && ChunkCRCBytes<ChunkDataSize)
+    {
+        /* Don't count the padding byte if they read it */
+        CRCBytes=Bytes;
+        if(CRCBytes>ChunkDataSize-ChunkCRCBytes)
+            CRCBytes=ChunkDataSize-ChunkCRCBytes;
+        ChunkCRC=RIFF_CRC32C(ChunkCRC,Data,CRCBytes);
+        ChunkCRCBytes+=CRCBytes;
+    }
+
+    DataLeft-=Bytes;
+    ReadFromBlock+=Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadChunk
+ *
+ * SYNOPSIS:
+ *    struct RIFFSpan RIFF::ReadChunk(class RIFFArena &Arena);
+ *
+ * PARAMETERS:
+ *    Arena [I] -- The arena to put the data in
+ *
+ * FUNCTION:
+ *    This function reads the rest of the current chunk into memory from
+ *    'Arena'.  This saves you from having to malloc a buffer for every
+ *    chunk when loading lots of small chunks.
+ *
+ * RETURNS:
+ *    The data that was read.  'Data' is NULL if there was nothing left to
+ *    read.  The data is good until the arena is Reset().
+ *
+ * SEE ALSO:
+ *    RIFF::ReadGroup(), RIFFArena::Reset()
+ ******************************************************************************/
+struct RIFFSpan RIFF::ReadChunk(class RIFFArena &Arena)
+{
+    struct RIFFSpan Span;
+    uint8_t *Mem;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    Span.Data=NULL;
+    Span.Size=0;
+
+    Span.Size=ChunkBytesLeft();
+    if(Span.Size>0)
+    {
+        Mem=(uint8_t *)Arena.Alloc(Span.Size);
+        Read(Mem,Span.Size);
+        Span.Data=Mem;
+    }
+
+    return Span;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadGroup
+ *
+ * SYNOPSIS:
+ *    struct RIFFArenaChunk *RIFF::ReadGroup(class RIFFArena &Arena,
+ *              unsigned *ChunkCount=NULL);
+ *
+ * PARAMETERS:
+ *    Arena [I] -- The arena to put the chunks in
+ *    ChunkCount [O] -- The number of chunks in the group (can be NULL)
+ *
+ * FUNCTION:
+ *    This function reads a whole group (and all the groups in it) into
+ *    memory from 'Arena'.  It must be called just after ReadNextDataBlock()
+ *    returns a group (instead of calling StartReadingGroup()).  When it
+ *    returns the group has been read and you can call ReadNextDataBlock()
+ *    for the next chunk after the group.
+ *
+ * RETURNS:
+ *    The first chunk in the group (follow 'Next' for the others) or NULL
+ *    if the group is empty.  Groups in the group have their chunks in
+ *    'Children'.  Everything is good until the arena is Reset().
+ *
+ * SEE ALSO:
+ *    RIFF::ReadChunk(), RIFFArena::Reset()
+ ******************************************************************************/
+struct RIFFArenaChunk *RIFF::ReadGroup(class RIFFArena &Arena,
+        unsigned *ChunkCount)
+{
+    struct RIFFArenaChunk *FirstChunk;
+    struct RIFFArenaChunk *LastChunk;
+    struct RIFFArenaChunk *Chunk;
+    char ChunkID[5];
+    uint32_t ChunkSize;
+    e_RIFFDataType DataType;
+    unsigned Count;
+
+    FirstChunk=NULL;
+    LastChunk=NULL;
+    Count=0;
+
+    StartReadingGroup();
+    while(ReadNextDataBlock(ChunkID,&ChunkSize,DataType))
+    {
+        Chunk=(struct RIFFArenaChunk *)Arena.Alloc(sizeof(struct RIFFArenaChunk));
+        memcpy(Chunk->ChunkID,ChunkID,sizeof(Chunk->ChunkID));
+        Chunk->DataType=DataType;
+        Chunk->Data.Data=NULL;
+        Chunk->Data.Size=0;
+        Chunk->Children=NULL;
+        Chunk->ChildCount=0;
+        Chunk->Next=NULL;
+
+        if(DataType==e_RIFFData_Group)
+            Chunk->Children=ReadGroup(Arena,&Chunk->ChildCount);
+        else
+            Chunk->Data=ReadChunk(Arena);
+
+        if(LastChunk==NULL)
+            FirstChunk=Chunk;
+        else
+            LastChunk->Next=Chunk;
+        LastChunk=Chunk;
+        Count++;
+    }
+    DoneReadingGroup();
+
+    if(ChunkCount!=NULL)
+        *ChunkCount=Count;
+
+    return FirstChunk;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadSwapped
+ *
+ * SYNOPSIS:
+ *    void RIFF::ReadSwapped(void *Data,unsigned Size,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Data [O] -- Where to put the values
+ *    Size [I] -- The size of one value in bytes
+ *    Count [I] -- The number of values to read
+ *
+ * FUNCTION:
+ *    This function is used by ReadArray() / Read<T>().  It reads an array
+ *    of numbers and swaps them in place if the file's byte order (big endian
+ *    for IFF, little endian for RIFF) is not the same as ours.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::WriteSwapped(), RIFF_SwapBytes()
+ ******************************************************************************/
+void RIFF::ReadSwapped(void *Data,unsigned Size,uint32_t Count)
+{
+    if(Size!=0 && Count>0xFFFFFFFF/Size)
+        throw(e_RIFFError_ChunkToSmall);
+
+    Read(Data,Size*Count);
+
+    if(IFFMode!=RIFF_HOST_BIG_ENDIAN)
+        RIFF_SwapBytes(Data,Size,Count);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::OpenWrite
+ *
+ * SYNOPSIS:
+ *    void RIFF::OpenWrite(const char *Filename,const char *FormType,
+ *          e_RIFFIOType IOType);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The filename to open.
+ *    FormType [I] -- Form type of this file.
+ *    IOType [I] -- The backend to use to write the file
+ *
+ * FUNCTION:
+ *    This function will create a new file and add the headers to the open of
+ *    it.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::OpenWrite(const char *Filename,const char *FormType,
+        e_RIFFIOType IOType)
+{
+    const char *FORMName;
+
+    if(strlen(FormType)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    CloseIO();
+    IO=RIFFIO_Create(IOType,true,&IOOptions);
+    if(IO==NULL)
+        throw(e_RIFFError_UnsupportedIOType);
+    if(Stats!=NULL)
+        IO=RIFFIO_CreateStats(IO,Stats);
+
+    if(!IO->Open(Filename,true))
+    {
+        CloseIO();
+        throw(e_RIFFError_FailedToOpenFile);
+    }
+
+    FORMName="RIFF";
+    if(IFFMode)
+        FORMName="FORM";
+    if(!IO->Write(FORMName,4))
+        throw(e_RIFFError_WriteError);
+    TotalFileSize=0;
+    WriteSize(TotalFileSize);
+    if(!IO->Write(FormType,4))
+        throw(e_RIFFError_WriteError);
+
+    TotalFileSize=4;    // The FormType counts
+    FormStart=0;
+    CurrentChunkSize=0;
+    CurrentListSize=0;
+    TraceChunkOpen=false;
+    TraceGroups.clear();
+    ChecksumTable.clear();
+    ChecksumPending=false;
+    ChunkCompress=e_RIFFCompress_None;
+    FrontSize=0;
+    DataBlockOpen=false;
+    UncommittedBytes=0;
+    LastCommit=RIFF_TraceNow();
+
+    Opened4Read=false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::CloseWrite
+ *
+ * SYNOPSIS:
+ *    void RIFF::CloseWrite(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function closes the file opened with OpenWrite().  It finalizes
+ *    the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::CloseWrite(void)
+{
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Checksums)
+        WriteChecksums();
+
+    PatchSize(FormStart+4,TotalFileSize);
+
+    if(!IO->Close())
+    {
+        CloseIO();
+        throw(e_RIFFError_WriteError);
+    }
+    CloseIO();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::StartDataBlock
+ *
+ * SYNOPSIS:
+ *    void RIFF::StartDataBlock(const char *ChunkID,
+ *              e_RIFFCompressType Compress=e_RIFFCompress_None);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The ID of the data block to start. This is an identifier
+ *                   used to find this data when reading the file back in.
+ *                   This must be 4 letters long and be in the AscII
+ *                   range of [a-z][A-Z][0-9] and space.  Only the length is
+ *                   checked.
+ *    Compress [I] -- How to compress the data in this data block:
+ *                      e_RIFFCompress_None -- Don't (the default)
+ *                      e_RIFFCompress_LZ -- The built in LZ codec
+ *                      e_RIFFCompress_Zlib -- zlib (if built with
+ *                          RIFF_USE_ZLIB)
+ *                      e_RIFFCompress_Zstd -- zstd (if built with
+ *                          RIFF_USE_ZSTD)
+ *
+ * FUNCTION:
+ *    This function starts a new block of data when writing a file.  This
+ *    will work out to an IFF chunk.
+ *
+ *    Compressed data blocks are stored in a "CMPR" chunk that has the real
+ *    chunk ID inside it, so older readers skip them.  The data is
+ *    compressed in blocks (see SetCompressBlockSize()) as you Write() it.
+ *    When reading, Read() uncompresses it for you and ReadNextDataBlock()
+ *    returns the real chunk ID and uncompressed size.
+ *
+ *    The "CMPR" chunk is (all numbers in the file's byte order):
+ *      char ChunkID[4] -- The real chunk ID
+ *      uint32_t Type -- The e_RIFFCompressType
+ *      uint32_t BlockSize -- Uncompressed bytes in each block
+ *      uint32_t Size -- Uncompressed size of the data
+ *      uint32_t IndexOffset -- Where the block index starts in the chunk
+ *      The blocks:
+ *          uint32_t Bytes -- Bytes in the block (top bit set if stored)
+ *          uint8_t Data[Bytes]
+ *      uint32_t Index[] -- Where each block starts in the chunk
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_UnsupportedCompression if 'Compress' wasn't built
+ *    in.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::StartDataBlock(const char *ChunkID,e_RIFFCompressType Compress)
+{
+    uint32_t ChunkSize;
+    uint64_t ChunkStart;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(strlen(ChunkID)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    if(!RIFF_CompressSupported(Compress))
+        throw(e_RIFFError_UnsupportedCompression);
+
+    if(FrontSize>0 && FrontIO==NULL && ListSizes.empty() &&
+            IsFrontChunk(ChunkID))
+    {
+        BeginFront();
+    }
+
+    if(!IO->Write(Compress==e_RIFFCompress_None?ChunkID:COMPRESS_CHUNK_ID,4))
+        throw(e_RIFFError_WriteError);
+
+    ChunkStart=IO->Tell();
+    ChunkSize=0;
+    WriteSize(ChunkSize);
+
+    SavedChuckOffset=ChunkStart;
+    SavedChuckSize=CurrentChunkSize;
+    DataBlockOpen=true;
+
+    CurrentChunkSize=0;
+    TotalFileSize+=4+4;
+    if(!ListSizes.empty())
+        CurrentListSize+=4+4;
+
+    if(Stats!=NULL)
+        Stats->DataBlocks++;
+
+    ChunkCRC=0;
+
+    ChunkCompress=Compress;
+    if(Compress!=e_RIFFCompress_None)
+    {
+        PackBlockSize=CompressBlockSize;
+        UnpackedSize=0;
+        UnpackPos=0;
+        UnpackBuffer.resize(PackBlockSize);
+        PackIndex.clear();
+
+        /* The size and index offset get filled in by EndDataBlock() */
+        memcpy(PackHeader,ChunkID,4);
+        MakeSize(&PackHeader[4],Compress);
+        MakeSize(&PackHeader[8],PackBlockSize);
+        MakeSize(&PackHeader[12],0);
+        MakeSize(&PackHeader[16],0);
+        if(!IO->Write(PackHeader,sizeof(PackHeader)))
+            throw(e_RIFFError_WriteError);
+        AddWritten(sizeof(PackHeader));
+    }
+
+    if(TraceHandler!=NULL)
+        TraceStart(e_RIFFTrace_ChunkStart,ChunkID,ChunkStart+4,0);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::EndDataBlock
+ *
+ * SYNOPSIS:
+ *    void RIFF::EndDataBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    When writing a file this function closes the data block opened with
+ *    StartDataBlock().  It will write the size of the data to the correct
+ *    place in the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::EndDataBlock(void)
+{
+    uint64_t ChunkOffset;
+    uint32_t ClosingChunkSize;
+    uint32_t TotalByteSizeOfChunk;
+    struct RIFFChecksum Checksum;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(ChunkCompress!=e_RIFFCompress_None)
+        EndCompress();
+
+    ClosingChunkSize=CurrentChunkSize;
+    TotalByteSizeOfChunk=ClosingChunkSize;
+
+    ChunkOffset=SavedChuckOffset;
+
+    /* Write the size of the closeing chunk */
+    PatchSize(ChunkOffset,ClosingChunkSize);
+
+    if(Checksums)
+    {
+        Checksum.Offset=ChunkOffset+4;
+        Checksum.Size=ClosingChunkSize;
+        Checksum.CRC=ChunkCRC;
+        ChecksumTable.push_back(Checksum);
+    }
+
+    /* Pad if needed */
+    if(ClosingChunkSize&1)
+    {
+        uint8_t ZeroPadding;
+
+        ZeroPadding=0;
+        if(!IO->Write(&ZeroPadding,1))
+            throw(e_RIFFError_WriteError);
+        TotalFileSize++;
+        TotalByteSizeOfChunk++; // Add to the amount of the new chunk
+        if(!ListSizes.empty())
+            CurrentListSize+=1;
+
+        if(Stats!=NULL)
+            Stats->PadBytes++;
+    }
+
+    CurrentChunkSize=SavedChuckSize;
+    DataBlockOpen=false;
+
+    if(TraceHandler!=NULL)
+        TraceChunkDone(ClosingChunkSize);
+
+    if(FrontIO!=NULL && ListSizes.empty())
+        EndFront();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::Write
+ *
+ * SYNOPSIS:
+ *    void RIFF::Write(const void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The binary data to write to the open chunk.
+ *    Bytes [I] -- The number of bytes to write to the chunk.
+ *
+ * FUNCTION:
+ *    This function writes bytes to the open chunk.  You can call this as
+ *    many times as you would like inside the chunk and it will append the
+ *    data to the open chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::Write(const void *Data,uint32_t Bytes)
+{
+    const uint8_t *Src;
+    uint32_t Copy;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(ChunkCompress==e_RIFFCompress_None)
+    {
+        WriteRaw(Data,Bytes);
+        return;
+    }
+
+    if(Bytes>0xFFFFFFFF-UnpackedSize)
+        throw(e_RIFFError_WriteError);
+
+    Src=(const uint8_t *)Data;
+    while(Bytes>0)
+    {
+        Copy=PackBlockSize-UnpackPos;
+        if(Copy>Bytes)
+            Copy=Bytes;
+        memcpy(UnpackBuffer.data()+UnpackPos,Src,Copy);
+
+        UnpackPos+=Copy;
+        UnpackedSize+=Copy;
+        Src+=Copy;
+        Bytes-=Copy;
+
+        if(UnpackPos==PackBlockSize)
+            WritePackedBlock();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteRaw
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteRaw(const void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The bytes to write
+ *    Bytes [I] -- The number of bytes to write
+ *
+ * FUNCTION:
+ *    This function writes bytes to the open chunk as is (without
+ *    compressing them).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Write()
+ ******************************************************************************/
+void RIFF::WriteRaw(const void *Data,uint32_t Bytes)
+{
+    if(!IO->Write(Data,Bytes))
+        throw(e_RIFFError_WriteError);
+
+    if(Checksums)
+        ChunkCRC=RIFF_CRC32C(ChunkCRC,Data,Bytes);
+
+    AddWritten(Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteSwapped
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteSwapped(const void *Data,unsigned Size,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The values to write
+ *    Size [I] -- The size of one value in bytes
+ *    Count [I] -- The number of values to write
+ *
+ * FUNCTION:
+ *    This function is used by WriteArray().  It writes an array of numbers
+ *    in the file's byte order.  If they need to be swapped they are copied
+ *    a bit at a time into a buffer on the stack and swapped there (the
+ *    caller's data is not changed).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::ReadSwapped(), RIFF_SwapBytes()
+ ******************************************************************************/
+void RIFF::WriteSwapped(const void *Data,unsigned Size,uint32_t Count)
+{
+    uint8_t Buffer[SWAP_BUFFER_SIZE];
+    const uint8_t *Pos;
+    uint32_t PerBuffer;
+    uint32_t Values;
+
+    if(Size!=0 && Count>0xFFFFFFFF/Size)
+        throw(e_RIFFError_WriteError);
+
+    if(IFFMode==RIFF_HOST_BIG_ENDIAN || Size<2)
+    {
+        Write(Data,Size*Count);
+        return;
+    }
+
+    Pos=(const uint8_t *)Data;
+    PerBuffer=sizeof(Buffer)/Size;
+    while(Count>0)
+    {
+        Values=Count;
+        if(Values>PerBuffer)
+            Values=PerBuffer;
+
+        memcpy(Buffer,Pos,Values*Size);
+        RIFF_SwapBytes(Buffer,Size,Values);
+        Write(Buffer,Values*Size);
+
+        Pos+=Values*Size;
+        Count-=Values;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::StartWriteInPlace
+ *
+ * SYNOPSIS:
+ *    void *RIFF::StartWriteInPlace(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes you are going to write to the open
+ *                 chunk.
+ *
+ * FUNCTION:
+ *    This function reserves space in the open chunk and gives you a pointer
+ *    to it so you can build the data in place (or have a device DMA
+ *    straight into it) instead of building it somewhere else and calling
+ *    Write().  When you have filled in the bytes call EndWriteInPlace().
+ *
+ *    With the e_RIFFIO_MMap I/O type the pointer is into the file itself so
+ *    there is no copy at all.  With other I/O types the pointer is to a
+ *    buffer that gets written to the file by EndWriteInPlace().  The I/O
+ *    holds the reserved span still (the map isn't moved) until
+ *    EndWriteInPlace() is called.
+ *
+ * RETURNS:
+ *    A pointer to 'Bytes' bytes to fill in.  This is only good until
+ *    EndWriteInPlace() is called.
+ *
+ * NOTES:
+ *    You can not call any other functions between StartWriteInPlace() and
+ *    EndWriteInPlace().
+ *
+ * SEE ALSO:
+ *    RIFF::EndWriteInPlace(), RIFF::Write()
+ ******************************************************************************/
+void *RIFF::StartWriteInPlace(uint32_t Bytes)
+{
+    void *Ptr;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    /* Compressed data has to go through a buffer */
+    Ptr=NULL;
+    if(ChunkCompress==e_RIFFCompress_None)
+        Ptr=IO->Reserve(Bytes);
+    if(Ptr==NULL)
+    {
+        InPlaceBuffer.resize(Bytes);
+        Ptr=InPlaceBuffer.data();
+    }
+    else
+    {
+        InPlaceBuffer.clear();
+    }
+    InPlaceBytes=Bytes;
+    InPlacePtr=Ptr;
+
+    return Ptr;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::EndWriteInPlace
+ *
+ * SYNOPSIS:
+ *    void RIFF::EndWriteInPlace(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function finishes the write started with StartWriteInPlace().
+ *    The bytes are added to the open chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartWriteInPlace()
+ ******************************************************************************/
+void RIFF::EndWriteInPlace(void)
+{
+    uint32_t Bytes;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    Bytes=InPlaceBytes;
+    InPlaceBytes=0;
+
+    if(ChunkCompress!=e_RIFFCompress_None)
+    {
+        Write(InPlaceBuffer.data(),Bytes);
+        InPlaceBuffer.clear();
+        return;
+    }
+
+    if(Checksums)
+        ChunkCRC=RIFF_CRC32C(ChunkCRC,InPlacePtr,Bytes);
+
+    if(!InPlaceBuffer.empty())
+    {
+        if(!IO->Write(InPlaceBuffer.data(),Bytes))
+            throw(e_RIFFError_WriteError);
+        InPlaceBuffer.clear();
+    }
+    else
+    {
+        /* The pointer was into the I/O's own memory, let it go */
+        IO->Release();
+    }
+
+    AddWritten(Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::AddWritten
+ *
+ * SYNOPSIS:
+ *    void RIFF::AddWritten(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes that where added to the open chunk
+ *
+ * FUNCTION:
+ *    This function adds bytes written to the open chunk into the sizes
+ *    we are keeping for the chunk, group and file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Write()
+ ******************************************************************************/
+void RIFF::AddWritten(uint32_t Bytes)
+{
+    TotalFileSize+=Bytes;
+    CurrentChunkSize+=Bytes;
+    if(!ListSizes.empty())
+        CurrentListSize+=Bytes;
+
+    if(Stats!=NULL)
+    {
+        Stats->Write.Calls++;
+        Stats->Write.Bytes+=Bytes;
+    }
+
+    if(CommitBytes!=0 || CommitMilliseconds!=0)
+        CheckCommit(Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::StartGroup
+ *
+ * SYNOPSIS:
+ *    void RIFF::StartGroup(const char *ListID);
+ *
+ * PARAMETERS:
+ *    ListID [I] -- The ID of the group to start.  This is the ID used to
+ *                  identify this group of data blocks when reading.
+ *                  This must be 4 letters long and be in the AscII range
+ *                  of [a-z][A-Z][0-9] and space.  Only the length is checked.
+ *
+ * FUNCTION:
+ *    This function starts group of data blocks.  Groups let you put data
+ *    blocks inside of other data blocks.  You can place groups inside of
+ *    other groups.
+ *
+ *    This works out to an IFF LIST chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    You must call EndGroup() to end the group.
+ *
+ * SEE ALSO:
+ *    EndGroup()
+ ******************************************************************************/
+void RIFF::StartGroup(const char *ListID)
+{
+    uint32_t ListSize;
+    uint64_t ListStart;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(strlen(ListID)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    if(FrontSize>0 && FrontIO==NULL && ListSizes.empty() &&
+            IsFrontChunk(ListID))
+    {
+        BeginFront();
+    }
+
+    if(!IO->Write("LIST",4))
+        throw(e_RIFFError_WriteError);
+    ListStart=IO->Tell();
+    ListSize=0;
+    WriteSize(ListSize);
+    if(!IO->Write(ListID,4))
+        throw(e_RIFFError_WriteError);
+
+    ListOffsets.push(ListStart);
+    ListSizes.push(CurrentListSize);
+
+    CurrentListSize=0;          // Reset the current list block size
+
+    CurrentListSize+=4;         // Add in ListID
+    TotalFileSize+=4+4+4;       // Add in 'LIST' + Size + ListID
+
+    if(Stats!=NULL)
+    {
+        Stats->Groups++;
+        if(ListOffsets.size()>Stats->MaxDepth)
+            Stats->MaxDepth=ListOffsets.size();
+    }
+
+    if(TraceHandler!=NULL)
+    {
+        TraceStart(e_RIFFTrace_GroupStart,ListID,ListStart+8,0);
+        TraceGroups.push_back(TraceChunk);
+        TraceChunkOpen=false;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::EndGroup
+ *
+ * SYNOPSIS:
+ *    void RIFF::EndGroup(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This ends the current group started with StartGroup().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    StartGroup()
+ ******************************************************************************/
+void RIFF::EndGroup(void)
+{
+    uint64_t ListOffset;
+    uint32_t ClosingListSize;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    ClosingListSize=CurrentListSize;
+
+    ListOffset=ListOffsets.top();
+    ListOffsets.pop();
+
+    /* Write the size of the closeing chunk */
+    PatchSize(ListOffset,ClosingListSize);
+
+    /* Pad if needed */
+    if(ClosingListSize&1)
+    {
+        uint8_t ZeroPadding;
+
+        ZeroPadding=0;
+        if(!IO->Write(&ZeroPadding,1))
+            throw(e_RIFFError_WriteError);
+        TotalFileSize++;
+        CurrentListSize++;  // Add this to the size of the current list
+
+        if(Stats!=NULL)
+            Stats->PadBytes++;
+    }
+
+    /* Move back up 1 level in the list */
+    /* Pop where we where then add in the block we just wrote, and add in
+       'LIST' and size */
+    CurrentListSize=ListSizes.top()+CurrentListSize+4+4;
+    ListSizes.pop();
+
+    if(TraceHandler!=NULL)
+        TraceGroupDone(ClosingListSize);
+
+    if(FrontIO!=NULL && ListSizes.empty())
+        EndFront();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteDataBlock
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteDataBlock(const char *ChunkID,const void *Data,
+ *              uint32_t Bytes);
+ *    template <typename S> void RIFF::WriteDataBlock(const char *ChunkID,
+ *              const S &Data);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk ID for the new data block
+ *    Data [I] -- The data to write
+ *    Bytes [I] -- The number of bytes to write
+ *
+ * FUNCTION:
+ *    This function writes a whole data block in one call.  It is the same
+ *    as calling StartDataBlock(), Write(), EndDataBlock().
+ *
+ *    The template version writes a struct that has been described with
+ *    RIFF_STRUCT() using WriteStruct().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartDataBlock(), RIFF::WriteStruct()
+ ******************************************************************************/
+void RIFF::WriteDataBlock(const char *ChunkID,const void *Data,uint32_t Bytes)
+{
+    StartDataBlock(ChunkID);
+    Write(Data,Bytes);
+    EndDataBlock();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteDataBlocks
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteDataBlocks(const void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [I] -- Whole data blocks one after the other.  Each is the chunk
+ *                ID, the size (in the file's byte order, see
+ *                SetIFFMode()), the data and a pad byte if the size is odd.
+ *    Bytes [I] -- The number of bytes in 'Data'
+ *
+ * FUNCTION:
+ *    This function writes a run of data blocks you have already built in
+ *    memory in one write.  Each StartDataBlock() / EndDataBlock() has to go
+ *    back and fix the size, so for lots of small data blocks this is a lot
+ *    faster.  The blocks are added to the open group (if there is one) the
+ *    same as if they where written one at a time (checksums, stats and
+ *    tracing included).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the blocks in 'Data' don't add up to
+ *    'Bytes'.
+ *
+ *    This can not be called with a data block open.
+ *
+ * SEE ALSO:
+ *    RIFF::WriteDataBlock(), RIFF::StartGroup()
+ ******************************************************************************/
+void RIFF::WriteDataBlocks(const void *Data,uint32_t Bytes)
+{
+    const uint8_t *Blocks;
+    const uint8_t *SizeBuff;
+    struct RIFFChecksum Checksum;
+    uint64_t Start;
+    uint32_t Pos;
+    uint32_t Size;
+    uint32_t Pad;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    /* Make sure it's all whole blocks before anything is written */
+    Blocks=(const uint8_t *)Data;
+    for(Pos=0;Pos<Bytes;Pos+=4+4+Size+Pad)
+    {
+        if(Bytes-Pos<4+4)
+            throw(e_RIFFError_BadFormat);
+        SizeBuff=&Blocks[Pos+4];
+        if(IFFMode)
+            Size=SizeBuff[0]<<24|SizeBuff[1]<<16|SizeBuff[2]<<8|SizeBuff[3];
+        else
+            Size=SizeBuff[3]<<24|SizeBuff[2]<<16|SizeBuff[1]<<8|SizeBuff[0];
+        Pad=Size&1;
+        if((uint64_t)Size+Pad>Bytes-Pos-4-4)
+            throw(e_RIFFError_BadFormat);
+
+        if(Checksums || TraceHandler!=NULL)
+        {
+            Start=IO->Tell()+Pos+4+4;
+            if(Checksums)
+            {
+                Checksum.Offset=Start;
+                Checksum.Size=Size;
+                Checksum.CRC=RIFF_CRC32C(0,&Blocks[Pos+4+4],Size);
+                ChecksumTable.push_back(Checksum);
+            }
+            if(TraceHandler!=NULL)
+            {
+                TraceStart(e_RIFFTrace_ChunkStart,(const char *)&Blocks[Pos],
+                        Start,0);
+                TraceChunkDone(Size);
+            }
+        }
+
+        if(Stats!=NULL)
+        {
+            Stats->DataBlocks++;
+            Stats->PadBytes+=Pad;
+        }
+    }
+
+    if(!IO->Write(Data,Bytes))
+        throw(e_RIFFError_WriteError);
+
+    TotalFileSize+=Bytes;
+    if(!ListSizes.empty())
+        CurrentListSize+=Bytes;
+
+    if(Stats!=NULL)
+    {
+        Stats->Write.Calls++;
+        Stats->Write.Bytes+=Bytes;
+    }
+
+    if(CommitBytes!=0 || CommitMilliseconds!=0)
+        CheckCommit(Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReserveFront
+ *
+ * SYNOPSIS:
+ *    void RIFF::ReserveFront(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes to hold at the front of the file for
+ *                 the chunks added with AddFrontChunk().  This is rounded
+ *                 up to an even number.
+ *
+ * FUNCTION:
+ *    This function writes a "JUNK" chunk that holds space near the start of
+ *    the file.  Later, when a chunk or group you have marked with
+ *    AddFrontChunk() is written at the top level, it is built in memory and
+ *    when it is done it is put in this space instead of at the end of the
+ *    file (a smaller "JUNK" chunk is left behind for the space that is
+ *    left).  This puts the metadata and index in front of the bulk of the
+ *    data, so a reader (or a player streaming the file) finds it without
+ *    reading the whole file, and nothing has to be moved after the file
+ *    is written.
+ *
+ *    If a marked chunk does not fit in the space that is left it is
+ *    written in the normal place.  The faststart tool (tools/Faststart)
+ *    can move it after the file is written.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    This must be called when writing, with no data block or group open.
+ *    Normally it is called right after Open().
+ *
+ *    Marked chunks are kept in memory until they are done.
+ *
+ *    The reserved space is in the first form only (see NextForm()).
+ *
+ *    The offsets in the trace (see SetTraceHandler()) for marked chunks are
+ *    where they would go in the reserved space.
+ *
+ * SEE ALSO:
+ *    RIFF::AddFrontChunk(), RIFF::Open()
+ ******************************************************************************/
+void RIFF::ReserveFront(uint32_t Bytes)
+{
+    uint8_t Header[8];
+    std::vector<uint8_t> Zeros;
+    uint64_t Start;
+    uint32_t Left;
+    uint32_t Copy;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Opened4Read || FrontIO!=NULL || !ListSizes.empty())
+        throw(e_RIFFError_UnsupportedFileMode);
+
+    if(Bytes>0xFFFFFFFF-8-1)
+        throw(e_RIFFError_WriteError);
+    Bytes=(Bytes+1)&~1;
+
+    Start=IO->Tell();
+    memcpy(Header,"JUNK",4);
+    MakeSize(&Header[4],Bytes);
+    if(!IO->Write(Header,sizeof(Header)))
+        throw(e_RIFFError_WriteError);
+
+    Zeros.resize(Bytes<65536?Bytes:65536);
+    for(Left=Bytes;Left>0;Left-=Copy)
+    {
+        Copy=Left<Zeros.size()?Left:Zeros.size();
+        if(!IO->Write(Zeros.data(),Copy))
+            throw(e_RIFFError_WriteError);
+    }
+
+    TotalFileSize+=sizeof(Header)+Bytes;
+
+    FrontOffset=Start;
+    FrontSize=sizeof(Header)+Bytes;
+
+    if(TraceHandler!=NULL)
+    {
+        TraceStart(e_RIFFTrace_ChunkStart,"JUNK",Start+8,0);
+        TraceChunkDone(Bytes);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::AddFrontChunk
+ *
+ * SYNOPSIS:
+ *    void RIFF::AddFrontChunk(const char *ChunkID);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk ID of a data block (or the list ID of a
+ *                   group) to put in the space from ReserveFront().  This
+ *                   must be 4 letters long.
+ *
+ * FUNCTION:
+ *    This function marks a chunk ID to go at the front of the file.  Only
+ *    data blocks and groups at the top level are moved.  You can mark as
+ *    many IDs as you like.  They stay marked for every file written with
+ *    this object.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::ReserveFront()
+ ******************************************************************************/
+void RIFF::AddFrontChunk(const char *ChunkID)
+{
+    if(strlen(ChunkID)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    if(IsFrontChunk(ChunkID))
+        return;
+
+    FrontIDs.insert(FrontIDs.end(),(const uint8_t *)ChunkID,
+            (const uint8_t *)ChunkID+4);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::IsFrontChunk
+ *
+ * SYNOPSIS:
+ *    bool RIFF::IsFrontChunk(const char *ChunkID);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk ID to look up
+ *
+ * FUNCTION:
+ *    This function checks if a chunk ID was marked with AddFrontChunk().
+ *
+ * RETURNS:
+ *    true -- It goes at the front
+ *    false -- It goes where it is written
+ *
+ * SEE ALSO:
+ *    RIFF::AddFrontChunk()
+ ******************************************************************************/
+bool RIFF::IsFrontChunk(const char *ChunkID)
+{
+    size_t r;
+
+    for(r=0;r<FrontIDs.size();r+=4)
+        if(memcmp(&FrontIDs[r],ChunkID,4)==0)
+            return true;
+
+    return false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::BeginFront
+ *
+ * SYNOPSIS:
+ *    void RIFF::BeginFront(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called when a chunk that goes at the front is
+ *    started.  It switches to writing into memory (as if the chunk was
+ *    already where the reserved space starts) until EndFront() is called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::EndFront(), RIFF::ReserveFront()
+ ******************************************************************************/
+void RIFF::BeginFront(void)
+{
+    FrontBuffer.clear();
+    FrontTrace.clear();
+    FrontIO=IO;
+    IO=RIFFIO_CreateMemory(&FrontBuffer,FrontOffset);
+    FrontChecksumStart=ChecksumTable.size();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::EndFront
+ *
+ * SYNOPSIS:
+ *    void RIFF::EndFront(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called when the chunk started with BeginFront() is
+ *    done.  It goes back to writing the file and puts the chunk in the
+ *    reserved space.  If it doesn't fit (with room for the "JUNK" header of
+ *    the space left, if any is left) it is written where we are in the file
+ *    instead.  The trace events held while building the chunk are sent
+ *    now, with the offsets it ended up at.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::BeginFront(), RIFF::ReserveFront()
+ ******************************************************************************/
+void RIFF::EndFront(void)
+{
+    uint8_t Header[8];
+    uint64_t Start;
+    uint64_t Moved;
+    uint32_t Bytes;
+    size_t r;
+
+    delete IO;
+    IO=FrontIO;
+    FrontIO=NULL;
+
+    Moved=0;
+    Bytes=FrontBuffer.size();
+    if(Bytes==FrontSize || (uint64_t)Bytes+sizeof(Header)<=FrontSize)
+    {
+        if(!IO->Patch(FrontOffset,FrontBuffer.data(),Bytes))
+        {
+            CloseIO();
+            throw(e_RIFFError_WriteError);
+        }
+        FrontOffset+=Bytes;
+        FrontSize-=Bytes;
+
+        if(FrontSize>0)
+        {
+            memcpy(Header,"JUNK",4);
+            MakeSize(&Header[4],FrontSize-sizeof(Header));
+            if(!IO->Patch(FrontOffset,Header,sizeof(Header)))
+            {
+                CloseIO();
+                throw(e_RIFFError_WriteError);
+            }
+        }
+
+        /* It was already counted as part of the "JUNK" chunk */
+        TotalFileSize-=Bytes;
+    }
+    else
+    {
+        Start=IO->Tell();
+        if(!IO->Write(FrontBuffer.data(),Bytes))
+            throw(e_RIFFError_WriteError);
+
+        for(r=FrontChecksumStart;r<ChecksumTable.size();r++)
+            ChecksumTable[r].Offset+=Start-FrontOffset;
+        Moved=Start-FrontOffset;
+    }
+    FrontBuffer.clear();
+
+    for(r=0;r<FrontTrace.size();r++)
+    {
+        FrontTrace[r].Offset+=Moved;
+        TraceHandler(&FrontTrace[r],TraceUserData);
+    }
+    FrontTrace.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::Commit
+ *
+ * SYNOPSIS:
+ *    void RIFF::Commit(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    When writing a file this function fills in the sizes of the form, the
+ *    open groups and the open data block with what has been written so far
+ *    and flushes the file, so it can be read as it is right now.
+ *
+ *    This is called for you if you use SetCommitInterval().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    A compressed data block that is still open is left out of the commit
+ *    (the sizes end where it starts).  Its header and index are only filled
+ *    in by EndDataBlock(), and most of its data is still in memory waiting
+ *    to fill a block (see SetCompressBlockSize()).
+ *
+ *    The checksums (see SetChecksums()) are only written at Close().
+ *
+ *    Nothing is committed while a chunk for the front of the file is being
+ *    built (see ReserveFront()).
+ *
+ * SEE ALSO:
+ *    RIFF::SetCommitInterval()
+ ******************************************************************************/
+void RIFF::Commit(void)
+{
+    uint32_t Exclude;
+    uint32_t Size;
+    unsigned g;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Opened4Read)
+        throw(e_RIFFError_UnsupportedFileMode);
+
+    if(FrontIO!=NULL)
+        return;
+
+    /* The data has to be out before the sizes that say it is there */
+    if(!IO->Flush(CommitSync))
+        throw(e_RIFFError_WriteError);
+
+    Exclude=0;
+    if(DataBlockOpen)
+    {
+        if(ChunkCompress!=e_RIFFCompress_None)
+            Exclude=4+4+CurrentChunkSize;
+        else
+            PatchSize(SavedChuckOffset,CurrentChunkSize);
+    }
+
+    /* Work out from the inner most group */
+    Size=CurrentListSize-Exclude;
+    for(g=ListOffsets.size();g>0;g--)
+    {
+        PatchSize(ListOffsets.at(g-1),Size);
+        Size=ListSizes.at(g-1)+4+4+Size;
+    }
+
+    PatchSize(FormStart+4,TotalFileSize-Exclude);
+
+    /* Let readers see the sizes (they get synced by the next commit) */
+    if(!IO->Flush(false))
+        throw(e_RIFFError_WriteError);
+
+    UncommittedBytes=0;
+    LastCommit=RIFF_TraceNow();
+
+    if(Stats!=NULL)
+        Stats->Commits++;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::CheckCommit
+ *
+ * SYNOPSIS:
+ *    void RIFF::CheckCommit(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes that where just written
+ *
+ * FUNCTION:
+ *    This function is called after bytes are written when
+ *    SetCommitInterval() is on.  It calls Commit() if enough bytes have
+ *    been written or enough time has gone by.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetCommitInterval(), RIFF::Commit()
+ ******************************************************************************/
+void RIFF::CheckCommit(uint32_t Bytes)
+{
+    UncommittedBytes+=Bytes;
+
+    if(CommitBytes!=0 && UncommittedBytes>=CommitBytes)
+        Commit();
+    else if(CommitMilliseconds!=0 &&
+            RIFF_TraceNow()-LastCommit>=CommitMilliseconds*1000000ULL)
+    {
+        Commit();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::SeekInChunk
+ *
+ * SYNOPSIS:
+ *    void RIFF::SeekInChunk(uint32_t Offset);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- The offset from the start of the chunk's data to move to
+ *
+ * FUNCTION:
+ *    This function moves where the next Read() will read from in the
+ *    current data block.  You can move forward or back.
+ *
+ *    For compressed data blocks 'Offset' is in the uncompressed data.  Only
+ *    the block 'Offset' is in gets read and uncompressed.
+ *
+ *    The checksum (see SetChecksums()) can't be checked for a chunk you
+ *    move around in.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_ChunkToSmall if 'Offset' is past the end of the
+ *    chunk.
+ *
+ * SEE ALSO:
+ *    RIFF::Read()
+ ******************************************************************************/
+void RIFF::SeekInChunk(uint32_t Offset)
+{
+    uint32_t Block;
+
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(ChunkCompress==e_RIFFCompress_None)
+    {
+        if(Offset>CurrentChunkSize-CurrentChunkPad)
+            throw(e_RIFFError_ChunkToSmall);
+        MoveInChunk(Offset);
+        return;
+    }
+
+    if(Offset>UnpackedSize)
+        throw(e_RIFFError_ChunkToSmall);
+
+    UnpackedLeft=UnpackedSize-Offset;
+    if(UnpackedLeft==0)
+    {
+        UnpackBuffer.clear();
+        UnpackPos=0;
+        return;
+    }
+
+    Block=Offset/PackBlockSize;
+    if(Block+1!=PackNextBlock || UnpackBuffer.empty())
+    {
+        if(PackIndex.empty())
+            LoadPackIndex();
+
+        ChecksumPending=false;
+        MoveInChunk(PackIndex[Block]);
+        PackNextBlock=Block;
+        ReadPackedBlock();
+    }
+    UnpackPos=Offset-Block*PackBlockSize;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ChunkBytesLeft
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFF::ChunkBytesLeft(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of bytes Read() can still read from the
+ *    current data block (not counting the padding byte).
+ *
+ * RETURNS:
+ *    The number of bytes left
+ *
+ * SEE ALSO:
+ *    RIFF::Read()
+ ******************************************************************************/
+uint32_t RIFF::ChunkBytesLeft(void)
+{
+    if(ChunkCompress!=e_RIFFCompress_None)
+        return UnpackedLeft;
+
+    if(DataLeft>CurrentChunkPad)
+        return DataLeft-CurrentChunkPad;
+    return 0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::MoveInChunk
+ *
+ * SYNOPSIS:
+ *    void RIFF::MoveInChunk(uint32_t Pos);
+ *
+ * PARAMETERS:
+ *    Pos [I] -- The offset in the chunk data (as stored in the file)
+ *
+ * FUNCTION:
+ *    This function seeks the file to a new place in the current data block
+ *    and fixes up how much is left to read.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SeekInChunk()
+ ******************************************************************************/
+void RIFF::MoveInChunk(uint32_t Pos)
+{
+    uint32_t At;
+
+    At=CurrentChunkSize-DataLeft;
+    if(Pos==At)
+        return;
+
+    if(!IO->Seek((uint64_t)CurrentChunkOffset+Pos))
+        throw(e_RIFFError_ReadError);
+
+    /* We can't work out the checksum if we don't read it all in order */
+    ChecksumPending=false;
+
+    ReadFromBlock+=Pos-At;
+    DataLeft=CurrentChunkSize-Pos;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::StartDecompress
+ *
+ * SYNOPSIS:
+ *    void RIFF::StartDecompress(char *ChunkID,uint32_t *ChunkSize);
+ *
+ * PARAMETERS:
+ *    ChunkID [O] -- The real chunk ID of the compressed data block
+ *    ChunkSize [O] -- The uncompressed size of the data block
+ *
+ * FUNCTION:
+ *    This function is called by ReadNextDataBlock() when it finds a "CMPR"
+ *    chunk.  It reads the header so Read() can uncompress the data.  See
+ *    StartDataBlock() for the format.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::ReadPackedBlock()
+ ******************************************************************************/
+void RIFF::StartDecompress(char *ChunkID,uint32_t *ChunkSize)
+{
+    uint32_t Fields[4];
+    uint32_t RawSize;
+
+    RawSize=CurrentChunkSize-CurrentChunkPad;
+    if(RawSize<sizeof(PackHeader))
+        return;
+
+    ReadRaw(PackHeader,sizeof(PackHeader));
+    RIFF_ParsePackHeader(PackHeader,RawSize,IFFMode,Fields);
+    if(!RIFF_CompressSupported((e_RIFFCompressType)Fields[0]))
+        throw(e_RIFFError_UnsupportedCompression);
+
+    ChunkCompress=(e_RIFFCompressType)Fields[0];
+    PackBlockSize=Fields[1];
+    UnpackedSize=Fields[2];
+    PackIndexOffset=Fields[3];
+    UnpackedLeft=UnpackedSize;
+    PackNextBlock=0;
+    UnpackPos=0;
+    UnpackBuffer.clear();
+    PackIndex.clear();
+
+    memcpy(ChunkID,PackHeader,4);
+    *ChunkSize=UnpackedSize;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadPackedBlock
+ *
+ * SYNOPSIS:
+ *    void RIFF::ReadPackedBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function reads the next compressed block from the file and
+ *    uncompresses it into 'UnpackBuffer'.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartDecompress()
+ ******************************************************************************/
+void RIFF::ReadPackedBlock(void)
+{
+    uint8_t Buffer[VERIFY_BUFFER_SIZE];
+    uint32_t Blocks;
+    uint32_t Expected;
+    uint32_t Stored;
+
+    Blocks=UnpackedSize/PackBlockSize+(UnpackedSize%PackBlockSize!=0);
+    if(PackNextBlock>=Blocks)
+        throw(e_RIFFError_BadFormat);
+
+    Expected=PackBlockSize;
+    if(PackNextBlock==Blocks-1 && UnpackedSize%PackBlockSize!=0)
+        Expected=UnpackedSize%PackBlockSize;
+
+    ReadRaw(&Stored,4);
+    if(IFFMode!=RIFF_HOST_BIG_ENDIAN)
+        RIFF_SwapBytes(&Stored,4,1);
+
+    UnpackBuffer.resize(Expected);
+    if(Stored&PACK_STORED_FLAG)
+    {
+        if((Stored&~PACK_STORED_FLAG)!=Expected)
+            throw(e_RIFFError_BadFormat);
+        ReadRaw(UnpackBuffer.data(),Expected);
+    }
+    else
+    {
+        if(Stored>DataLeft)
+            throw(e_RIFFError_BadFormat);
+        PackBuffer.resize(Stored);
+        ReadRaw(PackBuffer.data(),Stored);
+        if(!RIFF_Unpack(ChunkCompress,PackBuffer.data(),Stored,
+                UnpackBuffer.data(),Expected))
+        {
+            throw(e_RIFFError_BadFormat);
+        }
+    }
+    UnpackPos=0;
+    PackNextBlock++;
+
+    /* Read the index too so the checksum gets checked */
+    if(PackNextBlock==Blocks && ChecksumPending)
+    {
+        while(ChunkCRCBytes<ChunkDataSize)
+        {
+            Stored=ChunkDataSize-ChunkCRCBytes;
+            if(Stored>sizeof(Buffer))
+                Stored=sizeof(Buffer);
+            ReadRaw(Buffer,Stored);
+        }
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::LoadPackIndex
+ *
+ * SYNOPSIS:
+ *    void RIFF::LoadPackIndex(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function loads the block index of the current compressed data
+ *    block.  The file is left where it was.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SeekInChunk()
+ ******************************************************************************/
+void RIFF::LoadPackIndex(void)
+{
+    uint32_t Blocks;
+    uint32_t r;
+
+    Blocks=UnpackedSize/PackBlockSize+(UnpackedSize%PackBlockSize!=0);
+    PackIndex.resize(Blocks);
+
+    if(!IO->Seek((uint64_t)CurrentChunkOffset+PackIndexOffset) ||
+            !IO->Read(PackIndex.data(),Blocks*4) ||
+            !IO->Seek((uint64_t)CurrentChunkOffset+CurrentChunkSize-DataLeft))
+    {
+        PackIndex.clear();
+        throw(e_RIFFError_ReadError);
+    }
+
+    if(IFFMode!=RIFF_HOST_BIG_ENDIAN)
+        RIFF_SwapBytes(PackIndex.data(),4,Blocks);
+
+    for(r=0;r<Blocks;r++)
+    {
+        if(PackIndex[r]<sizeof(PackHeader) || PackIndex[r]>=PackIndexOffset)
+        {
+            PackIndex.clear();
+            throw(e_RIFFError_BadFormat);
+        }
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WritePackedBlock
+ *
+ * SYNOPSIS:
+ *    void RIFF::WritePackedBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function compresses what is in 'UnpackBuffer' and writes it out
+ *    as the next block.  If it doesn't get any smaller it is stored as is.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::Write()
+ ******************************************************************************/
+void RIFF::WritePackedBlock(void)
+{
+    uint8_t SizeBuff[4];
+    const uint8_t *Data;
+    uint32_t Stored;
+
+    if(UnpackPos==0)
+        return;
+
+    PackIndex.push_back(CurrentChunkSize);
+
+    PackBuffer.resize(RIFF_PackBound(ChunkCompress,UnpackPos));
+    Stored=RIFF_Pack(ChunkCompress,UnpackBuffer.data(),UnpackPos,
+            PackBuffer.data(),PackBuffer.size());
+    Data=PackBuffer.data();
+    if(Stored==0 || Stored>=UnpackPos)
+    {
+        Stored=UnpackPos;
+        Data=UnpackBuffer.data();
+        MakeSize(SizeBuff,Stored|PACK_STORED_FLAG);
+    }
+    else
+    {
+        MakeSize(SizeBuff,Stored);
+    }
+
+    WriteRaw(SizeBuff,4);
+    WriteRaw(Data,Stored);
+
+    UnpackPos=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::EndCompress
+ *
+ * SYNOPSIS:
+ *    void RIFF::EndCompress(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called by EndDataBlock() for compressed data blocks.
+ *    It writes the last block and the index and fills in the header.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::StartDataBlock()
+ ******************************************************************************/
+void RIFF::EndCompress(void)
+{
+    uint32_t IndexOffset;
+    uint32_t HeaderCRC;
+
+    WritePackedBlock();
+    ChunkCompress=e_RIFFCompress_None;
+
+    IndexOffset=CurrentChunkSize;
+    if(!PackIndex.empty())
+        WriteArray(PackIndex.data(),PackIndex.size());
+
+    MakeSize(&PackHeader[12],UnpackedSize);
+    MakeSize(&PackHeader[16],IndexOffset);
+    PatchSize(SavedChuckOffset+4+12,UnpackedSize);
+    PatchSize(SavedChuckOffset+4+16,IndexOffset);
+
+    if(Checksums)
+    {
+        /* The header wasn't in the CRC (it wasn't done yet) so add it to
+           the front now */
+        HeaderCRC=RIFF_CRC32C(0,PackHeader,sizeof(PackHeader));
+        ChunkCRC=RIFF_CRC32CCombine(HeaderCRC,ChunkCRC,
+                CurrentChunkSize-sizeof(PackHeader));
+    }
+
+    UnpackBuffer.clear();
+    PackBuffer.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::LoadChecksums
+ *
+ * SYNOPSIS:
+ *    void RIFF::LoadChecksums(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function loads the "CSUM" chunk from the end of the file into
+ *    'ChecksumTable' and then seeks back to the first chunk.  The last 4
+ *    bytes of the "CSUM" chunk are its size so we can find it from the end
+ *    of the file without walking the file.
+ *
+ *    The "CSUM" chunk is:
+ *      uint32_t Algo -- 1 = CRC32C
+ *      uint32_t Count -- Number of checksums
+ *      struct RIFFChecksum [Count]
+ *      uint32_t Size -- The size of this chunk
+ *    All in the file's byte order.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::WriteChecksums()
+ ******************************************************************************/
+void RIFF::LoadChecksums(void)
+{
+    char ChunkID[5];
+    uint64_t FileEnd;
+    uint64_t Start;
+    uint32_t Size;
+    uint32_t Count;
+
+    ChunkID[4]=0;
+
+    /* Smallest is the chunk header + algo + count + size */
+    FileEnd=(uint64_t)TotalFileSize+8;
+    if(FileEnd>=12+8+12)
+    {
+        if(!IO->Seek(FileEnd-4))
+        {
+            CloseIO();
+            throw(e_RIFFError_ReadError);
+        }
+        Size=ReadSize();
+
+        if(Size>=12 && Size%4==0 && (uint64_t)Size+8+12<=FileEnd)
+        {
+            Start=FileEnd-Size;
+            if(!IO->Seek(Start-8) || !IO->Read(ChunkID,4))
+            {
+                CloseIO();
+                throw(e_RIFFError_ReadError);
+            }
+
+            if(strcmp(ChunkID,CHECKSUM_CHUNK_ID)==0 && ReadSize()==Size &&
+                    ReadSize()==CHECKSUM_ALGO_CRC32C)
+            {
+                Count=ReadSize();
+                if(Count==(Size-12)/sizeof(struct RIFFChecksum))
+                {
+                    ChecksumTable.resize(Count);
+                    if(Count>0 && !IO->Read(ChecksumTable.data(),
+                            Count*sizeof(struct RIFFChecksum)))
+                    {
+                        CloseIO();
+                        throw(e_RIFFError_ReadError);
+                    }
+                    if(IFFMode!=RIFF_HOST_BIG_ENDIAN)
+                        RIFF_SwapBytes(ChecksumTable.data(),4,Count*3);
+                }
+            }
+        }
+    }
+
+    if(!IO->Seek(12))
+    {
+        CloseIO();
+        throw(e_RIFFError_ReadError);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteChecksums
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteChecksums(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes the "CSUM" chunk with all the checksums for the
+ *    data blocks that where written.  See LoadChecksums() for the format.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::LoadChecksums()
+ ******************************************************************************/
+void RIFF::WriteChecksums(void)
+{
+    uint32_t Header[2];
+    uint32_t Size;
+
+    static_assert(sizeof(struct RIFFChecksum)==12,"RIFFChecksum is packed");
+
+    /* The checksum chunk doesn't get a checksum */
+    Checksums=false;
+
+    /* The reader walks the table in file order, but chunks moved to the
+       front (see ReserveFront()) where added after the ones behind them */
+    std::sort(ChecksumTable.begin(),ChecksumTable.end(),RIFF_ChecksumBefore);
+
+    Header[0]=CHECKSUM_ALGO_CRC32C;
+    Header[1]=ChecksumTable.size();
+    Size=sizeof(Header)+ChecksumTable.size()*sizeof(struct RIFFChecksum)+
+            sizeof(Size);
+
+    StartDataBlock(CHECKSUM_CHUNK_ID);
+    WriteArray(Header,2);
+    if(!ChecksumTable.empty())
+    {
+        WriteArray((const uint32_t *)ChecksumTable.data(),
+                ChecksumTable.size()*3);
+    }
+    WriteArray(&Size,1);
+    EndDataBlock();
+
+    Checksums=true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ChecksumChunkDone
+ *
+ * SYNOPSIS:
+ *    bool RIFF::ChecksumChunkDone(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called when we are done with a chunk that has a
+ *    checksum.  If all of the chunk was read it checks the checksum.
+ *
+ * RETURNS:
+ *    true -- The chunk was good or not all of it was read
+ *    false -- The checksum didn't match
+ *
+ * SEE ALSO:
+ *    RIFF::VerifyChunk()
+ ******************************************************************************/
+bool RIFF::ChecksumChunkDone(void)
+{
+    ChecksumPending=false;
+
+    if(ChunkCRCBytes!=ChunkDataSize)
+        return true;
+
+    return ChunkCRC==ChecksumExpected;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::ReadSize
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFF::ReadSize(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function reads a 32bit var from the file and converts it
+ *    from IFF or RIFF as needed.
+ *
+ * RETURNS:
+ *    The read value.
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+uint32_t RIFF::ReadSize(void)
+{
+    uint8_t SizeBuff[4];
+    uint32_t Var;
+
+    if(!IO->Read(SizeBuff,4))
+    {
+        CloseIO();
+        throw(e_RIFFError_ReadError);
+    }
+
+    if(IFFMode)
+    {
+        Var =SizeBuff[3]<<0;
+        Var|=SizeBuff[2]<<8;
+        Var|=SizeBuff[1]<<16;
+        Var|=SizeBuff[0]<<24;
+    }
+    else
+    {
+        Var =SizeBuff[0]<<0;
+        Var|=SizeBuff[1]<<8;
+        Var|=SizeBuff[2]<<16;
+        Var|=SizeBuff[3]<<24;
+    }
+
+    return Var;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::WriteSize
+ *
+ * SYNOPSIS:
+ *    void RIFF::WriteSize(uint32_t Size);
+ *
+ * PARAMETERS:
+ *    Size [I] -- The size to write out
+ *
+ * FUNCTION:
+ *    This function writes a 32bit size out to the file converting for IFF and
+ *    RIFF as needed.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::WriteSize(uint32_t Size)
+{
+    uint8_t SizeBuff[4];
+
+    MakeSize(SizeBuff,Size);
+
+    if(!IO->Write(SizeBuff,4))
+    {
+        CloseIO();
+        throw(e_RIFFError_WriteError);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::PatchSize
+ *
+ * SYNOPSIS:
+ *    void RIFF::PatchSize(uint64_t Offset,uint32_t Size);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- Where in the file to write the size
+ *    Size [I] -- The size to write out
+ *
+ * FUNCTION:
+ *    This function writes a 32bit size over a size that was already written
+ *    to the file (converting for IFF and RIFF as needed).  The write
+ *    position is not changed.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::WriteSize()
+ ******************************************************************************/
+void RIFF::PatchSize(uint64_t Offset,uint32_t Size)
+{
+    uint8_t SizeBuff[4];
+
+    MakeSize(SizeBuff,Size);
+
+    if(!IO->Patch(Offset,SizeBuff,4))
+    {
+        CloseIO();
+        throw(e_RIFFError_WriteError);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::MakeSize
+ *
+ * SYNOPSIS:
+ *    void RIFF::MakeSize(uint8_t *SizeBuff,uint32_t Size);
+ *
+ * PARAMETERS:
+ *    SizeBuff [O] -- The 4 bytes to fill in
+ *    Size [I] -- The size to convert
+ *
+ * FUNCTION:
+ *    This function converts a size to the bytes we store in the file for
+ *    IFF or RIFF.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::WriteSize(), RIFF::PatchSize()
+ ******************************************************************************/
+void RIFF::MakeSize(uint8_t *SizeBuff,uint32_t Size)
+{
+    if(IFFMode)
+    {
+        SizeBuff[0]=(Size>>24)&0xFF;
+        SizeBuff[1]=(Size>>16)&0xFF;
+        SizeBuff[2]=(Size>>8)&0xFF;
+        SizeBuff[3]=(Size>>0)&0xFF;
+    }
+    else
+    {
+        SizeBuff[0]=(Size>>0)&0xFF;
+        SizeBuff[1]=(Size>>8)&0xFF;
+        SizeBuff[2]=(Size>>16)&0xFF;
+        SizeBuff[3]=(Size>>24)&0xFF;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::CloseIO
+ *
+ * SYNOPSIS:
+ *    void RIFF::CloseIO(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function closes the file and frees the backend (if there is one).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFF::CloseIO(void)
+{
+    if(FrontIO!=NULL)
+    {
+        /* We where in the middle of building a chunk for the front */
+        delete IO;
+        IO=FrontIO;
+        FrontIO=NULL;
+    }
+
+    if(IO!=NULL)
+    {
+        IO->Close();
+        delete IO;
+    }
+    IO=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::HintChunkStarted
+ *
+ * SYNOPSIS:
+ *    void RIFF::HintChunkStarted(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called when ReadNextDataBlock() has found a new chunk.
+ *    It remembers where the chunk is and asks the OS for the header of the
+ *    chunk after this one, which is the next thing we will read if the
+ *    caller skips this chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetAccessHints()
+ ******************************************************************************/
+void RIFF::HintChunkStarted(void)
+{
+    HintChunkStart=CurrentChunkOffset;
+    HintChunkEnd=HintChunkStart+DataLeft;
+    HintedTo=HintChunkStart;
+    DroppedTo=HintChunkStart;
+    HintChunkRead=false;
+
+    IO->Advise(HintChunkEnd,8,e_RIFFIOAdvice_WillNeed);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::HintChunkDone
+ *
+ * SYNOPSIS:
+ *    void RIFF::HintChunkDone(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function is called when we move off the current chunk.  If the
+ *    caller read from the chunk we tell the OS it can drop what is left of
+ *    it from the cache.  Chunks that where skipped where never loaded so
+ *    there is nothing to drop.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetAccessHints()
+ ******************************************************************************/
+void RIFF::HintChunkDone(void)
+{
+    if(!HintChunkRead)
+        return;
+    HintChunkRead=false;
+
+    if(HintChunkEnd>DroppedTo)
+        IO->Advise(DroppedTo,HintChunkEnd-DroppedTo,e_RIFFIOAdvice_DontNeed);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::HintRead
+ *
+ * SYNOPSIS:
+ *    void RIFF::HintRead(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes about to be read
+ *
+ * FUNCTION:
+ *    This function is called from Read() before the bytes are read.  It
+ *    keeps the OS loading up to 'HintWindow' bytes ahead of the read (but
+ *    not past the end of the chunk) and tells the OS it can drop what we
+ *    have read once we are a 'HintWindow' past it.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetAccessHints()
+ ******************************************************************************/
+void RIFF::HintRead(uint32_t Bytes)
+{
+    uint64_t Pos;
+    uint64_t From;
+    uint64_t To;
+
+    Pos=HintChunkEnd-DataLeft;
+    HintChunkRead=true;
+
+    /* Keep the OS a window ahead of us */
+    if(HintedTo<HintChunkEnd && Pos+Bytes+HintWindow/2>HintedTo)
+    {
+        From=HintedTo;
+        if(From<Pos)
+            From=Pos;
+        To=Pos+Bytes+HintWindow;
+        if(To>HintChunkEnd)
+            To=HintChunkEnd;
+        IO->Advise(From,To-From,e_RIFFIOAdvice_WillNeed);
+        HintedTo=To;
+    }
+
+    /* Drop what we are done with */
+    if(Pos-DroppedTo>=HintWindow)
+    {
+        IO->Advise(DroppedTo,Pos-DroppedTo,e_RIFFIOAdvice_DontNeed);
+        DroppedTo=Pos;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::TraceStart
+ *
+ * SYNOPSIS:
+ *    void RIFF::TraceStart(e_RIFFTraceEventType Type,const char *ChunkID,
+ *              uint64_t Offset,uint32_t Size);
+ *
+ * PARAMETERS:
+ *    Type [I] -- e_RIFFTrace_ChunkStart or e_RIFFTrace_GroupStart
+ *    ChunkID [I] -- The ID of the chunk / group
+ *    Offset [I] -- Where the data for the chunk starts in the file
+ *    Size [I] -- The size of the chunk (0 if we don't know it yet)
+ *
+ * FUNCTION:
+ *    This function fills in 'TraceChunk' for a chunk or group that is
+ *    starting and sends it to the trace handler.  The chunk is left open
+ *    until TraceChunkDone() is called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetTraceHandler()
+ ******************************************************************************/
+void RIFF::TraceStart(e_RIFFTraceEventType Type,const char *ChunkID,
+        uint64_t Offset,uint32_t Size)
+{
+    TraceChunk.Type=Type;
+    TraceChunk.Writing=!Opened4Read;
+    memcpy(TraceChunk.ChunkID,ChunkID,4);
+    TraceChunk.ChunkID[4]=0;
+    TraceChunk.Offset=Offset;
+    TraceChunk.Size=Size;
+    TraceChunk.Depth=TraceGroups.size();
+    TraceChunk.StartTime=RIFF_TraceNow();
+    TraceChunk.EndTime=0;
+    TraceChunkOpen=true;
+
+    TraceSend(&TraceChunk);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::TraceChunkDone
+ *
+ * SYNOPSIS:
+ *    void RIFF::TraceChunkDone(uint32_t Size);
+ *
+ * PARAMETERS:
+ *    Size [I] -- The final size of the chunk when writing (ignored when
+ *                reading)
+ *
+ * FUNCTION:
+ *    This function sends the end event for the open chunk (if there is one)
+ *    to the trace handler.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::TraceStart(), RIFF::TraceGroupDone()
+ ******************************************************************************/
+void RIFF::TraceChunkDone(uint32_t Size)
+{
+    if(!TraceChunkOpen)
+        return;
+    TraceChunkOpen=false;
+
+    if(TraceChunk.Type==e_RIFFTrace_GroupStart)
+        TraceChunk.Type=e_RIFFTrace_GroupEnd;
+    else
+        TraceChunk.Type=e_RIFFTrace_ChunkEnd;
+    if(TraceChunk.Writing)
+        TraceChunk.Size=Size;
+    TraceChunk.EndTime=RIFF_TraceNow();
+
+    TraceSend(&TraceChunk);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::TraceGroupDone
+ *
+ * SYNOPSIS:
+ *    void RIFF::TraceGroupDone(uint32_t Size);
+ *
+ * PARAMETERS:
+ *    Size [I] -- The final size of the group when writing (ignored when
+ *                reading)
+ *
+ * FUNCTION:
+ *    This function sends the end event for the inner most open group to the
+ *    trace handler.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::TraceStart(), RIFF::TraceChunkDone()
+ ******************************************************************************/
+void RIFF::TraceGroupDone(uint32_t Size)
+{
+    struct RIFFTraceEvent Event;
+
+    if(TraceGroups.empty())
+        return;
+
+    Event=TraceGroups.back();
+    TraceGroups.pop_back();
+
+    Event.Type=e_RIFFTrace_GroupEnd;
+    if(Event.Writing)
+        Event.Size=Size;
+    Event.EndTime=RIFF_TraceNow();
+
+    TraceSend(&Event);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF::TraceSend
+ *
+ * SYNOPSIS:
+ *    void RIFF::TraceSend(const struct RIFFTraceEvent *Event);
+ *
+ * PARAMETERS:
+ *    Event [I] -- The event to send
+ *
+ * FUNCTION:
+ *    This function sends an event to the trace handler.  While a chunk for
+ *    the front of the file is being built (see BeginFront()) we don't know
+ *    where it will end up yet, so the events are held and EndFront() sends
+ *    them with the final offsets.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetTraceHandler(), RIFF::EndFront()
+ ******************************************************************************/
+void RIFF::TraceSend(const struct RIFFTraceEvent *Event)
+{
+    if(FrontIO!=NULL)
+    {
+        FrontTrace.push_back(*Event);
+        return;
+    }
+
+    TraceHandler(Event,TraceUserData);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_TraceNow
+ *
+ * SYNOPSIS:
+ *    static uint64_t RIFF_TraceNow(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the time stamp used for tracing.
+ *
+ * RETURNS:
+ *    A monotonic time in ns.
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+static uint64_t RIFF_TraceNow(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFArena::RIFFArena
+ *
+ * SYNOPSIS:
+ *    RIFFArena::RIFFArena(uint32_t BlockSize=65536);
+ *    RIFFArena::RIFFArena(void *Buffer,uint32_t Size,uint32_t BlockSize=65536);
+ *
+ * PARAMETERS:
+ *    Buffer [I] -- Memory to use before we start to malloc.  This must stay
+ *                  around until the arena is gone.
+ *    Size [I] -- The number of bytes in 'Buffer'
+ *    BlockSize [I] -- How much to malloc at a time when we run out
+ *
+ * FUNCTION:
+ *    This is the constructor for the arena class.  An arena hands out
+ *    memory by bumping a pointer along a big block, and it all gets freed at
+ *    once with Reset().  After a Reset() the same memory is used again so
+ *    if you load the same sort of data over and over there are no more
+ *    mallocs after the first time.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::ReadChunk(), RIFF::ReadGroup()
+ ******************************************************************************/
+RIFFArena::RIFFArena(uint32_t BlockSize)
+{
+    First=NULL;
+    Last=NULL;
+    Current=NULL;
+    External.Mem=NULL;
+    this->BlockSize=BlockSize;
+    Used=0;
+}
+
+RIFFArena::RIFFArena(void *Buffer,uint32_t Size,uint32_t BlockSize)
+{
+    uint32_t Pad;
+
+    /* Everything we hand out is 8 byte aligned */
+    Pad=(8-((uintptr_t)Buffer&7))&7;
+
+    External.Next=NULL;
+    External.Mem=(uint8_t *)Buffer+Pad;
+    External.Size=Size>Pad?Size-Pad:0;
+    External.Used=0;
+    External.Owned=false;
+
+    First=&External;
+    Last=&External;
+    Current=&External;
+    this->BlockSize=BlockSize;
+    Used=0;
+}
+
+RIFFArena::~RIFFArena()
+{
+    Free();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFArena::Alloc
+ *
+ * SYNOPSIS:
+ *    void *RIFFArena::Alloc(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes to get
+ *
+ * FUNCTION:
+ *    This function gets memory from the arena.  There is no way to free it
+ *    other than Reset() / Free().
+ *
+ * RETURNS:
+ *    A pointer to the memory (8 byte aligned).
+ *
+ * NOTES:
+ *    Throws e_RIFFError_OutOfMemory if malloc() fails.
+ *
+ * SEE ALSO:
+ *    RIFFArena::Reset()
+ ******************************************************************************/
+void *RIFFArena::Alloc(uint32_t Bytes)
+{
+    struct RIFFArenaBlock *Block;
+    uint32_t Size;
+    uint8_t *Mem;
+
+    if(Bytes>0xFFFFFFF8)
+        throw(e_RIFFError_OutOfMemory);
+    Bytes=(Bytes+7)&~7;
+
+    /* Find a block with room (these are already allocated from before the
+       last Reset()) */
+    while(Current!=NULL && Current->Size-Current->Used<Bytes)
+        Current=Current->Next;
+
+    if(Current==NULL)
+    {
+        Size=BlockSize;
+        if(Bytes>Size)
+            Size=Bytes;
+
+        Block=(struct RIFFArenaBlock *)malloc(sizeof(struct RIFFArenaBlock)+
+                Size);
+        if(Block==NULL)
+            throw(e_RIFFError_OutOfMemory);
+
+        Block->Next=NULL;
+        Block->Mem=(uint8_t *)(Block+1);
+        Block->Size=Size;
+        Block->Used=0;
+        Block->Owned=true;
+
+        if(Last==NULL)
+            First=Block;
+        else
+            Last->Next=Block;
+        Last=Block;
+        Current=Block;
+    }
+
+    Mem=Current->Mem+Current->Used;
+    Current->Used+=Bytes;
+    Used+=Bytes;
+
+    return Mem;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFArena::Reset
+ *
+ * SYNOPSIS:
+ *    void RIFFArena::Reset(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function frees everything that was allocated from the arena.  The
+ *    memory is kept and used again for the next Alloc()'s.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFArena::Free()
+ ******************************************************************************/
+void RIFFArena::Reset(void)
+{
+    struct RIFFArenaBlock *Block;
+
+    for(Block=First;Block!=NULL;Block=Block->Next)
+        Block->Used=0;
+
+    Current=First;
+    Used=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFArena::Free
+ *
+ * SYNOPSIS:
+ *    void RIFFArena::Free(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function frees everything that was allocated from the arena and
+ *    gives the memory back (other than the buffer passed to the
+ *    constructor).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFArena::Reset()
+ ******************************************************************************/
+void RIFFArena::Free(void)
+{
+    struct RIFFArenaBlock *Block;
+    struct RIFFArenaBlock *Next;
+
+    for(Block=First;Block!=NULL;Block=Next)
+    {
+        Next=Block->Next;
+        if(Block->Owned)
+            free(Block);
+    }
+
+    First=NULL;
+    Last=NULL;
+    if(External.Mem!=NULL)
+    {
+        External.Next=NULL;
+        External.Used=0;
+        First=&External;
+        Last=&External;
+    }
+    Current=First;
+    Used=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFArena::GetUsed
+ *
+ * SYNOPSIS:
+ *    uint64_t RIFFArena::GetUsed(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets how many bytes have been allocated since the last
+ *    Reset().
+ *
+ * RETURNS:
+ *    The number of bytes (rounded up to 8 for each Alloc())
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+uint64_t RIFFArena::GetUsed(void)
+{
+    return Used;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_SwapBytes
+ *
+ * SYNOPSIS:
+ *    void RIFF_SwapBytes(void *Data,unsigned Size,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Data [I/O] -- The values to swap
+ *    Size [I] -- The size of one value in bytes
+ *    Count [I] -- The number of values
+ *
+ * FUNCTION:
+ *    This function reverses the bytes in each value of an array (big endian
+ *    <-> little endian).  2, 4 and 8 byte values are done 16 or 32 bytes at
+ *    a time with SSSE3 / AVX2 (picked when the program runs) or NEON if the
+ *    CPU has them, and whatever is left is done one value at a time.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::ReadArray(), RIFF::WriteArray()
+ ******************************************************************************/
+void RIFF_SwapBytes(void *Data,unsigned Size,uint32_t Count)
+{
+    uint32_t Done;
+
+    if(Size<2)
+        return;
+
+    Done=0;
+    if(Size==2 || Size==4 || Size==8)
+        Done=RIFF_SwapSIMD((uint8_t *)Data,Size,Count);
+
+    RIFF_SwapScalar((uint8_t *)Data+(uint64_t)Done*Size,Size,Count-Done);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_SwapScalar
+ *
+ * SYNOPSIS:
+ *    static void RIFF_SwapScalar(uint8_t *Data,unsigned Size,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Data [I/O] -- The values to swap
+ *    Size [I] -- The size of one value in bytes
+ *    Count [I] -- The number of values
+ *
+ * FUNCTION:
+ *    This function reverses the bytes in each value one value at a time.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF_SwapBytes()
+ ******************************************************************************/
+static void RIFF_SwapScalar(uint8_t *Data,unsigned Size,uint32_t Count)
+{
+    uint8_t Tmp;
+    unsigned a;
+    unsigned b;
+    uint32_t r;
+
+    switch(Size)
+    {
+        case 2:
+            for(r=0;r<Count;r++,Data+=2)
+            {
+                Tmp=Data[0];
+                Data[0]=Data[1];
+                Data[1]=Tmp;
+            }
+        break;
+        case 4:
+            for(r=0;r<Count;r++,Data+=4)
+            {
+                Tmp=Data[0];
+                Data[0]=Data[3];
+                Data[3]=Tmp;
+                Tmp=Data[1];
+                Data[1]=Data[2];
+                Data[2]=Tmp;
+            }
+        break;
+        default:
+            for(r=0;r<Count;r++,Data+=Size)
+            {
+                for(a=0,b=Size-1;a<b;a++,b--)
+                {
+                    Tmp=Data[a];
+                    Data[a]=Data[b];
+                    Data[b]=Tmp;
+                }
+            }
+        break;
+    }
+}
+
+#if RIFF_SWAP_X86
+/* Byte order for _mm_shuffle_epi8() to reverse 2, 4 and 8 byte values */
+static const uint8_t m_SwapMask2[16]={1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14};
+static const uint8_t m_SwapMask4[16]={3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12};
+static const uint8_t m_SwapMask8[16]={7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8};
+
+static const uint8_t *RIFF_SwapMask(unsigned Size)
+{
+    if(Size==2)
+        return m_SwapMask2;
+    if(Size==4)
+        return m_SwapMask4;
+    return m_SwapMask8;
+}
+
+__attribute__((target("ssse3")))
+static uint32_t RIFF_SwapSSSE3(uint8_t *Data,unsigned Size,uint32_t Count)
+{
+    __m128i Mask;
+    __m128i Vec;
+    uint64_t Bytes;
+    uint64_t r;
+
+    Mask=_mm_loadu_si128((const __m128i *)RIFF_SwapMask(Size));
+    Bytes=(uint64_t)Count*Size&~(uint64_t)15;
+    for(r=0;r<Bytes;r+=16)
+    {
+        Vec=_mm_loadu_si128((__m128i *)(Data+r));
+        _mm_storeu_si128((__m128i *)(Data+r),_mm_shuffle_epi8(Vec,Mask));
+    }
+    return Bytes/Size;
+}
+
+__attribute__((target("avx2")))
+static uint32_t RIFF_SwapAVX2(uint8_t *Data,unsigned Size,uint32_t Count)
+{
+    __m256i Mask;
+    __m256i Vec;
+    uint64_t Bytes;
+    uint64_t r;
+
+    /* The AVX2 shuffle works on each 16 byte half on its own */
+    Mask=_mm256_broadcastsi128_si256(_mm_loadu_si128(
+            (const __m128i *)RIFF_SwapMask(Size)));
+    Bytes=(uint64_t)Count*Size&~(uint64_t)31;
+    for(r=0;r<Bytes;r+=32)
+    {
+        Vec=_mm256_loadu_si256((__m256i *)(Data+r));
+        _mm256_storeu_si256((__m256i *)(Data+r),_mm256_shuffle_epi8(Vec,Mask));
+    }
+    return Bytes/Size;
+}
+
+static int RIFF_SwapLevel(void)
+{
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return 2;
+    if(__builtin_cpu_supports("ssse3"))
+        return 1;
+    return 0;
+}
+#endif
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_SwapSIMD
+ *
+ * SYNOPSIS:
+ *    static uint32_t RIFF_SwapSIMD(uint8_t *Data,unsigned Size,
+ *              uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Data [I/O] -- The values to swap
+ *    Size [I] -- The size of one value in bytes (2, 4 or 8)
+ *    Count [I] -- The number of values
+ *
+ * FUNCTION:
+ *    This function reverses the bytes in as many values as it can using
+ *    the vector instructions the CPU has.
+ *
+ * RETURNS:
+ *    The number of values that were swapped (from the start of 'Data').
+ *    The rest need to be done with RIFF_SwapScalar().
+ *
+ * SEE ALSO:
+ *    RIFF_SwapBytes()
+ ******************************************************************************/
+static uint32_t RIFF_SwapSIMD(uint8_t *Data,unsigned Size,uint32_t Count)
+{
+#if RIFF_SWAP_X86
+    static const int Level=RIFF_SwapLevel();
+    uint32_t Done;
+
+    Done=0;
+    if(Level>=2)
+        Done=RIFF_SwapAVX2(Data,Size,Count);
+    if(Level>=1)
+        Done+=RIFF_SwapSSSE3(Data+(uint64_t)Done*Size,Size,Count-Done);
+    return Done;
+#elif RIFF_SWAP_NEON
+    uint8x16_t Vec;
+    uint64_t Bytes;
+    uint64_t r;
+
+    Bytes=(uint64_t)Count*Size&~(uint64_t)15;
+    for(r=0;r<Bytes;r+=16)
+    {
+        Vec=vld1q_u8(Data+r);
+        if(Size==2)
+            Vec=vrev16q_u8(Vec);
+        else if(Size==4)
+            Vec=vrev32q_u8(Vec);
+        else
+            Vec=vrev64q_u8(Vec);
+        vst1q_u8(Data+r,Vec);
+    }
+    return Bytes/Size;
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_CRC32C
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFF_CRC32C(uint32_t CRC,const void *Data,size_t Bytes);
+ *
+ * PARAMETERS:
+ *    CRC [I] -- The CRC so far (0 to start)
+ *    Data [I] -- The bytes to add to the CRC
+ *    Bytes [I] -- The number of bytes in 'Data'
+ *
+ * FUNCTION:
+ *    This function works out a CRC32C (Castagnoli, the same one iSCSI and
+ *    ext4 use).  You can call it a bit at a time by passing in the result
+ *    from the last call.
+ *
+ *    It uses the SSE4.2 crc32 instruction (picked when the program runs) or
+ *    the ARMv8 CRC instructions if the CPU has them, else a table.
+ *
+ * RETURNS:
+ *    The new CRC
+ *
+ * SEE ALSO:
+ *    RIFF::SetChecksums()
+ ******************************************************************************/
+#if RIFF_SWAP_X86 && defined(__x86_64__)
+__attribute__((target("sse4.2")))
+static uint32_t RIFF_CRC32CSSE42(uint32_t CRC,const uint8_t *Data,size_t Bytes)
+{
+    uint64_t CRC64;
+    uint64_t Value;
+
+    while(Bytes>0 && ((uintptr_t)Data&7)!=0)
+    {
+        CRC=_mm_crc32_u8(CRC,*Data++);
+        Bytes--;
+    }
+
+    CRC64=CRC;
+    while(Bytes>=8)
+    {
+        memcpy(&Value,Data,8);
+        CRC64=_mm_crc32_u64(CRC64,Value);
+        Data+=8;
+        Bytes-=8;
+    }
+    CRC=(uint32_t)CRC64;
+
+    while(Bytes>0)
+    {
+        CRC=_mm_crc32_u8(CRC,*Data++);
+        Bytes--;
+    }
+    return CRC;
+}
+#endif
+
+uint32_t RIFF_CRC32C(uint32_t CRC,const void *Data,size_t Bytes)
+{
+    const uint8_t *Pos;
+
+    Pos=(const uint8_t *)Data;
+    CRC=~CRC;
+
+#if RIFF_SWAP_X86 && defined(__x86_64__)
+    static const bool HaveSSE42=__builtin_cpu_supports("sse4.2");
+    if(HaveSSE42)
+        return ~RIFF_CRC32CSSE42(CRC,Pos,Bytes);
+#elif defined(__ARM_FEATURE_CRC32)
+    uint64_t Value;
+
+    while(Bytes>=8)
+    {
+        memcpy(&Value,Pos,8);
+        CRC=__crc32cd(CRC,Value);
+        Pos+=8;
+        Bytes-=8;
+    }
+    while(Bytes>0)
+    {
+        CRC=__crc32cb(CRC,*Pos++);
+        Bytes--;
+    }
+    return ~CRC;
+#endif
+
+    return ~RIFF_CRC32CScalar(CRC,Pos,Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_CRC32CScalar
+ *
+ * SYNOPSIS:
+ *    static uint32_t RIFF_CRC32CScalar(uint32_t CRC,const uint8_t *Data,
+ *              size_t Bytes);
+ *
+ * PARAMETERS:
+ *    CRC [I] -- The CRC so far (already inverted)
+ *    Data [I] -- The bytes to add to the CRC
+ *    Bytes [I] -- The number of bytes in 'Data'
+ *
+ * FUNCTION:
+ *    This function does the CRC32C with tables 8 bytes at a time (slicing by
+ *    8) for CPU's without CRC instructions.  The tables are built the first
+ *    time through (safe with the worker pool calling this from many
+ *    threads at once).
+ *
+ * RETURNS:
+ *    The new CRC (still inverted)
+ *
+ * SEE ALSO:
+ *    RIFF_CRC32C()
+ ******************************************************************************/
+struct RIFFCRC32CTables
+{
+    uint32_t Table[8][256];
+
+    RIFFCRC32CTables()
+    {
+        uint32_t Value;
+        unsigned r;
+        unsigned b;
+
+        for(r=0;r<256;r++)
+        {
+            Value=r;
+            for(b=0;b<8;b++)
+                Value=(Value>>1)^(0x82F63B78&(0-(Value&1)));
+            Table[0][r]=Value;
+        }
+        for(r=0;r<256;r++)
+            for(b=1;b<8;b++)
+                Table[b][r]=(Table[b-1][r]>>8)^Table[0][Table[b-1][r]&0xFF];
+    }
+};
+
+static uint32_t RIFF_CRC32CScalar(uint32_t CRC,const uint8_t *Data,
+        size_t Bytes)
+{
+    /* Built once by the first caller, the compiler locks this for threads */
+    static const struct RIFFCRC32CTables Tables;
+    const uint32_t (*Table)[256]=Tables.Table;
+
+    while(Bytes>=8)
+    {
+        CRC^=Data[0] | Data[1]<<8 | Data[2]<<16 | (uint32_t)Data[3]<<24;
+        CRC=Table[7][CRC&0xFF]^Table[6][(CRC>>8)&0xFF]^
+                Table[5][(CRC>>16)&0xFF]^Table[4][CRC>>24]^
+                Table[3][Data[4]]^Table[2][Data[5]]^Table[1][Data[6]]^
+                Table[0][Data[7]];
+        Data+=8;
+        Bytes-=8;
+    }
+    while(Bytes>0)
+    {
+        CRC=(CRC>>8)^Table[0][(CRC^*Data++)&0xFF];
+        Bytes--;
+    }
+    return CRC;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_CRC32CCombine
+ *
+ * SYNOPSIS:
+ *    static uint32_t RIFF_CRC32CCombine(uint32_t CRC1,uint32_t CRC2,
+ *              uint32_t Bytes2);
+ *
+ * PARAMETERS:
+ *    CRC1 [I] -- The CRC of the first part of the data
+ *    CRC2 [I] -- The CRC of the second part of the data
+ *    Bytes2 [I] -- The number of bytes in the second part
+ *
+ * FUNCTION:
+ *    This function works out the CRC of 2 bits of data one after the other
+ *    from the CRC's of each bit (the same way zlib's crc32_combine() does).
+ *    This lets us CRC data before we know what goes in front of it.
+ *
+ * RETURNS:
+ *    The CRC of both parts
+ *
+ * SEE ALSO:
+ *    RIFF_CRC32C()
+ ******************************************************************************/
+static uint32_t RIFF_GF2Times(const uint32_t *Matrix,uint32_t Vector)
+{
+    uint32_t Sum;
+
+    Sum=0;
+    while(Vector!=0)
+    {
+        if(Vector&1)
+            Sum^=*Matrix;
+        Vector>>=1;
+        Matrix++;
+    }
+    return Sum;
+}
+
+static void RIFF_GF2Square(uint32_t *Square,const uint32_t *Matrix)
+{
+    unsigned r;
+
+    for(r=0;r<32;r++)
+        Square[r]=RIFF_GF2Times(Matrix,Matrix[r]);
+}
+
+static uint32_t RIFF_CRC32CCombine(uint32_t CRC1,uint32_t CRC2,
+        uint32_t Bytes2)
+{
+    uint32_t Even[32];
+    uint32_t Odd[32];
+    uint32_t Row;
+    unsigned r;
+
+    if(Bytes2==0)
+        return CRC1;
+
+    /* Odd is the operator for 1 zero bit */
+    Odd[0]=0x82F63B78;
+    Row=1;
+    for(r=1;r<32;r++)
+    {
+        Odd[r]=Row;
+        Row<<=1;
+    }
+
+    /* 2 zero bits, then 4 */
+    RIFF_GF2Square(Even,Odd);
+    RIFF_GF2Square(Odd,Even);
+
+    /* Add 'Bytes2' zero bytes to CRC1 */
+    do
+    {
+        RIFF_GF2Square(Even,Odd);
+        if(Bytes2&1)
+            CRC1=RIFF_GF2Times(Even,CRC1);
+        Bytes2>>=1;
+        if(Bytes2==0)
+            break;
+
+        RIFF_GF2Square(Odd,Even);
+        if(Bytes2&1)
+            CRC1=RIFF_GF2Times(Odd,CRC1);
+        Bytes2>>=1;
+    } while(Bytes2!=0);
+
+    return CRC1^CRC2;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_CompressSupported
+ *
+ * SYNOPSIS:
+ *    static bool RIFF_CompressSupported(e_RIFFCompressType Type);
+ *
+ * PARAMETERS:
+ *    Type [I] -- The compression type to check
+ *
+ * FUNCTION:
+ *    This function checks if a compression type was built in.
+ *
+ * RETURNS:
+ *    true -- We can use this type
+ *    false -- It wasn't built in (or isn't a type we know)
+ *
+ * SEE ALSO:
+ *    RIFF::StartDataBlock()
+ ******************************************************************************/
+static bool RIFF_CompressSupported(e_RIFFCompressType Type)
+{
+    switch(Type)
+    {
+        case e_RIFFCompress_None:
+        case e_RIFFCompress_LZ:
+            return true;
+        case e_RIFFCompress_Zlib:
+#ifdef RIFF_USE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case e_RIFFCompress_Zstd:
+#ifdef RIFF_USE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFF_PackBound
+ *
+ * SYNOPSIS:
+ *    static uint32_t RIFF_PackBound(e_RIFFCompressType Type,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Type [I] -- The compression type
+ *    Bytes [I] -- The number of bytes to compress
  *
  * FUNCTION:
- *    This function will create a new file and add the headers to the open of
- *    it.
+ *    This function gets the biggest 'Bytes' bytes can get when compressed.
  *
  * RETURNS:
- *    NONE
+ *    The size the buffer to compress into must be.
  *
  * SEE ALSO:
- *    
+ *    RIFF_Pack()
  ******************************************************************************/
-void RIFF::OpenWrite(const char *Filename,const char *FormType)
+static uint32_t RIFF_PackBound(e_RIFFCompressType Type,uint32_t Bytes)
 {
-    const char *FORMName;
-
-    if(strlen(FormType)!=4)
-        throw(e_RIFFError_InternalError_BadChunkIDSize);
-
-    FileHandle=fopen(Filename,"wb");
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FailedToOpenFile);
-
-    FORMName="RIFF";
-    if(IFFMode)
-        FORMName="FORM";
-    fwrite(FORMName,4,1,FileHandle);
-    TotalFileSize=0;
-    WriteSize(TotalFileSize);
-    if(fwrite(FormType,4,1,FileHandle)!=1)
-        throw(e_RIFFError_WriteError);
-
-    TotalFileSize=4;    // The FormType counts
-    CurrentChunkSize=0;
-    CurrentListSize=0;
-
-    Opened4Read=false;
+    switch(Type)
+    {
+#ifdef RIFF_USE_ZLIB
+        case e_RIFFCompress_Zlib:
+            return compressBound(Bytes);
+#endif
+#ifdef RIFF_USE_ZSTD
+        case e_RIFFCompress_Zstd:
+            return ZSTD_compressBound(Bytes);
+#endif
+        default:
+            break;
+    }
+    return Bytes+Bytes/255+16;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::CloseWrite
+ *    RIFF_Pack
  *
  * SYNOPSIS:
- *    void RIFF::CloseWrite(void);
+ *    static uint32_t RIFF_Pack(e_RIFFCompressType Type,const uint8_t *Src,
+ *              uint32_t SrcBytes,uint8_t *Dest,uint32_t DestSize);
  *
  * PARAMETERS:
- *    NONE
+ *    Type [I] -- The compression type to use
+ *    Src [I] -- The data to compress
+ *    SrcBytes [I] -- The number of bytes in 'Src'
+ *    Dest [O] -- Where to put the compressed data
+ *    DestSize [I] -- The size of 'Dest'
  *
  * FUNCTION:
- *    This function closes the file opened with OpenWrite().  It finalizes
- *    the file.
+ *    This function compresses one block.
  *
  * RETURNS:
- *    NONE
+ *    The number of bytes put in 'Dest' or 0 if it didn't fit.
  *
  * SEE ALSO:
- *    
+ *    RIFF_Unpack()
  ******************************************************************************/
-void RIFF::CloseWrite(void)
+static uint32_t RIFF_Pack(e_RIFFCompressType Type,const uint8_t *Src,
+        uint32_t SrcBytes,uint8_t *Dest,uint32_t DestSize)
 {
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
-
-    fseek(FileHandle,4,SEEK_SET);
-    WriteSize(TotalFileSize);
+#ifdef RIFF_USE_ZLIB
+    uLongf ZDestSize;
+#endif
+#ifdef RIFF_USE_ZSTD
+    size_t Result;
+#endif
 
-    fclose(FileHandle);
-    FileHandle=NULL;
+    switch(Type)
+    {
+        case e_RIFFCompress_LZ:
+            return RIFF_LZPack(Src,SrcBytes,Dest,DestSize);
+#ifdef RIFF_USE_ZLIB
+        case e_RIFFCompress_Zlib:
+            ZDestSize=DestSize;
+            if(compress2(Dest,&ZDestSize,Src,SrcBytes,Z_DEFAULT_COMPRESSION)!=
+                    Z_OK)
+            {
+                return 0;
+            }
+            return ZDestSize;
+#endif
+#ifdef RIFF_USE_ZSTD
+        case e_RIFFCompress_Zstd:
+            Result=ZSTD_compress(Dest,DestSize,Src,SrcBytes,ZSTD_LEVEL);
+            if(ZSTD_isError(Result))
+                return 0;
+            return Result;
+#endif
+        default:
+            break;
+    }
+    return 0;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::StartDataBlock
+ *    RIFF_Unpack
  *
  * SYNOPSIS:
- *    void RIFF::StartDataBlock(const char *ChunkID);
+ *    static bool RIFF_Unpack(e_RIFFCompressType Type,const uint8_t *Src,
+ *              uint32_t SrcBytes,uint8_t *Dest,uint32_t DestBytes);
  *
  * PARAMETERS:
- *    ChunkID [I] -- The ID of the data block to start. This is an identifier
- *                   used to find this data when reading the file back in.
- *                   This must be 4 letters long and be in the AscII
- *                   range of [a-z][A-Z][0-9] and space.  Only the length is
- *                   checked.
+ *    Type [I] -- The compression type used
+ *    Src [I] -- The compressed data
+ *    SrcBytes [I] -- The number of bytes in 'Src'
+ *    Dest [O] -- Where to put the uncompressed data
+ *    DestBytes [I] -- The number of bytes it should uncompress to
  *
  * FUNCTION:
- *    This function starts a new block of data when writing a file.  This
- *    will work out to an IFF chunk.
+ *    This function uncompresses one block.
  *
  * RETURNS:
- *    NONE
+ *    true -- 'Dest' has been filled in
+ *    false -- The data was bad (or didn't come out to 'DestBytes')
  *
  * SEE ALSO:
- *    
+ *    RIFF_Pack()
  ******************************************************************************/
-void RIFF::StartDataBlock(const char *ChunkID)
+static bool RIFF_Unpack(e_RIFFCompressType Type,const uint8_t *Src,
+        uint32_t SrcBytes,uint8_t *Dest,uint32_t DestBytes)
 {
-    uint32_t ChunkSize;
-    uint32_t ChunkStart;
-
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
-
-    if(strlen(ChunkID)!=4)
-        throw(e_RIFFError_InternalError_BadChunkIDSize);
-
-    fwrite(ChunkID,4,1,FileHandle);
+#ifdef RIFF_USE_ZLIB
+    uLongf ZDestBytes;
+#endif
 
-    ChunkStart=ftell(FileHandle);
-    ChunkSize=0;
-    WriteSize(ChunkSize);
-
-    SavedChuckOffset=ChunkStart;
-    SavedChuckSize=CurrentChunkSize;
-
-    CurrentChunkSize=0;
-    TotalFileSize+=4+4;
-    if(!ListSizes.empty())
-        CurrentListSize+=4+4;
+    switch(Type)
+    {
+        case e_RIFFCompress_LZ:
+            return RIFF_LZUnpack(Src,SrcBytes,Dest,DestBytes);
+#ifdef RIFF_USE_ZLIB
+        case e_RIFFCompress_Zlib:
+            ZDestBytes=DestBytes;
+            return uncompress(Dest,&ZDestBytes,Src,SrcBytes)==Z_OK &&
+                    ZDestBytes==DestBytes;
+#endif
+#ifdef RIFF_USE_ZSTD
+        case e_RIFFCompress_Zstd:
+            return ZSTD_decompress(Dest,DestBytes,Src,SrcBytes)==DestBytes;
+#endif
+        default:
+            break;
+    }
+    return false;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::EndDataBlock
+ *    RIFF_ParsePackHeader
  *
  * SYNOPSIS:
- *    void RIFF::EndDataBlock(void);
+ *    static void RIFF_ParsePackHeader(const uint8_t *Header,uint32_t RawSize,
+ *              bool IFF,uint32_t *Fields);
  *
  * PARAMETERS:
- *    NONE
+ *    Header [I] -- The RIFF_PACK_HEADER_SIZE bytes at the start of a "CMPR"
+ *                  chunk
+ *    RawSize [I] -- The size of the "CMPR" chunk (from its chunk header)
+ *    IFF [I] -- true if the file is IFF (big endian)
+ *    Fields [O] -- The 4 numbers after the chunk ID (compression type, block
+ *                  size, uncompressed size, index offset).  See
+ *                  RIFF::StartDataBlock() for the format.
  *
  * FUNCTION:
- *    When writing a file this function closes the data block opened with
- *    StartDataBlock().  It will write the size of the data to the correct
- *    place in the file.
+ *    This function pulls the numbers out of a compressed chunk header and
+ *    checks they make sense for a chunk of 'RawSize' bytes.
  *
  * RETURNS:
  *    NONE
  *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the header is bad (or
+ *    e_RIFFError_UnsupportedCompression if it says it isn't compressed).  It
+ *    doesn't check if the compression type is built in.
+ *
  * SEE ALSO:
- *    
+ *    RIFF_ReadPackHeader(), RIFF::StartDecompress()
  ******************************************************************************/
-void RIFF::EndDataBlock(void)
+static void RIFF_ParsePackHeader(const uint8_t *Header,uint32_t RawSize,
+        bool IFF,uint32_t *Fields)
 {
-    uint32_t ChunkOffset;
-    uint32_t ClosingChunkSize;
-    uint32_t TotalByteSizeOfChunk;
+    uint32_t Blocks;
 
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
-
-    ClosingChunkSize=CurrentChunkSize;
-    TotalByteSizeOfChunk=ClosingChunkSize;
+    memcpy(Fields,&Header[4],4*4);
+    if(IFF!=RIFF_HOST_BIG_ENDIAN)
+        RIFF_SwapBytes(Fields,4,4);
 
-    ChunkOffset=SavedChuckOffset;
+    if(Fields[0]==e_RIFFCompress_None)
+        throw(e_RIFFError_UnsupportedCompression);
 
-    /* Write the size of the closeing chunk */
-    fseek(FileHandle,ChunkOffset,SEEK_SET);
-    WriteSize(ClosingChunkSize);
-    fseek(FileHandle,0,SEEK_END);
+    if(Fields[1]==0 || Fields[1]>MAX_COMPRESS_BLOCK_SIZE)
+        throw(e_RIFFError_BadFormat);
 
-    /* Pad if needed */
-    if(ClosingChunkSize&1)
+    Blocks=Fields[2]/Fields[1]+(Fields[2]%Fields[1]!=0);
+    if(Fields[3]<RIFF_PACK_HEADER_SIZE || Fields[3]>RawSize ||
+            Blocks>(RawSize-Fields[3])/4)
     {
-        uint8_t ZeroPadding;
-
-        ZeroPadding=0;
-        fwrite(&ZeroPadding,1,1,FileHandle);
-        TotalFileSize++;
-        TotalByteSizeOfChunk++; // Add to the amount of the new chunk
-        if(!ListSizes.empty())
-            CurrentListSize+=1;
+        throw(e_RIFFError_BadFormat);
     }
-
-    CurrentChunkSize=SavedChuckSize;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::Write
+ *    RIFF_ReadPackHeader
  *
  * SYNOPSIS:
- *    void RIFF::Write(const void *Data,uint32_t Bytes);
+ *    void RIFF_ReadPackHeader(const uint8_t *Header,uint32_t RawSize,bool IFF,
+ *              char *ChunkID,uint32_t *Size);
  *
  * PARAMETERS:
- *    Data [I] -- The binary data to write to the open chunk.
- *    Bytes [I] -- The number of bytes to write to the chunk.
+ *    Header [I] -- The RIFF_PACK_HEADER_SIZE bytes at the start of a "CMPR"
+ *                  chunk
+ *    RawSize [I] -- The size of the "CMPR" chunk (from its chunk header)
+ *    IFF [I] -- true if the file is IFF (big endian)
+ *    ChunkID [O] -- The real chunk ID (4 bytes, not terminated)
+ *    Size [O] -- The uncompressed size of the chunk
  *
  * FUNCTION:
- *    This function writes bytes to the open chunk.  You can call this as
- *    many times as you would like inside the chunk and it will append the
- *    data to the open chunk.
+ *    This function gets the real chunk ID and size of a compressed data
+ *    block from its header.  This is for code that walks the file itself
+ *    (like RIFFTree) instead of using ReadNextDataBlock().
  *
  * RETURNS:
  *    NONE
  *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the header is bad.  The compression
+ *    type doesn't have to be built in (the data isn't looked at).
+ *
  * SEE ALSO:
- *    
+ *    RIFF_UnpackChunk()
  ******************************************************************************/
-void RIFF::Write(const void *Data,uint32_t Bytes)
+void RIFF_ReadPackHeader(const uint8_t *Header,uint32_t RawSize,bool IFF,
+        char *ChunkID,uint32_t *Size)
 {
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
+    uint32_t Fields[4];
 
-    if(Bytes>0 && fwrite(Data,Bytes,1,FileHandle)!=1)
-        throw(e_RIFFError_WriteError);
+    if(RawSize<RIFF_PACK_HEADER_SIZE)
+        throw(e_RIFFError_BadFormat);
 
-    TotalFileSize+=Bytes;
-    CurrentChunkSize+=Bytes;
-    if(!ListSizes.empty())
-        CurrentListSize+=Bytes;
+    RIFF_ParsePackHeader(Header,RawSize,IFF,Fields);
+
+    memcpy(ChunkID,Header,4);
+    *Size=Fields[2];
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::StartGroup
+ *    RIFF_UnpackChunk
  *
  * SYNOPSIS:
- *    void RIFF::StartGroup(const char *ListID);
+ *    void RIFF_UnpackChunk(const uint8_t *Raw,uint32_t RawSize,bool IFF,
+ *              uint8_t *Dest,uint32_t DestSize);
  *
  * PARAMETERS:
- *    ListID [I] -- The ID of the group to start.  This is the ID used to
- *                  identify this group of data blocks when reading.
- *                  This must be 4 letters long and be in the AscII range
- *                  of [a-z][A-Z][0-9] and space.  Only the length is checked.
+ *    Raw [I] -- All the data of a "CMPR" chunk (with the header)
+ *    RawSize [I] -- The number of bytes in 'Raw'
+ *    IFF [I] -- true if the file is IFF (big endian)
+ *    Dest [O] -- Where to put the uncompressed data
+ *    DestSize [I] -- The uncompressed size (from RIFF_ReadPackHeader())
  *
  * FUNCTION:
- *    This function starts group of data blocks.  Groups let you put data
- *    blocks inside of other data blocks.  You can place groups inside of
- *    other groups.
- *
- *    This works out to an IFF LIST chunk.
+ *    This function uncompresses a whole compressed data block that has
+ *    already been read into memory.
  *
  * RETURNS:
  *    NONE
  *
  * NOTES:
- *    You must call EndGroup() to end the group.
+ *    Throws e_RIFFError_BadFormat if the data is bad or
+ *    e_RIFFError_UnsupportedCompression if it was compressed with something
+ *    that isn't built in.
  *
  * SEE ALSO:
- *    EndGroup()
+ *    RIFF_ReadPackHeader()
  ******************************************************************************/
-void RIFF::StartGroup(const char *ListID)
+void RIFF_UnpackChunk(const uint8_t *Raw,uint32_t RawSize,bool IFF,
+        uint8_t *Dest,uint32_t DestSize)
 {
-    uint32_t ListSize;
-    uint32_t ListStart;
-
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
+    uint32_t Fields[4];
+    uint32_t Pos;
+    uint32_t Done;
+    uint32_t Expected;
+    uint32_t Stored;
 
-    if(strlen(ListID)!=4)
-        throw(e_RIFFError_InternalError_BadChunkIDSize);
+    if(RawSize<RIFF_PACK_HEADER_SIZE)
+        throw(e_RIFFError_BadFormat);
 
-    fwrite("LIST",4,1,FileHandle);
-    ListStart=ftell(FileHandle);
-    ListSize=0;
-    WriteSize(ListSize);
-    fwrite(ListID,4,1,FileHandle);
+    RIFF_ParsePackHeader(Raw,RawSize,IFF,Fields);
+    if(!RIFF_CompressSupported((e_RIFFCompressType)Fields[0]))
+        throw(e_RIFFError_UnsupportedCompression);
+    if(Fields[2]!=DestSize)
+        throw(e_RIFFError_BadFormat);
 
-    ListOffsets.push(ListStart);
-    ListSizes.push(CurrentListSize);
+    /* The blocks run from the header to the index */
+    Pos=RIFF_PACK_HEADER_SIZE;
+    for(Done=0;Done<DestSize;Done+=Expected)
+    {
+        Expected=DestSize-Done;
+        if(Expected>Fields[1])
+            Expected=Fields[1];
 
-    CurrentListSize=0;          // Reset the current list block size
+        if(Fields[3]-Pos<4)
+            throw(e_RIFFError_BadFormat);
+        memcpy(&Stored,&Raw[Pos],4);
+        if(IFF!=RIFF_HOST_BIG_ENDIAN)
+            RIFF_SwapBytes(&Stored,4,1);
+        Pos+=4;
 
-    CurrentListSize+=4;         // Add in ListID
-    TotalFileSize+=4+4+4;       // Add in 'LIST' + Size + ListID
+        if(Stored&PACK_STORED_FLAG)
+        {
+            Stored&=~PACK_STORED_FLAG;
+            if(Stored!=Expected || Stored>Fields[3]-Pos)
+                throw(e_RIFFError_BadFormat);
+            memcpy(&Dest[Done],&Raw[Pos],Stored);
+        }
+        else
+        {
+            if(Stored>Fields[3]-Pos || !RIFF_Unpack(
+                    (e_RIFFCompressType)Fields[0],&Raw[Pos],Stored,
+                    &Dest[Done],Expected))
+            {
+                throw(e_RIFFError_BadFormat);
+            }
+        }
+        Pos+=Stored;
+    }
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::EndGroup
+ *    RIFF_LZPack
  *
  * SYNOPSIS:
- *    void RIFF::EndGroup(void);
+ *    static uint32_t RIFF_LZPack(const uint8_t *Src,uint32_t SrcBytes,
+ *              uint8_t *Dest,uint32_t DestSize);
  *
  * PARAMETERS:
- *    NONE
+ *    Src [I] -- The data to compress
+ *    SrcBytes [I] -- The number of bytes in 'Src'
+ *    Dest [O] -- Where to put the compressed data
+ *    DestSize [I] -- The size of 'Dest'
  *
  * FUNCTION:
- *    This ends the current group started with StartGroup().
+ *    This function is the built in LZ codec.  It is a simple LZ77 (like
+ *    LZ4) that is built for speed more than size.  The data is a list of:
+ *      uint8_t Token -- Top 4 bits: number of literals, Bottom 4 bits:
+ *                       match length - 4.  15 means more bytes follow
+ *                       (added up until one isn't 255).
+ *      [More literal length bytes]
+ *      uint8_t Literals[]
+ *      uint16_t Offset -- Little endian, how far back the match is
+ *      [More match length bytes]
+ *    The last one stops after the literals.
  *
  * RETURNS:
- *    NONE
+ *    The number of bytes put in 'Dest' or 0 if it didn't fit.
  *
  * SEE ALSO:
- *    StartGroup()
+ *    RIFF_LZUnpack()
  ******************************************************************************/
-void RIFF::EndGroup(void)
+static uint32_t RIFF_LZPack(const uint8_t *Src,uint32_t SrcBytes,
+        uint8_t *Dest,uint32_t DestSize)
 {
-    uint32_t ListOffset;
-    uint32_t ClosingListSize;
+    uint32_t Table[1<<LZ_HASH_BITS];
+    uint8_t *Out;
+    uint8_t *OutEnd;
+    uint8_t *Token;
+    uint32_t Pos;
+    uint32_t Anchor;
+    uint32_t Match;
+    uint32_t Len;
+    uint32_t Literals;
+    uint32_t Seq;
+    uint32_t MatchSeq;
+    uint32_t Hash;
+    uint32_t Left;
 
-    if(FileHandle==NULL)
-        throw(e_RIFFError_FileNotOpen);
+    memset(Table,0x00,sizeof(Table));
+    Out=Dest;
+    OutEnd=Dest+DestSize;
+    Pos=0;
+    Anchor=0;
 
-    ClosingListSize=CurrentListSize;
+    for(;;)
+    {
+        /* Find the next match */
+        Match=0;
+        Len=0;
+        while(Pos+LZ_MIN_MATCH<=SrcBytes)
+        {
+            memcpy(&Seq,&Src[Pos],4);
+            Hash=(Seq*2654435761U)>>(32-LZ_HASH_BITS);
+            Match=Table[Hash];
+            Table[Hash]=Pos;
+            if(Match<Pos && Pos-Match<=LZ_MAX_OFFSET)
+            {
+                memcpy(&MatchSeq,&Src[Match],4);
+                if(MatchSeq==Seq)
+                {
+                    Len=LZ_MIN_MATCH;
+                    while(Pos+Len<SrcBytes && Src[Match+Len]==Src[Pos+Len])
+                        Len++;
+                    break;
+                }
+            }
+            Pos++;
+        }
+        if(Len==0)
+            Pos=SrcBytes;
 
-    ListOffset=ListOffsets.top();
-    ListOffsets.pop();
+        /* Token + literals + offset + lengths */
+        Literals=Pos-Anchor;
+        if((uint32_t)(OutEnd-Out)<1+Literals/255+1+Literals+2+Len/255+1)
+            return 0;
 
-    /* Write the size of the closeing chunk */
-    fseek(FileHandle,ListOffset,SEEK_SET);
-    WriteSize(ClosingListSize);
-    fseek(FileHandle,0,SEEK_END);
+        Token=Out++;
+        if(Literals>=15)
+        {
+            *Token=15<<4;
+            for(Left=Literals-15;Left>=255;Left-=255)
+                *Out++=255;
+            *Out++=Left;
+        }
+        else
+        {
+            *Token=Literals<<4;
+        }
+        memcpy(Out,&Src[Anchor],Literals);
+        Out+=Literals;
 
-    /* Pad if needed */
-    if(ClosingListSize&1)
-    {
-        uint8_t ZeroPadding;
+        if(Len==0)
+            break;
 
-        ZeroPadding=0;
-        fwrite(&ZeroPadding,1,1,FileHandle);
-        TotalFileSize++;
-        CurrentListSize++;  // Add this to the size of the current list
+        *Out++=(Pos-Match)&0xFF;
+        *Out++=(Pos-Match)>>8;
+        if(Len-LZ_MIN_MATCH>=15)
+        {
+            *Token|=15;
+            for(Left=Len-LZ_MIN_MATCH-15;Left>=255;Left-=255)
+                *Out++=255;
+            *Out++=Left;
+        }
+        else
+        {
+            *Token|=Len-LZ_MIN_MATCH;
+        }
+
+        Pos+=Len;
+        Anchor=Pos;
     }
 
-    /* Move back up 1 level in the list */
-    /* Pop where we where then add in the block we just wrote, and add in
-       'LIST' and size */
-    CurrentListSize=ListSizes.top()+CurrentListSize+4+4;
-    ListSizes.pop();
+    return Out-Dest;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::ReadSize
+ *    RIFF_LZUnpack
  *
  * SYNOPSIS:
- *    uint32_t RIFF::ReadSize(void);
+ *    static bool RIFF_LZUnpack(const uint8_t *Src,uint32_t SrcBytes,
+ *              uint8_t *Dest,uint32_t DestBytes);
  *
  * PARAMETERS:
- *    NONE
+ *    Src [I] -- The compressed data
+ *    SrcBytes [I] -- The number of bytes in 'Src'
+ *    Dest [O] -- Where to put the uncompressed data
+ *    DestBytes [I] -- The number of bytes it should uncompress to
  *
  * FUNCTION:
- *    This function reads a 32bit var from the file and converts it
- *    from IFF or RIFF as needed.
+ *    This function uncompresses data from RIFF_LZPack().  Everything is
+ *    checked so bad data can't write outside of 'Dest'.
  *
  * RETURNS:
- *    The read value.
+ *    true -- 'Dest' has been filled in
+ *    false -- The data was bad
  *
  * SEE ALSO:
- *    
+ *    RIFF_LZPack()
  ******************************************************************************/
-uint32_t RIFF::ReadSize(void)
+static bool RIFF_LZUnpack(const uint8_t *Src,uint32_t SrcBytes,uint8_t *Dest,
+        uint32_t DestBytes)
 {
-    uint8_t SizeBuff[4];
-    uint32_t Var;
+    const uint8_t *In;
+    const uint8_t *InEnd;
+    uint8_t *Out;
+    uint8_t *OutEnd;
+    const uint8_t *From;
+    uint32_t Literals;
+    uint32_t Len;
+    uint32_t Offset;
+    uint8_t Token;
+    uint8_t More;
 
-    if(fread(SizeBuff,4,1,FileHandle)!=1)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_ReadError);
-    }
+    In=Src;
+    InEnd=Src+SrcBytes;
+    Out=Dest;
+    OutEnd=Dest+DestBytes;
 
-    if(IFFMode)
-    {
-        Var =SizeBuff[3]<<0;
-        Var|=SizeBuff[2]<<8;
-        Var|=SizeBuff[1]<<16;
-        Var|=SizeBuff[0]<<24;
-    }
-    else
+    while(In<InEnd)
     {
-        Var =SizeBuff[0]<<0;
-        Var|=SizeBuff[1]<<8;
-        Var|=SizeBuff[2]<<16;
-        Var|=SizeBuff[3]<<24;
+        Token=*In++;
+
+        Literals=Token>>4;
+        if(Literals==15)
+        {
+            do
+            {
+                if(In>=InEnd)
+                    return false;
+                More=*In++;
+                Literals+=More;
+            } while(More==255);
+        }
+        if(Literals>(uint32_t)(InEnd-In) || Literals>(uint32_t)(OutEnd-Out))
+            return false;
+        memcpy(Out,In,Literals);
+        In+=Literals;
+        Out+=Literals;
+
+        /* The last one has no match */
+        if(In==InEnd)
+            break;
+
+        if(InEnd-In<2)
+            return false;
+        Offset=In[0] | In[1]<<8;
+        In+=2;
+        if(Offset==0 || Offset>(uint32_t)(Out-Dest))
+            return false;
+
+        Len=(Token&15)+LZ_MIN_MATCH;
+        if((Token&15)==15)
+        {
+            do
+            {
+                if(In>=InEnd)
+                    return false;
+                More=*In++;
+                Len+=More;
+            } while(More==255);
+        }
+        if(Len>(uint32_t)(OutEnd-Out))
+            return false;
+
+        /* Matches can overlap what they are making */
+        From=Out-Offset;
+        if(Offset>=Len)
+        {
+            memcpy(Out,From,Len);
+            Out+=Len;
+        }
+        else
+        {
+            while(Len-->0)
+                *Out++=*From++;
+        }
     }
 
-    return Var;
+    return Out==OutEnd;
 }
 
 /*******************************************************************************
  * NAME:
- *    RIFF::WriteSize
+ *    RIFF_ChecksumBefore
  *
  * SYNOPSIS:
- *    void RIFF::WriteSize(uint32_t Size);
+ *    static bool RIFF_ChecksumBefore(const struct RIFFChecksum &A,
+ *              const struct RIFFChecksum &B);
  *
  * PARAMETERS:
- *    Size [I] -- The size to write out
+ *    A [I] -- The first checksum to compare
+ *    B [I] -- The second checksum to compare
  *
  * FUNCTION:
- *    This function writes a 32bit size out to the file converting for IFF and
- *    RIFF as needed.
+ *    This function is used to sort the checksum table into file order.
  *
  * RETURNS:
- *    NONE
+ *    true -- 'A' is for a chunk before 'B'
+ *    false -- 'A' is not before 'B'
  *
  * SEE ALSO:
- *    
+ *    RIFF::WriteChecksums()
  ******************************************************************************/
-void RIFF::WriteSize(uint32_t Size)
+static bool RIFF_ChecksumBefore(const struct RIFFChecksum &A,
+        const struct RIFFChecksum &B)
 {
-    uint8_t SizeBuff[4];
-
-    if(IFFMode)
-    {
-        SizeBuff[0]=(Size>>24)&0xFF;
-        SizeBuff[1]=(Size>>16)&0xFF;
-        SizeBuff[2]=(Size>>8)&0xFF;
-        SizeBuff[3]=(Size>>0)&0xFF;
-    }
-    else
-    {
-        SizeBuff[0]=(Size>>0)&0xFF;
-        SizeBuff[1]=(Size>>8)&0xFF;
-        SizeBuff[2]=(Size>>16)&0xFF;
-        SizeBuff[3]=(Size>>24)&0xFF;
-    }
-
-    if(fwrite(SizeBuff,4,1,FileHandle)!=1)
-    {
-        fclose(FileHandle);
-        FileHandle=NULL;
-        throw(e_RIFFError_WriteError);
-    }
+    return A.Offset<B.Offset;
 }
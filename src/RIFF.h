@@ -39,17 +39,31 @@
 /***  HEADER FILES TO INCLUDE          ***/
 #include <list>
 #include <stack>
+#include <vector>
+#include <type_traits>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 /***  DEFINES                          ***/
+#define RIFF_INLINE_STACK_DEPTH         32      // Groups deep before we malloc
+#define RIFF_PACK_HEADER_SIZE           20      // Start of a compressed chunk
+#define RIFF_PACK_CHUNK_ID              "CMPR"  // Chunk ID of compressed chunks
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_BIG_ENDIAN__
+#define RIFF_HOST_BIG_ENDIAN            1
+#else
+#define RIFF_HOST_BIG_ENDIAN            0
+#endif
 
 /***  MACROS                           ***/
+/* Describes how a struct is stored in a chunk.  For example:
+        RIFF_STRUCT(fmt,RIFF_FIELD(fmt,AudioFormat),RIFF_FIELD(fmt,SampleRate));
+   must be at global scope, after the struct */
+#define RIFF_FIELD(Struct,Member)   RIFFField<Struct,decltype(Struct::Member),&Struct::Member>
+#define RIFF_STRUCT(Struct,...)     template <> struct RIFFStructLayout<Struct> : public RIFFStruct<Struct,__VA_ARGS__> {}
 
 /***  TYPE DEFINITIONS                 ***/
-typedef std::stack<uint32_t> t_RIFFOffsets;
-typedef std::stack<uint32_t> t_RIFFSizes;
-
 typedef enum
 {
     e_RIFFData_DataBlock,
@@ -62,6 +76,29 @@ typedef enum
     e_RIFFOpen_Write
 } e_RIFFOpenType;
 
+typedef enum
+{
+    e_RIFFIO_Buffered,          // stdio (the default)
+    e_RIFFIO_ReadAhead,         // Read only.  Needs RIFF_USE_READAHEAD
+    e_RIFFIO_MMap,              // Write only.  Memory mapped and preallocated
+    e_RIFFIO_Direct             // Write only.  O_DIRECT, skips the page cache
+} e_RIFFIOType;
+
+typedef enum
+{
+    e_RIFFHint_None,            // Leave it up to the OS (the default)
+    e_RIFFHint_Sequential,      // Walking the file in order
+    e_RIFFHint_Random           // Jumping around the file / skipping a lot
+} e_RIFFAccessHintType;
+
+typedef enum
+{
+    e_RIFFCompress_None,        // Stored as is (the default)
+    e_RIFFCompress_LZ,          // The built in LZ codec (fast, always there)
+    e_RIFFCompress_Zlib,        // Needs RIFF_USE_ZLIB when building
+    e_RIFFCompress_Zstd         // Needs RIFF_USE_ZSTD when building
+} e_RIFFCompressType;
+
 enum e_RIFFErrorType
 {
     e_RIFFError_None,
@@ -73,10 +110,141 @@ enum e_RIFFErrorType
     e_RIFFError_ChunkToSmall,
     e_RIFFError_BadFormat,
     e_RIFFError_FormTypeMismatch,
-    e_RIFFError_UnsupportedFileMode
+    e_RIFFError_UnsupportedFileMode,
+    e_RIFFError_UnsupportedIOType,
+    e_RIFFError_OutOfMemory,
+    e_RIFFError_BadChecksum,
+    e_RIFFError_UnsupportedCompression,
+    e_RIFFError_UnsupportedSampleFormat
+};
+
+struct RIFFIOOptions
+{
+    uint32_t ReadAheadBufferSize;
+    unsigned ReadAheadBuffers;
+    uint64_t MMapExtent;
+    uint32_t DirectBlockSize;
+};
+
+struct RIFFStatsCounter
+{
+    uint64_t Calls;
+    uint64_t Bytes;
+};
+
+struct RIFFStats
+{
+    /* Calls to the RIFF class */
+    struct RIFFStatsCounter Read;               // Read()
+    struct RIFFStatsCounter Write;              // Write() / EndWriteInPlace()
+    struct RIFFStatsCounter ReadNextDataBlock;  // Bytes is the chunk sizes
+    struct RIFFStatsCounter Skipped;            // Chunk data never read
+    uint64_t DataBlocks;                        // Data blocks written / found
+    uint64_t Groups;                            // Groups written / read
+    uint64_t PadBytes;                          // Padding written / skipped
+    unsigned MaxDepth;                          // Deepest group
+    uint64_t Commits;                           // Sizes fixed up early
+
+    /* Calls to the file */
+    struct RIFFStatsCounter IORead;
+    struct RIFFStatsCounter IOWrite;
+    struct RIFFStatsCounter IOSkip;             // Seeks forward when reading
+    struct RIFFStatsCounter IOPatch;            // Seeks back to fix sizes
+    uint64_t IOSeek;
+    uint64_t IONanoseconds;                     // Time in all of the above
+};
+
+typedef enum
+{
+    e_RIFFTrace_ChunkStart,
+    e_RIFFTrace_ChunkEnd,
+    e_RIFFTrace_GroupStart,
+    e_RIFFTrace_GroupEnd
+} e_RIFFTraceEventType;
+
+struct RIFFTraceEvent
+{
+    e_RIFFTraceEventType Type;
+    bool Writing;
+    char ChunkID[5];            // The chunk ID or the group ID
+    uint64_t Offset;            // File offset of the data (after the group ID)
+    uint32_t Size;              // Chunk size (0 for a start when writing)
+    unsigned Depth;             // Number of groups this is inside of
+    uint64_t StartTime;         // In ns (steady clock)
+    uint64_t EndTime;           // In ns (0 for starts)
+};
+
+typedef void (*t_RIFFTraceHandler)(const struct RIFFTraceEvent *Event,
+        void *UserData);
+
+struct RIFFChecksum
+{
+    uint32_t Offset;            // File offset of the chunk data
+    uint32_t Size;              // Chunk size
+    uint32_t CRC;               // CRC32C of the chunk data
+};
+
+typedef std::vector<struct RIFFChecksum> t_RIFFChecksums;
+
+struct RIFFSpan
+{
+    const uint8_t *Data;
+    uint32_t Size;
+};
+
+struct RIFFArenaChunk
+{
+    char ChunkID[5];                    // The chunk ID or the group ID
+    e_RIFFDataType DataType;
+    struct RIFFSpan Data;               // Data blocks only
+    struct RIFFArenaChunk *Children;    // Groups only.  The first chunk in it
+    unsigned ChildCount;
+    struct RIFFArenaChunk *Next;        // The next chunk in the same group
+};
+
+struct RIFFArenaBlock
+{
+    struct RIFFArenaBlock *Next;
+    uint8_t *Mem;
+    uint32_t Size;
+    uint32_t Used;
+    bool Owned;
 };
 
 /***  CLASS DEFINITIONS                ***/
+/* A stack that keeps the first 'N' items in the class (so we don't malloc
+   unless the groups go very deep) */
+template <typename T,unsigned N>
+class RIFFInlineStack
+{
+    public:
+        RIFFInlineStack() {Count=0;}
+        void push(const T &Item)
+        {
+            if(Count<N)
+                Inline[Count]=Item;
+            else
+                Spill.push_back(Item);
+            Count++;
+        }
+        void pop(void)
+        {
+            Count--;
+            if(Count>=N)
+                Spill.pop_back();
+        }
+        T &top(void) {return Count<=N?Inline[Count-1]:Spill.back();}
+        T &at(unsigned Index) {return Index<N?Inline[Index]:Spill[Index-N];}
+        unsigned size(void) {return Count;}
+        bool empty(void) {return Count==0;}
+        void clear(void) {Count=0; Spill.clear();}
+
+    private:
+        T Inline[N];
+        std::vector<T> Spill;
+        unsigned Count;
+};
+
 struct ListHistory
 {
     uint32_t BlockSize;
@@ -84,7 +252,133 @@ struct ListHistory
     uint32_t DataLeft;
 };
 
-typedef std::stack<struct ListHistory> t_RIFFHistory;
+/* One field of a struct (use RIFF_FIELD()).  Arrays are stored as all the
+   elements one after the other */
+template <typename S,typename T,T S::*Member>
+struct RIFFField
+{
+    typedef typename std::remove_all_extents<T>::type Element;
+    enum
+    {
+        Size=sizeof(T),
+        ElementSize=sizeof(Element),
+        Count=sizeof(T)/sizeof(Element)
+    };
+
+    static void Swap(uint8_t *Data)
+    {
+        uint8_t Tmp;
+        unsigned r;
+        unsigned a;
+
+        for(r=0;r<Count;r++,Data+=ElementSize)
+        {
+            for(a=0;a<ElementSize/2;a++)
+            {
+                Tmp=Data[a];
+                Data[a]=Data[ElementSize-1-a];
+                Data[ElementSize-1-a]=Tmp;
+            }
+        }
+    }
+    static void Encode(const S &Src,uint8_t *Dest,bool SwapBytes)
+    {
+        memcpy(Dest,&(Src.*Member),Size);
+        if(SwapBytes && ElementSize>1)
+            Swap(Dest);
+    }
+    static void Decode(S &Dest,const uint8_t *Src,bool SwapBytes)
+    {
+        memcpy(&(Dest.*Member),Src,Size);
+        if(SwapBytes && ElementSize>1)
+            Swap((uint8_t *)&(Dest.*Member));
+    }
+    static size_t Offset(const S &Obj)
+    {
+        return (const uint8_t *)&(Obj.*Member)-(const uint8_t *)&Obj;
+    }
+};
+
+/* A list of RIFFField's.  The encoder / decoder for each struct is made
+   from this at compile time */
+template <typename S,typename... Fields>
+struct RIFFStruct;
+
+template <typename S>
+struct RIFFStruct<S>
+{
+    enum {Size=0,AllBytes=1};
+    static void Encode(const S &,uint8_t *,bool) {}
+    static void Decode(S &,const uint8_t *,uint32_t,bool) {}
+    static bool SameLayout(const S &,size_t) {return true;}
+};
+
+template <typename S,typename F,typename... Rest>
+struct RIFFStruct<S,F,Rest...>
+{
+    typedef RIFFStruct<S,Rest...> Next;
+    enum
+    {
+        Size=F::Size+Next::Size,
+        AllBytes=F::ElementSize==1 && Next::AllBytes
+    };
+
+    static void Encode(const S &Src,uint8_t *Dest,bool SwapBytes)
+    {
+        F::Encode(Src,Dest,SwapBytes);
+        Next::Encode(Src,Dest+F::Size,SwapBytes);
+    }
+
+    /* Only the fields that are all there in 'Bytes' are set */
+    static void Decode(S &Dest,const uint8_t *Src,uint32_t Bytes,
+            bool SwapBytes)
+    {
+        if(Bytes<(uint32_t)F::Size)
+            return;
+        F::Decode(Dest,Src,SwapBytes);
+        Next::Decode(Dest,Src+F::Size,Bytes-F::Size,SwapBytes);
+    }
+
+    static bool SameLayout(const S &Obj,size_t At)
+    {
+        return F::Offset(Obj)==At && Next::SameLayout(Obj,At+F::Size);
+    }
+
+    /* true if the struct in memory is already the same as in the file */
+    static bool Matches(const S &Obj,bool SwapBytes)
+    {
+        return (!SwapBytes || AllBytes) && (size_t)Size==sizeof(S) &&
+                SameLayout(Obj,0);
+    }
+};
+
+/* Give one of these for each struct with RIFF_STRUCT() */
+template <typename S>
+struct RIFFStructLayout;
+
+typedef RIFFInlineStack<uint64_t,RIFF_INLINE_STACK_DEPTH> t_RIFFOffsets;
+typedef RIFFInlineStack<uint32_t,RIFF_INLINE_STACK_DEPTH> t_RIFFSizes;
+typedef RIFFInlineStack<struct ListHistory,RIFF_INLINE_STACK_DEPTH> t_RIFFHistory;
+
+class RIFFArena
+{
+    public:
+        RIFFArena(uint32_t BlockSize=65536);
+        RIFFArena(void *Buffer,uint32_t Size,uint32_t BlockSize=65536);
+        ~RIFFArena();
+        void *Alloc(uint32_t Bytes);
+        void Reset(void);
+        void Free(void);
+        uint64_t GetUsed(void);
+
+    private:
+        struct RIFFArenaBlock *First;
+        struct RIFFArenaBlock *Last;
+        struct RIFFArenaBlock *Current;
+        struct RIFFArenaBlock External;
+        uint32_t BlockSize;
+        uint64_t Used;
+};
 
 class RIFF
 {
@@ -93,18 +387,43 @@ class RIFF
         RIFF(bool UseIFF=false);
         ~RIFF();
         void SetIFFMode(bool UseIFF);
+        bool GetIFFMode(void);
         static const char *Error2Str(e_RIFFErrorType err);
+        void SetStats(struct RIFFStats *Stats,FILE *DumpAtClose=NULL);
+        static void DumpStats(const struct RIFFStats *Stats,FILE *Out);
+        void SetTraceHandler(t_RIFFTraceHandler Handler,void *UserData);
+        void SetChecksums(bool On);
+        const t_RIFFChecksums &GetChecksums(void);
 
         /* File control */
-        void Open(const char *Filename,e_RIFFOpenType Mode,const char *FormType);
+        void Open(const char *Filename,e_RIFFOpenType Mode,const char *FormType,
+                e_RIFFIOType IOType=e_RIFFIO_Buffered);
         void Close(void);
+        void NextForm(const char *FormType);
+        void SetReadAhead(uint32_t BufferSize,unsigned Buffers);
+        void SetAccessHints(e_RIFFAccessHintType Hints,uint32_t Window=0);
+        void SetMMapExtent(uint64_t Bytes);
+        void SetDirectBlockSize(uint32_t Bytes);
+        void SetCompressBlockSize(uint32_t Bytes);
+        void SetDecompress(bool On);
+        void SetCommitInterval(uint32_t Bytes,uint32_t Milliseconds,
+                bool Sync=false);
 
         /* Write methods */
-        void StartDataBlock(const char *ChunkID);
+        void StartDataBlock(const char *ChunkID,
+                e_RIFFCompressType Compress=e_RIFFCompress_None);
         void EndDataBlock(void);
         void Write(const void *Data,uint32_t Bytes);
+        void *StartWriteInPlace(uint32_t Bytes);
+        void EndWriteInPlace(void);
         void StartGroup(const char *ListID);
         void EndGroup(void);
+        void WriteDataBlock(const char *ChunkID,const void *Data,
+                uint32_t Bytes);
+        void WriteDataBlocks(const void *Data,uint32_t Bytes);
+        void ReserveFront(uint32_t Bytes);
+        void AddFrontChunk(const char *ChunkID);
+        void Commit(void);
 
         /* Read methods */
         void Read(void *Data,uint32_t Bytes);
@@ -112,37 +431,211 @@ class RIFF
         bool ReadNextDataBlock(char *ChunkID,uint32_t *ChunkSize,e_RIFFDataType &DataType);
         void StartReadingGroup(void);
         void DoneReadingGroup(void);
+        uint32_t GetChunkOffset(void);
+        void SeekInChunk(uint32_t Offset);
+        bool VerifyChunk(void);
+        struct RIFFSpan ReadChunk(class RIFFArena &Arena);
+        struct RIFFArenaChunk *ReadGroup(class RIFFArena &Arena,
+                unsigned *ChunkCount=NULL);
+
+        /* Typed read / write (byte swapped to / from the file's byte order) */
+        template <typename T> T Read(void)
+        {
+            T Value;
+            ReadArray(&Value,1);
+            return Value;
+        }
+        template <typename T> void ReadArray(T *Data,uint32_t Count)
+        {
+            static_assert(sizeof(T)<=8,"ReadArray() is for numbers");
+            ReadSwapped(Data,sizeof(T),Count);
+        }
+        template <typename T> void WriteArray(const T *Data,uint32_t Count)
+        {
+            static_assert(sizeof(T)<=8,"WriteArray() is for numbers");
+            WriteSwapped(Data,sizeof(T),Count);
+        }
+
+        /* Structs described with RIFF_STRUCT() (packed, in the file's byte
+           order) */
+        template <typename S> void WriteStruct(const S &Data)
+        {
+            typedef RIFFStructLayout<S> Layout;
+            uint8_t Buffer[Layout::Size];
+            bool SwapBytes=(IFFMode!=RIFF_HOST_BIG_ENDIAN);
+
+            if(Layout::Matches(Data,SwapBytes))
+            {
+                Write(&Data,sizeof(S));
+                return;
+            }
+            Layout::Encode(Data,Buffer,SwapBytes);
+            Write(Buffer,Layout::Size);
+        }
+        template <typename S> void WriteDataBlock(const char *ChunkID,
+                const S &Data)
+        {
+            StartDataBlock(ChunkID);
+            WriteStruct(Data);
+            EndDataBlock();
+        }
+        template <typename S> uint32_t ReadStruct(S &Data)
+        {
+            typedef RIFFStructLayout<S> Layout;
+            uint8_t Buffer[Layout::Size];
+            bool SwapBytes=(IFFMode!=RIFF_HOST_BIG_ENDIAN);
+            uint32_t Bytes;
+
+            /* Older files may have a smaller struct, only read what's there */
+            Bytes=Layout::Size;
+            if(ChunkBytesLeft()<Bytes)
+                Bytes=ChunkBytesLeft();
+
+            if(Bytes==(uint32_t)Layout::Size && Layout::Matches(Data,SwapBytes))
+            {
+                Read(&Data,sizeof(S));
+                return Bytes;
+            }
+            Read(Buffer,Bytes);
+            Layout::Decode(Data,Buffer,Bytes,SwapBytes);
+            return Bytes;
+        }
 
     private:
-        FILE *FileHandle;
+        class RIFFIO *IO;
+        struct RIFFIOOptions IOOptions;
         uint32_t CurrentChunkSize;
         uint32_t TotalFileSize;
         bool Opened4Read;
         bool IFFMode;
+        struct RIFFStats *Stats;
+        FILE *StatsDump;
+
+        /* Tracing */
+        t_RIFFTraceHandler TraceHandler;
+        void *TraceUserData;
+        struct RIFFTraceEvent TraceChunk;
+        bool TraceChunkOpen;
+        std::vector<struct RIFFTraceEvent> TraceGroups;
+
+        /* Checksums */
+        bool Checksums;
+        t_RIFFChecksums ChecksumTable;
+        size_t NextChecksum;
+        bool ChecksumPending;
+        uint32_t ChecksumExpected;
+        uint32_t ChunkCRC;
+        uint32_t ChunkCRCBytes;
+        uint32_t ChunkDataSize;
+
+        /* Compression */
+        uint32_t CompressBlockSize;
+        bool Decompress;
+        e_RIFFCompressType ChunkCompress;
+        uint8_t PackHeader[RIFF_PACK_HEADER_SIZE];
+        uint32_t PackBlockSize;
+        uint32_t PackIndexOffset;
+        uint32_t PackNextBlock;
+        uint32_t UnpackedSize;
+        uint32_t UnpackedLeft;
+        uint32_t UnpackPos;
+        std::vector<uint8_t> PackBuffer;
+        std::vector<uint8_t> UnpackBuffer;
+        std::vector<uint32_t> PackIndex;
 
         /* Write */
-        uint32_t SavedChuckOffset;
+        uint64_t FormStart;
+        uint64_t SavedChuckOffset;
         uint32_t SavedChuckSize;
         uint32_t CurrentListSize;
+        bool DataBlockOpen;
+        uint32_t InPlaceBytes;
+        void *InPlacePtr;
+        std::vector<uint8_t> InPlaceBuffer;
         t_RIFFOffsets ListOffsets;
         t_RIFFSizes ListSizes;
 
+        /* Faststart (chunks moved into the space from ReserveFront()) */
+        std::vector<uint8_t> FrontIDs;      // 4 bytes per chunk ID
+        class RIFFIO *FrontIO;              // The real backend while building
+        std::vector<uint8_t> FrontBuffer;
+        uint64_t FrontOffset;               // Where the space left starts
+        uint32_t FrontSize;                 // Bytes left (with the header)
+        size_t FrontChecksumStart;
+        std::vector<struct RIFFTraceEvent> FrontTrace; // Held until placed
+
+        /* Progressive commits (see SetCommitInterval()) */
+        uint32_t CommitBytes;
+        uint32_t CommitMilliseconds;
+        bool CommitSync;
+        uint64_t UncommittedBytes;
+        uint64_t LastCommit;                // ns, from RIFF_TraceNow()
+
         /* Read */
         uint32_t BlockSize;
         uint32_t ReadFromBlock;
         uint32_t DataLeft;
+        uint32_t CurrentChunkPad;
+        uint32_t CurrentChunkOffset;
         t_RIFFHistory PrevPos;
 
-        void OpenWrite(const char *Filename,const char *FormType);
+        /* Access hints */
+        e_RIFFAccessHintType AccessHints;
+        uint32_t HintWindow;
+        uint64_t HintChunkStart;
+        uint64_t HintChunkEnd;
+        uint64_t HintedTo;
+        uint64_t DroppedTo;
+        bool HintChunkRead;
+
+        void OpenWrite(const char *Filename,const char *FormType,
+                e_RIFFIOType IOType);
         void CloseWrite(void);
-        void OpenRead(const char *Filename,const char *FormType);
+        void OpenRead(const char *Filename,const char *FormType,
+                e_RIFFIOType IOType);
         void CloseRead(void);
         uint32_t ReadSize(void);
         void WriteSize(uint32_t Size);
+        void PatchSize(uint64_t Offset,uint32_t Size);
+        void MakeSize(uint8_t *SizeBuff,uint32_t Size);
+        void CloseIO(void);
+        void AddWritten(uint32_t Bytes);
+        void CheckCommit(uint32_t Bytes);
+        void HintChunkStarted(void);
+        void HintChunkDone(void);
+        void HintRead(uint32_t Bytes);
+        void TraceStart(e_RIFFTraceEventType Type,const char *ChunkID,
+                uint64_t Offset,uint32_t Size);
+        void TraceChunkDone(uint32_t Size);
+        void TraceGroupDone(uint32_t Size);
+        void TraceSend(const struct RIFFTraceEvent *Event);
+        void ReadSwapped(void *Data,unsigned Size,uint32_t Count);
+        void LoadChecksums(void);
+        void WriteChecksums(void);
+        bool ChecksumChunkDone(void);
+        void WriteSwapped(const void *Data,unsigned Size,uint32_t Count);
+        void WriteRaw(const void *Data,uint32_t Bytes);
+        void ReadRaw(void *Data,uint32_t Bytes);
+        uint32_t ChunkBytesLeft(void);
+        void MoveInChunk(uint32_t Pos);
+        void StartDecompress(char *ChunkID,uint32_t *ChunkSize);
+        void ReadPackedBlock(void);
+        void LoadPackIndex(void);
+        void WritePackedBlock(void);
+        void EndCompress(void);
+        bool IsFrontChunk(const char *ChunkID);
+        void BeginFront(void);
+        void EndFront(void);
 };
 
 /***  GLOBAL VARIABLE DEFINITIONS      ***/
 
 /***  EXTERNAL FUNCTION PROTOTYPES     ***/
+void RIFF_SwapBytes(void *Data,unsigned Size,uint32_t Count);
+uint32_t RIFF_CRC32C(uint32_t CRC,const void *Data,size_t Bytes);
+void RIFF_ReadPackHeader(const uint8_t *Header,uint32_t RawSize,bool IFF,
+        char *ChunkID,uint32_t *Size);
+void RIFF_UnpackChunk(const uint8_t *Raw,uint32_t RawSize,bool IFF,
+        uint8_t *Dest,uint32_t DestSize);
 
 #endif
@@ -0,0 +1,597 @@
+/*******************************************************************************
+ * FILENAME: RIFFDispatcher.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file has the RIFFDispatcher class that calls a handler for each
+ *    chunk ID / path found in a file.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFDispatcher.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+/*** DEFINES                  ***/
+#define DISPATCH_ROOT_NODE              0           // The top of the file
+#define DISPATCH_ANY_NODE               0xFFFFFFFE  // Chunk ID handlers
+#define DISPATCH_NO_NODE                0xFFFFFFFF  // No path handlers below
+#define DISPATCH_EMPTY_KEY              0xFFFFFFFFFFFFFFFFULL
+#define DISPATCH_MAX_DISPLACE           100000
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static uint64_t DispatchMix(uint64_t Key);
+static uint32_t DispatchFourCC(const char *ChunkID);
+static uint32_t DispatchNextPow2(uint32_t Value);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::RIFFDispatcher
+ *
+ * SYNOPSIS:
+ *    RIFFDispatcher::RIFFDispatcher();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the dispatcher class.  The dispatcher
+ *    replaces the big if(strcmp(ChunkID,...)) chain in the
+ *    ReadNextDataBlock() loop.  You add a handler for each chunk ID (or
+ *    path) you want and it walks the file for you, calling the handlers,
+ *    going into groups and skipping everything else.
+ *
+ *    The handlers are put in a perfect hash table keyed on the chunk ID and
+ *    the group it is in, so finding the handler for a chunk takes the same
+ *    time no matter how many handlers there are.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::Dispatch()
+ ******************************************************************************/
+RIFFDispatcher::RIFFDispatcher()
+{
+    NextNode=DISPATCH_ROOT_NODE+1;
+    HaveIDHandlers=false;
+    Built=false;
+    TableMask=0;
+    BucketMask=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::~RIFFDispatcher
+ *
+ * SYNOPSIS:
+ *    RIFFDispatcher::~RIFFDispatcher();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFDispatcher::~RIFFDispatcher()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::AddHandler
+ *
+ * SYNOPSIS:
+ *    void RIFFDispatcher::AddHandler(const char *ChunkID,
+ *              t_RIFFDispatchHandler Handler,void *UserData);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The 4 letter ID of the chunk to send to 'Handler'.  This
+ *                   matches the chunk no matter what group it is in.
+ *    Handler [I] -- The function to call when the chunk is found.  It is
+ *                   defined as:
+ *                      void Handler(class RIFF &RIFF,
+ *                              const struct RIFFDispatchInfo *Info,
+ *                              void *UserData);
+ *                   RIFF -- The file.  Use RIFF.Read() to read the chunk.
+ *                   Info -- The chunk ID, path, size, and depth of the chunk.
+ *                   UserData -- The 'UserData' passed to AddHandler().
+ *    UserData [I] -- A pointer to pass to the handler.
+ *
+ * FUNCTION:
+ *    This function adds a handler for a chunk ID.  If you add a handler for
+ *    a group ID it is called when the group is found (before the chunks in
+ *    it).  The handler must not call StartReadingGroup(), the dispatcher
+ *    goes into the group itself.
+ *
+ *    Adding a handler for an ID that already has one replaces it.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Path handlers win over chunk ID handlers.
+ *
+ *    Once there is a chunk ID handler the dispatcher has to go into every
+ *    group, because the chunk could be in any of them.  If you only use
+ *    path handlers, groups that aren't on any of the paths are skipped
+ *    without being read.
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::AddPathHandler(), RIFFDispatcher::Dispatch()
+ ******************************************************************************/
+void RIFFDispatcher::AddHandler(const char *ChunkID,
+        t_RIFFDispatchHandler Handler,void *UserData)
+{
+    struct RIFFDispatchEntry *Entry;
+    struct RIFFDispatchHandlerInfo NewHandler;
+
+    Entry=AddEntry(DISPATCH_ANY_NODE,ChunkID);
+
+    NewHandler.Handler=Handler;
+    NewHandler.UserData=UserData;
+    Handlers.push_back(NewHandler);
+
+    Entry->Handler=Handlers.size()-1;
+    HaveIDHandlers=true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::AddPathHandler
+ *
+ * SYNOPSIS:
+ *    void RIFFDispatcher::AddPathHandler(const char *Path,
+ *              t_RIFFDispatchHandler Handler,void *UserData);
+ *
+ * PARAMETERS:
+ *    Path [I] -- The full path to the chunk to send to 'Handler'.  This is
+ *                the group ID's and the chunk ID with a '/' between them.
+ *                For example "META/DATE/TIME".
+ *    Handler [I] -- The function to call when the chunk is found.  See
+ *                   AddHandler().
+ *    UserData [I] -- A pointer to pass to the handler.
+ *
+ * FUNCTION:
+ *    This function adds a handler for one chunk in one group.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::AddHandler(), RIFFDispatcher::Dispatch()
+ ******************************************************************************/
+void RIFFDispatcher::AddPathHandler(const char *Path,
+        t_RIFFDispatchHandler Handler,void *UserData)
+{
+    struct RIFFDispatchEntry *Entry;
+    struct RIFFDispatchHandlerInfo NewHandler;
+    char ChunkID[5];
+    uint32_t Node;
+    const char *Pos;
+
+    /* Walk down the path adding a node for each group */
+    Entry=NULL;
+    Node=DISPATCH_ROOT_NODE;
+    Pos=Path;
+    for(;;)
+    {
+        if(strlen(Pos)<4 || (Pos[4]!='/' && Pos[4]!=0))
+            throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+        memcpy(ChunkID,Pos,4);
+        ChunkID[4]=0;
+        Entry=AddEntry(Node,ChunkID);
+        if(Pos[4]==0)
+            break;
+
+        if(Entry->Child==DISPATCH_NO_NODE)
+            Entry->Child=NextNode++;
+        Node=Entry->Child;
+        Pos+=5;
+    }
+
+    NewHandler.Handler=Handler;
+    NewHandler.UserData=UserData;
+    Handlers.push_back(NewHandler);
+
+    Entry->Handler=Handlers.size()-1;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::Dispatch
+ *
+ * SYNOPSIS:
+ *    void RIFFDispatcher::Dispatch(class RIFF &RIFF);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to walk.  This must be open for reading.
+ *
+ * FUNCTION:
+ *    This function walks the rest of the file calling the handlers for the
+ *    chunks it finds.  Groups are gone into and chunks without a handler are
+ *    skipped (seeked over).  A handler can read as much or as little of its
+ *    chunk as it wants.
+ *
+ *    If called after StartReadingGroup() it only walks the rest of that
+ *    group (paths are then from that group).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::AddHandler(), RIFFDispatcher::AddPathHandler()
+ ******************************************************************************/
+void RIFFDispatcher::Dispatch(class RIFF &RIFF)
+{
+    if(!Built)
+        Build();
+
+    Path.clear();
+    DispatchGroup(RIFF,DISPATCH_ROOT_NODE,0);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::DispatchGroup
+ *
+ * SYNOPSIS:
+ *    void RIFFDispatcher::DispatchGroup(class RIFF &RIFF,uint32_t Node,
+ *              unsigned Depth);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file we are walking.
+ *    Node [I] -- The path node for this group (DISPATCH_NO_NODE if there
+ *                are no path handlers in it)
+ *    Depth [I] -- How many groups deep we are
+ *
+ * FUNCTION:
+ *    This function walks the chunks in the current group, calling handlers
+ *    and going into groups.  'Path' has the path of this group in it.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFDispatcher::DispatchGroup(class RIFF &RIFF,uint32_t Node,
+        unsigned Depth)
+{
+    const struct RIFFDispatchEntry *PathEntry;
+    const struct RIFFDispatchEntry *IDEntry;
+    const struct RIFFDispatchHandlerInfo *Handler;
+    struct RIFFDispatchInfo Info;
+    uint32_t Child;
+    uint32_t FourCC;
+    size_t PathLen;
+
+    PathLen=Path.size();
+    Info.Depth=Depth;
+
+    while(RIFF.ReadNextDataBlock(Info.ChunkID,&Info.ChunkSize,Info.DataType))
+    {
+        FourCC=DispatchFourCC(Info.ChunkID);
+
+        PathEntry=NULL;
+        if(Node!=DISPATCH_NO_NODE)
+            PathEntry=Lookup(Node,FourCC);
+
+        Handler=NULL;
+        if(PathEntry!=NULL && PathEntry->Handler>=0)
+        {
+            Handler=&Handlers[PathEntry->Handler];
+        }
+        else if(HaveIDHandlers)
+        {
+            IDEntry=Lookup(DISPATCH_ANY_NODE,FourCC);
+            if(IDEntry!=NULL)
+                Handler=&Handlers[IDEntry->Handler];
+        }
+
+        Child=DISPATCH_NO_NODE;
+        if(PathEntry!=NULL)
+            Child=PathEntry->Child;
+
+        /* Skip it if nothing wants it */
+        if(Handler==NULL && (Info.DataType!=e_RIFFData_Group ||
+                (Child==DISPATCH_NO_NODE && !HaveIDHandlers)))
+        {
+            continue;
+        }
+
+        Path.resize(PathLen);
+        if(PathLen>0)
+            Path.push_back('/');
+        Path.append(Info.ChunkID,4);
+        Info.Path=Path.c_str();
+
+        if(Handler!=NULL)
+            Handler->Handler(RIFF,&Info,Handler->UserData);
+
+        if(Info.DataType==e_RIFFData_Group &&
+                (Child!=DISPATCH_NO_NODE || HaveIDHandlers))
+        {
+            RIFF.StartReadingGroup();
+            DispatchGroup(RIFF,Child,Depth+1);
+            RIFF.DoneReadingGroup();
+        }
+    }
+
+    Path.resize(PathLen);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::AddEntry
+ *
+ * SYNOPSIS:
+ *    struct RIFFDispatchEntry *RIFFDispatcher::AddEntry(uint32_t Node,
+ *              const char *ChunkID);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The group node the chunk is in
+ *    ChunkID [I] -- The chunk ID
+ *
+ * FUNCTION:
+ *    This function finds or adds an entry in the list of entries that the
+ *    hash table is made from.
+ *
+ * RETURNS:
+ *    The entry.  This is only good until the next AddEntry().
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+struct RIFFDispatchEntry *RIFFDispatcher::AddEntry(uint32_t Node,
+        const char *ChunkID)
+{
+    struct RIFFDispatchEntry NewEntry;
+    uint64_t Key;
+    unsigned r;
+
+    if(strlen(ChunkID)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    Built=false;
+
+    Key=(uint64_t)Node<<32 | DispatchFourCC(ChunkID);
+    for(r=0;r<Entries.size();r++)
+        if(Entries[r].Key==Key)
+            return &Entries[r];
+
+    NewEntry.Key=Key;
+    NewEntry.Handler=-1;
+    NewEntry.Child=DISPATCH_NO_NODE;
+    Entries.push_back(NewEntry);
+
+    return &Entries.back();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::Build
+ *
+ * SYNOPSIS:
+ *    void RIFFDispatcher::Build(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function makes the perfect hash table from 'Entries' (hash and
+ *    displace).  The keys are split into buckets with one hash.  Then
+ *    starting with the biggest bucket we look for a displacement value that
+ *    puts all the keys in that bucket into empty slots in the table with a
+ *    second hash.  Looking up a key is then 2 hashes and 1 compare.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::Lookup()
+ ******************************************************************************/
+void RIFFDispatcher::Build(void)
+{
+    std::vector<std::vector<unsigned> > Buckets;
+    std::vector<unsigned> Order;
+    std::vector<uint32_t> Slots;
+    uint32_t TableSize;
+    uint32_t BucketCount;
+    uint32_t Slot;
+    uint32_t d;
+    unsigned b;
+    unsigned r;
+    unsigned k;
+    bool Fits;
+
+    TableSize=DispatchNextPow2(Entries.size()*2);
+    for(;;)
+    {
+        BucketCount=DispatchNextPow2(Entries.size()/2+1);
+        TableMask=TableSize-1;
+        BucketMask=BucketCount-1;
+
+        Buckets.assign(BucketCount,std::vector<unsigned>());
+        for(r=0;r<Entries.size();r++)
+            Buckets[DispatchMix(Entries[r].Key)&BucketMask].push_back(r);
+
+        Order.resize(BucketCount);
+        for(b=0;b<BucketCount;b++)
+            Order[b]=b;
+        std::stable_sort(Order.begin(),Order.end(),
+                [&Buckets](unsigned A,unsigned B)
+                {return Buckets[A].size()>Buckets[B].size();});
+
+        Table.assign(TableSize,RIFFDispatchEntry());
+        for(r=0;r<TableSize;r++)
+            Table[r].Key=DISPATCH_EMPTY_KEY;
+        Displace.assign(BucketCount,0);
+
+        for(b=0;b<BucketCount;b++)
+        {
+            std::vector<unsigned> &Bucket=Buckets[Order[b]];
+            if(Bucket.empty())
+                break;
+
+            for(d=0;d<DISPATCH_MAX_DISPLACE;d++)
+            {
+                Slots.clear();
+                Fits=true;
+                for(k=0;k<Bucket.size() && Fits;k++)
+                {
+                    Slot=DispatchMix(Entries[Bucket[k]].Key^
+                            (d*0x9E3779B97F4A7C15ULL))&TableMask;
+                    if(Table[Slot].Key!=DISPATCH_EMPTY_KEY ||
+                            std::find(Slots.begin(),Slots.end(),Slot)!=
+                            Slots.end())
+                    {
+                        Fits=false;
+                    }
+                    Slots.push_back(Slot);
+                }
+                if(Fits)
+                    break;
+            }
+            if(d==DISPATCH_MAX_DISPLACE)
+                break;
+
+            Displace[Order[b]]=d;
+            for(k=0;k<Bucket.size();k++)
+                Table[Slots[k]]=Entries[Bucket[k]];
+        }
+        if(b==BucketCount || Buckets[Order[b]].empty())
+            break;
+
+        /* Couldn't fit them all, try again with more room */
+        TableSize*=2;
+    }
+
+    Built=true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFDispatcher::Lookup
+ *
+ * SYNOPSIS:
+ *    const struct RIFFDispatchEntry *RIFFDispatcher::Lookup(uint32_t Node,
+ *              uint32_t FourCC);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The group node the chunk is in
+ *    FourCC [I] -- The chunk ID (from DispatchFourCC())
+ *
+ * FUNCTION:
+ *    This function looks up a chunk in the perfect hash table.
+ *
+ * RETURNS:
+ *    The entry or NULL if there isn't one.
+ *
+ * SEE ALSO:
+ *    RIFFDispatcher::Build()
+ ******************************************************************************/
+const struct RIFFDispatchEntry *RIFFDispatcher::Lookup(uint32_t Node,
+        uint32_t FourCC)
+{
+    const struct RIFFDispatchEntry *Entry;
+    uint64_t Key;
+    uint64_t Hash;
+
+    Key=(uint64_t)Node<<32 | FourCC;
+    Hash=DispatchMix(Key);
+    Entry=&Table[DispatchMix(Key^(Displace[Hash&BucketMask]*
+            0x9E3779B97F4A7C15ULL))&TableMask];
+    if(Entry->Key!=Key)
+        return NULL;
+    return Entry;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    DispatchMix
+ *
+ * SYNOPSIS:
+ *    static uint64_t DispatchMix(uint64_t Key);
+ *
+ * PARAMETERS:
+ *    Key [I] -- The value to hash
+ *
+ * FUNCTION:
+ *    This function mixes the bits of a key (the murmur3 finalizer).
+ *
+ * RETURNS:
+ *    The hash
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+static uint64_t DispatchMix(uint64_t Key)
+{
+    Key^=Key>>33;
+    Key*=0xFF51AFD7ED558CCDULL;
+    Key^=Key>>33;
+    Key*=0xC4CEB9FE1A85EC53ULL;
+    Key^=Key>>33;
+    return Key;
+}
+
+static uint32_t DispatchFourCC(const char *ChunkID)
+{
+    uint32_t FourCC;
+
+    memcpy(&FourCC,ChunkID,4);
+    return FourCC;
+}
+
+static uint32_t DispatchNextPow2(uint32_t Value)
+{
+    uint32_t Pow2;
+
+    Pow2=1;
+    while(Pow2<Value)
+        Pow2<<=1;
+    return Pow2;
+}
@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * FILENAME: RIFFDispatcher.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is the .h file for the RIFFDispatcher class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFDISPATCHER_H_
+#define __RIFFDISPATCHER_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+struct RIFFDispatchInfo
+{
+    char ChunkID[5];
+    const char *Path;                   // Group ID's + chunk ID ("INFO/INAM")
+    uint32_t ChunkSize;
+    e_RIFFDataType DataType;
+    unsigned Depth;                     // Number of groups this is inside of
+};
+
+typedef void (*t_RIFFDispatchHandler)(class RIFF &RIFF,
+        const struct RIFFDispatchInfo *Info,void *UserData);
+
+/***  CLASS DEFINITIONS                ***/
+struct RIFFDispatchHandlerInfo
+{
+    t_RIFFDispatchHandler Handler;
+    void *UserData;
+};
+
+struct RIFFDispatchEntry
+{
+    uint64_t Key;                       // Group node << 32 | FourCC
+    int Handler;                        // Index into 'Handlers' or -1
+    uint32_t Child;                     // The node for paths under this group
+};
+
+class RIFFDispatcher
+{
+    public:
+        RIFFDispatcher();
+        ~RIFFDispatcher();
+        void AddHandler(const char *ChunkID,t_RIFFDispatchHandler Handler,
+                void *UserData);
+        void AddPathHandler(const char *Path,t_RIFFDispatchHandler Handler,
+                void *UserData);
+        void Dispatch(class RIFF &RIFF);
+
+    private:
+        std::vector<struct RIFFDispatchHandlerInfo> Handlers;
+        std::vector<struct RIFFDispatchEntry> Entries;
+        uint32_t NextNode;
+        bool HaveIDHandlers;
+
+        /* The perfect hash table made from 'Entries' */
+        bool Built;
+        std::vector<struct RIFFDispatchEntry> Table;
+        std::vector<uint32_t> Displace;
+        uint32_t TableMask;
+        uint32_t BucketMask;
+
+        std::string Path;
+
+        struct RIFFDispatchEntry *AddEntry(uint32_t Node,const char *ChunkID);
+        void Build(void);
+        const struct RIFFDispatchEntry *Lookup(uint32_t Node,uint32_t FourCC);
+        void DispatchGroup(class RIFF &RIFF,uint32_t Node,unsigned Depth);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
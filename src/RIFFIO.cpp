@@ -0,0 +1,2006 @@
+/*******************************************************************************
+ * FILENAME: RIFFIO.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has the different ways the RIFF class can get at the file on disk.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFIO.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#ifdef RIFF_USE_READAHEAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdlib.h>
+#else
+#include <io.h>
+#endif
+
+/*** DEFINES                  ***/
+#define READAHEAD_DEFAULT_BUFFER_SIZE       (1024*1024)
+#define READAHEAD_DEFAULT_BUFFERS           3
+#define MMAP_DEFAULT_EXTENT                 (64*1024*1024)
+#define DIRECT_DEFAULT_BLOCK_SIZE           (1024*1024)
+#define DIRECT_ALIGNMENT                    4096
+
+/*** MACROS                   ***/
+#ifdef _WIN32
+#define RIFF_FSEEK(f,o,w)               _fseeki64(f,o,w)
+#define RIFF_FTELL(f)                   _ftelli64(f)
+#else
+#define RIFF_FSEEK(f,o,w)               fseeko(f,o,w)
+#define RIFF_FTELL(f)                   ftello(f)
+#endif
+
+/*** TYPE DEFINITIONS         ***/
+class RIFFIO_Buffered : public RIFFIO
+{
+    public:
+        RIFFIO_Buffered();
+        ~RIFFIO_Buffered();
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+        void Advise(uint64_t Offset,uint64_t Bytes,e_RIFFIOAdviceType Advice);
+        bool Flush(bool Sync);
+
+    private:
+        FILE *FileHandle;
+};
+
+#ifdef RIFF_USE_READAHEAD
+struct ReadAheadBuffer
+{
+    std::vector<uint8_t> Data;
+    uint64_t Offset;            // Where in the file 'Data' came from
+    uint32_t Bytes;             // How much of 'Data' is valid
+};
+
+class RIFFIO_ReadAhead : public RIFFIO
+{
+    public:
+        RIFFIO_ReadAhead(const struct RIFFIOOptions *Options);
+        ~RIFFIO_ReadAhead();
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+        void Advise(uint64_t Offset,uint64_t Bytes,e_RIFFIOAdviceType Advice);
+
+    private:
+        FILE *FileHandle;
+        std::thread Thread;
+        std::mutex Lock;
+        std::condition_variable BufferFilled;
+        std::condition_variable BufferFreed;
+        std::vector<struct ReadAheadBuffer> Buffers;
+        uint32_t BufferSize;
+        unsigned Head;          // The buffer the consumer is reading from
+        unsigned Filled;        // Number of buffers ready to be read
+        uint64_t ReadPos;       // Where the consumer is in the file
+        uint64_t FetchPos;      // Where the read ahead thread reads next
+        unsigned Generation;    // Bumped every time we throw away the buffers
+        bool AtEOF;
+        bool HadError;
+        bool Quit;
+
+        void ReadAheadThread(void);
+        void Restart(uint64_t Offset);
+};
+#endif
+
+#ifndef _WIN32
+class RIFFIO_MMap : public RIFFIO
+{
+    public:
+        RIFFIO_MMap(const struct RIFFIOOptions *Options);
+        ~RIFFIO_MMap();
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+        void *Reserve(uint32_t Bytes);
+        void Release(void);
+        bool Flush(bool Sync);
+
+    private:
+        int fd;
+        uint8_t *Map;
+        uint64_t MapSize;       // Bytes mapped (and allocated on disk)
+        uint64_t Extent;        // How much to grow by
+        uint64_t Pos;           // Where the next write goes
+        uint64_t FileEnd;       // The real size of the file
+        bool Reserved;          // A pointer from Reserve() is being used
+
+        bool Grow(uint64_t Needed);
+};
+
+struct DirectPatch
+{
+    uint64_t Offset;
+    std::vector<uint8_t> Data;
+};
+
+class RIFFIO_Direct : public RIFFIO
+{
+    public:
+        RIFFIO_Direct(const struct RIFFIOOptions *Options);
+        ~RIFFIO_Direct();
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+        void *Reserve(uint32_t Bytes);
+        void Release(void);
+        bool Flush(bool Sync);
+
+    private:
+        int fd;
+        uint8_t *Block;         // Aligned buffer we build each block in
+        uint32_t BlockSize;
+        uint32_t Fill;          // Bytes used in 'Block'
+        uint64_t BlockStart;    // Where in the file 'Block' goes
+        bool HadError;
+        bool Reserved;          // A pointer from Reserve() is being used
+        std::vector<struct DirectPatch> Patches;
+
+        bool FlushBlock(void);
+        void WritePatches(void);
+};
+#endif
+
+class RIFFIO_Stats : public RIFFIO
+{
+    public:
+        RIFFIO_Stats(class RIFFIO *IO,struct RIFFStats *Stats);
+        ~RIFFIO_Stats();
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+        void Advise(uint64_t Offset,uint64_t Bytes,e_RIFFIOAdviceType Advice);
+        void *Reserve(uint32_t Bytes);
+        void Release(void);
+        bool Flush(bool Sync);
+
+    private:
+        class RIFFIO *IO;
+        struct RIFFStats *Stats;
+};
+
+class RIFFIO_Memory : public RIFFIO
+{
+    public:
+        RIFFIO_Memory(std::vector<uint8_t> *Buffer,uint64_t Base);
+        bool Open(const char *Filename,bool ForWrite);
+        bool Close(void);
+        bool Read(void *Data,uint32_t Bytes);
+        bool Write(const void *Data,uint32_t Bytes);
+        bool Skip(uint64_t Bytes);
+        bool Seek(uint64_t Offset);
+        uint64_t Tell(void);
+        bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes);
+
+    private:
+        std::vector<uint8_t> *Buffer;
+        uint64_t Base;          // The file offset 'Buffer' will end up at
+};
+
+typedef std::chrono::steady_clock t_RIFFIOClock;
+
+/*** FUNCTION PROTOTYPES      ***/
+static void RIFFIO_Advise(FILE *FileHandle,uint64_t Offset,uint64_t Bytes,
+        e_RIFFIOAdviceType Advice);
+static bool RIFFIO_Sync(int fd);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Create
+ *
+ * SYNOPSIS:
+ *    class RIFFIO *RIFFIO_Create(e_RIFFIOType Type,bool ForWrite,
+ *              const struct RIFFIOOptions *Options);
+ *
+ * PARAMETERS:
+ *    Type [I] -- The type of backend to make
+ *    ForWrite [I] -- Are we going to be writing (true) or reading (false)
+ *    Options [I] -- Tuning options for the backends
+ *
+ * FUNCTION:
+ *    This function makes a new file backend of the requested type.
+ *
+ * RETURNS:
+ *    A pointer to the new backend or NULL if this type of backend can not
+ *    be used in this direction (or wasn't built in, e_RIFFIO_ReadAhead needs
+ *    RIFF_USE_READAHEAD because it needs threads).  Free it with delete.
+ *
+ * SEE ALSO:
+ *    RIFF::Open()
+ ******************************************************************************/
+class RIFFIO *RIFFIO_Create(e_RIFFIOType Type,bool ForWrite,
+        const struct RIFFIOOptions *Options)
+{
+    switch(Type)
+    {
+        case e_RIFFIO_Buffered:
+            return new RIFFIO_Buffered();
+        case e_RIFFIO_ReadAhead:
+#ifdef RIFF_USE_READAHEAD
+            if(ForWrite)
+                return NULL;
+            return new RIFFIO_ReadAhead(Options);
+#else
+            return NULL;
+#endif
+        case e_RIFFIO_MMap:
+#ifndef _WIN32
+            if(!ForWrite)
+                return NULL;
+            return new RIFFIO_MMap(Options);
+#else
+            return NULL;
+#endif
+        case e_RIFFIO_Direct:
+#ifndef _WIN32
+            if(!ForWrite)
+                return NULL;
+            return new RIFFIO_Direct(Options);
+#else
+            return NULL;
+#endif
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_CreateStats
+ *
+ * SYNOPSIS:
+ *    class RIFFIO *RIFFIO_CreateStats(class RIFFIO *IO,
+ *              struct RIFFStats *Stats);
+ *
+ * PARAMETERS:
+ *    IO [I] -- The backend to count the calls to.  This is freed when the
+ *              new backend is freed.
+ *    Stats [I] -- Where to add up the counts
+ *
+ * FUNCTION:
+ *    This function wraps a backend in one that counts the calls and bytes
+ *    going to the file and how long they took.  It is only used when stats
+ *    are turned on so there is no cost when they are off.
+ *
+ * RETURNS:
+ *    A pointer to the new backend.  Free it with delete.
+ *
+ * SEE ALSO:
+ *    RIFF::SetStats()
+ ******************************************************************************/
+class RIFFIO *RIFFIO_CreateStats(class RIFFIO *IO,struct RIFFStats *Stats)
+{
+    return new RIFFIO_Stats(IO,Stats);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_CreateMemory
+ *
+ * SYNOPSIS:
+ *    class RIFFIO *RIFFIO_CreateMemory(std::vector<uint8_t> *Buffer,
+ *              uint64_t Base);
+ *
+ * PARAMETERS:
+ *    Buffer [I] -- The buffer to write into.  This is not freed when the
+ *                  backend is.
+ *    Base [I] -- The file offset the first byte of 'Buffer' will be
+ *                written to.  Tell() and Patch() work in file offsets.
+ *
+ * FUNCTION:
+ *    This function makes a backend that writes into memory instead of a
+ *    file.  The RIFF class uses it to build a chunk before it knows where
+ *    in the file the chunk will go.  It can only be written to.
+ *
+ * RETURNS:
+ *    A pointer to the new backend.  Free it with delete.
+ *
+ * SEE ALSO:
+ *    RIFF::ReserveFront()
+ ******************************************************************************/
+class RIFFIO *RIFFIO_CreateMemory(std::vector<uint8_t> *Buffer,uint64_t Base)
+{
+    return new RIFFIO_Memory(Buffer,Base);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Buffered::RIFFIO_Buffered
+ *
+ * SYNOPSIS:
+ *    RIFFIO_Buffered::RIFFIO_Buffered();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the stdio backend.  This is the default
+ *    backend and just uses fopen()/fread()/fwrite().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFIO_Buffered::RIFFIO_Buffered()
+{
+    FileHandle=NULL;
+}
+
+RIFFIO_Buffered::~RIFFIO_Buffered()
+{
+    Close();
+}
+
+bool RIFFIO_Buffered::Open(const char *Filename,bool ForWrite)
+{
+    FileHandle=fopen(Filename,ForWrite?"wb":"rb");
+    return FileHandle!=NULL;
+}
+
+bool RIFFIO_Buffered::Close(void)
+{
+    bool RetValue;
+
+    RetValue=true;
+    if(FileHandle!=NULL && fclose(FileHandle)!=0)
+        RetValue=false;
+    FileHandle=NULL;
+
+    return RetValue;
+}
+
+bool RIFFIO_Buffered::Read(void *Data,uint32_t Bytes)
+{
+    if(Bytes==0)
+        return true;
+    return fread(Data,Bytes,1,FileHandle)==1;
+}
+
+bool RIFFIO_Buffered::Write(const void *Data,uint32_t Bytes)
+{
+    if(Bytes==0)
+        return true;
+    return fwrite(Data,Bytes,1,FileHandle)==1;
+}
+
+bool RIFFIO_Buffered::Skip(uint64_t Bytes)
+{
+    return RIFF_FSEEK(FileHandle,Bytes,SEEK_CUR)==0;
+}
+
+bool RIFFIO_Buffered::Seek(uint64_t Offset)
+{
+    return RIFF_FSEEK(FileHandle,Offset,SEEK_SET)==0;
+}
+
+uint64_t RIFFIO_Buffered::Tell(void)
+{
+    return RIFF_FTELL(FileHandle);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Buffered::Patch
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Buffered::Patch(uint64_t Offset,const void *Data,
+ *              uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- Where in the file to write the bytes
+ *    Data [I] -- The bytes to write
+ *    Bytes [I] -- The number of bytes to write
+ *
+ * FUNCTION:
+ *    This function writes over bytes that have already been written (like
+ *    the size of a chunk) and then goes back to where we where.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_Buffered::Patch(uint64_t Offset,const void *Data,uint32_t Bytes)
+{
+    int64_t Pos;
+
+    Pos=RIFF_FTELL(FileHandle);
+    if(Pos<0)
+        return false;
+
+    if(RIFF_FSEEK(FileHandle,Offset,SEEK_SET)!=0)
+        return false;
+    if(fwrite(Data,Bytes,1,FileHandle)!=1)
+        return false;
+    return RIFF_FSEEK(FileHandle,Pos,SEEK_SET)==0;
+}
+
+void RIFFIO_Buffered::Advise(uint64_t Offset,uint64_t Bytes,
+        e_RIFFIOAdviceType Advice)
+{
+    RIFFIO_Advise(FileHandle,Offset,Bytes,Advice);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Buffered::Flush
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Buffered::Flush(bool Sync);
+ *
+ * PARAMETERS:
+ *    Sync [I] -- Wait for the data to get to the disk as well
+ *
+ * FUNCTION:
+ *    This function hands what is in the stdio buffer to the OS, so other
+ *    programs reading the file see it.  With 'Sync' it also waits for it
+ *    (and what was handed over before) to be written to the disk.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *    RIFF::Commit()
+ ******************************************************************************/
+bool RIFFIO_Buffered::Flush(bool Sync)
+{
+    if(FileHandle==NULL || fflush(FileHandle)!=0)
+        return false;
+
+    if(Sync)
+    {
+#ifdef _WIN32
+        return RIFFIO_Sync(_fileno(FileHandle));
+#else
+        return RIFFIO_Sync(fileno(FileHandle));
+#endif
+    }
+
+    return true;
+}
+
+#ifdef RIFF_USE_READAHEAD
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::RIFFIO_ReadAhead
+ *
+ * SYNOPSIS:
+ *    RIFFIO_ReadAhead::RIFFIO_ReadAhead(const struct RIFFIOOptions *Options);
+ *
+ * PARAMETERS:
+ *    Options [I] -- The size and number of buffers to use.  0 for either
+ *                   uses the default.
+ *
+ * FUNCTION:
+ *    This is the constructor for the read ahead backend.  This backend has
+ *    a thread that reads the file ahead of the caller into a ring of
+ *    buffers, so disk reads happen while the caller is working on the last
+ *    block of data.
+ *
+ *    Skipping forward inside the buffered data is free.  Skipping past it
+ *    (or seeking) throws away the buffers and starts reading ahead from
+ *    the new place.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFIO_ReadAhead::RIFFIO_ReadAhead(const struct RIFFIOOptions *Options)
+{
+    unsigned Count;
+    unsigned r;
+
+    FileHandle=NULL;
+
+    BufferSize=Options->ReadAheadBufferSize;
+    if(BufferSize==0)
+        BufferSize=READAHEAD_DEFAULT_BUFFER_SIZE;
+    Count=Options->ReadAheadBuffers;
+    if(Count<2)
+        Count=READAHEAD_DEFAULT_BUFFERS;
+
+    Buffers.resize(Count);
+    for(r=0;r<Count;r++)
+    {
+        Buffers[r].Offset=0;
+        Buffers[r].Bytes=0;
+    }
+
+    Head=0;
+    Filled=0;
+    ReadPos=0;
+    FetchPos=0;
+    Generation=0;
+    AtEOF=false;
+    HadError=false;
+    Quit=false;
+}
+
+RIFFIO_ReadAhead::~RIFFIO_ReadAhead()
+{
+    Close();
+}
+
+bool RIFFIO_ReadAhead::Open(const char *Filename,bool ForWrite)
+{
+    unsigned r;
+
+    if(ForWrite)
+        return false;
+
+    FileHandle=fopen(Filename,"rb");
+    if(FileHandle==NULL)
+        return false;
+
+    /* We do our own buffering */
+    setvbuf(FileHandle,NULL,_IONBF,0);
+
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fileno(FileHandle),0,0,POSIX_FADV_SEQUENTIAL);
+#endif
+
+    for(r=0;r<Buffers.size();r++)
+        Buffers[r].Data.resize(BufferSize);
+
+    Quit=false;
+    Thread=std::thread(&RIFFIO_ReadAhead::ReadAheadThread,this);
+
+    return true;
+}
+
+bool RIFFIO_ReadAhead::Close(void)
+{
+    if(Thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            Quit=true;
+        }
+        BufferFreed.notify_all();
+        Thread.join();
+    }
+
+    if(FileHandle!=NULL)
+        fclose(FileHandle);
+    FileHandle=NULL;
+
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::Read
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_ReadAhead::Read(void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [O] -- Where to copy the bytes to
+ *    Bytes [I] -- The number of bytes to read
+ *
+ * FUNCTION:
+ *    This function copies bytes out of the read ahead buffers, waiting for
+ *    the read ahead thread if it hasn't got to them yet.  Each buffer is
+ *    handed back to the thread as soon as we are done with it.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error or we hit the end of the file.
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_ReadAhead::Read(void *Data,uint32_t Bytes)
+{
+    uint8_t *Dest;
+    struct ReadAheadBuffer *Buff;
+    uint32_t Offset;
+    uint32_t Copy;
+
+    Dest=(uint8_t *)Data;
+    while(Bytes>0)
+    {
+        {
+            std::unique_lock<std::mutex> Guard(Lock);
+            while(Filled==0 && !AtEOF && !HadError)
+                BufferFilled.wait(Guard);
+            if(Filled==0)
+                return false;
+            Buff=&Buffers[Head];
+        }
+
+        /* The thread will not touch a filled buffer, so we can copy
+           without the lock */
+        Offset=ReadPos-Buff->Offset;
+        Copy=Buff->Bytes-Offset;
+        if(Copy>Bytes)
+            Copy=Bytes;
+        memcpy(Dest,&Buff->Data[Offset],Copy);
+
+        Dest+=Copy;
+        Bytes-=Copy;
+        ReadPos+=Copy;
+
+        if(ReadPos>=Buff->Offset+Buff->Bytes)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            Head=(Head+1)%Buffers.size();
+            Filled--;
+            BufferFreed.notify_all();
+        }
+    }
+    return true;
+}
+
+bool RIFFIO_ReadAhead::Write(const void * /*Data*/,uint32_t /*Bytes*/)
+{
+    return false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::Skip
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_ReadAhead::Skip(uint64_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes to skip forward
+ *
+ * FUNCTION:
+ *    This function skips bytes in the file.  If the bytes have already been
+ *    read ahead we just step over them, else we restart the read ahead at
+ *    the new place.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_ReadAhead::Skip(uint64_t Bytes)
+{
+    uint64_t NewPos;
+    struct ReadAheadBuffer *Buff;
+
+    NewPos=ReadPos+Bytes;
+
+    std::unique_lock<std::mutex> Guard(Lock);
+    while(Filled>0)
+    {
+        Buff=&Buffers[Head];
+        if(NewPos<Buff->Offset+Buff->Bytes)
+        {
+            /* It's in this buffer */
+            ReadPos=NewPos;
+            return true;
+        }
+
+        /* Done with this buffer */
+        Head=(Head+1)%Buffers.size();
+        Filled--;
+        BufferFreed.notify_all();
+    }
+    Guard.unlock();
+
+    Restart(NewPos);
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::Seek
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_ReadAhead::Seek(uint64_t Offset);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- The place in the file to move to
+ *
+ * FUNCTION:
+ *    This function moves to a new place in the file.  Going forward is a
+ *    Skip().  Going back into the buffer we are reading from (it is kept
+ *    until we read past the end of it) just moves back in it, only going
+ *    back further than that restarts the read ahead.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *    RIFFIO_ReadAhead::Skip(), RIFFIO_ReadAhead::Restart()
+ ******************************************************************************/
+bool RIFFIO_ReadAhead::Seek(uint64_t Offset)
+{
+    if(Offset>=ReadPos)
+        return Skip(Offset-ReadPos);
+
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        if(Filled>0 && Offset>=Buffers[Head].Offset)
+        {
+            ReadPos=Offset;
+            return true;
+        }
+    }
+
+    Restart(Offset);
+    return true;
+}
+
+uint64_t RIFFIO_ReadAhead::Tell(void)
+{
+    return ReadPos;
+}
+
+bool RIFFIO_ReadAhead::Patch(uint64_t /*Offset*/,const void * /*Data*/,
+        uint32_t /*Bytes*/)
+{
+    return false;
+}
+
+void RIFFIO_ReadAhead::Advise(uint64_t Offset,uint64_t Bytes,
+        e_RIFFIOAdviceType Advice)
+{
+    RIFFIO_Advise(FileHandle,Offset,Bytes,Advice);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::Restart
+ *
+ * SYNOPSIS:
+ *    void RIFFIO_ReadAhead::Restart(uint64_t Offset);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- The place in the file to start reading ahead from
+ *
+ * FUNCTION:
+ *    This function throws away everything that has been read ahead and
+ *    starts the read ahead thread going again from a new place.
+ *
+ *    If the thread is in the middle of a read it will throw that read away
+ *    when it sees 'Generation' has changed.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFIO_ReadAhead::Restart(uint64_t Offset)
+{
+    std::lock_guard<std::mutex> Guard(Lock);
+
+    Generation++;
+    Head=0;
+    Filled=0;
+    ReadPos=Offset;
+    FetchPos=Offset;
+    AtEOF=false;
+    HadError=false;
+    BufferFreed.notify_all();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_ReadAhead::ReadAheadThread
+ *
+ * SYNOPSIS:
+ *    void RIFFIO_ReadAhead::ReadAheadThread(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the read ahead thread.  It fills any free buffers with the next
+ *    bytes from the file, and tells the kernel about the bytes after that
+ *    so they are on their way in by the time we get there.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFIO_ReadAhead::ReadAheadThread(void)
+{
+    struct ReadAheadBuffer *Buff;
+    uint64_t FilePos;
+    uint64_t Offset;
+    unsigned Gen;
+    size_t Got;
+    bool Error;
+
+    FilePos=0;
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> Guard(Lock);
+            while(!Quit && (Filled==Buffers.size() || AtEOF || HadError))
+                BufferFreed.wait(Guard);
+            if(Quit)
+                return;
+
+            Buff=&Buffers[(Head+Filled)%Buffers.size()];
+            Offset=FetchPos;
+            Gen=Generation;
+        }
+
+        Error=false;
+        if(FilePos!=Offset)
+        {
+            if(RIFF_FSEEK(FileHandle,Offset,SEEK_SET)!=0)
+                Error=true;
+            FilePos=Offset;
+        }
+
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+        /* Get the kernel started on the block after this one */
+        posix_fadvise(fileno(FileHandle),Offset+BufferSize,BufferSize,
+                POSIX_FADV_WILLNEED);
+#endif
+
+        Got=0;
+        if(!Error)
+        {
+            Got=fread(Buff->Data.data(),1,BufferSize,FileHandle);
+            if(Got<BufferSize && ferror(FileHandle))
+            {
+                Error=true;
+                clearerr(FileHandle);
+            }
+            if(Got<BufferSize)
+                clearerr(FileHandle);
+            FilePos+=Got;
+        }
+
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            if(Gen!=Generation)
+                continue;       // Someone seeked while we were reading
+
+            if(Error)
+            {
+                HadError=true;
+            }
+            else
+            {
+                if(Got>0)
+                {
+                    Buff->Offset=Offset;
+                    Buff->Bytes=Got;
+                    Filled++;
+                    FetchPos+=Got;
+                }
+                if(Got<BufferSize)
+                    AtEOF=true;
+            }
+        }
+        BufferFilled.notify_all();
+    }
+}
+#endif
+
+#ifndef _WIN32
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_MMap::RIFFIO_MMap
+ *
+ * SYNOPSIS:
+ *    RIFFIO_MMap::RIFFIO_MMap(const struct RIFFIOOptions *Options);
+ *
+ * PARAMETERS:
+ *    Options [I] -- How much to grow the file by each time it fills up.
+ *                   0 uses the default (64M).
+ *
+ * FUNCTION:
+ *    This is the constructor for the memory mapped write backend.  The file
+ *    is allocated on disk in big extents and mapped into memory.  Writes
+ *    are just a memcpy() into the map (no system call), and Reserve() lets
+ *    the caller fill the file in place with no copy at all.
+ *
+ *    The file is cut back to the real size when it is closed.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFIO_MMap::RIFFIO_MMap(const struct RIFFIOOptions *Options)
+{
+    long PageSize;
+
+    fd=-1;
+    Map=NULL;
+    MapSize=0;
+    Pos=0;
+    FileEnd=0;
+    Reserved=false;
+
+    Extent=Options->MMapExtent;
+    if(Extent==0)
+        Extent=MMAP_DEFAULT_EXTENT;
+
+    /* Keep the map a multiple of the page size */
+    PageSize=sysconf(_SC_PAGESIZE);
+    if(PageSize<=0)
+        PageSize=4096;
+    Extent=(Extent+PageSize-1)/PageSize*PageSize;
+}
+
+RIFFIO_MMap::~RIFFIO_MMap()
+{
+    Close();
+}
+
+bool RIFFIO_MMap::Open(const char *Filename,bool ForWrite)
+{
+    if(!ForWrite)
+        return false;
+
+    fd=open(Filename,O_RDWR|O_CREAT|O_TRUNC,0666);
+    if(fd<0)
+        return false;
+
+    if(!Grow(Extent))
+    {
+        close(fd);
+        fd=-1;
+        return false;
+    }
+    return true;
+}
+
+bool RIFFIO_MMap::Close(void)
+{
+    bool RetValue;
+
+    RetValue=true;
+    if(Map!=NULL && munmap(Map,MapSize)!=0)
+        RetValue=false;
+    Map=NULL;
+
+    if(fd>=0)
+    {
+        /* Give back what we didn't use */
+        if(ftruncate(fd,FileEnd)!=0)
+            RetValue=false;
+        if(close(fd)!=0)
+            RetValue=false;
+    }
+    fd=-1;
+    MapSize=0;
+
+    return RetValue;
+}
+
+bool RIFFIO_MMap::Read(void *Data,uint32_t Bytes)
+{
+    if(Pos+Bytes>FileEnd)
+        return false;
+    memcpy(Data,&Map[Pos],Bytes);
+    Pos+=Bytes;
+    return true;
+}
+
+bool RIFFIO_MMap::Write(const void *Data,uint32_t Bytes)
+{
+    if(Pos+Bytes>MapSize && !Grow(Pos+Bytes))
+        return false;
+
+    memcpy(&Map[Pos],Data,Bytes);
+    Pos+=Bytes;
+    if(Pos>FileEnd)
+        FileEnd=Pos;
+
+    return true;
+}
+
+bool RIFFIO_MMap::Skip(uint64_t Bytes)
+{
+    return Seek(Pos+Bytes);
+}
+
+bool RIFFIO_MMap::Seek(uint64_t Offset)
+{
+    if(Offset>FileEnd)
+        return false;
+    Pos=Offset;
+    return true;
+}
+
+uint64_t RIFFIO_MMap::Tell(void)
+{
+    return Pos;
+}
+
+bool RIFFIO_MMap::Patch(uint64_t Offset,const void *Data,uint32_t Bytes)
+{
+    if(Offset+Bytes>FileEnd)
+        return false;
+    memcpy(&Map[Offset],Data,Bytes);
+    return true;
+}
+
+/* The map is shared, so other programs already see what we have written.
+   Only syncing has anything to do. */
+bool RIFFIO_MMap::Flush(bool Sync)
+{
+    if(Map==NULL)
+        return false;
+
+    if(Sync && FileEnd>0 && msync(Map,FileEnd,MS_SYNC)!=0)
+        return false;
+
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_MMap::Reserve
+ *
+ * SYNOPSIS:
+ *    void *RIFFIO_MMap::Reserve(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes to reserve
+ *
+ * FUNCTION:
+ *    This function reserves the next 'Bytes' bytes of the file and returns
+ *    a pointer to them in the map, so the caller can fill them in place.
+ *    The bytes count as written.
+ *
+ * RETURNS:
+ *    A pointer to the bytes in the file, or NULL if the file could not be
+ *    grown.  The pointer is good until Release() is called.  The map can't
+ *    grow (and move) until then, so writes that need more room fail.
+ *
+ * SEE ALSO:
+ *    RIFFIO_MMap::Release()
+ ******************************************************************************/
+void *RIFFIO_MMap::Reserve(uint32_t Bytes)
+{
+    uint8_t *Ptr;
+
+    if(Pos+Bytes>MapSize && !Grow(Pos+Bytes))
+        return NULL;
+
+    Ptr=&Map[Pos];
+    Pos+=Bytes;
+    if(Pos>FileEnd)
+        FileEnd=Pos;
+    Reserved=true;
+
+    return Ptr;
+}
+
+/* The caller is done with the pointer from Reserve() */
+void RIFFIO_MMap::Release(void)
+{
+    Reserved=false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_MMap::Grow
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_MMap::Grow(uint64_t Needed);
+ *
+ * PARAMETERS:
+ *    Needed [I] -- The number of bytes the file needs to hold
+ *
+ * FUNCTION:
+ *    This function grows the file by whole extents until it can hold
+ *    'Needed' bytes, allocates the new space on disk and maps it.
+ *
+ *    We allocate the space for real (with fallocate()) so running out of
+ *    disk shows up here instead of as a SIGBUS when we touch the map.  Only
+ *    if the file system can't allocate space do we fall back to making the
+ *    file bigger without allocating it.
+ *
+ *    The map isn't grown while a pointer from Reserve() is being used
+ *    because it may move.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- We could not grow the file
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_MMap::Grow(uint64_t Needed)
+{
+    uint64_t NewSize;
+    void *NewMap;
+    int Err;
+
+    if(Reserved)
+        return false;
+
+    NewSize=MapSize;
+    while(NewSize<Needed)
+        NewSize+=Extent;
+
+#if defined(__linux__)
+    Err=0;
+    if(fallocate(fd,0,MapSize,NewSize-MapSize)!=0)
+        Err=errno;
+#else
+    Err=posix_fallocate(fd,MapSize,NewSize-MapSize);
+#endif
+    if(Err!=0)
+    {
+        /* Out of disk (ENOSPC) etc, only go sparse if we can't allocate */
+        if(Err!=EOPNOTSUPP && Err!=ENOSYS)
+            return false;
+        if(ftruncate(fd,NewSize)!=0)
+            return false;
+    }
+
+#if defined(__linux__)
+    if(Map!=NULL)
+        NewMap=mremap(Map,MapSize,NewSize,MREMAP_MAYMOVE);
+    else
+        NewMap=mmap(NULL,NewSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+#else
+    if(Map!=NULL)
+        munmap(Map,MapSize);
+    Map=NULL;
+    NewMap=mmap(NULL,NewSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+#endif
+    if(NewMap==MAP_FAILED)
+        return false;
+
+    Map=(uint8_t *)NewMap;
+    MapSize=NewSize;
+
+    return true;
+}
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::RIFFIO_Direct
+ *
+ * SYNOPSIS:
+ *    RIFFIO_Direct::RIFFIO_Direct(const struct RIFFIOOptions *Options);
+ *
+ * PARAMETERS:
+ *    Options [I] -- The size of the blocks to write.  0 uses the default (1M).
+ *                   This is rounded up to a multiple of 4K.
+ *
+ * FUNCTION:
+ *    This is the constructor for the direct I/O write backend.  The file is
+ *    opened with O_DIRECT so the data goes straight to the disk without
+ *    going through (and pushing everything else out of) the page cache.
+ *
+ *    Writes are built up in an aligned block and written a full block at
+ *    a time.  Size patches that land in the block we are building are
+ *    made in memory.  Patches to blocks already on the disk are saved up
+ *    and made at Close(), after the last (partial) block has been written
+ *    and the file has been cut back to its real size.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFIO_Direct::RIFFIO_Direct(const struct RIFFIOOptions *Options)
+{
+    fd=-1;
+    Block=NULL;
+    Fill=0;
+    BlockStart=0;
+    HadError=false;
+    Reserved=false;
+
+    BlockSize=Options->DirectBlockSize;
+    if(BlockSize==0)
+        BlockSize=DIRECT_DEFAULT_BLOCK_SIZE;
+    BlockSize=(BlockSize+DIRECT_ALIGNMENT-1)/DIRECT_ALIGNMENT*DIRECT_ALIGNMENT;
+}
+
+RIFFIO_Direct::~RIFFIO_Direct()
+{
+    Close();
+}
+
+bool RIFFIO_Direct::Open(const char *Filename,bool ForWrite)
+{
+    void *Mem;
+
+    if(!ForWrite)
+        return false;
+
+    if(posix_memalign(&Mem,DIRECT_ALIGNMENT,BlockSize)!=0)
+        return false;
+    Block=(uint8_t *)Mem;
+
+#if defined(O_DIRECT)
+    fd=open(Filename,O_WRONLY|O_CREAT|O_TRUNC|O_DIRECT,0666);
+    if(fd<0 && errno==EINVAL)
+    {
+        /* This file system can't do direct I/O (tmpfs for example), so
+           we just do normal writes of big blocks */
+        fd=open(Filename,O_WRONLY|O_CREAT|O_TRUNC,0666);
+    }
+#else
+    fd=open(Filename,O_WRONLY|O_CREAT|O_TRUNC,0666);
+#if defined(F_NOCACHE)
+    if(fd>=0)
+        fcntl(fd,F_NOCACHE,1);
+#endif
+#endif
+    if(fd<0)
+    {
+        free(Block);
+        Block=NULL;
+        return false;
+    }
+
+    Fill=0;
+    BlockStart=0;
+    HadError=false;
+    Patches.clear();
+
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::Close
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Direct::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes out the last block (padded out to the alignment
+ *    direct I/O needs), cuts the file back to its real size and then
+ *    makes any patches that landed on blocks that where already written.
+ *
+ *    The patches are done with O_DIRECT turned off because they are only
+ *    a few bytes each.
+ *
+ * RETURNS:
+ *    true -- Everything made it to the disk
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_Direct::Close(void)
+{
+    uint64_t FileEnd;
+    uint32_t Padded;
+
+    if(fd<0)
+        return true;
+
+    FileEnd=BlockStart+Fill;
+
+    if(Fill>0)
+    {
+        Padded=(Fill+DIRECT_ALIGNMENT-1)/DIRECT_ALIGNMENT*DIRECT_ALIGNMENT;
+        memset(&Block[Fill],0,Padded-Fill);
+        if(pwrite(fd,Block,Padded,BlockStart)!=(ssize_t)Padded)
+            HadError=true;
+    }
+
+    if(ftruncate(fd,FileEnd)!=0)
+        HadError=true;
+
+    WritePatches();
+
+    if(close(fd)!=0)
+        HadError=true;
+    fd=-1;
+
+    free(Block);
+    Block=NULL;
+
+    return !HadError;
+}
+
+bool RIFFIO_Direct::Read(void * /*Data*/,uint32_t /*Bytes*/)
+{
+    return false;
+}
+
+bool RIFFIO_Direct::Write(const void *Data,uint32_t Bytes)
+{
+    const uint8_t *Src;
+    uint32_t Copy;
+
+    if(HadError)
+        return false;
+
+    Src=(const uint8_t *)Data;
+    while(Bytes>0)
+    {
+        if(Fill==BlockSize && !FlushBlock())
+            return false;
+
+        Copy=BlockSize-Fill;
+        if(Copy>Bytes)
+            Copy=Bytes;
+        memcpy(&Block[Fill],Src,Copy);
+        Fill+=Copy;
+        Src+=Copy;
+        Bytes-=Copy;
+    }
+    return true;
+}
+
+bool RIFFIO_Direct::Skip(uint64_t /*Bytes*/)
+{
+    return false;
+}
+
+bool RIFFIO_Direct::Seek(uint64_t /*Offset*/)
+{
+    return false;
+}
+
+uint64_t RIFFIO_Direct::Tell(void)
+{
+    return BlockStart+Fill;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::Patch
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Direct::Patch(uint64_t Offset,const void *Data,
+ *              uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- Where in the file to write the bytes
+ *    Data [I] -- The bytes to write
+ *    Bytes [I] -- The number of bytes to write
+ *
+ * FUNCTION:
+ *    This function writes over bytes that have already been written.  If
+ *    the bytes are still in the block we are building they are changed in
+ *    memory, otherwise the patch is saved until Close().  A patch can be
+ *    split between the two.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_Direct::Patch(uint64_t Offset,const void *Data,uint32_t Bytes)
+{
+    const uint8_t *Src;
+    struct DirectPatch NewPatch;
+    uint32_t OnDisk;
+
+    if(Offset+Bytes>BlockStart+Fill)
+        return false;
+
+    Src=(const uint8_t *)Data;
+
+    if(Offset<BlockStart)
+    {
+        OnDisk=Bytes;
+        if(Offset+OnDisk>BlockStart)
+            OnDisk=BlockStart-Offset;
+
+        NewPatch.Offset=Offset;
+        NewPatch.Data.assign(Src,Src+OnDisk);
+        Patches.push_back(NewPatch);
+
+        Offset+=OnDisk;
+        Src+=OnDisk;
+        Bytes-=OnDisk;
+    }
+
+    if(Bytes>0)
+        memcpy(&Block[Offset-BlockStart],Src,Bytes);
+
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::Reserve
+ *
+ * SYNOPSIS:
+ *    void *RIFFIO_Direct::Reserve(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The number of bytes to reserve
+ *
+ * FUNCTION:
+ *    This function reserves the next 'Bytes' bytes in the block we are
+ *    building, if they fit.
+ *
+ * RETURNS:
+ *    A pointer to the bytes in the block or NULL if they don't fit in what
+ *    is left of the block.  The block isn't written out until Release() is
+ *    called, so writes that fill it fail until then.
+ *
+ * SEE ALSO:
+ *    RIFFIO_Direct::Release()
+ ******************************************************************************/
+void *RIFFIO_Direct::Reserve(uint32_t Bytes)
+{
+    uint8_t *Ptr;
+
+    if(HadError)
+        return NULL;
+
+    if(Fill==BlockSize && !FlushBlock())
+        return NULL;
+
+    if(Fill+Bytes>BlockSize)
+        return NULL;
+
+    Ptr=&Block[Fill];
+    Fill+=Bytes;
+    Reserved=true;
+
+    return Ptr;
+}
+
+/* The caller is done with the pointer from Reserve() */
+void RIFFIO_Direct::Release(void)
+{
+    Reserved=false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::FlushBlock
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Direct::FlushBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes the (full) block we have been building to the
+ *    disk and starts a new one.  It refuses while a pointer from Reserve()
+ *    is still being filled in.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+bool RIFFIO_Direct::FlushBlock(void)
+{
+    if(Reserved)
+        return false;
+
+    if(pwrite(fd,Block,BlockSize,BlockStart)!=(ssize_t)BlockSize)
+    {
+        HadError=true;
+        return false;
+    }
+
+    BlockStart+=BlockSize;
+    Fill=0;
+
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::WritePatches
+ *
+ * SYNOPSIS:
+ *    void RIFFIO_Direct::WritePatches(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function makes the patches that landed on blocks that where
+ *    already written.  They are done with O_DIRECT turned off because they
+ *    are only a few bytes each.  Errors are saved in 'HadError'.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFIO_Direct::Patch()
+ ******************************************************************************/
+void RIFFIO_Direct::WritePatches(void)
+{
+    unsigned r;
+    int Flags;
+
+    if(Patches.empty())
+        return;
+
+    Flags=fcntl(fd,F_GETFL);
+#if defined(O_DIRECT)
+    if(Flags!=-1)
+        fcntl(fd,F_SETFL,Flags&~O_DIRECT);
+#endif
+    for(r=0;r<Patches.size();r++)
+    {
+        if(pwrite(fd,Patches[r].Data.data(),Patches[r].Data.size(),
+                Patches[r].Offset)!=(ssize_t)Patches[r].Data.size())
+        {
+            HadError=true;
+        }
+    }
+    Patches.clear();
+#if defined(O_DIRECT)
+    if(Flags!=-1)
+        fcntl(fd,F_SETFL,Flags);
+#endif
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Direct::Flush
+ *
+ * SYNOPSIS:
+ *    bool RIFFIO_Direct::Flush(bool Sync);
+ *
+ * PARAMETERS:
+ *    Sync [I] -- Wait for the data to get to the disk as well
+ *
+ * FUNCTION:
+ *    This function writes the part of the block we are building that is
+ *    filled in (padded out to the alignment, it is written again when it is
+ *    full) and makes the patches that are being held for Close(), so other
+ *    programs reading the file see everything written so far.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *    RIFF::Commit()
+ ******************************************************************************/
+bool RIFFIO_Direct::Flush(bool Sync)
+{
+    uint32_t Padded;
+
+    if(fd<0)
+        return false;
+
+    if(Fill>0)
+    {
+        Padded=(Fill+DIRECT_ALIGNMENT-1)/DIRECT_ALIGNMENT*DIRECT_ALIGNMENT;
+        memset(&Block[Fill],0,Padded-Fill);
+        if(pwrite(fd,Block,Padded,BlockStart)!=(ssize_t)Padded)
+            HadError=true;
+    }
+
+    WritePatches();
+
+    if(Sync && !RIFFIO_Sync(fd))
+        HadError=true;
+
+    return !HadError;
+}
+#endif
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Stats::RIFFIO_Stats
+ *
+ * SYNOPSIS:
+ *    RIFFIO_Stats::RIFFIO_Stats(class RIFFIO *IO,struct RIFFStats *Stats);
+ *
+ * PARAMETERS:
+ *    IO [I] -- The backend that does the real work
+ *    Stats [I] -- Where to add up the counts
+ *
+ * FUNCTION:
+ *    This is the constructor for the backend that counts calls to another
+ *    backend.  Every call is passed on to 'IO' and timed.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFIO_CreateStats()
+ ******************************************************************************/
+RIFFIO_Stats::RIFFIO_Stats(class RIFFIO *IO,struct RIFFStats *Stats)
+{
+    this->IO=IO;
+    this->Stats=Stats;
+}
+
+RIFFIO_Stats::~RIFFIO_Stats()
+{
+    delete IO;
+}
+
+bool RIFFIO_Stats::Open(const char *Filename,bool ForWrite)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Open(Filename,ForWrite);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+
+    return RetValue;
+}
+
+/* Close() is timed because this is where most backends flush */
+bool RIFFIO_Stats::Close(void)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Close();
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+
+    return RetValue;
+}
+
+bool RIFFIO_Stats::Read(void *Data,uint32_t Bytes)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Read(Data,Bytes);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+    Stats->IORead.Calls++;
+    Stats->IORead.Bytes+=Bytes;
+
+    return RetValue;
+}
+
+bool RIFFIO_Stats::Write(const void *Data,uint32_t Bytes)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Write(Data,Bytes);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+    Stats->IOWrite.Calls++;
+    Stats->IOWrite.Bytes+=Bytes;
+
+    return RetValue;
+}
+
+bool RIFFIO_Stats::Skip(uint64_t Bytes)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Skip(Bytes);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+    Stats->IOSkip.Calls++;
+    Stats->IOSkip.Bytes+=Bytes;
+
+    return RetValue;
+}
+
+bool RIFFIO_Stats::Seek(uint64_t Offset)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Seek(Offset);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+    Stats->IOSeek++;
+
+    return RetValue;
+}
+
+uint64_t RIFFIO_Stats::Tell(void)
+{
+    return IO->Tell();
+}
+
+bool RIFFIO_Stats::Patch(uint64_t Offset,const void *Data,uint32_t Bytes)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Patch(Offset,Data,Bytes);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+    Stats->IOPatch.Calls++;
+    Stats->IOPatch.Bytes+=Bytes;
+
+    return RetValue;
+}
+
+void RIFFIO_Stats::Advise(uint64_t Offset,uint64_t Bytes,
+        e_RIFFIOAdviceType Advice)
+{
+    IO->Advise(Offset,Bytes,Advice);
+}
+
+void *RIFFIO_Stats::Reserve(uint32_t Bytes)
+{
+    return IO->Reserve(Bytes);
+}
+
+void RIFFIO_Stats::Release(void)
+{
+    IO->Release();
+}
+
+bool RIFFIO_Stats::Flush(bool Sync)
+{
+    t_RIFFIOClock::time_point Start;
+    bool RetValue;
+
+    Start=t_RIFFIOClock::now();
+    RetValue=IO->Flush(Sync);
+    Stats->IONanoseconds+=std::chrono::duration_cast<std::chrono::nanoseconds>(
+            t_RIFFIOClock::now()-Start).count();
+
+    return RetValue;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Memory::RIFFIO_Memory
+ *
+ * SYNOPSIS:
+ *    RIFFIO_Memory::RIFFIO_Memory(std::vector<uint8_t> *Buffer,
+ *              uint64_t Base);
+ *
+ * PARAMETERS:
+ *    Buffer [I] -- The buffer to write into
+ *    Base [I] -- The file offset the start of 'Buffer' stands for
+ *
+ * FUNCTION:
+ *    This is the constructor for the backend that writes to memory.  Writes
+ *    are added to the end of 'Buffer'.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFIO_CreateMemory()
+ ******************************************************************************/
+RIFFIO_Memory::RIFFIO_Memory(std::vector<uint8_t> *Buffer,uint64_t Base)
+{
+    this->Buffer=Buffer;
+    this->Base=Base;
+}
+
+bool RIFFIO_Memory::Open(const char * /*Filename*/,bool ForWrite)
+{
+    return ForWrite;
+}
+
+bool RIFFIO_Memory::Close(void)
+{
+    return true;
+}
+
+bool RIFFIO_Memory::Read(void * /*Data*/,uint32_t /*Bytes*/)
+{
+    return false;
+}
+
+bool RIFFIO_Memory::Write(const void *Data,uint32_t Bytes)
+{
+    Buffer->insert(Buffer->end(),(const uint8_t *)Data,
+            (const uint8_t *)Data+Bytes);
+    return true;
+}
+
+bool RIFFIO_Memory::Skip(uint64_t /*Bytes*/)
+{
+    return false;
+}
+
+bool RIFFIO_Memory::Seek(uint64_t /*Offset*/)
+{
+    return false;
+}
+
+uint64_t RIFFIO_Memory::Tell(void)
+{
+    return Base+Buffer->size();
+}
+
+bool RIFFIO_Memory::Patch(uint64_t Offset,const void *Data,uint32_t Bytes)
+{
+    if(Offset<Base || Offset-Base+Bytes>Buffer->size())
+        return false;
+
+    memcpy(Buffer->data()+(Offset-Base),Data,Bytes);
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Advise
+ *
+ * SYNOPSIS:
+ *    static void RIFFIO_Advise(FILE *FileHandle,uint64_t Offset,
+ *              uint64_t Bytes,e_RIFFIOAdviceType Advice);
+ *
+ * PARAMETERS:
+ *    FileHandle [I] -- The file to give the hint about
+ *    Offset [I] -- The start of the bytes the hint is for
+ *    Bytes [I] -- The number of bytes the hint is for.  0 means to the end
+ *                 of the file.
+ *    Advice [I] -- The hint to give:
+ *                      e_RIFFIOAdvice_Random -- We will be jumping around
+ *                          so don't bother reading ahead.
+ *                      e_RIFFIOAdvice_WillNeed -- We are going to read
+ *                          these bytes soon, start reading them in.
+ *                      e_RIFFIOAdvice_DontNeed -- We are done with these
+ *                          bytes, they can be dropped from the cache.
+ *
+ * FUNCTION:
+ *    This function passes a hint about how we are going to use the file
+ *    on to the OS.  This is only a hint and does nothing on systems without
+ *    posix_fadvise().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+static void RIFFIO_Advise(FILE *FileHandle,uint64_t Offset,uint64_t Bytes,
+        e_RIFFIOAdviceType Advice)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    int PosixAdvice;
+
+    if(FileHandle==NULL)
+        return;
+
+    switch(Advice)
+    {
+        case e_RIFFIOAdvice_Random:
+            PosixAdvice=POSIX_FADV_RANDOM;
+        break;
+        case e_RIFFIOAdvice_WillNeed:
+            PosixAdvice=POSIX_FADV_WILLNEED;
+        break;
+        case e_RIFFIOAdvice_DontNeed:
+            PosixAdvice=POSIX_FADV_DONTNEED;
+        break;
+        default:
+            return;
+    }
+
+    posix_fadvise(fileno(FileHandle),Offset,Bytes,PosixAdvice);
+#endif
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFIO_Sync
+ *
+ * SYNOPSIS:
+ *    static bool RIFFIO_Sync(int fd);
+ *
+ * PARAMETERS:
+ *    fd [I] -- The file to sync
+ *
+ * FUNCTION:
+ *    This function waits for the data written to a file to get to the
+ *    disk.  Where there is a choice only the data (and the size) is synced,
+ *    not the times on the file.
+ *
+ * RETURNS:
+ *    true -- Things worked out
+ *    false -- There was an error
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+static bool RIFFIO_Sync(int fd)
+{
+#if defined(_WIN32)
+    return _commit(fd)==0;
+#elif defined(__APPLE__)
+    return fsync(fd)==0;
+#else
+    return fdatasync(fd)==0;
+#endif
+}
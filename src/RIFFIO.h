@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * FILENAME: RIFFIO.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is the .h file for the file access backends used by the RIFF class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFIO_H_
+#define __RIFFIO_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+/***  DEFINES                          ***/
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+typedef enum
+{
+    e_RIFFIOAdvice_Random,
+    e_RIFFIOAdvice_WillNeed,
+    e_RIFFIOAdvice_DontNeed
+} e_RIFFIOAdviceType;
+
+/***  CLASS DEFINITIONS                ***/
+/* All the backends return false on an error and leave it up to the RIFF
+   class to throw */
+class RIFFIO
+{
+    public:
+        virtual ~RIFFIO() {}
+        virtual bool Open(const char *Filename,bool ForWrite)=0;
+        virtual bool Close(void)=0;
+        virtual bool Read(void *Data,uint32_t Bytes)=0;
+        virtual bool Write(const void *Data,uint32_t Bytes)=0;
+        virtual bool Skip(uint64_t Bytes)=0;
+        virtual bool Seek(uint64_t Offset)=0;
+        virtual uint64_t Tell(void)=0;
+        virtual bool Patch(uint64_t Offset,const void *Data,uint32_t Bytes)=0;
+        virtual void Advise(uint64_t /*Offset*/,uint64_t /*Bytes*/,
+                e_RIFFIOAdviceType /*Advice*/) {}
+        virtual void *Reserve(uint32_t /*Bytes*/) {return NULL;}
+        virtual void Release(void) {}
+        virtual bool Flush(bool /*Sync*/) {return true;}
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+class RIFFIO *RIFFIO_Create(e_RIFFIOType Type,bool ForWrite,
+        const struct RIFFIOOptions *Options);
+class RIFFIO *RIFFIO_CreateStats(class RIFFIO *IO,struct RIFFStats *Stats);
+class RIFFIO *RIFFIO_CreateMemory(std::vector<uint8_t> *Buffer,uint64_t Base);
+
+#endif
@@ -0,0 +1,1284 @@
+/*******************************************************************************
+ * FILENAME: RIFFInterleave.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has the classes for writing packets from many streams into one group
+ *    in time order (like the "movi" group of an AVI) and reading them back one
+ *    stream at a time.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFInterleave.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+/*** DEFINES                  ***/
+#define INTERLEAVE_INDEX_VERSION        1
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static bool Interleave_Before(uint64_t Time,
+        const struct RIFFInterleavePacket &Packet);
+static bool Interleave_EntryBefore(const struct RIFFInterleaveEntry &Entry,
+        uint64_t Time);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::RIFFInterleaver
+ *
+ * SYNOPSIS:
+ *    RIFFInterleaver::RIFFInterleaver();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the interleaver.  The interleaver takes
+ *    packets from a number of streams, each with a time stamp, and writes
+ *    them as data blocks in one group in time order (like the "movi" group
+ *    in an AVI file).
+ *
+ *    The packets don't have to be given in order.  They are held for
+ *    'Window' (see Open()) so packets that come in late can be put in the
+ *    right place.  The data blocks are built in memory and written many at
+ *    a time with RIFF::WriteDataBlocks().
+ *
+ *    When it is closed an index ("ix00", "ix01", ...) is written for each
+ *    stream after the group so one stream can be read without reading the
+ *    others (see RIFFInterleaveReader).
+ *
+ *    The packets can also be split over a number of forms or files (see
+ *    SetSegments()) to get past the 4G limit of a RIFF file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Open(), RIFFInterleaveReader
+ ******************************************************************************/
+RIFFInterleaver::RIFFInterleaver()
+{
+    File=NULL;
+    Window=0;
+    Latest=0;
+    BatchSize=RIFFINTERLEAVE_BATCH_SIZE;
+    MaxPending=RIFFINTERLEAVE_MAX_PENDING;
+    GroupPos=0;
+    PendingBytes=0;
+    ListID[0]=0;
+    Segments=e_RIFFSegment_None;
+    SegmentBytes=RIFFINTERLEAVE_SEGMENT_BYTES;
+    SegmentTime=0;
+    SegmentStart=0;
+    strcpy(SegmentForm,RIFFINTERLEAVE_SEGMENT_FORM);
+    Segment=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::~RIFFInterleaver
+ *
+ * SYNOPSIS:
+ *    RIFFInterleaver::~RIFFInterleaver();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.  It does not close the
+ *    group, you have to call Close().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFInterleaver::~RIFFInterleaver()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::AddStream
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFInterleaver::AddStream(const char *ChunkID);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk ID to use for this stream's packets.  This
+ *                   must be 4 letters long.
+ *
+ * FUNCTION:
+ *    This function adds a stream.  Streams can share a chunk ID, they are
+ *    told apart by the index.
+ *
+ * RETURNS:
+ *    The stream number to pass to Write()
+ *
+ * NOTES:
+ *    Throws e_RIFFError_InternalError_BadChunkIDSize if 'ChunkID' isn't 4
+ *    letters or there are already RIFFINTERLEAVE_MAX_STREAMS streams.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Write()
+ ******************************************************************************/
+unsigned RIFFInterleaver::AddStream(const char *ChunkID)
+{
+    struct RIFFInterleaveStream NewStream;
+
+    if(strlen(ChunkID)!=4 || Streams.size()>=RIFFINTERLEAVE_MAX_STREAMS)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    strcpy(NewStream.ChunkID,ChunkID);
+    Streams.push_back(NewStream);
+
+    return Streams.size()-1;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::SetBatchSize
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::SetBatchSize(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- About how many bytes to write at a time.  0 for the
+ *                 default (RIFFINTERLEAVE_BATCH_SIZE).
+ *
+ * FUNCTION:
+ *    This function sets how many bytes of data blocks are built up in
+ *    memory before they are written to the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::SetMaxPending()
+ ******************************************************************************/
+void RIFFInterleaver::SetBatchSize(uint32_t Bytes)
+{
+    BatchSize=Bytes==0?RIFFINTERLEAVE_BATCH_SIZE:Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::SetMaxPending
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::SetMaxPending(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The most packet data to hold while waiting for late
+ *                 packets.  0 for the default (RIFFINTERLEAVE_MAX_PENDING).
+ *
+ * FUNCTION:
+ *    This function limits how much memory is used holding packets for the
+ *    window (see Open()).  When there is more than this the oldest packets
+ *    are written even if they are still in the window.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Open()
+ ******************************************************************************/
+void RIFFInterleaver::SetMaxPending(uint32_t Bytes)
+{
+    MaxPending=Bytes==0?RIFFINTERLEAVE_MAX_PENDING:Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::SetSegments
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::SetSegments(uint32_t MaxBytes,uint64_t MaxTime=0,
+ *              const char *FormType=RIFFINTERLEAVE_SEGMENT_FORM);
+ *    void RIFFInterleaver::SetSegmentFiles(const char *Filename,
+ *              const char *FormType,uint32_t MaxBytes,uint64_t MaxTime=0);
+ *
+ * PARAMETERS:
+ *    MaxBytes [I] -- The most packet data (with the chunk headers) to put
+ *                    in one segment.  0 for the default
+ *                    (RIFFINTERLEAVE_SEGMENT_BYTES).
+ *    MaxTime [I] -- The longest time (in the same units as the time stamps)
+ *                   one segment can have.  0 for no limit.
+ *    FormType [I] -- The form type of the new forms / files
+ *    Filename [I] -- The name of the file the RIFF class was opened with
+ *
+ * FUNCTION:
+ *    These functions turn on segments.  When the next packet would make the
+ *    segment bigger than 'MaxBytes' or longer than 'MaxTime' the group is
+ *    ended (between packets), the index for the packets in that segment is
+ *    written and a new segment is started with a new group:
+ *
+ *    SetSegments() starts a new form in the same file (see
+ *    RIFF::NextForm()).  This is how AVI files get past 4G ("RIFF" "AVIX"
+ *    forms).
+ *
+ *    SetSegmentFiles() closes the file and opens a new one.  The files are
+ *    named 'Filename' with ".001", ".002", ... on the end (see
+ *    RIFFInterleave_SegmentFilename()).  Each file is a complete file with
+ *    the 'FormType' form type.
+ *
+ *    Call before Open().  RIFFInterleaveReader puts the segments back
+ *    together.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    With SetSegmentFiles() the RIFF class you passed to Open() is closed
+ *    and opened again for each file (with the default I/O type).  When you
+ *    are done the RIFF class has the last file open.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::GetSegmentCount(), RIFFInterleaveReader::Open()
+ ******************************************************************************/
+void RIFFInterleaver::SetSegments(uint32_t MaxBytes,uint64_t MaxTime,
+        const char *FormType)
+{
+    if(strlen(FormType)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    Segments=e_RIFFSegment_Forms;
+    SegmentBytes=MaxBytes==0?RIFFINTERLEAVE_SEGMENT_BYTES:MaxBytes;
+    SegmentTime=MaxTime;
+    strcpy(SegmentForm,FormType);
+    SegmentFile.clear();
+}
+
+void RIFFInterleaver::SetSegmentFiles(const char *Filename,
+        const char *FormType,uint32_t MaxBytes,uint64_t MaxTime)
+{
+    SetSegments(MaxBytes,MaxTime,FormType);
+    Segments=e_RIFFSegment_Files;
+    SegmentFile=Filename;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::GetSegmentCount
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFInterleaver::GetSegmentCount(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets how many segments have been started (1 if segments
+ *    are not on).
+ *
+ * RETURNS:
+ *    The number of segments
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::SetSegments()
+ ******************************************************************************/
+unsigned RIFFInterleaver::GetSegmentCount(void)
+{
+    return Segment+1;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::Open
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::Open(class RIFF &RIFF,uint64_t Window,
+ *              const char *ListID=RIFFINTERLEAVE_LIST_ID);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to write to.  It must be open for writing.
+ *    Window [I] -- How far behind the newest packet (in the same units as
+ *                  the time stamps) a packet can come in and still be put
+ *                  in order.  0 to write the packets as they come in.
+ *    ListID [I] -- The ID of the group to write the packets in
+ *
+ * FUNCTION:
+ *    This function starts the group the packets go in.  Add the streams
+ *    with AddStream() before calling Write() for them.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    You can not write anything else to the file until Close() is called.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Write(), RIFFInterleaver::Close()
+ ******************************************************************************/
+void RIFFInterleaver::Open(class RIFF &RIFF,uint64_t Window,
+        const char *ListID)
+{
+    unsigned s;
+
+    RIFF.StartGroup(ListID);
+
+    File=&RIFF;
+    strcpy(this->ListID,ListID);
+    this->Window=Window;
+    Latest=0;
+    GroupPos=0;
+    Pending.clear();
+    PendingData.clear();
+    PendingBytes=0;
+    Batch.clear();
+    Batch.reserve(BatchSize);
+    Segment=0;
+    for(s=0;s<Streams.size();s++)
+        Streams[s].Index.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::Write
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::Write(unsigned Stream,uint64_t Time,
+ *              const void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream this packet is for (from AddStream())
+ *    Time [I] -- The time stamp of the packet.  All the streams must use
+ *                the same units.
+ *    Data [I] -- The packet
+ *    Bytes [I] -- The size of the packet
+ *
+ * FUNCTION:
+ *    This function adds a packet.  It is copied and held until it falls
+ *    out of the window, then it is written in time order with the packets
+ *    from the other streams.  Packets with the same time are written in the
+ *    order they where given.
+ *
+ *    A packet that is older than a packet that has already been written
+ *    (it came in later than the window) is written straight away, out of
+ *    order.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_FileNotOpen if Open() wasn't called and
+ *    e_RIFFError_InternalError_BadChunkIDSize if 'Stream' wasn't added.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::AddStream(), RIFFInterleaver::Close()
+ ******************************************************************************/
+void RIFFInterleaver::Write(unsigned Stream,uint64_t Time,const void *Data,
+        uint32_t Bytes)
+{
+    struct RIFFInterleavePacket Packet;
+    std::deque<struct RIFFInterleavePacket>::iterator Pos;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+    if(Stream>=Streams.size())
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    Packet.Time=Time;
+    Packet.Stream=Stream;
+    Packet.Offset=PendingData.size();
+    Packet.Bytes=Bytes;
+    PendingData.insert(PendingData.end(),(const uint8_t *)Data,
+            (const uint8_t *)Data+Bytes);
+    PendingBytes+=Bytes;
+
+    /* Most packets are the newest so this is normally the end */
+    if(Pending.empty() || Pending.back().Time<=Time)
+    {
+        Pending.push_back(Packet);
+    }
+    else
+    {
+        Pos=std::upper_bound(Pending.begin(),Pending.end(),Time,
+                Interleave_Before);
+        Pending.insert(Pos,Packet);
+    }
+
+    if(Time>Latest)
+        Latest=Time;
+
+    while(!Pending.empty() && (PendingBytes>MaxPending ||
+            (Latest>=Window && Pending.front().Time<=Latest-Window)))
+    {
+        WritePacket();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::Close
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes the packets that are still being held, ends the
+ *    group and then writes the index for each stream ("ix00" for stream 0,
+ *    "ix01" for stream 1, ...).  It doesn't close the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Open()
+ ******************************************************************************/
+void RIFFInterleaver::Close(void)
+{
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    while(!Pending.empty())
+        WritePacket();
+    WriteBatch();
+
+    File->EndGroup();
+    WriteIndex();
+
+    PendingData.clear();
+    File=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::WritePacket
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::WritePacket(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function adds the oldest packet to the batch as a data block and
+ *    adds it to its stream's index.  The batch is written when it gets to
+ *    the batch size.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::WriteBatch()
+ ******************************************************************************/
+void RIFFInterleaver::WritePacket(void)
+{
+    struct RIFFInterleavePacket Packet;
+    struct RIFFInterleaveEntry Entry;
+    const uint8_t *Data;
+    uint8_t Header[8];
+    bool IFF;
+    uint32_t Bytes;
+    unsigned r;
+
+    Packet=Pending.front();
+    Pending.pop_front();
+
+    Bytes=Packet.Bytes;
+    if(Segments!=e_RIFFSegment_None && GroupPos>0)
+    {
+        if((uint64_t)GroupPos+8+Bytes+(Bytes&1)>SegmentBytes ||
+                (SegmentTime!=0 && Packet.Time>SegmentStart &&
+                Packet.Time-SegmentStart>=SegmentTime))
+        {
+            NextSegment();
+        }
+    }
+    if(GroupPos==0)
+        SegmentStart=Packet.Time;
+
+    if((uint64_t)Bytes+(Bytes&1)+8>0xFFFFFFFF-4-GroupPos)
+        throw(e_RIFFError_WriteError);
+
+    /* The data block header (size in the file's byte order) */
+    IFF=File->GetIFFMode();
+    memcpy(Header,Streams[Packet.Stream].ChunkID,4);
+    for(r=0;r<4;r++)
+        Header[4+r]=Bytes>>(IFF?24-r*8:r*8);
+
+    Data=PendingData.data()+Packet.Offset;
+    Batch.insert(Batch.end(),Header,Header+sizeof(Header));
+    Batch.insert(Batch.end(),Data,Data+Bytes);
+    if(Bytes&1)
+        Batch.push_back(0);
+
+    Entry.Time=Packet.Time;
+    Entry.Offset=GroupPos+sizeof(Header);
+    Entry.Bytes=Bytes;
+    Streams[Packet.Stream].Index.push_back(Entry);
+    GroupPos+=sizeof(Header)+Bytes+(Bytes&1);
+
+    /* Packets are taken out of order so we can only throw away the data
+       when nothing is held, or by moving what is left down when most of it
+       has been used */
+    PendingBytes-=Bytes;
+    if(Pending.empty())
+    {
+        PendingData.clear();
+    }
+    else if(PendingData.size()>BatchSize && PendingBytes<PendingData.size()/2)
+    {
+        std::vector<uint8_t> Held;
+
+        Held.reserve(PendingBytes);
+        for(r=0;r<Pending.size();r++)
+        {
+            Data=PendingData.data()+Pending[r].Offset;
+            Pending[r].Offset=Held.size();
+            Held.insert(Held.end(),Data,Data+Pending[r].Bytes);
+        }
+        PendingData.swap(Held);
+    }
+
+    if(Batch.size()>=BatchSize)
+        WriteBatch();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::WriteBatch
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::WriteBatch(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes the data blocks that have been built up.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::WriteDataBlocks()
+ ******************************************************************************/
+void RIFFInterleaver::WriteBatch(void)
+{
+    if(Batch.empty())
+        return;
+
+    File->WriteDataBlocks(Batch.data(),Batch.size());
+    Batch.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::WriteIndex
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::WriteIndex(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes an "ixNN" chunk for each stream.  Each is a
+ *    RIFFInterleaveIndexHeader followed by a RIFFInterleaveEntry for each
+ *    packet in the stream.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::Open()
+ ******************************************************************************/
+void RIFFInterleaver::WriteIndex(void)
+{
+    typedef RIFFStructLayout<RIFFInterleaveEntry> Layout;
+    struct RIFFInterleaveIndexHeader Header;
+    std::vector<uint8_t> Entries;
+    char ChunkID[5];
+    bool SwapBytes;
+    size_t e;
+    unsigned s;
+
+    SwapBytes=(File->GetIFFMode()!=RIFF_HOST_BIG_ENDIAN);
+    for(s=0;s<Streams.size();s++)
+    {
+        const std::vector<struct RIFFInterleaveEntry> &Index=Streams[s].Index;
+
+        Header.Version=INTERLEAVE_INDEX_VERSION;
+        Header.Stream=s;
+        memcpy(Header.ChunkID,Streams[s].ChunkID,4);
+        Header.Entries=Index.size();
+
+        Entries.resize(Index.size()*Layout::Size);
+        for(e=0;e<Index.size();e++)
+            Layout::Encode(Index[e],&Entries[e*Layout::Size],SwapBytes);
+
+        sprintf(ChunkID,"ix%02u",s);
+        File->StartDataBlock(ChunkID);
+        File->WriteStruct(Header);
+        File->Write(Entries.data(),Entries.size());
+        File->EndDataBlock();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaver::NextSegment
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaver::NextSegment(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function ends the segment (the group and its index) and starts
+ *    the next one in a new form or file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::SetSegments()
+ ******************************************************************************/
+void RIFFInterleaver::NextSegment(void)
+{
+    unsigned s;
+
+    WriteBatch();
+    File->EndGroup();
+    WriteIndex();
+
+    Segment++;
+    if(Segments==e_RIFFSegment_Files)
+    {
+        File->Close();
+        File->Open(RIFFInterleave_SegmentFilename(SegmentFile.c_str(),
+                Segment).c_str(),e_RIFFOpen_Write,SegmentForm);
+    }
+    else
+    {
+        File->NextForm(SegmentForm);
+    }
+    File->StartGroup(ListID);
+
+    GroupPos=0;
+    for(s=0;s<Streams.size();s++)
+        Streams[s].Index.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::RIFFInterleaveReader
+ *
+ * SYNOPSIS:
+ *    RIFFInterleaveReader::RIFFInterleaveReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the interleave reader.  It uses the index
+ *    written by RIFFInterleaver to get the packets for one stream without
+ *    reading the others.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::Open(), RIFFInterleaver
+ ******************************************************************************/
+RIFFInterleaveReader::RIFFInterleaveReader()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::~RIFFInterleaveReader
+ *
+ * SYNOPSIS:
+ *    RIFFInterleaveReader::~RIFFInterleaveReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFInterleaveReader::~RIFFInterleaveReader()
+{
+    Close();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::Open
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaveReader::Open(class RIFFTree &Tree,
+ *              const char *ListID=RIFFINTERLEAVE_LIST_ID);
+ *    void RIFFInterleaveReader::Open(const char *Filename,
+ *              const char *FormType,bool UseIFF=false,
+ *              const char *ListID=RIFFINTERLEAVE_LIST_ID);
+ *
+ * PARAMETERS:
+ *    Tree [I] -- The file to read from.  It must be open and stay open
+ *                while you use the reader.
+ *    ListID [I] -- The ID of the group the packets are in
+ *    Filename [I] -- The file to open
+ *    FormType [I] -- The form type the file must have
+ *    UseIFF [I] -- true if the file is an IFF file
+ *
+ * FUNCTION:
+ *    This function loads the index for every stream.  Only the index
+ *    chunks are read, the packets are read when you ask for them.
+ *
+ *    The first version reads all the forms in the file (see
+ *    RIFFInterleaver::SetSegments()).
+ *
+ *    The second version opens the file and the segment files after it
+ *    ('Filename' with ".001", ".002", ... on the end) for as many as there
+ *    are (see RIFFInterleaver::SetSegmentFiles()).
+ *
+ *    The segments are put together so each stream is one list of packets
+ *    and one index, the same as if it was all written in one group.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the group or the index isn't there or
+ *    the index doesn't fit the group.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::ReadPacket()
+ ******************************************************************************/
+void RIFFInterleaveReader::Open(class RIFFTree &Tree,const char *ListID)
+{
+    Close();
+    AddTree(Tree,ListID);
+}
+
+void RIFFInterleaveReader::Open(const char *Filename,const char *FormType,
+        bool UseIFF,const char *ListID)
+{
+    class RIFFTree *Tree;
+    std::string Name;
+    FILE *Test;
+    unsigned Segment;
+
+    Close();
+
+    Name=Filename;
+    for(Segment=0;;Segment++)
+    {
+        if(Segment>0)
+        {
+            /* The segment files stop when we can't find the next one */
+            Name=RIFFInterleave_SegmentFilename(Filename,Segment);
+            Test=fopen(Name.c_str(),"rb");
+            if(Test==NULL)
+                break;
+            fclose(Test);
+        }
+
+        Tree=new RIFFTree(UseIFF);
+        Trees.push_back(Tree);
+        Tree->Open(Name.c_str(),FormType);
+        AddTree(*Tree,ListID);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::Close
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaveReader::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function frees the index and closes any files Open() opened.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::Open()
+ ******************************************************************************/
+void RIFFInterleaveReader::Close(void)
+{
+    unsigned r;
+
+    for(r=0;r<Trees.size();r++)
+        delete Trees[r];
+    Trees.clear();
+    Groups.clear();
+    Streams.clear();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::GetSegmentCount
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFInterleaveReader::GetSegmentCount(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets how many segments (forms / files) the packets were
+ *    found in.
+ *
+ * RETURNS:
+ *    The number of segments
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::Open()
+ ******************************************************************************/
+unsigned RIFFInterleaveReader::GetSegmentCount(void)
+{
+    return Groups.size();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::GetStreamCount
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFInterleaveReader::GetStreamCount(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of streams in the file.
+ *
+ * RETURNS:
+ *    The number of streams
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::GetStreamID()
+ ******************************************************************************/
+unsigned RIFFInterleaveReader::GetStreamCount(void)
+{
+    return Streams.size();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::GetStreamID
+ *
+ * SYNOPSIS:
+ *    const char *RIFFInterleaveReader::GetStreamID(unsigned Stream);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream to get the chunk ID of
+ *
+ * FUNCTION:
+ *    This function gets the chunk ID that was given to AddStream() for a
+ *    stream.
+ *
+ * RETURNS:
+ *    The chunk ID
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::AddStream()
+ ******************************************************************************/
+const char *RIFFInterleaveReader::GetStreamID(unsigned Stream)
+{
+    if(Stream>=Streams.size())
+        throw(e_RIFFError_BadFormat);
+
+    return Streams[Stream].ChunkID;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::GetPacketCount
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFInterleaveReader::GetPacketCount(unsigned Stream);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream to get the number of packets for
+ *
+ * FUNCTION:
+ *    This function gets the number of packets in a stream.
+ *
+ * RETURNS:
+ *    The number of packets
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::GetPacket()
+ ******************************************************************************/
+uint32_t RIFFInterleaveReader::GetPacketCount(unsigned Stream)
+{
+    if(Stream>=Streams.size())
+        throw(e_RIFFError_BadFormat);
+
+    return Streams[Stream].Index.size();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::GetPacket
+ *
+ * SYNOPSIS:
+ *    const struct RIFFInterleaveEntry &RIFFInterleaveReader::GetPacket(
+ *              unsigned Stream,uint32_t Packet);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream the packet is in
+ *    Packet [I] -- The packet number in the stream
+ *
+ * FUNCTION:
+ *    This function gets the time stamp and size of a packet.
+ *
+ * RETURNS:
+ *    The index entry for the packet
+ *
+ * NOTES:
+ *    Throws e_RIFFError_ChunkToSmall if 'Packet' is past the end of the
+ *    stream.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::ReadPacket()
+ ******************************************************************************/
+const struct RIFFInterleaveEntry &RIFFInterleaveReader::GetPacket(
+        unsigned Stream,uint32_t Packet)
+{
+    if(Packet>=GetPacketCount(Stream))
+        throw(e_RIFFError_ChunkToSmall);
+
+    return Streams[Stream].Index[Packet];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::FindPacket
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFInterleaveReader::FindPacket(unsigned Stream,
+ *              uint64_t Time);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream to look in
+ *    Time [I] -- The time to look for
+ *
+ * FUNCTION:
+ *    This function finds the first packet in a stream with a time stamp at
+ *    or after 'Time'.  If packets where written out of order (they came in
+ *    later than the window) this may not find the first one.
+ *
+ * RETURNS:
+ *    The packet number.  GetPacketCount() if all the packets are before
+ *    'Time'.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::GetPacket()
+ ******************************************************************************/
+uint32_t RIFFInterleaveReader::FindPacket(unsigned Stream,uint64_t Time)
+{
+    const std::vector<struct RIFFInterleaveEntry> *Index;
+
+    if(Stream>=Streams.size())
+        throw(e_RIFFError_BadFormat);
+
+    Index=&Streams[Stream].Index;
+    return std::lower_bound(Index->begin(),Index->end(),Time,
+            Interleave_EntryBefore)-Index->begin();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::ReadPacket
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaveReader::ReadPacket(unsigned Stream,uint32_t Packet,
+ *              void *Data);
+ *
+ * PARAMETERS:
+ *    Stream [I] -- The stream the packet is in
+ *    Packet [I] -- The packet number in the stream
+ *    Data [O] -- Where to put the packet.  This must be GetPacket().Bytes
+ *                long.
+ *
+ * FUNCTION:
+ *    This function reads one packet straight from where it is in the file.
+ *    Nothing else in the group is read.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::GetPacket()
+ ******************************************************************************/
+void RIFFInterleaveReader::ReadPacket(unsigned Stream,uint32_t Packet,
+        void *Data)
+{
+    const struct RIFFInterleaveEntry &Entry=GetPacket(Stream,Packet);
+    const std::vector<uint32_t> &Starts=Streams[Stream].SegmentStarts;
+    unsigned Segment;
+
+    /* The last segment that starts at or before this packet */
+    Segment=std::upper_bound(Starts.begin(),Starts.end(),Packet)-
+            Starts.begin()-1;
+
+    Groups[Segment]->Read(Data,Entry.Offset,Entry.Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::AddTree
+ *
+ * SYNOPSIS:
+ *    void RIFFInterleaveReader::AddTree(class RIFFTree &Tree,
+ *              const char *ListID);
+ *
+ * PARAMETERS:
+ *    Tree [I] -- The file to add
+ *    ListID [I] -- The ID of the group the packets are in
+ *
+ * FUNCTION:
+ *    This function adds a segment for each form in a file.  The first form
+ *    must have the group, forms after it that don't are skipped.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::AddSegment()
+ ******************************************************************************/
+void RIFFInterleaveReader::AddTree(class RIFFTree &Tree,const char *ListID)
+{
+    class RIFFNode *Form;
+    bool SwapBytes;
+    unsigned f;
+
+    SwapBytes=(Tree.GetIFFMode()!=RIFF_HOST_BIG_ENDIAN);
+    if(!AddSegment(Tree.GetRoot(),SwapBytes,ListID))
+        throw(e_RIFFError_BadFormat);
+
+    for(f=1;(Form=Tree.GetForm(f))!=NULL;f++)
+        AddSegment(Form,SwapBytes,ListID);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleaveReader::AddSegment
+ *
+ * SYNOPSIS:
+ *    bool RIFFInterleaveReader::AddSegment(class RIFFNode *Form,
+ *              bool SwapBytes,const char *ListID);
+ *
+ * PARAMETERS:
+ *    Form [I] -- The form with the group and index in it
+ *    SwapBytes [I] -- The index isn't in the host's byte order
+ *    ListID [I] -- The ID of the group the packets are in
+ *
+ * FUNCTION:
+ *    This function loads the index chunks in a form and adds the packets to
+ *    the end of each stream.
+ *
+ * RETURNS:
+ *    true -- The segment was added
+ *    false -- The form doesn't have the group
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the index isn't valid or doesn't match
+ *    the streams in the segments before it.
+ *
+ * SEE ALSO:
+ *    RIFFInterleaveReader::Open()
+ ******************************************************************************/
+bool RIFFInterleaveReader::AddSegment(class RIFFNode *Form,bool SwapBytes,
+        const char *ListID)
+{
+    typedef RIFFStructLayout<RIFFInterleaveIndexHeader> HeaderLayout;
+    typedef RIFFStructLayout<RIFFInterleaveEntry> EntryLayout;
+    struct RIFFInterleaveIndexHeader Header;
+    class RIFFNode *Group;
+    class RIFFNode *Node;
+    const uint8_t *Data;
+    char ChunkID[5];
+    uint32_t GroupSize;
+    uint32_t First;
+    uint32_t e;
+    unsigned s;
+
+    Group=Form->FindChild(ListID);
+    if(Group==NULL || !Group->IsGroup())
+        return false;
+    GroupSize=Group->GetSize()-4;
+
+    for(s=0;s<Streams.size();s++)
+        Streams[s].SegmentStarts.push_back(Streams[s].Index.size());
+
+    for(s=0;s<RIFFINTERLEAVE_MAX_STREAMS;s++)
+    {
+        sprintf(ChunkID,"ix%02u",s);
+        Node=Form->FindChild(ChunkID);
+        if(Node==NULL)
+            break;
+
+        if(Node->GetSize()<HeaderLayout::Size)
+            throw(e_RIFFError_BadFormat);
+        Data=Node->GetData();
+        HeaderLayout::Decode(Header,Data,HeaderLayout::Size,SwapBytes);
+        if(Header.Version!=INTERLEAVE_INDEX_VERSION || Header.Stream!=s ||
+                Header.Entries>(Node->GetSize()-HeaderLayout::Size)/
+                EntryLayout::Size)
+        {
+            throw(e_RIFFError_BadFormat);
+        }
+
+        /* A new stream has no packets in the segments before this one */
+        if(s==Streams.size())
+        {
+            Streams.resize(s+1);
+            memcpy(Streams[s].ChunkID,Header.ChunkID,4);
+            Streams[s].ChunkID[4]=0;
+            Streams[s].SegmentStarts.assign(Groups.size()+1,0);
+        }
+        if(memcmp(Streams[s].ChunkID,Header.ChunkID,4)!=0)
+            throw(e_RIFFError_BadFormat);
+
+        std::vector<struct RIFFInterleaveEntry> &Index=Streams[s].Index;
+        First=Index.size();
+        Index.resize(First+Header.Entries);
+        Data+=HeaderLayout::Size;
+        for(e=First;e<Index.size();e++)
+        {
+            EntryLayout::Decode(Index[e],Data,EntryLayout::Size,SwapBytes);
+            if(Index[e].Offset>GroupSize ||
+                    Index[e].Bytes>GroupSize-Index[e].Offset)
+            {
+                throw(e_RIFFError_BadFormat);
+            }
+            Data+=EntryLayout::Size;
+        }
+        Node->Unload();
+    }
+
+    Groups.push_back(Group);
+    return true;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFInterleave_SegmentFilename
+ *
+ * SYNOPSIS:
+ *    std::string RIFFInterleave_SegmentFilename(const char *Filename,
+ *              unsigned Segment);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The name of the first file
+ *    Segment [I] -- The segment to get the file name of (0 is the first
+ *                   file)
+ *
+ * FUNCTION:
+ *    This function works out the file name of a segment file written with
+ *    RIFFInterleaver::SetSegmentFiles().  It is 'Filename' with ".001",
+ *    ".002", ... on the end.
+ *
+ * RETURNS:
+ *    The file name
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::SetSegmentFiles()
+ ******************************************************************************/
+std::string RIFFInterleave_SegmentFilename(const char *Filename,
+        unsigned Segment)
+{
+    char Ext[20];
+
+    if(Segment==0)
+        return Filename;
+
+    sprintf(Ext,".%03u",Segment);
+    return std::string(Filename)+Ext;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    Interleave_Before
+ *
+ * SYNOPSIS:
+ *    static bool Interleave_Before(uint64_t Time,
+ *              const struct RIFFInterleavePacket &Packet);
+ *    static bool Interleave_EntryBefore(
+ *              const struct RIFFInterleaveEntry &Entry,uint64_t Time);
+ *
+ * PARAMETERS:
+ *    Time [I] -- The time to compare
+ *    Packet [I] -- The held packet to compare with
+ *    Entry [I] -- The index entry to compare with
+ *
+ * FUNCTION:
+ *    These functions compare time stamps for std::upper_bound() and
+ *    std::lower_bound().
+ *
+ * RETURNS:
+ *    true -- The first arg is before the second
+ *    false -- It isn't
+ *
+ * SEE ALSO:
+ *    RIFFInterleaver::Write(), RIFFInterleaveReader::FindPacket()
+ ******************************************************************************/
+static bool Interleave_Before(uint64_t Time,
+        const struct RIFFInterleavePacket &Packet)
+{
+    return Time<Packet.Time;
+}
+
+static bool Interleave_EntryBefore(const struct RIFFInterleaveEntry &Entry,
+        uint64_t Time)
+{
+    return Entry.Time<Time;
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * FILENAME: RIFFInterleave.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has the classes for writing packets from many streams (audio, sensor
+ *    data, video frames, ...) into one group in time order, and for getting
+ *    the packets for one stream back out using the index written with them.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFINTERLEAVE_H_
+#define __RIFFINTERLEAVE_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include "RIFFTree.h"
+#include <deque>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+#define RIFFINTERLEAVE_LIST_ID          "movi"
+#define RIFFINTERLEAVE_MAX_STREAMS      100     // Index chunks are "ix00" - "ix99"
+#define RIFFINTERLEAVE_BATCH_SIZE       (64*1024)       // Default
+#define RIFFINTERLEAVE_MAX_PENDING      (4*1024*1024)   // Default
+#define RIFFINTERLEAVE_SEGMENT_FORM     "AVIX"          // Default
+#define RIFFINTERLEAVE_SEGMENT_BYTES    (1024*1024*1024)        // Default
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+typedef enum
+{
+    e_RIFFSegment_None,         // Everything in one group (the default)
+    e_RIFFSegment_Forms,        // More forms in the same file ("RIFF" "AVIX")
+    e_RIFFSegment_Files         // More files ("Name.001", "Name.002", ...)
+} e_RIFFSegmentType;
+
+/* The start of an "ixNN" chunk.  After it are 'Entries' RIFFInterleaveEntry's
+   for the packets of stream NN in the order they are in the file. */
+struct RIFFInterleaveIndexHeader
+{
+    uint16_t Version;
+    uint16_t Stream;
+    uint8_t ChunkID[4];                 // The chunk ID of the stream's packets
+    uint32_t Entries;
+};
+
+RIFF_STRUCT(RIFFInterleaveIndexHeader,
+        RIFF_FIELD(RIFFInterleaveIndexHeader,Version),
+        RIFF_FIELD(RIFFInterleaveIndexHeader,Stream),
+        RIFF_FIELD(RIFFInterleaveIndexHeader,ChunkID),
+        RIFF_FIELD(RIFFInterleaveIndexHeader,Entries));
+
+struct RIFFInterleaveEntry
+{
+    uint64_t Time;
+    uint32_t Offset;                    // Of the data from after the group ID
+    uint32_t Bytes;
+};
+
+RIFF_STRUCT(RIFFInterleaveEntry,RIFF_FIELD(RIFFInterleaveEntry,Time),
+        RIFF_FIELD(RIFFInterleaveEntry,Offset),
+        RIFF_FIELD(RIFFInterleaveEntry,Bytes));
+
+struct RIFFInterleavePacket
+{
+    uint64_t Time;
+    unsigned Stream;
+    size_t Offset;                      // In 'PendingData'
+    uint32_t Bytes;
+};
+
+struct RIFFInterleaveStream
+{
+    char ChunkID[5];
+    std::vector<struct RIFFInterleaveEntry> Index;
+    std::vector<uint32_t> SegmentStarts;    // First packet in each segment
+};
+
+/***  CLASS DEFINITIONS                ***/
+class RIFFInterleaver
+{
+    public:
+        RIFFInterleaver();
+        ~RIFFInterleaver();
+        unsigned AddStream(const char *ChunkID);
+        void SetBatchSize(uint32_t Bytes);
+        void SetMaxPending(uint32_t Bytes);
+        void SetSegments(uint32_t MaxBytes,uint64_t MaxTime=0,
+                const char *FormType=RIFFINTERLEAVE_SEGMENT_FORM);
+        void SetSegmentFiles(const char *Filename,const char *FormType,
+                uint32_t MaxBytes,uint64_t MaxTime=0);
+        void Open(class RIFF &RIFF,uint64_t Window,
+                const char *ListID=RIFFINTERLEAVE_LIST_ID);
+        void Write(unsigned Stream,uint64_t Time,const void *Data,
+                uint32_t Bytes);
+        void Close(void);
+        unsigned GetSegmentCount(void);
+
+    private:
+        class RIFF *File;
+        char ListID[5];
+        uint64_t Window;
+        uint64_t Latest;                    // Newest time we have been given
+        uint32_t BatchSize;
+        uint32_t MaxPending;
+        uint32_t GroupPos;                  // Bytes written after the group ID
+        std::vector<struct RIFFInterleaveStream> Streams;
+        std::deque<struct RIFFInterleavePacket> Pending;  // Oldest first
+        std::vector<uint8_t> PendingData;
+        size_t PendingBytes;                // Bytes in 'PendingData' in use
+        std::vector<uint8_t> Batch;
+
+        /* Segments */
+        e_RIFFSegmentType Segments;
+        uint32_t SegmentBytes;
+        uint64_t SegmentTime;
+        uint64_t SegmentStart;              // Time of the segment's 1st packet
+        char SegmentForm[5];
+        std::string SegmentFile;
+        unsigned Segment;
+
+        void WritePacket(void);
+        void WriteBatch(void);
+        void WriteIndex(void);
+        void NextSegment(void);
+};
+
+class RIFFInterleaveReader
+{
+    public:
+        RIFFInterleaveReader();
+        ~RIFFInterleaveReader();
+        void Open(class RIFFTree &Tree,
+                const char *ListID=RIFFINTERLEAVE_LIST_ID);
+        void Open(const char *Filename,const char *FormType,
+                bool UseIFF=false,const char *ListID=RIFFINTERLEAVE_LIST_ID);
+        void Close(void);
+        unsigned GetSegmentCount(void);
+        unsigned GetStreamCount(void);
+        const char *GetStreamID(unsigned Stream);
+        uint32_t GetPacketCount(unsigned Stream);
+        const struct RIFFInterleaveEntry &GetPacket(unsigned Stream,
+                uint32_t Packet);
+        uint32_t FindPacket(unsigned Stream,uint64_t Time);
+        void ReadPacket(unsigned Stream,uint32_t Packet,void *Data);
+
+    private:
+        std::vector<class RIFFTree *> Trees;    // The ones we opened
+        std::vector<class RIFFNode *> Groups;   // One for each segment
+        std::vector<struct RIFFInterleaveStream> Streams;
+
+        void AddTree(class RIFFTree &Tree,const char *ListID);
+        bool AddSegment(class RIFFNode *Form,bool SwapBytes,
+                const char *ListID);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+std::string RIFFInterleave_SegmentFilename(const char *Filename,
+        unsigned Segment);
+
+#endif
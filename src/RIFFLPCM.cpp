@@ -0,0 +1,1570 @@
+/*******************************************************************************
+ * FILENAME: RIFFLPCM.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has a lossless PCM codec (fixed linear prediction and Rice coding,
+ *    like FLAC) for storing WAV sample data in an "LPCM" chunk.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFLPCM.h"
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+#define LPCM_VERSION                    1
+#define LPCM_MAX_ORDER                  4
+#define LPCM_MAX_BLOCK_FRAMES           65536
+#define LPCM_RICE_PARTITION             256
+#define LPCM_RICE_ESCAPE                31      // Values stored as is
+#define LPCM_MAX_UNARY                  0x40000000
+
+/* How the 2 channels of a stereo block are stored */
+#define LPCM_STEREO_LEFT_RIGHT          0
+#define LPCM_STEREO_LEFT_SIDE           1
+#define LPCM_STEREO_SIDE_RIGHT          2
+#define LPCM_STEREO_MID_SIDE            3
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LPCM_X86                        1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define LPCM_NEON                       1
+#include <arm_neon.h>
+#endif
+
+/*** MACROS                   ***/
+#define LPCM_MASK(Bits)                 ((Bits)>=32?0xFFFFFFFF:(1U<<(Bits))-1)
+
+/*** TYPE DEFINITIONS         ***/
+struct LPCMBitWriter
+{
+    std::vector<uint8_t> *Out;
+    uint64_t Acc;
+    unsigned Count;
+};
+
+struct LPCMBitReader
+{
+    const uint8_t *Pos;
+    const uint8_t *End;
+    uint64_t Acc;                       // Next bit is the top bit
+    unsigned Count;
+};
+
+/*** FUNCTION PROTOTYPES      ***/
+static void LPCM_Diff(const int32_t *In,int32_t *Out,uint32_t Count);
+static unsigned LPCM_BestOrder(const int32_t *Samples,uint32_t Count,
+        int32_t *Work,uint64_t *Cost);
+static void LPCM_EncodeSubframe(struct LPCMBitWriter *Bits,
+        const int32_t *Samples,const int32_t *Work,unsigned Order,
+        uint32_t Count,unsigned SampleBits);
+static void LPCM_DecodeSubframe(struct LPCMBitReader *Bits,int32_t *Samples,
+        uint32_t Count,unsigned SampleBits);
+static void LPCM_PutBits(struct LPCMBitWriter *Bits,uint32_t Value,
+        unsigned Count);
+static void LPCM_PutZeros(struct LPCMBitWriter *Bits,uint32_t Count);
+static void LPCM_FlushBits(struct LPCMBitWriter *Bits);
+static void LPCM_FillBits(struct LPCMBitReader *Bits);
+static uint32_t LPCM_GetBits(struct LPCMBitReader *Bits,unsigned Count);
+static uint32_t LPCM_GetUnary(struct LPCMBitReader *Bits);
+static unsigned LPCM_LeadingZeros(uint64_t Value);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::RIFFLPCMWriter
+ *
+ * SYNOPSIS:
+ *    RIFFLPCMWriter::RIFFLPCMWriter();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the lossless PCM writer.  It writes the
+ *    samples you would have put in a WAV "data" chunk into an "LPCM" chunk
+ *    instead, losslessly compressed.
+ *
+ *    The samples are cut into blocks of frames.  For each block the
+ *    channels of a stereo pair are turned into left/side, side/right or
+ *    mid/side (which ever is smallest), each channel gets the best fixed
+ *    predictor (order 0 to 4) and what the predictor got wrong is Rice
+ *    coded.  Each block can be decoded on its own and there is an index of
+ *    the blocks at the end of the chunk.
+ *
+ *    The "LPCM" chunk is:
+ *      struct RIFFLPCMHeader
+ *      The blocks:
+ *          struct RIFFLPCMBlockHeader
+ *          uint8_t Coded[Bytes]
+ *      uint32_t Index[Blocks] -- Where each block starts in the chunk
+ *      struct RIFFLPCMTrailer
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::RIFFLPCMReader()
+ ******************************************************************************/
+RIFFLPCMWriter::RIFFLPCMWriter()
+{
+    File=NULL;
+    TotalFrames=0;
+    ChunkPos=0;
+    BlockUsed=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::~RIFFLPCMWriter
+ *
+ * SYNOPSIS:
+ *    RIFFLPCMWriter::~RIFFLPCMWriter();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFLPCMWriter::~RIFFLPCMWriter()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::Start
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMWriter::Start(class RIFF &RIFF,unsigned Channels,
+ *              unsigned BitsPerSample,uint32_t BlockFrames=0);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to write to.  This must be open for writing.
+ *    Channels [I] -- The number of channels (1 to RIFFLPCM_MAX_CHANNELS)
+ *    BitsPerSample [I] -- 8, 16 or 24
+ *    BlockFrames [I] -- The number of frames in each block.  0 for the
+ *                       default (RIFFLPCM_DEFAULT_BLOCK_FRAMES).  Smaller
+ *                       blocks make seeking cheaper, bigger blocks are a
+ *                       little smaller.
+ *
+ * FUNCTION:
+ *    This function starts the "LPCM" data block.  Call Write() with the
+ *    samples and then End().  You can't write any other chunks until End()
+ *    is called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_UnsupportedCompression if the channels or bits
+ *    can't be stored.
+ *
+ * SEE ALSO:
+ *    RIFFLPCMWriter::Write(), RIFFLPCMWriter::End()
+ ******************************************************************************/
+void RIFFLPCMWriter::Start(class RIFF &RIFF,unsigned Channels,
+        unsigned BitsPerSample,uint32_t BlockFrames)
+{
+    if(Channels<1 || Channels>RIFFLPCM_MAX_CHANNELS)
+        throw(e_RIFFError_UnsupportedCompression);
+    if(BitsPerSample!=8 && BitsPerSample!=16 && BitsPerSample!=24)
+        throw(e_RIFFError_UnsupportedCompression);
+
+    if(BlockFrames==0)
+        BlockFrames=RIFFLPCM_DEFAULT_BLOCK_FRAMES;
+    if(BlockFrames>LPCM_MAX_BLOCK_FRAMES)
+        BlockFrames=LPCM_MAX_BLOCK_FRAMES;
+
+    Header.Version=LPCM_VERSION;
+    Header.Channels=Channels;
+    Header.BitsPerSample=BitsPerSample;
+    Header.Reserved=0;
+    Header.BlockFrames=BlockFrames;
+
+    TotalFrames=0;
+    BlockUsed=0;
+    Index.clear();
+    Block.resize(BlockFrames*Channels);
+
+    RIFF.StartDataBlock(RIFFLPCM_CHUNK_ID);
+    RIFF.WriteStruct(Header);
+    ChunkPos=RIFFStructLayout<RIFFLPCMHeader>::Size;
+
+    File=&RIFF;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::Write
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMWriter::Write(const void *Data,uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Data [I] -- The samples.  These are the same as in a WAV "data" chunk
+ *                (interleaved, little endian, 8 bit is unsigned).
+ *    Frames [I] -- The number of frames (one sample for each channel) in
+ *                  'Data'
+ *
+ * FUNCTION:
+ *    This function adds samples to the "LPCM" data block.  You can call it
+ *    as many times as you like.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMWriter::Start()
+ ******************************************************************************/
+void RIFFLPCMWriter::Write(const void *Data,uint32_t Frames)
+{
+    const uint8_t *In;
+    int32_t *Out;
+    uint32_t Copy;
+    uint32_t Samples;
+    uint32_t r;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Frames>0xFFFFFFFF-TotalFrames)
+        throw(e_RIFFError_WriteError);
+
+    In=(const uint8_t *)Data;
+    while(Frames>0)
+    {
+        Copy=Header.BlockFrames-BlockUsed;
+        if(Copy>Frames)
+            Copy=Frames;
+
+        Out=&Block[BlockUsed*Header.Channels];
+        Samples=Copy*Header.Channels;
+        switch(Header.BitsPerSample)
+        {
+            case 8:
+                for(r=0;r<Samples;r++,In++)
+                    Out[r]=(int32_t)In[0]-128;
+            break;
+            case 16:
+                for(r=0;r<Samples;r++,In+=2)
+                    Out[r]=(int16_t)(In[0] | In[1]<<8);
+            break;
+            case 24:
+                for(r=0;r<Samples;r++,In+=3)
+                {
+                    Out[r]=(int32_t)((uint32_t)In[0]<<8 | (uint32_t)In[1]<<16 |
+                            (uint32_t)In[2]<<24)>>8;
+                }
+            break;
+        }
+
+        BlockUsed+=Copy;
+        TotalFrames+=Copy;
+        Frames-=Copy;
+
+        if(BlockUsed==Header.BlockFrames)
+            EncodeBlock();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::End
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMWriter::End(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function writes out the last block and the index and ends the
+ *    "LPCM" data block.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMWriter::Start()
+ ******************************************************************************/
+void RIFFLPCMWriter::End(void)
+{
+    struct RIFFLPCMTrailer Trailer;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(BlockUsed>0)
+        EncodeBlock();
+
+    Trailer.TotalFrames=TotalFrames;
+    Trailer.Blocks=Index.size();
+
+    if(!Index.empty())
+        File->WriteArray(Index.data(),Index.size());
+    File->WriteStruct(Trailer);
+    File->EndDataBlock();
+
+    File=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMWriter::EncodeBlock
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMWriter::EncodeBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function codes the frames in 'Block' and writes them out.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::DecodeBlock()
+ ******************************************************************************/
+void RIFFLPCMWriter::EncodeBlock(void)
+{
+    struct RIFFLPCMBlockHeader BlockHeader;
+    struct LPCMBitWriter Bits;
+    unsigned Order[RIFFLPCM_MAX_CHANNELS+2];
+    uint64_t Cost[RIFFLPCM_MAX_CHANNELS+2];
+    unsigned Signal[RIFFLPCM_MAX_CHANNELS];
+    unsigned SignalBits[RIFFLPCM_MAX_CHANNELS];
+    uint64_t Best;
+    unsigned Signals;
+    unsigned Channels;
+    unsigned Mode;
+    uint32_t Frames;
+    uint32_t r;
+    unsigned c;
+    int32_t *Left;
+    int32_t *Right;
+    int32_t *Side;
+    int32_t *Mid;
+
+    Frames=BlockUsed;
+    Channels=Header.Channels;
+
+    /* Stereo also gets a side and mid channel to pick from */
+    Signals=Channels==2?4:Channels;
+    Planes.resize(Signals*Frames);
+    Work.resize(Signals*LPCM_MAX_ORDER*Frames);
+
+    for(c=0;c<Channels;c++)
+        for(r=0;r<Frames;r++)
+            Planes[c*Frames+r]=Block[r*Channels+c];
+
+    for(c=0;c<Channels;c++)
+    {
+        Signal[c]=c;
+        SignalBits[c]=Header.BitsPerSample;
+    }
+
+    Mode=LPCM_STEREO_LEFT_RIGHT;
+    if(Channels==2)
+    {
+        Left=&Planes[0];
+        Right=&Planes[Frames];
+        Side=&Planes[2*Frames];
+        Mid=&Planes[3*Frames];
+        for(r=0;r<Frames;r++)
+        {
+            Side[r]=Left[r]-Right[r];
+            Mid[r]=(Left[r]+Right[r])>>1;
+        }
+    }
+
+    for(c=0;c<Signals;c++)
+    {
+        Order[c]=LPCM_BestOrder(&Planes[c*Frames],Frames,
+                &Work[c*LPCM_MAX_ORDER*Frames],&Cost[c]);
+    }
+
+    if(Channels==2)
+    {
+        Best=Cost[0]+Cost[1];
+        if(Cost[0]+Cost[2]<Best)
+        {
+            Best=Cost[0]+Cost[2];
+            Mode=LPCM_STEREO_LEFT_SIDE;
+        }
+        if(Cost[2]+Cost[1]<Best)
+        {
+            Best=Cost[2]+Cost[1];
+            Mode=LPCM_STEREO_SIDE_RIGHT;
+        }
+        if(Cost[3]+Cost[2]<Best)
+        {
+            Best=Cost[3]+Cost[2];
+            Mode=LPCM_STEREO_MID_SIDE;
+        }
+
+        switch(Mode)
+        {
+            case LPCM_STEREO_LEFT_SIDE:
+                Signal[1]=2;
+                SignalBits[1]++;
+            break;
+            case LPCM_STEREO_SIDE_RIGHT:
+                Signal[0]=2;
+                SignalBits[0]++;
+            break;
+            case LPCM_STEREO_MID_SIDE:
+                Signal[0]=3;
+                Signal[1]=2;
+                SignalBits[1]++;
+            break;
+        }
+    }
+
+    Coded.clear();
+    Bits.Out=&Coded;
+    Bits.Acc=0;
+    Bits.Count=0;
+
+    if(Channels==2)
+        LPCM_PutBits(&Bits,Mode,2);
+
+    for(c=0;c<Channels;c++)
+    {
+        LPCM_EncodeSubframe(&Bits,&Planes[Signal[c]*Frames],
+                &Work[Signal[c]*LPCM_MAX_ORDER*Frames],Order[Signal[c]],Frames,
+                SignalBits[c]);
+    }
+    LPCM_FlushBits(&Bits);
+
+    BlockHeader.Frames=Frames;
+    BlockHeader.Bytes=Coded.size();
+
+    Index.push_back(ChunkPos);
+    File->WriteStruct(BlockHeader);
+    File->Write(Coded.data(),Coded.size());
+    ChunkPos+=RIFFStructLayout<RIFFLPCMBlockHeader>::Size+Coded.size();
+
+    BlockUsed=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::RIFFLPCMReader
+ *
+ * SYNOPSIS:
+ *    RIFFLPCMReader::RIFFLPCMReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the lossless PCM reader.  It decodes an
+ *    "LPCM" chunk (see RIFFLPCMWriter) back to the samples that where in
+ *    the WAV "data" chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMWriter::RIFFLPCMWriter()
+ ******************************************************************************/
+RIFFLPCMReader::RIFFLPCMReader()
+{
+    File=NULL;
+    memset(&Header,0x00,sizeof(Header));
+    memset(&Trailer,0x00,sizeof(Trailer));
+    IndexOffset=0;
+    NextBlock=0;
+    BlockFrames=0;
+    BlockPos=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::~RIFFLPCMReader
+ *
+ * SYNOPSIS:
+ *    RIFFLPCMReader::~RIFFLPCMReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFLPCMReader::~RIFFLPCMReader()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::Start
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMReader::Start(class RIFF &RIFF,uint32_t ChunkSize);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to read from.  ReadNextDataBlock() must have just
+ *                returned the "LPCM" data block.
+ *    ChunkSize [I] -- The size ReadNextDataBlock() returned
+ *
+ * FUNCTION:
+ *    This function reads the header and block index of the "LPCM" data
+ *    block so you can Read() the samples.  The reader can only be used
+ *    until you move on to the next chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the chunk isn't valid.
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::Read()
+ ******************************************************************************/
+void RIFFLPCMReader::Start(class RIFF &RIFF,uint32_t ChunkSize)
+{
+    uint32_t HeaderSize;
+    uint32_t TrailerSize;
+    uint32_t Blocks;
+    uint32_t r;
+
+    HeaderSize=RIFFStructLayout<RIFFLPCMHeader>::Size;
+    TrailerSize=RIFFStructLayout<RIFFLPCMTrailer>::Size;
+
+    File=NULL;
+    if(ChunkSize<HeaderSize+TrailerSize)
+        throw(e_RIFFError_BadFormat);
+
+    if(RIFF.ReadStruct(Header)!=HeaderSize)
+        throw(e_RIFFError_BadFormat);
+
+    if(Header.Version!=LPCM_VERSION || Header.Channels<1 ||
+            Header.Channels>RIFFLPCM_MAX_CHANNELS ||
+            (Header.BitsPerSample!=8 && Header.BitsPerSample!=16 &&
+            Header.BitsPerSample!=24))
+    {
+        throw(e_RIFFError_UnsupportedCompression);
+    }
+    if(Header.BlockFrames<1 || Header.BlockFrames>LPCM_MAX_BLOCK_FRAMES)
+        throw(e_RIFFError_BadFormat);
+
+    RIFF.SeekInChunk(ChunkSize-TrailerSize);
+    RIFF.ReadStruct(Trailer);
+
+    Blocks=Trailer.TotalFrames/Header.BlockFrames+
+            (Trailer.TotalFrames%Header.BlockFrames!=0);
+    if(Trailer.Blocks!=Blocks ||
+            Blocks>(ChunkSize-HeaderSize-TrailerSize)/sizeof(uint32_t))
+    {
+        throw(e_RIFFError_BadFormat);
+    }
+
+    IndexOffset=ChunkSize-TrailerSize-Blocks*sizeof(uint32_t);
+    Index.resize(Blocks);
+    if(Blocks>0)
+    {
+        RIFF.SeekInChunk(IndexOffset);
+        RIFF.ReadArray(Index.data(),Blocks);
+    }
+    for(r=0;r<Blocks;r++)
+        if(Index[r]<HeaderSize || Index[r]>=IndexOffset)
+            throw(e_RIFFError_BadFormat);
+
+    RIFF.SeekInChunk(HeaderSize);
+
+    Block.resize(Header.BlockFrames*Header.Channels);
+    NextBlock=0;
+    BlockFrames=0;
+    BlockPos=0;
+    File=&RIFF;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::GetChannels
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFLPCMReader::GetChannels(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of channels in the samples.
+ *
+ * RETURNS:
+ *    The number of channels
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::Start()
+ ******************************************************************************/
+unsigned RIFFLPCMReader::GetChannels(void)
+{
+    return Header.Channels;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::GetBitsPerSample
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFLPCMReader::GetBitsPerSample(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the size of one sample (8, 16 or 24).
+ *
+ * RETURNS:
+ *    The number of bits in a sample
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::Start()
+ ******************************************************************************/
+unsigned RIFFLPCMReader::GetBitsPerSample(void)
+{
+    return Header.BitsPerSample;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::GetFrames
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFLPCMReader::GetFrames(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of frames in the chunk.
+ *
+ * RETURNS:
+ *    The number of frames
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::Start()
+ ******************************************************************************/
+uint32_t RIFFLPCMReader::GetFrames(void)
+{
+    return Trailer.TotalFrames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::Read
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFLPCMReader::Read(void *Data,uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Data [O] -- Where to put the samples.  They are the same as in a WAV
+ *                "data" chunk (interleaved, little endian, 8 bit is
+ *                unsigned).
+ *    Frames [I] -- The number of frames to read
+ *
+ * FUNCTION:
+ *    This function decodes the next frames.
+ *
+ * RETURNS:
+ *    The number of frames read.  This is less than 'Frames' at the end.
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::SeekFrame()
+ ******************************************************************************/
+uint32_t RIFFLPCMReader::Read(void *Data,uint32_t Frames)
+{
+    uint8_t *Out;
+    const int32_t *In;
+    uint32_t Done;
+    uint32_t Copy;
+    uint32_t Samples;
+    uint32_t r;
+    int32_t Value;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    Out=(uint8_t *)Data;
+    Done=0;
+    while(Done<Frames)
+    {
+        if(BlockPos>=BlockFrames)
+        {
+            if(NextBlock>=Trailer.Blocks)
+                break;
+            DecodeBlock();
+        }
+
+        Copy=BlockFrames-BlockPos;
+        if(Copy>Frames-Done)
+            Copy=Frames-Done;
+
+        In=&Block[BlockPos*Header.Channels];
+        Samples=Copy*Header.Channels;
+        switch(Header.BitsPerSample)
+        {
+            case 8:
+                for(r=0;r<Samples;r++)
+                    *Out++=In[r]+128;
+            break;
+            case 16:
+                for(r=0;r<Samples;r++)
+                {
+                    Value=In[r];
+                    *Out++=Value;
+                    *Out++=Value>>8;
+                }
+            break;
+            case 24:
+                for(r=0;r<Samples;r++)
+                {
+                    Value=In[r];
+                    *Out++=Value;
+                    *Out++=Value>>8;
+                    *Out++=Value>>16;
+                }
+            break;
+        }
+
+        BlockPos+=Copy;
+        Done+=Copy;
+    }
+    return Done;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::SeekFrame
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMReader::SeekFrame(uint32_t Frame);
+ *
+ * PARAMETERS:
+ *    Frame [I] -- The frame to read next
+ *
+ * FUNCTION:
+ *    This function moves to a frame.  Only the block the frame is in is
+ *    decoded (using the block index).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMReader::Read()
+ ******************************************************************************/
+void RIFFLPCMReader::SeekFrame(uint32_t Frame)
+{
+    uint32_t BlockNum;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Frame>=Trailer.TotalFrames)
+    {
+        NextBlock=Trailer.Blocks;
+        BlockFrames=0;
+        BlockPos=0;
+        return;
+    }
+
+    BlockNum=Frame/Header.BlockFrames;
+    if(BlockNum+1!=NextBlock || BlockFrames==0)
+    {
+        File->SeekInChunk(Index[BlockNum]);
+        NextBlock=BlockNum;
+        DecodeBlock();
+    }
+    BlockPos=Frame-BlockNum*Header.BlockFrames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFLPCMReader::DecodeBlock
+ *
+ * SYNOPSIS:
+ *    void RIFFLPCMReader::DecodeBlock(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function reads the next block and decodes it into 'Block'.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFLPCMWriter::EncodeBlock()
+ ******************************************************************************/
+void RIFFLPCMReader::DecodeBlock(void)
+{
+    struct RIFFLPCMBlockHeader BlockHeader;
+    struct LPCMBitReader Bits;
+    unsigned SignalBits[RIFFLPCM_MAX_CHANNELS];
+    uint32_t Expected;
+    uint32_t Frames;
+    unsigned Channels;
+    unsigned Mode;
+    uint32_t r;
+    unsigned c;
+    int32_t *First;
+    int32_t *Second;
+    int64_t Mid;
+    int64_t Side;
+
+    Channels=Header.Channels;
+
+    Expected=Header.BlockFrames;
+    if(NextBlock==Trailer.Blocks-1)
+        Expected=Trailer.TotalFrames-NextBlock*Header.BlockFrames;
+
+    if(File->ReadStruct(BlockHeader)!=RIFFStructLayout<RIFFLPCMBlockHeader>::Size)
+        throw(e_RIFFError_BadFormat);
+    if(BlockHeader.Frames!=Expected || BlockHeader.Bytes>IndexOffset)
+        throw(e_RIFFError_BadFormat);
+    Frames=BlockHeader.Frames;
+
+    Coded.resize(BlockHeader.Bytes);
+    File->Read(Coded.data(),BlockHeader.Bytes);
+
+    Bits.Pos=Coded.data();
+    Bits.End=Coded.data()+Coded.size();
+    Bits.Acc=0;
+    Bits.Count=0;
+
+    for(c=0;c<Channels;c++)
+        SignalBits[c]=Header.BitsPerSample;
+
+    Mode=LPCM_STEREO_LEFT_RIGHT;
+    if(Channels==2)
+    {
+        Mode=LPCM_GetBits(&Bits,2);
+        if(Mode==LPCM_STEREO_LEFT_SIDE || Mode==LPCM_STEREO_MID_SIDE)
+            SignalBits[1]++;
+        if(Mode==LPCM_STEREO_SIDE_RIGHT)
+            SignalBits[0]++;
+    }
+
+    Planes.resize(Channels*Frames);
+    for(c=0;c<Channels;c++)
+        LPCM_DecodeSubframe(&Bits,&Planes[c*Frames],Frames,SignalBits[c]);
+
+    if(Channels==2)
+    {
+        First=&Planes[0];
+        Second=&Planes[Frames];
+        for(r=0;r<Frames;r++)
+        {
+            switch(Mode)
+            {
+                case LPCM_STEREO_LEFT_SIDE:
+                    Second[r]=First[r]-Second[r];
+                break;
+                case LPCM_STEREO_SIDE_RIGHT:
+                    First[r]=First[r]+Second[r];
+                break;
+                case LPCM_STEREO_MID_SIDE:
+                    Side=Second[r];
+                    Mid=(int64_t)First[r]*2+(Side&1);
+                    First[r]=(Mid+Side)>>1;
+                    Second[r]=(Mid-Side)>>1;
+                break;
+            }
+        }
+    }
+
+    for(c=0;c<Channels;c++)
+        for(r=0;r<Frames;r++)
+            Block[r*Channels+c]=Planes[c*Frames+r];
+
+    BlockFrames=Frames;
+    BlockPos=0;
+    NextBlock++;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_BestOrder
+ *
+ * SYNOPSIS:
+ *    static unsigned LPCM_BestOrder(const int32_t *Samples,uint32_t Count,
+ *              int32_t *Work,uint64_t *Cost);
+ *
+ * PARAMETERS:
+ *    Samples [I] -- The samples for one channel
+ *    Count [I] -- The number of samples
+ *    Work [O] -- LPCM_MAX_ORDER * 'Count' values.  This is filled in with
+ *                the residuals for each order (order 1 first).
+ *    Cost [O] -- The sum of the residuals for the order picked
+ *
+ * FUNCTION:
+ *    This function works out which fixed predictor does best.  The
+ *    residual for an order is the difference of the one below it, so each
+ *    order is one pass of LPCM_Diff().
+ *
+ * RETURNS:
+ *    The order to use (0 - LPCM_MAX_ORDER)
+ *
+ * SEE ALSO:
+ *    LPCM_EncodeSubframe()
+ ******************************************************************************/
+static unsigned LPCM_BestOrder(const int32_t *Samples,uint32_t Count,
+        int32_t *Work,uint64_t *Cost)
+{
+    const int32_t *Residual;
+    uint64_t Sum;
+    uint64_t Best;
+    unsigned BestOrder;
+    unsigned Order;
+    uint32_t r;
+
+    Residual=Samples;
+    for(Order=1;Order<=LPCM_MAX_ORDER;Order++)
+    {
+        LPCM_Diff(Residual,&Work[(Order-1)*Count],Count);
+        Residual=&Work[(Order-1)*Count];
+    }
+
+    Best=0;
+    BestOrder=0;
+    for(Order=0;Order<=LPCM_MAX_ORDER;Order++)
+    {
+        /* Small blocks are just stored with order 0 */
+        if(Order>0 && Count<=LPCM_MAX_ORDER)
+            break;
+
+        Residual=Order==0?Samples:&Work[(Order-1)*Count];
+        Sum=0;
+        for(r=Count<=LPCM_MAX_ORDER?0:LPCM_MAX_ORDER;r<Count;r++)
+            Sum+=Residual[r]<0?-(int64_t)Residual[r]:Residual[r];
+
+        if(Order==0 || Sum<Best)
+        {
+            Best=Sum;
+            BestOrder=Order;
+        }
+    }
+
+    *Cost=Best;
+    return BestOrder;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_EncodeSubframe
+ *
+ * SYNOPSIS:
+ *    static void LPCM_EncodeSubframe(struct LPCMBitWriter *Bits,
+ *              const int32_t *Samples,const int32_t *Work,unsigned Order,
+ *              uint32_t Count,unsigned SampleBits);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- Where to write the coded channel
+ *    Samples [I] -- The samples for this channel
+ *    Work [I] -- The residuals from LPCM_BestOrder()
+ *    Order [I] -- The predictor order to use
+ *    Count [I] -- The number of samples
+ *    SampleBits [I] -- The number of bits in a sample (one more for a side
+ *                      channel)
+ *
+ * FUNCTION:
+ *    This function codes one channel of a block:
+ *      3 bits -- The predictor order
+ *      'SampleBits' bits -- One for each of the first 'Order' samples
+ *      The residuals in partitions of LPCM_RICE_PARTITION:
+ *          5 bits -- The Rice parameter (k) or LPCM_RICE_ESCAPE
+ *          If it is LPCM_RICE_ESCAPE:
+ *              5 bits -- Bits in each value
+ *              The values (zig zag coded)
+ *          else
+ *              Each value (zig zag coded) as value>>k zeros, a 1, then the
+ *              bottom k bits.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_DecodeSubframe()
+ ******************************************************************************/
+static void LPCM_EncodeSubframe(struct LPCMBitWriter *Bits,
+        const int32_t *Samples,const int32_t *Work,unsigned Order,
+        uint32_t Count,unsigned SampleBits)
+{
+    const int32_t *Residual;
+    uint32_t Start;
+    uint32_t Size;
+    uint32_t Value;
+    uint32_t Max;
+    uint64_t Sum;
+    uint64_t RiceBits;
+    uint64_t EscapeBits;
+    unsigned k;
+    unsigned Width;
+    uint32_t r;
+
+    LPCM_PutBits(Bits,Order,3);
+    for(r=0;r<Order;r++)
+        LPCM_PutBits(Bits,Samples[r],SampleBits);
+
+    Residual=Order==0?Samples:&Work[(Order-1)*Count];
+
+    for(Start=Order;Start<Count;Start+=Size)
+    {
+        Size=Count-Start;
+        if(Size>LPCM_RICE_PARTITION)
+            Size=LPCM_RICE_PARTITION;
+
+        Sum=0;
+        Max=0;
+        for(r=Start;r<Start+Size;r++)
+        {
+            Value=((uint32_t)Residual[r]<<1)^(uint32_t)(Residual[r]>>31);
+            Sum+=Value;
+            if(Value>Max)
+                Max=Value;
+        }
+
+        /* Guess k from the average, then see what it really costs */
+        k=0;
+        while(k<30 && ((uint64_t)Size<<(k+1))<Sum)
+            k++;
+        RiceBits=(uint64_t)Size*(k+1);
+        for(r=Start;r<Start+Size;r++)
+        {
+            Value=((uint32_t)Residual[r]<<1)^(uint32_t)(Residual[r]>>31);
+            RiceBits+=Value>>k;
+        }
+
+        Width=0;
+        while(Width<32 && (Max>>Width)!=0)
+            Width++;
+        EscapeBits=5+(uint64_t)Size*Width;
+
+        if(EscapeBits<RiceBits && Width<32)
+        {
+            LPCM_PutBits(Bits,LPCM_RICE_ESCAPE,5);
+            LPCM_PutBits(Bits,Width,5);
+            for(r=Start;r<Start+Size;r++)
+            {
+                Value=((uint32_t)Residual[r]<<1)^(uint32_t)(Residual[r]>>31);
+                LPCM_PutBits(Bits,Value,Width);
+            }
+        }
+        else
+        {
+            LPCM_PutBits(Bits,k,5);
+            for(r=Start;r<Start+Size;r++)
+            {
+                Value=((uint32_t)Residual[r]<<1)^(uint32_t)(Residual[r]>>31);
+                LPCM_PutZeros(Bits,Value>>k);
+                LPCM_PutBits(Bits,(1U<<k)|(Value&LPCM_MASK(k)),k+1);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_DecodeSubframe
+ *
+ * SYNOPSIS:
+ *    static void LPCM_DecodeSubframe(struct LPCMBitReader *Bits,
+ *              int32_t *Samples,uint32_t Count,unsigned SampleBits);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The coded data
+ *    Samples [O] -- Where to put the samples
+ *    Count [I] -- The number of samples
+ *    SampleBits [I] -- The number of bits in a sample
+ *
+ * FUNCTION:
+ *    This function decodes one channel of a block.  See
+ *    LPCM_EncodeSubframe() for the format.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the data is bad.
+ *
+ * SEE ALSO:
+ *    LPCM_EncodeSubframe()
+ ******************************************************************************/
+static void LPCM_DecodeSubframe(struct LPCMBitReader *Bits,int32_t *Samples,
+        uint32_t Count,unsigned SampleBits)
+{
+    unsigned Order;
+    uint32_t Start;
+    uint32_t Size;
+    uint32_t Value;
+    unsigned k;
+    unsigned Width;
+    uint32_t r;
+    uint32_t *Out;
+
+    Order=LPCM_GetBits(Bits,3);
+    if(Order>LPCM_MAX_ORDER || Order>Count)
+        throw(e_RIFFError_BadFormat);
+
+    for(r=0;r<Order;r++)
+    {
+        Value=LPCM_GetBits(Bits,SampleBits);
+        Samples[r]=(int32_t)(Value<<(32-SampleBits))>>(32-SampleBits);
+    }
+
+    for(Start=Order;Start<Count;Start+=Size)
+    {
+        Size=Count-Start;
+        if(Size>LPCM_RICE_PARTITION)
+            Size=LPCM_RICE_PARTITION;
+
+        k=LPCM_GetBits(Bits,5);
+        if(k==LPCM_RICE_ESCAPE)
+        {
+            Width=LPCM_GetBits(Bits,5);
+            for(r=Start;r<Start+Size;r++)
+            {
+                Value=LPCM_GetBits(Bits,Width);
+                Samples[r]=(int32_t)((Value>>1)^(0U-(Value&1)));
+            }
+        }
+        else
+        {
+            for(r=Start;r<Start+Size;r++)
+            {
+                Value=LPCM_GetUnary(Bits)<<k;
+                Value|=LPCM_GetBits(Bits,k);
+                Samples[r]=(int32_t)((Value>>1)^(0U-(Value&1)));
+            }
+        }
+    }
+
+    /* Undo the prediction (unsigned so bad data can't overflow) */
+    Out=(uint32_t *)Samples;
+    switch(Order)
+    {
+        case 1:
+            for(r=1;r<Count;r++)
+                Out[r]+=Out[r-1];
+        break;
+        case 2:
+            for(r=2;r<Count;r++)
+                Out[r]+=2*Out[r-1]-Out[r-2];
+        break;
+        case 3:
+            for(r=3;r<Count;r++)
+                Out[r]+=3*(Out[r-1]-Out[r-2])+Out[r-3];
+        break;
+        case 4:
+            for(r=4;r<Count;r++)
+                Out[r]+=4*(Out[r-1]+Out[r-3])-6*Out[r-2]-Out[r-4];
+        break;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_PutBits
+ *
+ * SYNOPSIS:
+ *    static void LPCM_PutBits(struct LPCMBitWriter *Bits,uint32_t Value,
+ *              unsigned Count);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being written
+ *    Value [I] -- The value to add.  Only the bottom 'Count' bits are used.
+ *    Count [I] -- The number of bits to add (0 - 32)
+ *
+ * FUNCTION:
+ *    This function adds bits to the coded data (top bit first).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_GetBits()
+ ******************************************************************************/
+static void LPCM_PutBits(struct LPCMBitWriter *Bits,uint32_t Value,
+        unsigned Count)
+{
+    if(Count==0)
+        return;
+
+    Bits->Acc=(Bits->Acc<<Count)|(Value&LPCM_MASK(Count));
+    Bits->Count+=Count;
+    while(Bits->Count>=8)
+    {
+        Bits->Count-=8;
+        Bits->Out->push_back(Bits->Acc>>Bits->Count);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_PutZeros
+ *
+ * SYNOPSIS:
+ *    static void LPCM_PutZeros(struct LPCMBitWriter *Bits,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being written
+ *    Count [I] -- The number of 0 bits to add
+ *
+ * FUNCTION:
+ *    This function adds a run of 0 bits to the coded data.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_GetUnary()
+ ******************************************************************************/
+static void LPCM_PutZeros(struct LPCMBitWriter *Bits,uint32_t Count)
+{
+    while(Count>=32)
+    {
+        LPCM_PutBits(Bits,0,32);
+        Count-=32;
+    }
+    LPCM_PutBits(Bits,0,Count);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_FlushBits
+ *
+ * SYNOPSIS:
+ *    static void LPCM_FlushBits(struct LPCMBitWriter *Bits);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being written
+ *
+ * FUNCTION:
+ *    This function writes out the last byte (padded with 0's).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_PutBits()
+ ******************************************************************************/
+static void LPCM_FlushBits(struct LPCMBitWriter *Bits)
+{
+    if(Bits->Count>0)
+        Bits->Out->push_back(Bits->Acc<<(8-Bits->Count));
+    Bits->Acc=0;
+    Bits->Count=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_FillBits
+ *
+ * SYNOPSIS:
+ *    static void LPCM_FillBits(struct LPCMBitReader *Bits);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being read
+ *
+ * FUNCTION:
+ *    This function loads as many bytes as will fit into 'Acc'.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_GetBits()
+ ******************************************************************************/
+static void LPCM_FillBits(struct LPCMBitReader *Bits)
+{
+    while(Bits->Count<=56 && Bits->Pos<Bits->End)
+    {
+        Bits->Acc|=(uint64_t)*Bits->Pos++<<(56-Bits->Count);
+        Bits->Count+=8;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_GetBits
+ *
+ * SYNOPSIS:
+ *    static uint32_t LPCM_GetBits(struct LPCMBitReader *Bits,unsigned Count);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being read
+ *    Count [I] -- The number of bits to get (0 - 32)
+ *
+ * FUNCTION:
+ *    This function gets the next bits from the coded data.
+ *
+ * RETURNS:
+ *    The bits
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if we run out of data.
+ *
+ * SEE ALSO:
+ *    LPCM_PutBits()
+ ******************************************************************************/
+static uint32_t LPCM_GetBits(struct LPCMBitReader *Bits,unsigned Count)
+{
+    uint32_t Value;
+
+    if(Count==0)
+        return 0;
+
+    if(Bits->Count<Count)
+    {
+        LPCM_FillBits(Bits);
+        if(Bits->Count<Count)
+            throw(e_RIFFError_BadFormat);
+    }
+
+    Value=Bits->Acc>>(64-Count);
+    Bits->Acc<<=Count;
+    Bits->Count-=Count;
+
+    return Value;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_GetUnary
+ *
+ * SYNOPSIS:
+ *    static uint32_t LPCM_GetUnary(struct LPCMBitReader *Bits);
+ *
+ * PARAMETERS:
+ *    Bits [I] -- The bits being read
+ *
+ * FUNCTION:
+ *    This function counts the 0 bits up to the next 1 bit (and skips the
+ *    1).
+ *
+ * RETURNS:
+ *    The number of 0 bits
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if we run out of data.
+ *
+ * SEE ALSO:
+ *    LPCM_PutZeros()
+ ******************************************************************************/
+static uint32_t LPCM_GetUnary(struct LPCMBitReader *Bits)
+{
+    uint32_t Zeros;
+    unsigned Lead;
+
+    Zeros=0;
+    for(;;)
+    {
+        if(Bits->Count==0)
+        {
+            LPCM_FillBits(Bits);
+            if(Bits->Count==0 || Zeros>LPCM_MAX_UNARY)
+                throw(e_RIFFError_BadFormat);
+        }
+
+        /* The bits under 'Count' are always 0 */
+        Lead=Bits->Acc==0?64:LPCM_LeadingZeros(Bits->Acc);
+        if(Lead>=Bits->Count)
+        {
+            Zeros+=Bits->Count;
+            Bits->Acc=0;
+            Bits->Count=0;
+            continue;
+        }
+
+        Zeros+=Lead;
+        Bits->Acc=Lead+1<64?Bits->Acc<<(Lead+1):0;
+        Bits->Count-=Lead+1;
+        return Zeros;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_LeadingZeros
+ *
+ * SYNOPSIS:
+ *    static unsigned LPCM_LeadingZeros(uint64_t Value);
+ *
+ * PARAMETERS:
+ *    Value [I] -- The value to look at (not 0)
+ *
+ * FUNCTION:
+ *    This function counts the 0 bits at the top of a value.
+ *
+ * RETURNS:
+ *    The number of 0 bits before the first 1
+ *
+ * SEE ALSO:
+ *    LPCM_GetUnary()
+ ******************************************************************************/
+static unsigned LPCM_LeadingZeros(uint64_t Value)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(Value);
+#else
+    unsigned Count;
+
+    Count=0;
+    while(!(Value&0x8000000000000000ULL))
+    {
+        Value<<=1;
+        Count++;
+    }
+    return Count;
+#endif
+}
+
+/*******************************************************************************
+ * NAME:
+ *    LPCM_Diff
+ *
+ * SYNOPSIS:
+ *    static void LPCM_Diff(const int32_t *In,int32_t *Out,uint32_t Count);
+ *
+ * PARAMETERS:
+ *    In [I] -- The values
+ *    Out [O] -- The difference between each value and the one before it
+ *               ('Out[0]' is set to 'In[0]')
+ *    Count [I] -- The number of values
+ *
+ * FUNCTION:
+ *    This function is the prediction kernel.  Taking the difference once
+ *    gives the order 1 fixed predictor residual, twice gives order 2, etc.
+ *
+ *    It uses SSE2 / AVX2 (picked at run time) or NEON when the CPU has
+ *    them.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    LPCM_BestOrder()
+ ******************************************************************************/
+#if LPCM_X86
+__attribute__((target("sse2")))
+static uint32_t LPCM_DiffSSE2(const int32_t *In,int32_t *Out,uint32_t Count)
+{
+    __m128i Cur;
+    __m128i Prev;
+    uint32_t r;
+
+    for(r=1;r+4<=Count;r+=4)
+    {
+        Cur=_mm_loadu_si128((const __m128i *)&In[r]);
+        Prev=_mm_loadu_si128((const __m128i *)&In[r-1]);
+        _mm_storeu_si128((__m128i *)&Out[r],_mm_sub_epi32(Cur,Prev));
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static uint32_t LPCM_DiffAVX2(const int32_t *In,int32_t *Out,uint32_t Count)
+{
+    __m256i Cur;
+    __m256i Prev;
+    uint32_t r;
+
+    for(r=1;r+8<=Count;r+=8)
+    {
+        Cur=_mm256_loadu_si256((const __m256i *)&In[r]);
+        Prev=_mm256_loadu_si256((const __m256i *)&In[r-1]);
+        _mm256_storeu_si256((__m256i *)&Out[r],_mm256_sub_epi32(Cur,Prev));
+    }
+    return r;
+}
+
+static int LPCM_DiffLevel(void)
+{
+    if(__builtin_cpu_supports("avx2"))
+        return 2;
+    if(__builtin_cpu_supports("sse2"))
+        return 1;
+    return 0;
+}
+#elif LPCM_NEON
+static uint32_t LPCM_DiffNEON(const int32_t *In,int32_t *Out,uint32_t Count)
+{
+    uint32_t r;
+
+    for(r=1;r+4<=Count;r+=4)
+        vst1q_s32(&Out[r],vsubq_s32(vld1q_s32(&In[r]),vld1q_s32(&In[r-1])));
+    return r;
+}
+#endif
+
+static void LPCM_Diff(const int32_t *In,int32_t *Out,uint32_t Count)
+{
+    uint32_t r;
+
+    if(Count==0)
+        return;
+
+    Out[0]=In[0];
+    r=1;
+
+#if LPCM_X86
+    static const int Level=LPCM_DiffLevel();
+    if(Level==2)
+        r=LPCM_DiffAVX2(In,Out,Count);
+    else if(Level==1)
+        r=LPCM_DiffSSE2(In,Out,Count);
+#elif LPCM_NEON
+    r=LPCM_DiffNEON(In,Out,Count);
+#endif
+
+    for(;r<Count;r++)
+        Out[r]=(int32_t)((uint32_t)In[r]-(uint32_t)In[r-1]);
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * FILENAME: RIFFLPCM.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has a lossless PCM codec (fixed linear prediction and Rice coding,
+ *    like FLAC) for storing WAV sample data in an "LPCM" chunk.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFLPCM_H_
+#define __RIFFLPCM_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+#define RIFFLPCM_CHUNK_ID               "LPCM"
+#define RIFFLPCM_MAX_CHANNELS           8
+#define RIFFLPCM_DEFAULT_BLOCK_FRAMES   4096
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+struct RIFFLPCMHeader
+{
+    uint16_t Version;
+    uint16_t Channels;
+    uint16_t BitsPerSample;
+    uint16_t Reserved;
+    uint32_t BlockFrames;               // Frames in each block (but the last)
+};
+
+struct RIFFLPCMTrailer
+{
+    uint32_t TotalFrames;
+    uint32_t Blocks;
+};
+
+struct RIFFLPCMBlockHeader
+{
+    uint32_t Frames;
+    uint32_t Bytes;                     // Bytes of coded data that follow
+};
+
+RIFF_STRUCT(RIFFLPCMHeader,RIFF_FIELD(RIFFLPCMHeader,Version),
+        RIFF_FIELD(RIFFLPCMHeader,Channels),
+        RIFF_FIELD(RIFFLPCMHeader,BitsPerSample),
+        RIFF_FIELD(RIFFLPCMHeader,Reserved),
+        RIFF_FIELD(RIFFLPCMHeader,BlockFrames));
+RIFF_STRUCT(RIFFLPCMTrailer,RIFF_FIELD(RIFFLPCMTrailer,TotalFrames),
+        RIFF_FIELD(RIFFLPCMTrailer,Blocks));
+RIFF_STRUCT(RIFFLPCMBlockHeader,RIFF_FIELD(RIFFLPCMBlockHeader,Frames),
+        RIFF_FIELD(RIFFLPCMBlockHeader,Bytes));
+
+/***  CLASS DEFINITIONS                ***/
+class RIFFLPCMWriter
+{
+    public:
+        RIFFLPCMWriter();
+        ~RIFFLPCMWriter();
+        void Start(class RIFF &RIFF,unsigned Channels,unsigned BitsPerSample,
+                uint32_t BlockFrames=0);
+        void Write(const void *Data,uint32_t Frames);
+        void End(void);
+
+    private:
+        class RIFF *File;
+        struct RIFFLPCMHeader Header;
+        uint32_t TotalFrames;
+        uint32_t ChunkPos;
+        uint32_t BlockUsed;
+        std::vector<uint32_t> Index;
+        std::vector<int32_t> Block;         // Interleaved samples
+        std::vector<int32_t> Planes;        // One channel after the other
+        std::vector<int32_t> Work;          // Differences for each order
+        std::vector<uint8_t> Coded;
+
+        void EncodeBlock(void);
+};
+
+class RIFFLPCMReader
+{
+    public:
+        RIFFLPCMReader();
+        ~RIFFLPCMReader();
+        void Start(class RIFF &RIFF,uint32_t ChunkSize);
+        unsigned GetChannels(void);
+        unsigned GetBitsPerSample(void);
+        uint32_t GetFrames(void);
+        uint32_t Read(void *Data,uint32_t Frames);
+        void SeekFrame(uint32_t Frame);
+
+    private:
+        class RIFF *File;
+        struct RIFFLPCMHeader Header;
+        struct RIFFLPCMTrailer Trailer;
+        uint32_t IndexOffset;               // Where the block index starts
+        uint32_t NextBlock;
+        uint32_t BlockFrames;               // Frames in the decoded block
+        uint32_t BlockPos;
+        std::vector<uint32_t> Index;
+        std::vector<int32_t> Block;         // Interleaved samples
+        std::vector<int32_t> Planes;
+        std::vector<uint8_t> Coded;
+
+        void DecodeBlock(void);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
@@ -0,0 +1,566 @@
+/*******************************************************************************
+ * FILENAME: RIFFTraceHistogram.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file has a trace handler for the RIFF class that keeps a histogram
+ *    of how long each type of chunk takes.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFTraceHistogram.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::RIFFTraceHistogram
+ *
+ * SYNOPSIS:
+ *    RIFFTraceHistogram::RIFFTraceHistogram();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the trace histogram class.  This class
+ *    collects how long chunks take (from start to end) for each chunk ID
+ *    in log / linear buckets (like an HDR histogram) so you can get
+ *    percentiles out of it without keeping every sample.
+ *
+ *    Hook it up to a RIFF class with:
+ *      RIFF.SetTraceHandler(RIFFTraceHistogram::TraceHandler,&Histogram);
+ *
+ *    Adding a sample is a few adds and a map lookup (skipped if it's the
+ *    same ID as last time) so it can be left on.  This class is not thread
+ *    safe, use one per thread and Merge() them.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetTraceHandler()
+ ******************************************************************************/
+RIFFTraceHistogram::RIFFTraceHistogram()
+{
+    LastKey=0;
+    LastHist=NULL;
+}
+
+RIFFTraceHistogram::~RIFFTraceHistogram()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::TraceHandler
+ *
+ * SYNOPSIS:
+ *    static void RIFFTraceHistogram::TraceHandler(
+ *              const struct RIFFTraceEvent *Event,void *UserData);
+ *
+ * PARAMETERS:
+ *    Event [I] -- The trace event from the RIFF class
+ *    UserData [I] -- A pointer to the RIFFTraceHistogram to add to
+ *
+ * FUNCTION:
+ *    This is the trace handler to give to RIFF::SetTraceHandler().  It adds
+ *    the time for every chunk and group end event to the histogram.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFF::SetTraceHandler()
+ ******************************************************************************/
+void RIFFTraceHistogram::TraceHandler(const struct RIFFTraceEvent *Event,
+        void *UserData)
+{
+    class RIFFTraceHistogram *Histogram=(class RIFFTraceHistogram *)UserData;
+
+    if(Event->Type==e_RIFFTrace_ChunkEnd)
+    {
+        Histogram->Add(Event->ChunkID,false,Event->Writing,
+                Event->EndTime-Event->StartTime);
+    }
+    else if(Event->Type==e_RIFFTrace_GroupEnd)
+    {
+        Histogram->Add(Event->ChunkID,true,Event->Writing,
+                Event->EndTime-Event->StartTime);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Add
+ *
+ * SYNOPSIS:
+ *    void RIFFTraceHistogram::Add(const char *ChunkID,bool Group,
+ *              bool Writing,uint64_t Nanoseconds);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk (or group) ID to add the time to
+ *    Group [I] -- Is this a group (true) or a data block (false)
+ *    Writing [I] -- Was this written (true) or read (false)
+ *    Nanoseconds [I] -- How long it took
+ *
+ * FUNCTION:
+ *    This function adds one sample to the histogram for a chunk ID.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFTraceHistogram::TraceHandler()
+ ******************************************************************************/
+void RIFFTraceHistogram::Add(const char *ChunkID,bool Group,bool Writing,
+        uint64_t Nanoseconds)
+{
+    struct RIFFHistogram *Hist;
+
+    Hist=Find(MakeKey(ChunkID,Group,Writing),true);
+
+    Hist->Counts[Bucket(Nanoseconds)]++;
+    if(Hist->Samples==0 || Nanoseconds<Hist->Min)
+        Hist->Min=Nanoseconds;
+    if(Nanoseconds>Hist->Max)
+        Hist->Max=Nanoseconds;
+    Hist->Samples++;
+    Hist->Sum+=Nanoseconds;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Merge
+ *
+ * SYNOPSIS:
+ *    void RIFFTraceHistogram::Merge(const class RIFFTraceHistogram &Other);
+ *
+ * PARAMETERS:
+ *    Other [I] -- The histograms to add into this one
+ *
+ * FUNCTION:
+ *    This function adds all the samples from another RIFFTraceHistogram to
+ *    this one.  This is used to put together the histograms from many
+ *    threads.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTraceHistogram::Merge(const class RIFFTraceHistogram &Other)
+{
+    std::map<uint64_t,struct RIFFHistogram>::const_iterator i;
+    struct RIFFHistogram *Hist;
+    const struct RIFFHistogram *From;
+    unsigned b;
+
+    for(i=Other.Histograms.begin();i!=Other.Histograms.end();i++)
+    {
+        From=&i->second;
+        if(From->Samples==0)
+            continue;
+
+        Hist=Find(i->first,true);
+        for(b=0;b<RIFFHIST_BUCKETS;b++)
+            Hist->Counts[b]+=From->Counts[b];
+        if(Hist->Samples==0 || From->Min<Hist->Min)
+            Hist->Min=From->Min;
+        if(From->Max>Hist->Max)
+            Hist->Max=From->Max;
+        Hist->Samples+=From->Samples;
+        Hist->Sum+=From->Sum;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Clear
+ *
+ * SYNOPSIS:
+ *    void RIFFTraceHistogram::Clear(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function throws away all the samples.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTraceHistogram::Clear(void)
+{
+    Histograms.clear();
+    LastKey=0;
+    LastHist=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::GetCount
+ *
+ * SYNOPSIS:
+ *    uint64_t RIFFTraceHistogram::GetCount(const char *ChunkID,bool Group,
+ *              bool Writing);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk (or group) ID to look up
+ *    Group [I] -- Look up a group (true) or a data block (false)
+ *    Writing [I] -- Look up writes (true) or reads (false)
+ *
+ * FUNCTION:
+ *    This function gets the number of samples for a chunk ID.
+ *
+ * RETURNS:
+ *    The number of samples (0 if there are none).
+ *
+ * SEE ALSO:
+ *    RIFFTraceHistogram::GetPercentile()
+ ******************************************************************************/
+uint64_t RIFFTraceHistogram::GetCount(const char *ChunkID,bool Group,
+        bool Writing)
+{
+    struct RIFFHistogram *Hist;
+
+    Hist=Find(MakeKey(ChunkID,Group,Writing),false);
+    if(Hist==NULL)
+        return 0;
+    return Hist->Samples;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::GetPercentile
+ *
+ * SYNOPSIS:
+ *    uint64_t RIFFTraceHistogram::GetPercentile(const char *ChunkID,
+ *              bool Group,bool Writing,double Percent);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk (or group) ID to look up
+ *    Group [I] -- Look up a group (true) or a data block (false)
+ *    Writing [I] -- Look up writes (true) or reads (false)
+ *    Percent [I] -- The percentile to get (50, 99, 99.9, etc)
+ *
+ * FUNCTION:
+ *    This function gets a percentile of the time taken for a chunk ID.
+ *
+ * RETURNS:
+ *    The time in ns (within 1/16th).  0 if there are no samples.
+ *
+ * SEE ALSO:
+ *    RIFFTraceHistogram::GetCount()
+ ******************************************************************************/
+uint64_t RIFFTraceHistogram::GetPercentile(const char *ChunkID,bool Group,
+        bool Writing,double Percent)
+{
+    struct RIFFHistogram *Hist;
+
+    Hist=Find(MakeKey(ChunkID,Group,Writing),false);
+    if(Hist==NULL)
+        return 0;
+    return Percentile(Hist,Percent);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Dump
+ *
+ * SYNOPSIS:
+ *    void RIFFTraceHistogram::Dump(FILE *Out);
+ *
+ * PARAMETERS:
+ *    Out [I] -- Where to print the table
+ *
+ * FUNCTION:
+ *    This function prints a table with the count, min, percentiles, max
+ *    and mean time for each chunk ID (in us).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTraceHistogram::Dump(FILE *Out)
+{
+    std::map<uint64_t,struct RIFFHistogram>::const_iterator i;
+    const struct RIFFHistogram *Hist;
+    char ChunkID[5];
+
+    fprintf(Out,"       %-9s %10s %10s %10s %10s %10s %10s %10s %10s\n","ID",
+            "Count","Min us","p50 us","p90 us","p99 us","p99.9 us","Max us",
+            "Mean us");
+
+    for(i=Histograms.begin();i!=Histograms.end();i++)
+    {
+        Hist=&i->second;
+        if(Hist->Samples==0)
+            continue;
+
+        ChunkID[0]=i->first;
+        ChunkID[1]=i->first>>8;
+        ChunkID[2]=i->first>>16;
+        ChunkID[3]=i->first>>24;
+        ChunkID[4]=0;
+
+        fprintf(Out,"%-6s %-4s %-4s %10llu %10.1f %10.1f %10.1f %10.1f "
+                "%10.1f %10.1f %10.1f\n",(i->first>>33)&1?"Write":"Read",
+                (i->first>>32)&1?"LIST":"",ChunkID,
+                (unsigned long long)Hist->Samples,Hist->Min/1000.0,
+                Percentile(Hist,50)/1000.0,Percentile(Hist,90)/1000.0,
+                Percentile(Hist,99)/1000.0,Percentile(Hist,99.9)/1000.0,
+                Hist->Max/1000.0,(double)Hist->Sum/Hist->Samples/1000.0);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Find
+ *
+ * SYNOPSIS:
+ *    struct RIFFHistogram *RIFFTraceHistogram::Find(uint64_t Key,
+ *              bool Create);
+ *
+ * PARAMETERS:
+ *    Key [I] -- The key from MakeKey()
+ *    Create [I] -- Make a new empty histogram if there isn't one
+ *
+ * FUNCTION:
+ *    This function finds the histogram for a key.  The last one found is
+ *    remembered because chunks of the same type tend to come in a row.
+ *
+ * RETURNS:
+ *    A pointer to the histogram or NULL if not found (and 'Create' is false)
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+struct RIFFHistogram *RIFFTraceHistogram::Find(uint64_t Key,bool Create)
+{
+    std::map<uint64_t,struct RIFFHistogram>::iterator i;
+
+    if(LastHist!=NULL && LastKey==Key)
+        return LastHist;
+
+    i=Histograms.find(Key);
+    if(i==Histograms.end())
+    {
+        if(!Create)
+            return NULL;
+        i=Histograms.insert(std::make_pair(Key,RIFFHistogram())).first;
+        memset(&i->second,0,sizeof(struct RIFFHistogram));
+    }
+
+    LastKey=Key;
+    LastHist=&i->second;
+
+    return LastHist;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::MakeKey
+ *
+ * SYNOPSIS:
+ *    static uint64_t RIFFTraceHistogram::MakeKey(const char *ChunkID,
+ *              bool Group,bool Writing);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The 4 letter chunk ID
+ *    Group [I] -- Is this a group
+ *    Writing [I] -- Is this for writing
+ *
+ * FUNCTION:
+ *    This function packs a chunk ID and flags into a key for the map.
+ *
+ * RETURNS:
+ *    The key
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+uint64_t RIFFTraceHistogram::MakeKey(const char *ChunkID,bool Group,
+        bool Writing)
+{
+    uint64_t Key;
+
+    Key=(uint8_t)ChunkID[0] | (uint8_t)ChunkID[1]<<8 |
+            (uint8_t)ChunkID[2]<<16 | (uint32_t)(uint8_t)ChunkID[3]<<24;
+    if(Group)
+        Key|=1ULL<<32;
+    if(Writing)
+        Key|=1ULL<<33;
+
+    return Key;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Bucket
+ *
+ * SYNOPSIS:
+ *    static unsigned RIFFTraceHistogram::Bucket(uint64_t Value);
+ *
+ * PARAMETERS:
+ *    Value [I] -- The value to find the bucket for
+ *
+ * FUNCTION:
+ *    This function works out which bucket a value goes in.  Values under 16
+ *    get a bucket each, after that every power of 2 is split into 16
+ *    buckets.
+ *
+ * RETURNS:
+ *    The bucket index
+ *
+ * SEE ALSO:
+ *    RIFFTraceHistogram::BucketValue()
+ ******************************************************************************/
+unsigned RIFFTraceHistogram::Bucket(uint64_t Value)
+{
+    unsigned Bit;
+    unsigned Sub;
+
+    if(Value<RIFFHIST_SUB_BUCKETS)
+        return Value;
+
+    Bit=0;
+    while((Value>>Bit)>1)
+        Bit++;
+    if(Bit>RIFFHIST_MAX_BITS)
+        return RIFFHIST_BUCKETS-1;
+
+    Sub=(Value>>(Bit-RIFFHIST_SUB_BITS))&(RIFFHIST_SUB_BUCKETS-1);
+    return (Bit-RIFFHIST_SUB_BITS+1)*RIFFHIST_SUB_BUCKETS+Sub;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::BucketValue
+ *
+ * SYNOPSIS:
+ *    static uint64_t RIFFTraceHistogram::BucketValue(unsigned Bucket);
+ *
+ * PARAMETERS:
+ *    Bucket [I] -- The bucket index
+ *
+ * FUNCTION:
+ *    This function gets the value in the middle of a bucket.
+ *
+ * RETURNS:
+ *    The value
+ *
+ * SEE ALSO:
+ *    RIFFTraceHistogram::Bucket()
+ ******************************************************************************/
+uint64_t RIFFTraceHistogram::BucketValue(unsigned Bucket)
+{
+    unsigned Shift;
+    uint64_t Low;
+
+    if(Bucket<RIFFHIST_SUB_BUCKETS)
+        return Bucket;
+
+    Shift=Bucket/RIFFHIST_SUB_BUCKETS-1;
+    Low=(uint64_t)(RIFFHIST_SUB_BUCKETS+Bucket%RIFFHIST_SUB_BUCKETS)<<Shift;
+
+    return Low+((1ULL<<Shift)>>1);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTraceHistogram::Percentile
+ *
+ * SYNOPSIS:
+ *    static uint64_t RIFFTraceHistogram::Percentile(
+ *              const struct RIFFHistogram *Hist,double Percent);
+ *
+ * PARAMETERS:
+ *    Hist [I] -- The histogram to look in
+ *    Percent [I] -- The percentile to get
+ *
+ * FUNCTION:
+ *    This function walks the buckets to find a percentile.  The result is
+ *    kept between the min and max we have seen.
+ *
+ * RETURNS:
+ *    The value at the percentile
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+uint64_t RIFFTraceHistogram::Percentile(const struct RIFFHistogram *Hist,
+        double Percent)
+{
+    uint64_t Want;
+    uint64_t Count;
+    uint64_t Value;
+    unsigned b;
+
+    if(Hist->Samples==0)
+        return 0;
+
+    Want=(uint64_t)(Hist->Samples*Percent/100.0);
+    if(Want>=Hist->Samples)
+        Want=Hist->Samples-1;
+
+    Count=0;
+    for(b=0;b<RIFFHIST_BUCKETS-1;b++)
+    {
+        Count+=Hist->Counts[b];
+        if(Count>Want)
+            break;
+    }
+
+    Value=BucketValue(b);
+    if(Value<Hist->Min)
+        Value=Hist->Min;
+    if(Value>Hist->Max)
+        Value=Hist->Max;
+
+    return Value;
+}
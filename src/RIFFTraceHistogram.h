@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * FILENAME: RIFFTraceHistogram.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is the .h file for the RIFFTraceHistogram class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFTRACEHISTOGRAM_H_
+#define __RIFFTRACEHISTOGRAM_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <map>
+#include <stdio.h>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+/* Each power of 2 is split into 16 buckets so values are within 1/16th.
+   Anything over 2^42 ns (about 73 minutes) goes in the last bucket. */
+#define RIFFHIST_SUB_BITS               4
+#define RIFFHIST_SUB_BUCKETS            (1<<RIFFHIST_SUB_BITS)
+#define RIFFHIST_MAX_BITS               42
+#define RIFFHIST_BUCKETS                ((RIFFHIST_MAX_BITS-RIFFHIST_SUB_BITS+2)*\
+                                                RIFFHIST_SUB_BUCKETS)
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+struct RIFFHistogram
+{
+    uint64_t Counts[RIFFHIST_BUCKETS];
+    uint64_t Samples;
+    uint64_t Sum;
+    uint64_t Min;
+    uint64_t Max;
+};
+
+/***  CLASS DEFINITIONS                ***/
+class RIFFTraceHistogram
+{
+    public:
+        RIFFTraceHistogram();
+        ~RIFFTraceHistogram();
+        static void TraceHandler(const struct RIFFTraceEvent *Event,
+                void *UserData);
+        void Add(const char *ChunkID,bool Group,bool Writing,
+                uint64_t Nanoseconds);
+        void Merge(const class RIFFTraceHistogram &Other);
+        void Clear(void);
+        uint64_t GetCount(const char *ChunkID,bool Group,bool Writing);
+        uint64_t GetPercentile(const char *ChunkID,bool Group,bool Writing,
+                double Percent);
+        void Dump(FILE *Out);
+
+    private:
+        std::map<uint64_t,struct RIFFHistogram> Histograms;
+        uint64_t LastKey;
+        struct RIFFHistogram *LastHist;
+
+        struct RIFFHistogram *Find(uint64_t Key,bool Create);
+        static uint64_t MakeKey(const char *ChunkID,bool Group,bool Writing);
+        static unsigned Bucket(uint64_t Value);
+        static uint64_t BucketValue(unsigned Bucket);
+        static uint64_t Percentile(const struct RIFFHistogram *Hist,
+                double Percent);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
@@ -0,0 +1,994 @@
+/*******************************************************************************
+ * FILENAME: RIFFTree.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This file has the RIFFTree class that loads a file as a tree of nodes as
+ *    they are needed.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFTree.h"
+#include "RIFFIO.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/*** DEFINES                  ***/
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::RIFFTree
+ *
+ * SYNOPSIS:
+ *    RIFFTree::RIFFTree(bool UseIFF=false);
+ *
+ * PARAMETERS:
+ *    UseIFF [I] -- If true then the file is read as an IFF file, else RIFF.
+ *
+ * FUNCTION:
+ *    This is the constructor for the tree class.  The tree class lets you
+ *    get at a file as a tree of nodes (chunks and groups) instead of
+ *    walking it with ReadNextDataBlock().
+ *
+ *    Nothing is read until you ask for it.  The chunks in a group are only
+ *    found the first time you look at the group's children, and the data
+ *    for a chunk is only loaded the first time you call GetData().  This
+ *    means you can pick a few chunks out of a huge file and only read the
+ *    headers of the groups you go through and the chunks you want.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFTree::Open()
+ ******************************************************************************/
+RIFFTree::RIFFTree(bool UseIFF)
+{
+    IO=NULL;
+    IFFMode=UseIFF;
+    Root=NULL;
+    FormsDone=false;
+    CacheLimit=0;
+    CachedBytes=0;
+}
+
+RIFFTree::~RIFFTree()
+{
+    Close();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::Open
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::Open(const char *Filename,const char *FormType);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The file to open
+ *    FormType [I] -- The form type the file must have
+ *
+ * FUNCTION:
+ *    This function opens a file and makes the root node.  Only the file
+ *    header is read.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws the same e_RIFFErrorType errors as the RIFF class.
+ *
+ * SEE ALSO:
+ *    RIFFTree::GetRoot(), RIFFTree::Close()
+ ******************************************************************************/
+void RIFFTree::Open(const char *Filename,const char *FormType)
+{
+    struct RIFFIOOptions Options;
+    uint8_t Header[12];
+
+    Close();
+
+    memset(&Options,0,sizeof(Options));
+    IO=RIFFIO_Create(e_RIFFIO_Buffered,false,&Options);
+    if(IO==NULL)
+        throw(e_RIFFError_UnsupportedIOType);
+
+    if(!IO->Open(Filename,false))
+    {
+        Close();
+        throw(e_RIFFError_FailedToOpenFile);
+    }
+
+    if(!IO->Read(Header,sizeof(Header)))
+    {
+        Close();
+        throw(e_RIFFError_ReadError);
+    }
+
+    if(memcmp(Header,IFFMode?"FORM":"RIFF",4)!=0)
+    {
+        Close();
+        throw(e_RIFFError_BadFormat);
+    }
+
+    if(strlen(FormType)!=4 || memcmp(&Header[8],FormType,4)!=0)
+    {
+        Close();
+        throw(e_RIFFError_FormTypeMismatch);
+    }
+
+    Root=new RIFFNode(this,NULL);
+    memcpy(Root->ChunkID,FormType,4);
+    Root->Group=true;
+    Root->Size=GetSize(&Header[4]);
+    Root->Offset=12;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::Close
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function closes the file and frees all the nodes.  Any node
+ *    pointers you have are no longer valid.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFTree::Open()
+ ******************************************************************************/
+void RIFFTree::Close(void)
+{
+    unsigned r;
+
+    LRU.clear();
+    CachedBytes=0;
+
+    delete Root;
+    Root=NULL;
+    for(r=0;r<Forms.size();r++)
+        delete Forms[r];
+    Forms.clear();
+    FormsDone=false;
+
+    if(IO!=NULL)
+    {
+        IO->Close();
+        delete IO;
+    }
+    IO=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::GetRoot
+ *
+ * SYNOPSIS:
+ *    class RIFFNode *RIFFTree::GetRoot(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the top node of the tree.  This is a group node
+ *    with the form type as its ID.
+ *
+ * RETURNS:
+ *    The root node
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetChild(), RIFFNode::Find()
+ ******************************************************************************/
+class RIFFNode *RIFFTree::GetRoot(void)
+{
+    if(Root==NULL)
+        throw(e_RIFFError_FileNotOpen);
+    return Root;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::GetForm
+ *
+ * SYNOPSIS:
+ *    class RIFFNode *RIFFTree::GetForm(unsigned Index);
+ *
+ * PARAMETERS:
+ *    Index [I] -- The form to get.  0 is the first form (the root).
+ *
+ * FUNCTION:
+ *    This function gets one of the forms in the file.  Most files only have
+ *    one form but big AVI files (and files written with RIFF::NextForm())
+ *    have more forms after the first one ("RIFF" "AVIX").  They are group
+ *    nodes with the form type as their ID, the same as the root.
+ *
+ *    The forms after the first are found the first time you ask for them
+ *    (only their headers are read).  Their form type isn't checked.
+ *
+ * RETURNS:
+ *    The form or NULL if there aren't that many forms in the file
+ *
+ * SEE ALSO:
+ *    RIFFTree::GetRoot(), RIFF::NextForm()
+ ******************************************************************************/
+class RIFFNode *RIFFTree::GetForm(unsigned Index)
+{
+    class RIFFNode *Last;
+    class RIFFNode *Form;
+    uint8_t Header[12];
+    uint64_t Pos;
+    uint32_t Size;
+
+    if(Index==0)
+        return GetRoot();
+
+    if(Root==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    while(Forms.size()<Index && !FormsDone)
+    {
+        /* The next form starts after the last one (the size counts the
+           form type which is before 'Offset') */
+        Last=Forms.empty()?Root:Forms.back();
+        Pos=Last->Offset-4+Last->Size+(Last->Size&1);
+
+        if(!IO->Seek(Pos) || !IO->Read(Header,sizeof(Header)) ||
+                memcmp(Header,IFFMode?"FORM":"RIFF",4)!=0)
+        {
+            FormsDone=true;
+            break;
+        }
+        Size=GetSize(&Header[4]);
+        if(Size<4)
+        {
+            FormsDone=true;
+            break;
+        }
+
+        Form=new RIFFNode(this,NULL);
+        memcpy(Form->ChunkID,&Header[8],4);
+        Form->Group=true;
+        Form->Size=Size;
+        Form->Offset=Pos+12;
+        Forms.push_back(Form);
+    }
+
+    if(Index>Forms.size())
+        return NULL;
+    return Forms[Index-1];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::SetCacheLimit
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::SetCacheLimit(uint64_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The most chunk data to keep loaded.  0 for no limit (the
+ *                 default).
+ *
+ * FUNCTION:
+ *    This function limits how much chunk data is kept in memory.  When
+ *    loading a chunk would go over the limit the chunks that were used the
+ *    longest time ago are unloaded (they will be loaded again if you ask
+ *    for them).  The chunk being loaded is always kept even if it is bigger
+ *    than the limit.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetData()
+ ******************************************************************************/
+void RIFFTree::SetCacheLimit(uint64_t Bytes)
+{
+    CacheLimit=Bytes;
+    Evict(NULL);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::GetCachedBytes
+ *
+ * SYNOPSIS:
+ *    uint64_t RIFFTree::GetCachedBytes(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets how many bytes of chunk data are loaded.
+ *
+ * RETURNS:
+ *    The number of bytes
+ *
+ * SEE ALSO:
+ *    RIFFTree::SetCacheLimit()
+ ******************************************************************************/
+uint64_t RIFFTree::GetCachedBytes(void)
+{
+    return CachedBytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::GetIFFMode
+ *
+ * SYNOPSIS:
+ *    bool RIFFTree::GetIFFMode(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets if the tree is reading an IFF file (big endian
+ *    sizes) or a RIFF file.  Use it to work out the byte order of the data
+ *    in the chunks.
+ *
+ * RETURNS:
+ *    true -- IFF
+ *    false -- RIFF
+ *
+ * SEE ALSO:
+ *    RIFFTree::RIFFTree()
+ ******************************************************************************/
+bool RIFFTree::GetIFFMode(void)
+{
+    return IFFMode;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::LoadChildren
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::LoadChildren(class RIFFNode *Node);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The group node to find the children of
+ *
+ * FUNCTION:
+ *    This function walks the chunk headers in a group and makes a node for
+ *    each one.  Only the headers are read.
+ *
+ *    Compressed data blocks ("CMPR" chunks, see RIFF::StartDataBlock()) get
+ *    the real chunk ID and uncompressed size from the compression header so
+ *    they look like any other chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTree::LoadChildren(class RIFFNode *Node)
+{
+    class RIFFNode *Child;
+    uint8_t Header[12];
+    uint8_t PackHeader[RIFF_PACK_HEADER_SIZE];
+    uint64_t Pos;
+    uint64_t End;
+    uint32_t Size;
+
+    Node->ChildrenLoaded=true;
+    if(!Node->Group)
+        return;
+
+    /* The group size counts the group ID which we have already skipped */
+    Pos=Node->Offset;
+    End=Node->Offset+Node->Size-4;
+
+    while(Pos+8<=End)
+    {
+        ReadAt(Pos,Header,8);
+        Size=GetSize(&Header[4]);
+        if(Pos+8+Size>End)
+            throw(e_RIFFError_BadFormat);
+
+        Child=new RIFFNode(this,Node);
+        Node->Children.push_back(Child);
+
+        Child->Size=Size;
+        if(memcmp(Header,"LIST",4)==0 && Size>=4)
+        {
+            ReadAt(Pos+8,&Header[8],4);
+            memcpy(Child->ChunkID,&Header[8],4);
+            Child->Group=true;
+            Child->Offset=Pos+12;
+        }
+        else if(memcmp(Header,RIFF_PACK_CHUNK_ID,4)==0 &&
+                Size>=RIFF_PACK_HEADER_SIZE)
+        {
+            ReadAt(Pos+8,PackHeader,sizeof(PackHeader));
+            RIFF_ReadPackHeader(PackHeader,Size,IFFMode,Child->ChunkID,
+                    &Child->Size);
+            Child->Packed=true;
+            Child->PackedSize=Size;
+            Child->Offset=Pos+8;
+        }
+        else
+        {
+            memcpy(Child->ChunkID,Header,4);
+            Child->Offset=Pos+8;
+        }
+
+        Pos+=8+Size+(Size&1);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::LoadData
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::LoadData(class RIFFNode *Node);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The data block node to load
+ *
+ * FUNCTION:
+ *    This function reads all the data for a chunk into the node (and
+ *    uncompresses it if it is compressed) and unloads other chunks if we are
+ *    over the cache limit.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetData()
+ ******************************************************************************/
+void RIFFTree::LoadData(class RIFFNode *Node)
+{
+    std::vector<uint8_t> Raw;
+
+    Node->Data.resize(Node->Size);
+    if(Node->Packed)
+    {
+        Raw.resize(Node->PackedSize);
+        ReadAt(Node->Offset,Raw.data(),Node->PackedSize);
+        RIFF_UnpackChunk(Raw.data(),Node->PackedSize,IFFMode,
+                Node->Data.data(),Node->Size);
+    }
+    else
+    {
+        ReadAt(Node->Offset,Node->Data.data(),Node->Size);
+    }
+
+    Node->DataLoaded=true;
+    LRU.push_front(Node);
+    Node->LRUPos=LRU.begin();
+    CachedBytes+=Node->Size;
+
+    Evict(Node);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::ReadAt
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::ReadAt(uint64_t Offset,void *Data,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Offset [I] -- Where in the file to read from
+ *    Data [O] -- Where to put the bytes
+ *    Bytes [I] -- How many bytes to read
+ *
+ * FUNCTION:
+ *    This function reads bytes from anywhere in the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTree::ReadAt(uint64_t Offset,void *Data,uint32_t Bytes)
+{
+    if(IO==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(IO->Tell()!=Offset && !IO->Seek(Offset))
+        throw(e_RIFFError_ReadError);
+    if(!IO->Read(Data,Bytes))
+        throw(e_RIFFError_ReadError);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::GetSize
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFTree::GetSize(const uint8_t *SizeBuff);
+ *
+ * PARAMETERS:
+ *    SizeBuff [I] -- The 4 bytes of the size from the file
+ *
+ * FUNCTION:
+ *    This function converts a size from the file from IFF or RIFF as
+ *    needed.
+ *
+ * RETURNS:
+ *    The size
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+uint32_t RIFFTree::GetSize(const uint8_t *SizeBuff)
+{
+    if(IFFMode)
+    {
+        return (uint32_t)SizeBuff[0]<<24 | SizeBuff[1]<<16 | SizeBuff[2]<<8 |
+                SizeBuff[3];
+    }
+    return (uint32_t)SizeBuff[3]<<24 | SizeBuff[2]<<16 | SizeBuff[1]<<8 |
+            SizeBuff[0];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::Touch
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::Touch(class RIFFNode *Node);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The loaded node that was just used
+ *
+ * FUNCTION:
+ *    This function moves a node to the front of the LRU list so it is the
+ *    last one to be unloaded.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTree::Touch(class RIFFNode *Node)
+{
+    LRU.splice(LRU.begin(),LRU,Node->LRUPos);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::Drop
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::Drop(class RIFFNode *Node);
+ *
+ * PARAMETERS:
+ *    Node [I] -- The node to unload
+ *
+ * FUNCTION:
+ *    This function frees the data loaded for a node.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+void RIFFTree::Drop(class RIFFNode *Node)
+{
+    if(!Node->DataLoaded)
+        return;
+
+    LRU.erase(Node->LRUPos);
+    CachedBytes-=Node->Size;
+
+    Node->DataLoaded=false;
+    std::vector<uint8_t>().swap(Node->Data);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFTree::Evict
+ *
+ * SYNOPSIS:
+ *    void RIFFTree::Evict(class RIFFNode *Keep);
+ *
+ * PARAMETERS:
+ *    Keep [I] -- A node that must not be unloaded (or NULL)
+ *
+ * FUNCTION:
+ *    This function unloads the least recently used chunks until we are
+ *    under the cache limit.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFTree::SetCacheLimit()
+ ******************************************************************************/
+void RIFFTree::Evict(class RIFFNode *Keep)
+{
+    if(CacheLimit==0)
+        return;
+
+    while(CachedBytes>CacheLimit && !LRU.empty() && LRU.back()!=Keep)
+        Drop(LRU.back());
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::RIFFNode
+ *
+ * SYNOPSIS:
+ *    RIFFNode::RIFFNode(class RIFFTree *Tree,class RIFFNode *Parent);
+ *
+ * PARAMETERS:
+ *    Tree [I] -- The tree this node is in
+ *    Parent [I] -- The group this node is in (NULL for the root)
+ *
+ * FUNCTION:
+ *    This is the constructor for a node.  Nodes are only made by RIFFTree.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+RIFFNode::RIFFNode(class RIFFTree *Tree,class RIFFNode *Parent)
+{
+    this->Tree=Tree;
+    this->Parent=Parent;
+    memset(ChunkID,0,sizeof(ChunkID));
+    Group=false;
+    Size=0;
+    Offset=0;
+    Packed=false;
+    PackedSize=0;
+    ChildrenLoaded=false;
+    DataLoaded=false;
+}
+
+RIFFNode::~RIFFNode()
+{
+    unsigned r;
+
+    for(r=0;r<Children.size();r++)
+        delete Children[r];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::GetID
+ *
+ * SYNOPSIS:
+ *    const char *RIFFNode::GetID(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the chunk ID (or group ID for groups, or form type
+ *    for the root) of this node.
+ *
+ * RETURNS:
+ *    The ID as a string.
+ *
+ * SEE ALSO:
+ *    
+ ******************************************************************************/
+const char *RIFFNode::GetID(void)
+{
+    return ChunkID;
+}
+
+bool RIFFNode::IsGroup(void)
+{
+    return Group;
+}
+
+/* The size from the chunk header (for groups this includes the group ID,
+   for compressed chunks it is the uncompressed size) */
+uint32_t RIFFNode::GetSize(void)
+{
+    return Size;
+}
+
+/* Where the data for this chunk starts in the file (after the group ID, for
+   compressed chunks this is the compression header) */
+uint64_t RIFFNode::GetOffset(void)
+{
+    return Offset;
+}
+
+class RIFFNode *RIFFNode::GetParent(void)
+{
+    return Parent;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::GetChildCount
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFNode::GetChildCount(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of chunks / groups in this group.  The
+ *    first time this (or any of the other child functions) is called the
+ *    headers in the group are read.
+ *
+ * RETURNS:
+ *    The number of children.  Always 0 for data blocks.
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetChild()
+ ******************************************************************************/
+unsigned RIFFNode::GetChildCount(void)
+{
+    if(!ChildrenLoaded)
+        Tree->LoadChildren(this);
+    return Children.size();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::GetChild
+ *
+ * SYNOPSIS:
+ *    class RIFFNode *RIFFNode::GetChild(unsigned Index);
+ *
+ * PARAMETERS:
+ *    Index [I] -- Which child to get (in file order)
+ *
+ * FUNCTION:
+ *    This function gets one of the chunks / groups in this group.
+ *
+ * RETURNS:
+ *    The child node or NULL if 'Index' is past the end.
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetChildCount(), RIFFNode::FindChild()
+ ******************************************************************************/
+class RIFFNode *RIFFNode::GetChild(unsigned Index)
+{
+    if(!ChildrenLoaded)
+        Tree->LoadChildren(this);
+    if(Index>=Children.size())
+        return NULL;
+    return Children[Index];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::FindChild
+ *
+ * SYNOPSIS:
+ *    class RIFFNode *RIFFNode::FindChild(const char *ChunkID,unsigned Nth=0);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk / group ID to look for
+ *    Nth [I] -- Which one to get if there is more than one (0 is the first)
+ *
+ * FUNCTION:
+ *    This function finds a chunk / group in this group by ID.
+ *
+ * RETURNS:
+ *    The child node or NULL if not found.
+ *
+ * SEE ALSO:
+ *    RIFFNode::Find()
+ ******************************************************************************/
+class RIFFNode *RIFFNode::FindChild(const char *ChunkID,unsigned Nth)
+{
+    unsigned r;
+
+    if(!ChildrenLoaded)
+        Tree->LoadChildren(this);
+
+    for(r=0;r<Children.size();r++)
+    {
+        if(strcmp(Children[r]->ChunkID,ChunkID)==0)
+        {
+            if(Nth==0)
+                return Children[r];
+            Nth--;
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::Find
+ *
+ * SYNOPSIS:
+ *    class RIFFNode *RIFFNode::Find(const char *Path);
+ *
+ * PARAMETERS:
+ *    Path [I] -- The IDs of the groups to go through and the chunk to find
+ *                split with '/'.  For example "INFO/INAM".
+ *
+ * FUNCTION:
+ *    This function finds a node under this one by path.  The first match
+ *    at each level is used.  Only the groups on the path are read.
+ *
+ * RETURNS:
+ *    The node or NULL if not found.
+ *
+ * SEE ALSO:
+ *    RIFFNode::FindChild()
+ ******************************************************************************/
+class RIFFNode *RIFFNode::Find(const char *Path)
+{
+    class RIFFNode *Node;
+    char ID[5];
+    const char *End;
+
+    Node=this;
+    while(Node!=NULL && *Path!=0)
+    {
+        End=strchr(Path,'/');
+        if(End==NULL)
+            End=Path+strlen(Path);
+        if(End-Path!=4)
+            return NULL;
+
+        memcpy(ID,Path,4);
+        ID[4]=0;
+        Node=Node->FindChild(ID);
+
+        Path=End;
+        if(*Path=='/')
+            Path++;
+    }
+    return Node;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::GetData
+ *
+ * SYNOPSIS:
+ *    const uint8_t *RIFFNode::GetData(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the data for a chunk.  The first time it is called
+ *    the whole chunk is read into memory.  After that the loaded copy is
+ *    used until it is unloaded.
+ *
+ * RETURNS:
+ *    A pointer to GetSize() bytes or NULL for groups.  The pointer is good
+ *    until Unload() is called or (if there is a cache limit) until the next
+ *    time GetData() is called on another node.
+ *
+ * SEE ALSO:
+ *    RIFFNode::Read(), RIFFTree::SetCacheLimit()
+ ******************************************************************************/
+const uint8_t *RIFFNode::GetData(void)
+{
+    if(Group)
+        return NULL;
+
+    if(DataLoaded)
+        Tree->Touch(this);
+    else
+        Tree->LoadData(this);
+
+    return Data.data();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::Read
+ *
+ * SYNOPSIS:
+ *    void RIFFNode::Read(void *Data,uint32_t Offset,uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Data [O] -- Where to put the bytes
+ *    Offset [I] -- Where in the chunk to start
+ *    Bytes [I] -- How many bytes to read
+ *
+ * FUNCTION:
+ *    This function reads part of a chunk without loading it.  If the chunk
+ *    is already loaded the bytes are copied from memory.  Compressed chunks
+ *    can't be read in parts so they are loaded (see GetData()) first.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_ChunkToSmall if the bytes are past the end of the
+ *    chunk.
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetData()
+ ******************************************************************************/
+void RIFFNode::Read(void *Data,uint32_t Offset,uint32_t Bytes)
+{
+    if((uint64_t)Offset+Bytes>Size)
+        throw(e_RIFFError_ChunkToSmall);
+
+    if(Packed)
+        GetData();
+
+    if(DataLoaded)
+    {
+        memcpy(Data,this->Data.data()+Offset,Bytes);
+        return;
+    }
+
+    Tree->ReadAt(this->Offset+Offset,Data,Bytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFNode::Unload
+ *
+ * SYNOPSIS:
+ *    void RIFFNode::Unload(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function frees the loaded data for a chunk.  It will be loaded
+ *    again the next time GetData() is called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFNode::GetData()
+ ******************************************************************************/
+void RIFFNode::Unload(void)
+{
+    Tree->Drop(this);
+}
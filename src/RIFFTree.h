@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * FILENAME: RIFFTree.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is the .h file for the RIFFTree and RIFFNode classes.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFTREE_H_
+#define __RIFFTREE_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <list>
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+typedef std::list<class RIFFNode *> t_RIFFNodeLRU;
+
+/***  CLASS DEFINITIONS                ***/
+class RIFFNode
+{
+    friend class RIFFTree;
+
+    public:
+        const char *GetID(void);
+        bool IsGroup(void);
+        uint32_t GetSize(void);
+        uint64_t GetOffset(void);
+        class RIFFNode *GetParent(void);
+        unsigned GetChildCount(void);
+        class RIFFNode *GetChild(unsigned Index);
+        class RIFFNode *FindChild(const char *ChunkID,unsigned Nth=0);
+        class RIFFNode *Find(const char *Path);
+        const uint8_t *GetData(void);
+        void Read(void *Data,uint32_t Offset,uint32_t Bytes);
+        void Unload(void);
+
+    private:
+        RIFFNode(class RIFFTree *Tree,class RIFFNode *Parent);
+        ~RIFFNode();
+
+        class RIFFTree *Tree;
+        class RIFFNode *Parent;
+        char ChunkID[5];
+        bool Group;
+        uint32_t Size;              // Size from the chunk header
+        uint64_t Offset;            // File offset of the data
+        bool Packed;                // A compressed data block ("CMPR")
+        uint32_t PackedSize;        // Size of the "CMPR" chunk in the file
+        bool ChildrenLoaded;
+        std::vector<class RIFFNode *> Children;
+        bool DataLoaded;
+        std::vector<uint8_t> Data;
+        t_RIFFNodeLRU::iterator LRUPos;
+};
+
+class RIFFTree
+{
+    friend class RIFFNode;
+
+    public:
+        RIFFTree(bool UseIFF=false);
+        ~RIFFTree();
+        void Open(const char *Filename,const char *FormType);
+        void Close(void);
+        class RIFFNode *GetRoot(void);
+        class RIFFNode *GetForm(unsigned Index);
+        void SetCacheLimit(uint64_t Bytes);
+        uint64_t GetCachedBytes(void);
+        bool GetIFFMode(void);
+
+    private:
+        class RIFFIO *IO;
+        bool IFFMode;
+        class RIFFNode *Root;
+        std::vector<class RIFFNode *> Forms;    // The forms after the root
+        bool FormsDone;                         // Found all of 'Forms'
+        uint64_t CacheLimit;
+        uint64_t CachedBytes;
+        t_RIFFNodeLRU LRU;          // Loaded payloads, most recent first
+
+        void LoadChildren(class RIFFNode *Node);
+        void LoadData(class RIFFNode *Node);
+        void ReadAt(uint64_t Offset,void *Data,uint32_t Bytes);
+        uint32_t GetSize(const uint8_t *SizeBuff);
+        void Touch(class RIFFNode *Node);
+        void Drop(class RIFFNode *Node);
+        void Evict(class RIFFNode *Keep);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
@@ -0,0 +1,903 @@
+/*******************************************************************************
+ * FILENAME: RIFFVisitor.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has a class that walks a RIFF / IFF file and hands the chunks
+ *    off to a pool of worker threads for processing.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFVisitor.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/*** DEFINES                  ***/
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+struct VisitQueue
+{
+    std::mutex Lock;
+    std::deque<size_t> Jobs;
+};
+
+struct VisitState
+{
+    const std::vector<struct RIFFVisitJob> *Jobs;
+    const std::vector<int> *JobHandlers;
+    const std::vector<struct RIFFVisitHandlerInfo> *Handlers;
+    std::vector<void *> Results;
+    std::vector<std::exception_ptr> Errors;
+    std::vector<uint8_t> Done;
+    std::mutex DoneLock;
+    std::condition_variable DoneCond;
+    std::atomic<bool> Abort;
+    std::vector<VisitQueue *> Queues;
+    std::vector<FILE *> Files;
+};
+
+struct VerifyState
+{
+    t_RIFFChecksums Checksums;
+    size_t Next;
+    unsigned Bad;
+    std::vector<struct RIFFChecksum> *BadChunks;
+};
+
+/*** FUNCTION PROTOTYPES      ***/
+static void VisitWorker(struct VisitState *State,unsigned Worker);
+static bool VisitGetJob(struct VisitState *State,unsigned Worker,size_t &Job);
+static void *VerifyCRCHandler(const struct RIFFVisitJob *Job,
+        const uint8_t *Data,void *UserData);
+static void VerifyCRCResult(const struct RIFFVisitJob *Job,void *Result,
+        void *UserData);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::RIFFVisitor
+ *
+ * SYNOPSIS:
+ *    RIFFVisitor::RIFFVisitor(bool UseIFF=false);
+ *
+ * PARAMETERS:
+ *    UseIFF [I] -- If true then the file is read as an IFF file, else RIFF.
+ *
+ * FUNCTION:
+ *    This is the constructor for the visitor class.  The visitor walks a
+ *    file once to find where all the chunks are, then hands the chunks that
+ *    have a handler off to a pool of threads.
+ *
+ *    Each thread has its own queue of chunks to process.  When a thread runs
+ *    out of work it steals from the back of another thread's queue so
+ *    one big chunk does not hold everyone else up.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::Visit()
+ ******************************************************************************/
+RIFFVisitor::RIFFVisitor(bool UseIFF)
+{
+    IFFMode=UseIFF;
+    SplitSize=0;
+    Threads=0;
+    ResultHandler=NULL;
+    ResultUserData=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::~RIFFVisitor
+ *
+ * SYNOPSIS:
+ *    RIFFVisitor::~RIFFVisitor();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFVisitor::~RIFFVisitor()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::AddHandler
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::AddHandler(const char *ChunkID,
+ *              t_RIFFVisitHandler Handler,void *UserData);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The 4 letter ID of the data block to send to 'Handler'.
+ *                   This matches the chunk no matter what group it is in.
+ *    Handler [I] -- The function to call with the chunk data.  This is
+ *                   called from a worker thread.  It is defined as:
+ *                      void *Handler(const struct RIFFVisitJob *Job,
+ *                              const uint8_t *Data,void *UserData);
+ *                   Job -- Info about the chunk (and range of the chunk)
+ *                          that is in 'Data'.
+ *                   Data -- The bytes from the chunk.  This is only valid
+ *                           until the handler returns.
+ *                   UserData -- The 'UserData' passed to AddHandler().
+ *                   The return value is passed to the result handler.
+ *    UserData [I] -- A pointer to pass to the handler.
+ *
+ * FUNCTION:
+ *    This function adds a handler for a chunk ID.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    If more than one handler matches a chunk the path handlers are
+ *    checked first, then the handlers in the order they where added.
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::AddPathHandler(), RIFFVisitor::SetResultHandler()
+ ******************************************************************************/
+void RIFFVisitor::AddHandler(const char *ChunkID,t_RIFFVisitHandler Handler,
+        void *UserData)
+{
+    struct RIFFVisitHandlerInfo NewHandler;
+
+    if(strlen(ChunkID)!=4)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    NewHandler.Match=ChunkID;
+    NewHandler.IsPath=false;
+    NewHandler.Handler=Handler;
+    NewHandler.UserData=UserData;
+
+    Handlers.push_back(NewHandler);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::AddPathHandler
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::AddPathHandler(const char *Path,
+ *              t_RIFFVisitHandler Handler,void *UserData);
+ *
+ * PARAMETERS:
+ *    Path [I] -- The full path to the data block to send to 'Handler'.  This
+ *                is the group ID's and the chunk ID with a '/' between them.
+ *                For example "INFO/INAM".  A chunk not in a group is just
+ *                the chunk ID ("data").
+ *    Handler [I] -- The function to call with the chunk data.  See
+ *                   AddHandler()
+ *    UserData [I] -- A pointer to pass to the handler.
+ *
+ * FUNCTION:
+ *    This function adds a handler for chunks found at a path in the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::AddHandler()
+ ******************************************************************************/
+void RIFFVisitor::AddPathHandler(const char *Path,t_RIFFVisitHandler Handler,
+        void *UserData)
+{
+    struct RIFFVisitHandlerInfo NewHandler;
+
+    if(strlen(Path)>=RIFFVISITOR_MAX_PATH)
+        throw(e_RIFFError_InternalError_BadChunkIDSize);
+
+    NewHandler.Match=Path;
+    NewHandler.IsPath=true;
+    NewHandler.Handler=Handler;
+    NewHandler.UserData=UserData;
+
+    Handlers.push_back(NewHandler);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::SetResultHandler
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::SetResultHandler(t_RIFFVisitResult Handler,
+ *              void *UserData);
+ *
+ * PARAMETERS:
+ *    Handler [I] -- The function to call with the results.  This is called
+ *                   from the thread that called Visit() in the same order
+ *                   as the chunks are in the file.  It is defined as:
+ *                      void Handler(const struct RIFFVisitJob *Job,
+ *                              void *Result,void *UserData);
+ *                   Job -- The chunk (and range) this is the result for
+ *                   Result -- What the chunk handler returned.
+ *                   UserData -- The 'UserData' passed in here.
+ *                   This can be NULL to ignore results.
+ *    UserData [I] -- A pointer to pass to the handler.
+ *
+ * FUNCTION:
+ *    This function sets the function that collects the results from the
+ *    chunk handlers.
+ *
+ *    If Visit() throws, the results that were already made are still passed
+ *    to the handler (so you can free them) before the error gets to you.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::AddHandler()
+ ******************************************************************************/
+void RIFFVisitor::SetResultHandler(t_RIFFVisitResult Handler,void *UserData)
+{
+    ResultHandler=Handler;
+    ResultUserData=UserData;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::SetSplitSize
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::SetSplitSize(uint32_t Bytes);
+ *
+ * PARAMETERS:
+ *    Bytes [I] -- The biggest range of a chunk to hand to a handler in one
+ *                 go.  Chunks bigger than this are split into ranges of
+ *                 this size (the last one may be smaller).  0 means never
+ *                 split a chunk (the default).
+ *
+ * FUNCTION:
+ *    This function sets how big a chunk can get before it is split up
+ *    between threads.  This is only useful if your handler can work on
+ *    part of a chunk (a checksum of blocks, converting samples, etc).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFVisitor::SetSplitSize(uint32_t Bytes)
+{
+    SplitSize=Bytes;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::SetThreads
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::SetThreads(unsigned Count);
+ *
+ * PARAMETERS:
+ *    Count [I] -- The number of worker threads to use.  0 means use 1
+ *                 thread for each core (the default).
+ *
+ * FUNCTION:
+ *    This function sets the number of threads in the pool.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFVisitor::SetThreads(unsigned Count)
+{
+    Threads=Count;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::Visit
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::Visit(const char *Filename,const char *FormType);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The file to process
+ *    FormType [I] -- The form type of this file.  This will be checked against
+ *                    the form type in the file.
+ *
+ * FUNCTION:
+ *    This function walks the file finding all the chunks that have handlers,
+ *    then processes them in the thread pool.  Groups are walked into
+ *    automatically.
+ *
+ *    The result handler is called in file order as each result becomes
+ *    ready, so results can be used while the rest of the file is still
+ *    being worked on.
+ *
+ *    Compressed data blocks are not uncompressed, they are handed to the
+ *    "CMPR" handler (if there is one) as they are in the file.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    If a handler throws, the rest of the work is stopped and the exception
+ *    is thrown again from this function (once all the results before it
+ *    have been sent to the result handler).  Results from jobs that were
+ *    already running finish and are sent to the result handler too, so
+ *    nothing the handlers made is lost.
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::AddHandler()
+ ******************************************************************************/
+void RIFFVisitor::Visit(const char *Filename,const char *FormType)
+{
+    class RIFF RIFF(IFFMode);
+    std::vector<struct RIFFVisitJob> Jobs;
+    std::vector<int> JobHandlers;
+
+    /* Find all the chunks we want.  The workers read the file as is so
+       compressed data blocks are left as "CMPR" chunks */
+    RIFF.SetDecompress(false);
+    RIFF.Open(Filename,e_RIFFOpen_Read,FormType);
+    ScanGroup(RIFF,"",Jobs,JobHandlers);
+    RIFF.Close();
+
+    RunJobs(Filename,Jobs,JobHandlers,Handlers,ResultHandler,ResultUserData);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::VerifyChecksums
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFVisitor::VerifyChecksums(const char *Filename,
+ *              const char *FormType,
+ *              std::vector<struct RIFFChecksum> *BadChunks=NULL);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The file to check
+ *    FormType [I] -- The form type of this file.  This will be checked against
+ *                    the form type in the file.
+ *    BadChunks [O] -- If this isn't NULL the checksum entries for the chunks
+ *                     that didn't match are added to it.
+ *
+ * FUNCTION:
+ *    This function checks all the chunks in a file that was written with
+ *    RIFF::SetChecksums() against their checksums.  The chunks are
+ *    checked on the thread pool (see SetThreads()).  The handlers added
+ *    with AddHandler() are not used.
+ *
+ * RETURNS:
+ *    The number of chunks that didn't match their checksum.  A file without
+ *    checksums returns 0.
+ *
+ * SEE ALSO:
+ *    RIFF::SetChecksums(), RIFF::VerifyChunk()
+ ******************************************************************************/
+unsigned RIFFVisitor::VerifyChecksums(const char *Filename,const char *FormType,
+        std::vector<struct RIFFChecksum> *BadChunks)
+{
+    class RIFF RIFF(IFFMode);
+    std::vector<struct RIFFVisitJob> Jobs;
+    std::vector<int> JobHandlers;
+    std::vector<struct RIFFVisitHandlerInfo> CRCHandlers(1);
+    struct VerifyState Verify;
+    struct RIFFVisitJob Job;
+    size_t r;
+
+    RIFF.SetChecksums(true);
+    RIFF.Open(Filename,e_RIFFOpen_Read,FormType);
+    Verify.Checksums=RIFF.GetChecksums();
+    RIFF.Close();
+
+    Verify.Next=0;
+    Verify.Bad=0;
+    Verify.BadChunks=BadChunks;
+
+    CRCHandlers[0].IsPath=false;
+    CRCHandlers[0].Handler=VerifyCRCHandler;
+    CRCHandlers[0].UserData=NULL;
+
+    memset(&Job,0x00,sizeof(Job));
+    for(r=0;r<Verify.Checksums.size();r++)
+    {
+        Job.ChunkOffset=Verify.Checksums[r].Offset;
+        Job.ChunkSize=Verify.Checksums[r].Size;
+        Job.RangeStart=0;
+        Job.RangeBytes=Verify.Checksums[r].Size;
+        Jobs.push_back(Job);
+        JobHandlers.push_back(0);
+    }
+
+    RunJobs(Filename,Jobs,JobHandlers,CRCHandlers,VerifyCRCResult,&Verify);
+
+    return Verify.Bad;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::RunJobs
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::RunJobs(const char *Filename,
+ *              const std::vector<struct RIFFVisitJob> &Jobs,
+ *              const std::vector<int> &JobHandlers,
+ *              const std::vector<struct RIFFVisitHandlerInfo> &JobHandlerList,
+ *              t_RIFFVisitResult Result,void *ResultData);
+ *
+ * PARAMETERS:
+ *    Filename [I] -- The file the jobs are in
+ *    Jobs [I] -- The jobs to do
+ *    JobHandlers [I] -- The index into 'JobHandlerList' for each job
+ *    JobHandlerList [I] -- The handlers to call
+ *    Result [I] -- The result handler (can be NULL)
+ *    ResultData [I] -- The user data to pass to 'Result'
+ *
+ * FUNCTION:
+ *    This function hands the jobs out to the thread pool and sends the
+ *    results to 'Result' in file order.
+ *
+ *    If a job (or 'Result') throws, the jobs not started yet are dropped
+ *    and the results of the ones that finished are still sent to 'Result'
+ *    (still in file order) before the error is thrown on.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::Visit()
+ ******************************************************************************/
+void RIFFVisitor::RunJobs(const char *Filename,
+        const std::vector<struct RIFFVisitJob> &Jobs,
+        const std::vector<int> &JobHandlers,
+        const std::vector<struct RIFFVisitHandlerInfo> &JobHandlerList,
+        t_RIFFVisitResult Result,void *ResultData)
+{
+    std::vector<std::thread> Workers;
+    struct VisitState State;
+    unsigned WorkerCount;
+    unsigned w;
+    size_t r;
+    size_t Reported;
+
+    if(Jobs.empty())
+        return;
+
+    WorkerCount=Threads;
+    if(WorkerCount==0)
+        WorkerCount=std::thread::hardware_concurrency();
+    if(WorkerCount==0)
+        WorkerCount=1;
+    if(WorkerCount>Jobs.size())
+        WorkerCount=Jobs.size();
+
+    State.Jobs=&Jobs;
+    State.JobHandlers=&JobHandlers;
+    State.Handlers=&JobHandlerList;
+    State.Results.resize(Jobs.size(),NULL);
+    State.Errors.resize(Jobs.size());
+    State.Done.resize(Jobs.size(),0);
+    State.Abort=false;
+    Reported=0;
+
+    try
+    {
+        /* Each worker gets its own handle so they can seek on their own */
+        for(w=0;w<WorkerCount;w++)
+        {
+            State.Files.push_back(fopen(Filename,"rb"));
+            if(State.Files.back()==NULL)
+                throw(e_RIFFError_FailedToOpenFile);
+            State.Queues.push_back(new VisitQueue);
+        }
+
+        /* Deal the jobs out round robin so the start of the file gets done
+           first (results are reported in file order) */
+        for(r=0;r<Jobs.size();r++)
+            State.Queues[r%WorkerCount]->Jobs.push_back(r);
+
+        for(w=0;w<WorkerCount;w++)
+            Workers.push_back(std::thread(VisitWorker,&State,w));
+
+        for(r=0;r<Jobs.size();r++)
+        {
+            {
+                std::unique_lock<std::mutex> Lock(State.DoneLock);
+                while(!State.Done[r])
+                    State.DoneCond.wait(Lock);
+            }
+
+            if(State.Errors[r])
+                std::rethrow_exception(State.Errors[r]);
+
+            Reported=r+1;
+            if(Result!=NULL)
+                Result(&Jobs[r],State.Results[r],ResultData);
+        }
+    }
+    catch(...)
+    {
+        State.Abort=true;
+        for(w=0;w<Workers.size();w++)
+            Workers[w].join();
+
+        /* Hand over the results that were done after all (so they can be
+           freed), we are throwing the first error so ignore any more */
+        if(Result!=NULL)
+        {
+            for(r=Reported;r<Jobs.size();r++)
+            {
+                if(!State.Done[r] || State.Errors[r] ||
+                        State.Results[r]==NULL)
+                {
+                    continue;
+                }
+                try
+                {
+                    Result(&Jobs[r],State.Results[r],ResultData);
+                }
+                catch(...)
+                {
+                }
+            }
+        }
+
+        for(w=0;w<State.Files.size();w++)
+            if(State.Files[w]!=NULL)
+                fclose(State.Files[w]);
+        for(w=0;w<State.Queues.size();w++)
+            delete State.Queues[w];
+        throw;
+    }
+
+    for(w=0;w<Workers.size();w++)
+        Workers[w].join();
+    for(w=0;w<State.Files.size();w++)
+        fclose(State.Files[w]);
+    for(w=0;w<State.Queues.size();w++)
+        delete State.Queues[w];
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::ScanGroup
+ *
+ * SYNOPSIS:
+ *    void RIFFVisitor::ScanGroup(class RIFF &RIFF,const char *Path,
+ *              std::vector<struct RIFFVisitJob> &Jobs,
+ *              std::vector<int> &JobHandlers);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file we are walking.
+ *    Path [I] -- The path of the group we are in ("" for the top)
+ *    Jobs [O] -- The list to add the jobs we find to
+ *    JobHandlers [O] -- The handler index for each of the jobs in 'Jobs'
+ *
+ * FUNCTION:
+ *    This function walks the chunks in the current group (and any groups
+ *    inside it) and makes a job for each chunk that has a handler.  Chunks
+ *    bigger than 'SplitSize' are made into more than 1 job.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+void RIFFVisitor::ScanGroup(class RIFF &RIFF,const char *Path,
+        std::vector<struct RIFFVisitJob> &Jobs,std::vector<int> &JobHandlers)
+{
+    char ChunkID[5];
+    uint32_t ChunkLen;
+    e_RIFFDataType DataType;
+    struct RIFFVisitJob Job;
+    char ChunkPath[RIFFVISITOR_MAX_PATH];
+    uint32_t Offset;
+    uint32_t Bytes;
+    int Handler;
+
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkLen,DataType))
+    {
+        if(Path[0]==0)
+            snprintf(ChunkPath,sizeof(ChunkPath),"%s",ChunkID);
+        else
+            snprintf(ChunkPath,sizeof(ChunkPath),"%s/%s",Path,ChunkID);
+
+        if(DataType==e_RIFFData_Group)
+        {
+            RIFF.StartReadingGroup();
+            ScanGroup(RIFF,ChunkPath,Jobs,JobHandlers);
+            RIFF.DoneReadingGroup();
+            continue;
+        }
+
+        Handler=FindHandler(ChunkID,ChunkPath);
+        if(Handler<0)
+            continue;
+
+        strcpy(Job.ChunkID,ChunkID);
+        strcpy(Job.Path,ChunkPath);
+        Job.ChunkOffset=RIFF.GetChunkOffset();
+        Job.ChunkSize=ChunkLen;
+
+        Offset=0;
+        do
+        {
+            Bytes=ChunkLen-Offset;
+            if(SplitSize>0 && Bytes>SplitSize)
+                Bytes=SplitSize;
+
+            Job.RangeStart=Offset;
+            Job.RangeBytes=Bytes;
+            Jobs.push_back(Job);
+            JobHandlers.push_back(Handler);
+
+            Offset+=Bytes;
+        } while(Offset<ChunkLen);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFVisitor::FindHandler
+ *
+ * SYNOPSIS:
+ *    int RIFFVisitor::FindHandler(const char *ChunkID,const char *Path);
+ *
+ * PARAMETERS:
+ *    ChunkID [I] -- The chunk ID to look up
+ *    Path [I] -- The full path to the chunk
+ *
+ * FUNCTION:
+ *    This function finds the handler for a chunk.  Path handlers win over
+ *    chunk ID handlers.
+ *
+ * RETURNS:
+ *    The index into 'Handlers' or -1 if there is no handler for this chunk.
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+int RIFFVisitor::FindHandler(const char *ChunkID,const char *Path)
+{
+    unsigned r;
+
+    for(r=0;r<Handlers.size();r++)
+        if(Handlers[r].IsPath && Handlers[r].Match==Path)
+            return r;
+
+    for(r=0;r<Handlers.size();r++)
+        if(!Handlers[r].IsPath && Handlers[r].Match==ChunkID)
+            return r;
+
+    return -1;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    VisitGetJob
+ *
+ * SYNOPSIS:
+ *    static bool VisitGetJob(struct VisitState *State,unsigned Worker,
+ *              size_t &Job);
+ *
+ * PARAMETERS:
+ *    State [I] -- The shared state for this visit
+ *    Worker [I] -- The worker asking for a job
+ *    Job [O] -- The job to do next
+ *
+ * FUNCTION:
+ *    This function gets the next job for a worker.  It takes from the front
+ *    of its own queue, and if that is empty it steals from the back of
+ *    another worker's queue.
+ *
+ * RETURNS:
+ *    true -- 'Job' has been filled in
+ *    false -- There is no work left.
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+static bool VisitGetJob(struct VisitState *State,unsigned Worker,size_t &Job)
+{
+    unsigned Count;
+    unsigned r;
+    struct VisitQueue *Queue;
+
+    Count=State->Queues.size();
+    for(r=0;r<Count;r++)
+    {
+        Queue=State->Queues[(Worker+r)%Count];
+
+        std::lock_guard<std::mutex> Lock(Queue->Lock);
+        if(Queue->Jobs.empty())
+            continue;
+
+        if(r==0)
+        {
+            Job=Queue->Jobs.front();
+            Queue->Jobs.pop_front();
+        }
+        else
+        {
+            Job=Queue->Jobs.back();
+            Queue->Jobs.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    VisitWorker
+ *
+ * SYNOPSIS:
+ *    static void VisitWorker(struct VisitState *State,unsigned Worker);
+ *
+ * PARAMETERS:
+ *    State [I] -- The shared state for this visit
+ *    Worker [I] -- Which worker this is
+ *
+ * FUNCTION:
+ *    This is the thread function for the worker threads.  It reads the
+ *    chunk data for each job and calls the handler for it.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+static void VisitWorker(struct VisitState *State,unsigned Worker)
+{
+    const struct RIFFVisitJob *Job;
+    const struct RIFFVisitHandlerInfo *Handler;
+    std::vector<uint8_t> Buffer;
+    FILE *File;
+    size_t JobIndex;
+    void *Result;
+
+    File=State->Files[Worker];
+
+    while(!State->Abort && VisitGetJob(State,Worker,JobIndex))
+    {
+        Job=&(*State->Jobs)[JobIndex];
+        Handler=&(*State->Handlers)[(*State->JobHandlers)[JobIndex]];
+        Result=NULL;
+
+        try
+        {
+            Buffer.resize(Job->RangeBytes);
+            if(Job->RangeBytes>0)
+            {
+                if(fseek(File,Job->ChunkOffset+Job->RangeStart,SEEK_SET)!=0)
+                    throw(e_RIFFError_ReadError);
+                if(fread(Buffer.data(),Job->RangeBytes,1,File)!=1)
+                    throw(e_RIFFError_ReadError);
+            }
+
+            Result=Handler->Handler(Job,Buffer.data(),Handler->UserData);
+        }
+        catch(...)
+        {
+            State->Errors[JobIndex]=std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(State->DoneLock);
+            State->Results[JobIndex]=Result;
+            State->Done[JobIndex]=1;
+        }
+        State->DoneCond.notify_all();
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    VerifyCRCHandler
+ *
+ * SYNOPSIS:
+ *    static void *VerifyCRCHandler(const struct RIFFVisitJob *Job,
+ *              const uint8_t *Data,void *UserData);
+ *
+ * PARAMETERS:
+ *    Job [I] -- The chunk to check
+ *    Data [I] -- The chunk data
+ *    UserData [I] -- Not used
+ *
+ * FUNCTION:
+ *    This is the chunk handler for VerifyChecksums().  It works out the
+ *    CRC32C of the chunk.
+ *
+ * RETURNS:
+ *    The CRC (cast to a pointer)
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::VerifyChecksums()
+ ******************************************************************************/
+static void *VerifyCRCHandler(const struct RIFFVisitJob *Job,
+        const uint8_t *Data,void * /*UserData*/)
+{
+    return (void *)(uintptr_t)RIFF_CRC32C(0,Data,Job->RangeBytes);
+}
+
+/*******************************************************************************
+ * NAME:
+ *    VerifyCRCResult
+ *
+ * SYNOPSIS:
+ *    static void VerifyCRCResult(const struct RIFFVisitJob *Job,void *Result,
+ *              void *UserData);
+ *
+ * PARAMETERS:
+ *    Job [I] -- The chunk that was checked
+ *    Result [I] -- The CRC from VerifyCRCHandler()
+ *    UserData [I] -- The 'struct VerifyState'
+ *
+ * FUNCTION:
+ *    This is the result handler for VerifyChecksums().  Results come in
+ *    the same order as the checksum table so we just walk the table.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFVisitor::VerifyChecksums()
+ ******************************************************************************/
+static void VerifyCRCResult(const struct RIFFVisitJob * /*Job*/,void *Result,
+        void *UserData)
+{
+    struct VerifyState *Verify=(struct VerifyState *)UserData;
+    const struct RIFFChecksum *Checksum;
+
+    Checksum=&Verify->Checksums[Verify->Next++];
+    if((uint32_t)(uintptr_t)Result!=Checksum->CRC)
+    {
+        Verify->Bad++;
+        if(Verify->BadChunks!=NULL)
+            Verify->BadChunks->push_back(*Checksum);
+    }
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * FILENAME: RIFFVisitor.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is the .h file for the RIFFVisitor class.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFVISITOR_H_
+#define __RIFFVISITOR_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+#define RIFFVISITOR_MAX_PATH            64
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+struct RIFFVisitJob
+{
+    char ChunkID[5];
+    char Path[RIFFVISITOR_MAX_PATH];    // Group ID's + chunk ID ("INFO/INAM")
+    uint32_t ChunkOffset;               // File offset of the chunk data
+    uint32_t ChunkSize;                 // Total bytes in the chunk
+    uint32_t RangeStart;                // Offset of 'Data' inside the chunk
+    uint32_t RangeBytes;                // Number of bytes in 'Data'
+};
+
+typedef void *(*t_RIFFVisitHandler)(const struct RIFFVisitJob *Job,
+        const uint8_t *Data,void *UserData);
+typedef void (*t_RIFFVisitResult)(const struct RIFFVisitJob *Job,void *Result,
+        void *UserData);
+
+/***  CLASS DEFINITIONS                ***/
+struct RIFFVisitHandlerInfo
+{
+    std::string Match;                  // Chunk ID or full path
+    bool IsPath;
+    t_RIFFVisitHandler Handler;
+    void *UserData;
+};
+
+class RIFFVisitor
+{
+    public:
+        RIFFVisitor(bool UseIFF=false);
+        ~RIFFVisitor();
+        void AddHandler(const char *ChunkID,t_RIFFVisitHandler Handler,
+                void *UserData);
+        void AddPathHandler(const char *Path,t_RIFFVisitHandler Handler,
+                void *UserData);
+        void SetResultHandler(t_RIFFVisitResult Handler,void *UserData);
+        void SetSplitSize(uint32_t Bytes);
+        void SetThreads(unsigned Count);
+        void Visit(const char *Filename,const char *FormType);
+        unsigned VerifyChecksums(const char *Filename,const char *FormType,
+                std::vector<struct RIFFChecksum> *BadChunks=NULL);
+
+    private:
+        bool IFFMode;
+        uint32_t SplitSize;
+        unsigned Threads;
+        std::vector<struct RIFFVisitHandlerInfo> Handlers;
+        t_RIFFVisitResult ResultHandler;
+        void *ResultUserData;
+
+        void ScanGroup(class RIFF &RIFF,const char *Path,
+                std::vector<struct RIFFVisitJob> &Jobs,
+                std::vector<int> &JobHandlers);
+        int FindHandler(const char *ChunkID,const char *Path);
+        void RunJobs(const char *Filename,
+                const std::vector<struct RIFFVisitJob> &Jobs,
+                const std::vector<int> &JobHandlers,
+                const std::vector<struct RIFFVisitHandlerInfo> &JobHandlerList,
+                t_RIFFVisitResult Result,void *ResultData);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
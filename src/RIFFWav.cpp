@@ -0,0 +1,2254 @@
+/*******************************************************************************
+ * FILENAME: RIFFWav.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has classes for reading and writing the samples in WAV files (the
+ *    "fmt " and "data" chunks of a "WAVE" form) converted to / from float or
+ *    int32.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFFWav.h"
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/*** DEFINES                  ***/
+#define WAV_MAX_BLOCK_FRAMES            (1024*1024)
+#define WAV_INT_TO_FLOAT                (1.0f/2147483648.0f)
+#define WAV_FLOAT_INT_MAX               2147483520.0f   // Biggest float < 2^31
+#define WAV_OVERVIEW_VERSION            1
+#define WAV_OVERVIEW_MAX_LEVELS         32
+#define WAV_DEFAULT_CHANNEL_MASK(c)     ((c)<32?(1U<<(c))-1:0)
+
+/* The end of the KSDATAFORMAT_SUBTYPE_xxx GUIDs (after the format tag) */
+#define WAV_SUBFORMAT_GUID  "\x00\x00\x00\x00\x10\x00\x80\x00\x00\xAA\x00\x38\x9B\x71"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WAV_X86                         1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !RIFF_HOST_BIG_ENDIAN
+#define WAV_NEON                        1
+#include <arm_neon.h>
+#endif
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+
+/*** FUNCTION PROTOTYPES      ***/
+static void WAV_UnpackInt(const uint8_t *In,int32_t *Out,uint32_t Count,
+        unsigned Bytes,bool BigEndian);
+static uint32_t WAV_OverviewPoints(uint32_t Frames,uint64_t PointFrames);
+static void WAV_Unpack8(const uint8_t *In,int32_t *Out,uint32_t Count);
+static void WAV_Unpack16(const uint8_t *In,int32_t *Out,uint32_t Count);
+static void WAV_Unpack24(const uint8_t *In,int32_t *Out,uint32_t Count,
+        bool BigEndian);
+static void WAV_Unpack32(const uint8_t *In,int32_t *Out,uint32_t Count);
+static void WAV_IntToFloat(const int32_t *In,float *Out,uint32_t Count);
+static void WAV_FloatToInt(const float *In,int32_t *Out,uint32_t Count,
+        unsigned Bits);
+template <typename T> static void WAV_Interleave(const T * const *Planes,
+        uint32_t Start,unsigned Channels,T *Out,uint32_t Frames);
+static uint32_t WAV_Interleave2(const void *Left,const void *Right,void *Out,
+        uint32_t Frames);
+static void WAV_Dither(float *Data,uint32_t Count,float LSB,uint32_t *State);
+static void WAV_RoundInt(int32_t *Data,uint32_t Count,unsigned Bits);
+static void WAV_PackInt(const int32_t *In,uint8_t *Out,uint32_t Count,
+        unsigned Bytes,bool BigEndian);
+
+/*** VARIABLE DEFINITIONS     ***/
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::RIFFWavReader
+ *
+ * SYNOPSIS:
+ *    RIFFWavReader::RIFFWavReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the WAV reader.  It finds the "fmt " and
+ *    "data" chunks in a WAV file and then reads the samples a block at a
+ *    time, converted to float or int32.  The "data" chunk is never loaded
+ *    all at once.
+ *
+ *    8, 16, 24 and 32 bit int and 32 bit float samples can be read (big
+ *    endian for IFF files).  Samples in an "LPCM" chunk (see RIFFLPCM.h)
+ *    are decoded as they are read.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::Open()
+ ******************************************************************************/
+RIFFWavReader::RIFFWavReader()
+{
+    File=NULL;
+    memset(&Format,0x00,sizeof(Format));
+    BlockFrames=0;
+    FramePos=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::~RIFFWavReader
+ *
+ * SYNOPSIS:
+ *    RIFFWavReader::~RIFFWavReader();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFWavReader::~RIFFWavReader()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::Open
+ *
+ * SYNOPSIS:
+ *    void RIFFWavReader::Open(class RIFF &RIFF,uint32_t BlockFrames=0);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to read.  This must have been opened for reading
+ *                with a form type of "WAVE" (RIFFWAV_FORM_TYPE).
+ *    BlockFrames [I] -- The number of frames to read from the file at a
+ *                       time.  0 for the default
+ *                       (RIFFWAV_DEFAULT_BLOCK_FRAMES).
+ *
+ * FUNCTION:
+ *    This function reads chunks until it finds the "fmt " chunk and then
+ *    the "data" (or "LPCM") chunk.  Other chunks and groups are skipped.
+ *    After this you can get the format with GetFormat() and read the
+ *    samples with ReadFloat() or ReadInt().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the "fmt " or "data" chunk isn't found
+ *    or the "fmt " chunk isn't valid.  Throws
+ *    e_RIFFError_UnsupportedSampleFormat if the samples can't be converted.
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::GetFormat(), RIFFWavReader::ReadFloat(),
+ *    RIFFWavReader::ReadInt()
+ ******************************************************************************/
+void RIFFWavReader::Open(class RIFF &RIFF,uint32_t BlockFrames)
+{
+    struct RIFFWavFmt Fmt;
+    e_RIFFDataType DataType;
+    char ChunkID[5];
+    uint32_t ChunkSize;
+    uint32_t Bytes;
+    unsigned Tag;
+    bool HaveFmt;
+    bool Lossless;
+
+    File=NULL;
+    FramePos=0;
+
+    memset(&Fmt,0x00,sizeof(Fmt));
+    HaveFmt=false;
+    for(;;)
+    {
+        if(!RIFF.ReadNextDataBlock(ChunkID,&ChunkSize,DataType))
+            throw(e_RIFFError_BadFormat);
+        if(DataType!=e_RIFFData_DataBlock)
+            continue;
+
+        if(strcmp(ChunkID,"fmt ")==0)
+        {
+            RIFF.ReadStruct(Fmt);
+            HaveFmt=true;
+            continue;
+        }
+        if(strcmp(ChunkID,"data")==0 || strcmp(ChunkID,RIFFLPCM_CHUNK_ID)==0)
+            break;
+    }
+
+    /* The "fmt " chunk has to come first */
+    if(!HaveFmt)
+        throw(e_RIFFError_BadFormat);
+
+    Tag=Fmt.AudioFormat;
+    Format.ValidBits=Fmt.BitsPerSample;
+    Format.ChannelMask=0;
+    if(Tag==RIFFWAV_FORMAT_EXTENSIBLE)
+    {
+        if(Fmt.ExtraSize<22)
+            throw(e_RIFFError_BadFormat);
+        Tag=Fmt.SubFormat;
+        if(Fmt.ValidBitsPerSample!=0)
+            Format.ValidBits=Fmt.ValidBitsPerSample;
+        Format.ChannelMask=Fmt.ChannelMask;
+    }
+
+    if(Tag!=RIFFWAV_FORMAT_PCM && Tag!=RIFFWAV_FORMAT_FLOAT)
+        throw(e_RIFFError_UnsupportedSampleFormat);
+
+    Format.Channels=Fmt.NumChannels;
+    Format.SampleRate=Fmt.SampleRate;
+    Format.BitsPerSample=Fmt.BitsPerSample;
+    Format.BlockAlign=Fmt.BlockAlign;
+    Format.Float=(Tag==RIFFWAV_FORMAT_FLOAT);
+    Format.BigEndian=RIFF.GetIFFMode();
+
+    if(Format.Channels==0 || Format.BlockAlign==0 ||
+            Format.BlockAlign%Format.Channels!=0)
+    {
+        throw(e_RIFFError_BadFormat);
+    }
+
+    /* Bytes for each sample (24 bit samples could be stored in 4 bytes) */
+    Bytes=Format.BlockAlign/Format.Channels;
+    if(Bytes>4 || Format.BitsPerSample>Bytes*8 ||
+            (Format.Float && (Bytes!=4 || Format.BitsPerSample!=32)))
+    {
+        throw(e_RIFFError_UnsupportedSampleFormat);
+    }
+    if(Format.ValidBits==0 || Format.ValidBits>Bytes*8)
+        Format.ValidBits=Bytes*8;
+
+    Lossless=(strcmp(ChunkID,RIFFLPCM_CHUNK_ID)==0);
+    Format.Lossless=Lossless;
+    if(Lossless)
+    {
+        LPCM.Start(RIFF,ChunkSize);
+        if(Format.Float || LPCM.GetChannels()!=Format.Channels ||
+                LPCM.GetBitsPerSample()!=Bytes*8)
+        {
+            throw(e_RIFFError_BadFormat);
+        }
+
+        /* LPCM always gives us "data" chunk (little endian) samples */
+        Format.BigEndian=false;
+        Format.Frames=LPCM.GetFrames();
+    }
+    else
+    {
+        Format.Frames=ChunkSize/Format.BlockAlign;
+    }
+
+    if(BlockFrames==0)
+        BlockFrames=RIFFWAV_DEFAULT_BLOCK_FRAMES;
+    if(BlockFrames>WAV_MAX_BLOCK_FRAMES)
+        BlockFrames=WAV_MAX_BLOCK_FRAMES;
+    this->BlockFrames=BlockFrames;
+
+    Raw.resize(BlockFrames*Format.BlockAlign);
+    IntWork.clear();
+    FloatWork.clear();
+
+    File=&RIFF;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::GetFormat
+ *
+ * SYNOPSIS:
+ *    const struct RIFFWavFormat &RIFFWavReader::GetFormat(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the format of the samples (from the "fmt " chunk).
+ *
+ * RETURNS:
+ *    The format.  'Frames' is the number of frames in the file.
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::Open()
+ ******************************************************************************/
+const struct RIFFWavFormat &RIFFWavReader::GetFormat(void)
+{
+    return Format;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::GetFramePos
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFWavReader::GetFramePos(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the frame that will be read next.
+ *
+ * RETURNS:
+ *    The frame number (0 is the first frame)
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::ReadFloat()
+ ******************************************************************************/
+uint32_t RIFFWavReader::GetFramePos(void)
+{
+    return FramePos;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::SeekToFrame
+ *
+ * SYNOPSIS:
+ *    void RIFFWavReader::SeekToFrame(uint32_t Frame);
+ *
+ * PARAMETERS:
+ *    Frame [I] -- The frame to read next (0 is the first frame).  Frames
+ *                 past the end move to the end.
+ *
+ * FUNCTION:
+ *    This function moves to a frame so the next ReadFloat() / ReadInt()
+ *    starts there.  You can move forward or back.
+ *
+ *    The file offset is worked out from the block align, so it doesn't
+ *    matter how long the file is.  For a compressed "data" chunk (see
+ *    RIFF::StartDataBlock()) or an "LPCM" chunk only the block the frame is
+ *    in is read (found with the chunk's block index).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::GetFramePos(), RIFF::SeekInChunk()
+ ******************************************************************************/
+void RIFFWavReader::SeekToFrame(uint32_t Frame)
+{
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Frame>Format.Frames)
+        Frame=Format.Frames;
+
+    if(Format.Lossless)
+        LPCM.SeekFrame(Frame);
+    else
+        File->SeekInChunk(Frame*Format.BlockAlign);
+
+    FramePos=Frame;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::ReadFloat
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFWavReader::ReadFloat(float *Samples,uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Samples [O] -- Where to put the samples.  This needs room for 'Frames'
+ *                   times the number of channels.  The channels are
+ *                   interleaved.
+ *    Frames [I] -- The number of frames to read
+ *
+ * FUNCTION:
+ *    This function reads the next frames and converts them to float.  Int
+ *    samples are scaled to -1.0 to 1.0 (1.0 itself can't happen).
+ *
+ * RETURNS:
+ *    The number of frames read.  This is less than 'Frames' at the end of
+ *    the samples.
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::ReadInt()
+ ******************************************************************************/
+uint32_t RIFFWavReader::ReadFloat(float *Samples,uint32_t Frames)
+{
+    uint32_t Done;
+    uint32_t Count;
+    uint32_t Bytes;
+    float *Out;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    Bytes=Format.BlockAlign/Format.Channels;
+    Done=0;
+    while(Done<Frames)
+    {
+        Count=ReadBlock(Frames-Done);
+        if(Count==0)
+            break;
+
+        Out=Samples+(uint64_t)Done*Format.Channels;
+        Count*=Format.Channels;
+        if(Format.Float)
+        {
+            memcpy(Out,Raw.data(),Count*sizeof(float));
+        }
+        else
+        {
+            IntWork.resize(BlockFrames*Format.Channels);
+            WAV_UnpackInt(Raw.data(),IntWork.data(),Count,Bytes,
+                    Format.BigEndian);
+            WAV_IntToFloat(IntWork.data(),Out,Count);
+        }
+        Done+=Count/Format.Channels;
+    }
+    return Done;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::ReadInt
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFWavReader::ReadInt(int32_t *Samples,uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Samples [O] -- Where to put the samples.  This needs room for 'Frames'
+ *                   times the number of channels.  The channels are
+ *                   interleaved.
+ *    Frames [I] -- The number of frames to read
+ *
+ * FUNCTION:
+ *    This function reads the next frames and converts them to int32.  The
+ *    samples use the full int32 range no matter how many bits they have
+ *    (a 16 bit sample is shifted up 16 bits, etc).  Float samples are
+ *    clipped to -1.0 to 1.0.
+ *
+ * RETURNS:
+ *    The number of frames read.  This is less than 'Frames' at the end of
+ *    the samples.
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::ReadFloat()
+ ******************************************************************************/
+uint32_t RIFFWavReader::ReadInt(int32_t *Samples,uint32_t Frames)
+{
+    uint32_t Done;
+    uint32_t Count;
+    uint32_t Bytes;
+    int32_t *Out;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    Bytes=Format.BlockAlign/Format.Channels;
+    Done=0;
+    while(Done<Frames)
+    {
+        Count=ReadBlock(Frames-Done);
+        if(Count==0)
+            break;
+
+        Out=Samples+(uint64_t)Done*Format.Channels;
+        Count*=Format.Channels;
+        if(Format.Float)
+        {
+            FloatWork.resize(BlockFrames*Format.Channels);
+            memcpy(FloatWork.data(),Raw.data(),Count*sizeof(float));
+            WAV_FloatToInt(FloatWork.data(),Out,Count,32);
+        }
+        else
+        {
+            WAV_UnpackInt(Raw.data(),Out,Count,Bytes,Format.BigEndian);
+        }
+        Done+=Count/Format.Channels;
+    }
+    return Done;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavReader::ReadBlock
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFWavReader::ReadBlock(uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Frames [I] -- The most frames to read
+ *
+ * FUNCTION:
+ *    This function reads up to one block of frames from the file into
+ *    'Raw'.  2 and 4 byte samples are swapped to the CPU's byte order, 3
+ *    byte samples are left as they are in the file.
+ *
+ * RETURNS:
+ *    The number of frames read (0 at the end)
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::ReadFloat(), RIFFWavReader::ReadInt()
+ ******************************************************************************/
+uint32_t RIFFWavReader::ReadBlock(uint32_t Frames)
+{
+    uint32_t Bytes;
+
+    if(Frames>BlockFrames)
+        Frames=BlockFrames;
+    if(Frames>Format.Frames-FramePos)
+        Frames=Format.Frames-FramePos;
+    if(Frames==0)
+        return 0;
+
+    if(Format.Lossless)
+        Frames=LPCM.Read(Raw.data(),Frames);
+    else
+        File->Read(Raw.data(),Frames*Format.BlockAlign);
+
+    Bytes=Format.BlockAlign/Format.Channels;
+    if(Format.BigEndian!=RIFF_HOST_BIG_ENDIAN && Bytes!=3)
+        RIFF_SwapBytes(Raw.data(),Bytes,Frames*Format.Channels);
+
+    FramePos+=Frames;
+    return Frames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::RIFFWavWriter
+ *
+ * SYNOPSIS:
+ *    RIFFWavWriter::RIFFWavWriter();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the WAV writer.  It writes the "fmt "
+ *    chunk for you and then takes the samples one buffer per channel
+ *    (planar) as float or int32, interleaves them, converts them to the
+ *    file's format and writes them to the "data" chunk a block at a time.
+ *
+ *    The file can have 16, 24 or 32 bit int or 32 bit float samples (big
+ *    endian for IFF files).
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::Open()
+ ******************************************************************************/
+RIFFWavWriter::RIFFWavWriter()
+{
+    File=NULL;
+    memset(&Format,0x00,sizeof(Format));
+    BlockFrames=0;
+    Dither=true;
+    Lossless=false;
+    memset(DitherState,0x00,sizeof(DitherState));
+    Overview=false;
+    OverviewBase=0;
+    OverviewUsed=0;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::~RIFFWavWriter
+ *
+ * SYNOPSIS:
+ *    RIFFWavWriter::~RIFFWavWriter();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFWavWriter::~RIFFWavWriter()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::SetDither
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::SetDither(bool On);
+ *
+ * PARAMETERS:
+ *    On [I] -- true to add dither, false to just round
+ *
+ * FUNCTION:
+ *    This function sets if TPDF dither (+-1 LSB of triangle shaped noise)
+ *    is added to float samples before they are rounded to the int samples
+ *    in the file.  This is on by default.  It isn't used for float files or
+ *    for samples written with WriteInt().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::WriteFloat()
+ ******************************************************************************/
+void RIFFWavWriter::SetDither(bool On)
+{
+    Dither=On;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::SetLossless
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::SetLossless(bool On);
+ *
+ * PARAMETERS:
+ *    On [I] -- true to write the samples to an "LPCM" chunk
+ *
+ * FUNCTION:
+ *    This function sets if the samples are compressed into an "LPCM" chunk
+ *    (see RIFFLPCMWriter) instead of a "data" chunk.  Only 16 and 24 bit
+ *    int samples can be compressed.  RIFFWavReader reads the "LPCM" chunk
+ *    the same as a "data" chunk, other programs won't know what it is.
+ *    Call before Open().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::Open()
+ ******************************************************************************/
+void RIFFWavWriter::SetLossless(bool On)
+{
+    Lossless=On;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::SetOverview
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::SetOverview(bool On,uint32_t BaseFrames=0);
+ *
+ * PARAMETERS:
+ *    On [I] -- true to write an overview of the samples
+ *    BaseFrames [I] -- The number of frames in each point of the most
+ *                      detailed level.  0 for the default
+ *                      (RIFFWAV_OVERVIEW_BASE_FRAMES).
+ *
+ * FUNCTION:
+ *    This function sets if an overview (for drawing the waveform) is made
+ *    as the samples are written.  The overview is the min, max and RMS of
+ *    each channel for every 'BaseFrames' frames, then for every
+ *    RIFFWAV_OVERVIEW_FACTOR of those, and so on up to one point for the
+ *    whole file.  It is written in an "OVRV" chunk after the "data" chunk
+ *    when Close() is called.  Read it with RIFFWavOverview.  Call before
+ *    Open().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::Close(), RIFFWavOverview::Get()
+ ******************************************************************************/
+void RIFFWavWriter::SetOverview(bool On,uint32_t BaseFrames)
+{
+    Overview=On;
+    OverviewBase=BaseFrames==0?RIFFWAV_OVERVIEW_BASE_FRAMES:BaseFrames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::Open
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::Open(class RIFF &RIFF,unsigned Channels,
+ *              uint32_t SampleRate,unsigned BitsPerSample,bool Float=false,
+ *              uint32_t BlockFrames=0);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to write to.  This must have been opened for
+ *                writing with a form type of "WAVE" (RIFFWAV_FORM_TYPE).
+ *    Channels [I] -- The number of channels
+ *    SampleRate [I] -- The sample rate in Hz
+ *    BitsPerSample [I] -- The size of the samples in the file (16, 24 or
+ *                         32)
+ *    Float [I] -- true for 32 bit float samples, false for int samples
+ *    BlockFrames [I] -- The number of frames to write to the file at a
+ *                       time.  0 for the default
+ *                       (RIFFWAV_DEFAULT_BLOCK_FRAMES).
+ *
+ * FUNCTION:
+ *    This function writes the "fmt " chunk and starts the "data" chunk.
+ *    WAVE_FORMAT_EXTENSIBLE is used for more than 2 channels or more than
+ *    16 bit int samples.  Call WriteFloat() / WriteInt() with the samples
+ *    and then Close().  You can't write any other chunks until Close() is
+ *    called.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * NOTES:
+ *    Throws e_RIFFError_UnsupportedSampleFormat if the samples can't be
+ *    written.
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::WriteFloat(), RIFFWavWriter::Close()
+ ******************************************************************************/
+void RIFFWavWriter::Open(class RIFF &RIFF,unsigned Channels,
+        uint32_t SampleRate,unsigned BitsPerSample,bool Float,
+        uint32_t BlockFrames)
+{
+    typedef RIFFStructLayout<RIFFWavFmt> Layout;
+    uint8_t Buffer[Layout::Size];
+    struct RIFFWavFmt Fmt;
+    uint32_t FmtSize;
+    unsigned Tag;
+    bool Extensible;
+
+    if(Channels<1 || Channels>0xFFFF/4)
+        throw(e_RIFFError_UnsupportedSampleFormat);
+    if(BitsPerSample!=16 && BitsPerSample!=24 && BitsPerSample!=32)
+        throw(e_RIFFError_UnsupportedSampleFormat);
+    if(Float && BitsPerSample!=32)
+        throw(e_RIFFError_UnsupportedSampleFormat);
+    if(Lossless && (Float || BitsPerSample==32 ||
+            Channels>RIFFLPCM_MAX_CHANNELS))
+    {
+        throw(e_RIFFError_UnsupportedSampleFormat);
+    }
+
+    Format.Channels=Channels;
+    Format.SampleRate=SampleRate;
+    Format.BitsPerSample=BitsPerSample;
+    Format.ValidBits=BitsPerSample;
+    Format.BlockAlign=Channels*BitsPerSample/8;
+    Format.ChannelMask=WAV_DEFAULT_CHANNEL_MASK(Channels);
+    Format.Float=Float;
+    Format.BigEndian=RIFF.GetIFFMode() && !Lossless;
+    Format.Lossless=Lossless;
+    Format.Frames=0;
+
+    Tag=Float?RIFFWAV_FORMAT_FLOAT:RIFFWAV_FORMAT_PCM;
+    Extensible=(Channels>2 || (!Float && BitsPerSample>16));
+
+    memset(&Fmt,0x00,sizeof(Fmt));
+    Fmt.AudioFormat=Extensible?RIFFWAV_FORMAT_EXTENSIBLE:Tag;
+    Fmt.NumChannels=Channels;
+    Fmt.SampleRate=SampleRate;
+    Fmt.ByteRate=SampleRate*Format.BlockAlign;
+    Fmt.BlockAlign=Format.BlockAlign;
+    Fmt.BitsPerSample=BitsPerSample;
+    if(Extensible)
+    {
+        Fmt.ExtraSize=RIFFWAV_FMT_SIZE_EXTENSIBLE-RIFFWAV_FMT_SIZE_FLOAT;
+        Fmt.ValidBitsPerSample=BitsPerSample;
+        Fmt.ChannelMask=Format.ChannelMask;
+        Fmt.SubFormat=Tag;
+        memcpy(Fmt.SubFormatGUID,WAV_SUBFORMAT_GUID,
+                sizeof(Fmt.SubFormatGUID));
+        FmtSize=RIFFWAV_FMT_SIZE_EXTENSIBLE;
+    }
+    else
+    {
+        FmtSize=Float?RIFFWAV_FMT_SIZE_FLOAT:RIFFWAV_FMT_SIZE_PCM;
+    }
+
+    /* Only the start of the struct is written for the older formats */
+    Layout::Encode(Fmt,Buffer,RIFF.GetIFFMode()!=RIFF_HOST_BIG_ENDIAN);
+    RIFF.WriteDataBlock("fmt ",Buffer,FmtSize);
+
+    if(BlockFrames==0)
+        BlockFrames=RIFFWAV_DEFAULT_BLOCK_FRAMES;
+    if(BlockFrames>WAV_MAX_BLOCK_FRAMES)
+        BlockFrames=WAV_MAX_BLOCK_FRAMES;
+    this->BlockFrames=BlockFrames;
+
+    Raw.resize(BlockFrames*Format.BlockAlign);
+    IntWork.resize(BlockFrames*Channels);
+    FloatWork.resize(BlockFrames*Channels);
+
+    /* Any seed but 0 works for xorshift */
+    DitherState[0]=0x9E3779B9;
+    DitherState[1]=0x7F4A7C15;
+    DitherState[2]=0x85EBCA6B;
+    DitherState[3]=0xC2B2AE35;
+    DitherState[4]=0x27D4EB2F;
+    DitherState[5]=0x165667B1;
+    DitherState[6]=0xD3A2646C;
+    DitherState[7]=0xFD7046C5;
+
+    if(OverviewBase==0)
+        OverviewBase=RIFFWAV_OVERVIEW_BASE_FRAMES;
+    OverviewUsed=0;
+    OverviewPoint.resize(Channels*3);
+    OverviewPoints.clear();
+
+    if(Lossless)
+        LPCM.Start(RIFF,Channels,BitsPerSample);
+    else
+        RIFF.StartDataBlock("data");
+
+    File=&RIFF;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::WriteFloat
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::WriteFloat(const float * const *Planes,
+ *              uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Planes [I] -- One pointer for each channel to that channel's samples
+ *                  (-1.0 to 1.0)
+ *    Frames [I] -- The number of samples in each channel
+ *
+ * FUNCTION:
+ *    This function interleaves the samples, converts them to the file's
+ *    format (dithered, rounded and clipped for int files) and writes them.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::WriteInt(), RIFFWavWriter::SetDither()
+ ******************************************************************************/
+void RIFFWavWriter::WriteFloat(const float * const *Planes,uint32_t Frames)
+{
+    uint32_t Done;
+    uint32_t Count;
+    uint32_t Samples;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    for(Done=0;Done<Frames;Done+=Count)
+    {
+        Count=Frames-Done;
+        if(Count>BlockFrames)
+            Count=BlockFrames;
+        Samples=Count*Format.Channels;
+
+        WAV_Interleave(Planes,Done,Format.Channels,FloatWork.data(),Count);
+        if(Overview)
+            AddOverview(FloatWork.data(),Count);
+
+        if(Format.Float)
+        {
+            memcpy(Raw.data(),FloatWork.data(),Samples*sizeof(float));
+        }
+        else
+        {
+            if(Dither)
+            {
+                WAV_Dither(FloatWork.data(),Samples,
+                        1.0f/(1U<<(Format.BitsPerSample-1)),DitherState);
+            }
+            WAV_FloatToInt(FloatWork.data(),IntWork.data(),Samples,
+                    Format.BitsPerSample);
+            WAV_PackInt(IntWork.data(),Raw.data(),Samples,
+                    Format.BitsPerSample/8,Format.BigEndian);
+        }
+        WriteBlock(Count);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::WriteInt
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::WriteInt(const int32_t * const *Planes,
+ *              uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Planes [I] -- One pointer for each channel to that channel's samples.
+ *                  These are full range int32's (a 16 bit sample shifted
+ *                  up 16 bits, the same as RIFFWavReader::ReadInt()).
+ *    Frames [I] -- The number of samples in each channel
+ *
+ * FUNCTION:
+ *    This function interleaves the samples, converts them to the file's
+ *    format (rounded to the file's bits) and writes them.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::WriteFloat()
+ ******************************************************************************/
+void RIFFWavWriter::WriteInt(const int32_t * const *Planes,uint32_t Frames)
+{
+    uint32_t Done;
+    uint32_t Count;
+    uint32_t Samples;
+
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    for(Done=0;Done<Frames;Done+=Count)
+    {
+        Count=Frames-Done;
+        if(Count>BlockFrames)
+            Count=BlockFrames;
+        Samples=Count*Format.Channels;
+
+        WAV_Interleave(Planes,Done,Format.Channels,IntWork.data(),Count);
+        if(Overview || Format.Float)
+            WAV_IntToFloat(IntWork.data(),FloatWork.data(),Samples);
+        if(Overview)
+            AddOverview(FloatWork.data(),Count);
+
+        if(Format.Float)
+        {
+            memcpy(Raw.data(),FloatWork.data(),Samples*sizeof(float));
+        }
+        else
+        {
+            WAV_RoundInt(IntWork.data(),Samples,Format.BitsPerSample);
+            WAV_PackInt(IntWork.data(),Raw.data(),Samples,
+                    Format.BitsPerSample/8,Format.BigEndian);
+        }
+        WriteBlock(Count);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::Close
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::Close(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function ends the "data" chunk (and writes the "OVRV" chunk if
+ *    SetOverview() was turned on).  It doesn't close the file, you can
+ *    write more chunks (like an "INFO" group) and then call RIFF::Close().
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::Open()
+ ******************************************************************************/
+void RIFFWavWriter::Close(void)
+{
+    if(File==NULL)
+        throw(e_RIFFError_FileNotOpen);
+
+    if(Format.Lossless)
+        LPCM.End();
+    else
+        File->EndDataBlock();
+
+    if(Overview)
+        WriteOverview();
+
+    File=NULL;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::WriteBlock
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::WriteBlock(uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Frames [I] -- The number of frames in 'Raw'
+ *
+ * FUNCTION:
+ *    This function writes a block of frames from 'Raw' to the file.  2 and
+ *    4 byte samples in 'Raw' are in the CPU's byte order and are swapped
+ *    if the file is the other byte order.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavReader::ReadBlock()
+ ******************************************************************************/
+void RIFFWavWriter::WriteBlock(uint32_t Frames)
+{
+    uint32_t Bytes;
+
+    Bytes=Format.BitsPerSample/8;
+    if(Format.BigEndian!=RIFF_HOST_BIG_ENDIAN && Bytes!=3)
+        RIFF_SwapBytes(Raw.data(),Bytes,Frames*Format.Channels);
+
+    if(Format.Lossless)
+        LPCM.Write(Raw.data(),Frames);
+    else
+        File->Write(Raw.data(),Frames*Format.BlockAlign);
+
+    Format.Frames+=Frames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::AddOverview
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::AddOverview(const float *Samples,uint32_t Frames);
+ *
+ * PARAMETERS:
+ *    Samples [I] -- The interleaved samples being written
+ *    Frames [I] -- The number of frames in 'Samples'
+ *
+ * FUNCTION:
+ *    This function adds samples to the most detailed level of the overview.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::WriteOverview()
+ ******************************************************************************/
+void RIFFWavWriter::AddOverview(const float *Samples,uint32_t Frames)
+{
+    double *Point;
+    double Value;
+    uint32_t r;
+    unsigned c;
+
+    Point=OverviewPoint.data();
+    for(r=0;r<Frames;r++)
+    {
+        if(OverviewUsed==0)
+        {
+            for(c=0;c<Format.Channels;c++)
+            {
+                Point[c*3+0]=HUGE_VAL;
+                Point[c*3+1]=-HUGE_VAL;
+                Point[c*3+2]=0;
+            }
+        }
+
+        for(c=0;c<Format.Channels;c++)
+        {
+            Value=*Samples++;
+            if(Value<Point[c*3+0])
+                Point[c*3+0]=Value;
+            if(Value>Point[c*3+1])
+                Point[c*3+1]=Value;
+            Point[c*3+2]+=Value*Value;
+        }
+
+        if(++OverviewUsed==OverviewBase)
+        {
+            OverviewPoints.insert(OverviewPoints.end(),OverviewPoint.begin(),
+                    OverviewPoint.end());
+            OverviewUsed=0;
+        }
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavWriter::WriteOverview
+ *
+ * SYNOPSIS:
+ *    void RIFFWavWriter::WriteOverview(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function makes the rest of the levels of the overview from the
+ *    most detailed one and writes them out in an "OVRV" chunk.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavWriter::AddOverview(), RIFFWavOverview::Load()
+ ******************************************************************************/
+void RIFFWavWriter::WriteOverview(void)
+{
+    struct RIFFWavOverviewHeader Header;
+    std::vector<double> Level;
+    std::vector<double> Next;
+    std::vector<uint16_t> Packed;
+    uint64_t PointFrames;
+    uint32_t Points;
+    uint32_t Frames;
+    uint32_t p;
+    unsigned Width;
+    unsigned Levels;
+    unsigned c;
+    unsigned a;
+    long Value;
+
+    /* The last point is what ever is left */
+    if(OverviewUsed>0)
+    {
+        OverviewPoints.insert(OverviewPoints.end(),OverviewPoint.begin(),
+                OverviewPoint.end());
+        OverviewUsed=0;
+    }
+
+    Width=Format.Channels*3;
+    Levels=0;
+    if(Format.Frames>0)
+    {
+        for(Points=OverviewPoints.size()/Width,Levels=1;
+                Points>1 && Levels<WAV_OVERVIEW_MAX_LEVELS;Levels++)
+        {
+            Points=(Points+RIFFWAV_OVERVIEW_FACTOR-1)/RIFFWAV_OVERVIEW_FACTOR;
+        }
+    }
+
+    Header.Version=WAV_OVERVIEW_VERSION;
+    Header.Channels=Format.Channels;
+    Header.BaseFrames=OverviewBase;
+    Header.Factor=RIFFWAV_OVERVIEW_FACTOR;
+    Header.Levels=Levels;
+    Header.Frames=Format.Frames;
+
+    File->StartDataBlock(RIFFWAV_OVERVIEW_CHUNK_ID);
+    File->WriteStruct(Header);
+
+    Level.swap(OverviewPoints);
+    PointFrames=OverviewBase;
+    while(Levels-->0)
+    {
+        Points=Level.size()/Width;
+        Packed.resize(Points*Width);
+        for(p=0;p<Points;p++)
+        {
+            Frames=PointFrames;
+            if(p==Points-1)
+                Frames=Format.Frames-(uint64_t)p*PointFrames;
+
+            for(c=0;c<Format.Channels;c++)
+            {
+                for(a=0;a<2;a++)
+                {
+                    Value=lrint(Level[p*Width+c*3+a]*32768);
+                    if(Value<-32768)
+                        Value=-32768;
+                    if(Value>32767)
+                        Value=32767;
+                    Packed[p*Width+c*3+a]=(uint16_t)Value;
+                }
+                Value=lrint(sqrt(Level[p*Width+c*3+2]/Frames)*65535);
+                Packed[p*Width+c*3+2]=Value>65535?65535:Value;
+            }
+        }
+        File->WriteArray(Packed.data(),Packed.size());
+
+        /* Merge the points for the next level */
+        Next.assign(((Points+RIFFWAV_OVERVIEW_FACTOR-1)/
+                RIFFWAV_OVERVIEW_FACTOR)*Width,0);
+        for(p=0;p<Points;p++)
+        {
+            for(c=0;c<Width;c+=3)
+            {
+                a=(p/RIFFWAV_OVERVIEW_FACTOR)*Width+c;
+                if(p%RIFFWAV_OVERVIEW_FACTOR==0 || Level[p*Width+c]<Next[a])
+                    Next[a]=Level[p*Width+c];
+                if(p%RIFFWAV_OVERVIEW_FACTOR==0 || Level[p*Width+c+1]>Next[a+1])
+                    Next[a+1]=Level[p*Width+c+1];
+                Next[a+2]+=Level[p*Width+c+2];
+            }
+        }
+        Level.swap(Next);
+        PointFrames*=RIFFWAV_OVERVIEW_FACTOR;
+    }
+
+    File->EndDataBlock();
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::RIFFWavOverview
+ *
+ * SYNOPSIS:
+ *    RIFFWavOverview::RIFFWavOverview();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the constructor for the overview reader.  It loads the "OVRV"
+ *    chunk (see RIFFWavWriter::SetOverview()) and gives the min, max and
+ *    RMS of the samples for any part of the file at any width without
+ *    reading the samples.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Load(), RIFFWavOverview::Get()
+ ******************************************************************************/
+RIFFWavOverview::RIFFWavOverview()
+{
+    memset(&Header,0x00,sizeof(Header));
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::~RIFFWavOverview
+ *
+ * SYNOPSIS:
+ *    RIFFWavOverview::~RIFFWavOverview();
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This is the deconstructure for this class.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *
+ ******************************************************************************/
+RIFFWavOverview::~RIFFWavOverview()
+{
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::Load
+ *
+ * SYNOPSIS:
+ *    bool RIFFWavOverview::Load(class RIFF &RIFF);
+ *    void RIFFWavOverview::Load(class RIFF &RIFF,uint32_t ChunkSize);
+ *
+ * PARAMETERS:
+ *    RIFF [I] -- The file to read the overview from
+ *    ChunkSize [I] -- The size ReadNextDataBlock() returned for the "OVRV"
+ *                     chunk
+ *
+ * FUNCTION:
+ *    This function loads the overview.
+ *
+ *    The first version reads chunks until it finds the "OVRV" chunk.  The
+ *    other chunks (including "data") are skipped without being read.
+ *
+ *    The second version is for when you are reading the chunks yourself
+ *    and ReadNextDataBlock() has just returned the "OVRV" chunk.
+ *
+ * RETURNS:
+ *    true -- The overview was loaded
+ *    false -- There is no "OVRV" chunk in the file (first version only)
+ *
+ * NOTES:
+ *    Throws e_RIFFError_BadFormat if the chunk isn't valid.
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Get()
+ ******************************************************************************/
+bool RIFFWavOverview::Load(class RIFF &RIFF)
+{
+    e_RIFFDataType DataType;
+    char ChunkID[5];
+    uint32_t ChunkSize;
+
+    while(RIFF.ReadNextDataBlock(ChunkID,&ChunkSize,DataType))
+    {
+        if(DataType==e_RIFFData_DataBlock &&
+                strcmp(ChunkID,RIFFWAV_OVERVIEW_CHUNK_ID)==0)
+        {
+            Load(RIFF,ChunkSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+void RIFFWavOverview::Load(class RIFF &RIFF,uint32_t ChunkSize)
+{
+    uint64_t PointFrames;
+    uint64_t Bytes;
+    uint32_t Points;
+    unsigned l;
+
+    Levels.clear();
+
+    if(RIFF.ReadStruct(Header)!=RIFFStructLayout<RIFFWavOverviewHeader>::Size)
+        throw(e_RIFFError_BadFormat);
+    if(Header.Version!=WAV_OVERVIEW_VERSION || Header.Channels==0 ||
+            Header.BaseFrames==0 || Header.Factor<2 ||
+            Header.Levels>WAV_OVERVIEW_MAX_LEVELS ||
+            (Header.Levels==0)!=(Header.Frames==0))
+    {
+        throw(e_RIFFError_BadFormat);
+    }
+
+    /* Make sure all the levels are there before we allocate anything */
+    Bytes=RIFFStructLayout<RIFFWavOverviewHeader>::Size;
+    PointFrames=Header.BaseFrames;
+    for(l=0;l<Header.Levels;l++)
+    {
+        Bytes+=(uint64_t)WAV_OverviewPoints(Header.Frames,PointFrames)*
+                Header.Channels*3*sizeof(uint16_t);
+        PointFrames*=Header.Factor;
+    }
+    if(Bytes>ChunkSize)
+        throw(e_RIFFError_BadFormat);
+
+    Levels.resize(Header.Levels);
+    PointFrames=Header.BaseFrames;
+    for(l=0;l<Header.Levels;l++)
+    {
+        Points=WAV_OverviewPoints(Header.Frames,PointFrames);
+        Levels[l].resize((size_t)Points*Header.Channels*3);
+        RIFF.ReadArray(Levels[l].data(),Levels[l].size());
+        PointFrames*=Header.Factor;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::GetChannels
+ *
+ * SYNOPSIS:
+ *    unsigned RIFFWavOverview::GetChannels(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of channels in the overview.
+ *
+ * RETURNS:
+ *    The number of channels
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Load()
+ ******************************************************************************/
+unsigned RIFFWavOverview::GetChannels(void)
+{
+    return Header.Channels;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::GetFrames
+ *
+ * SYNOPSIS:
+ *    uint32_t RIFFWavOverview::GetFrames(void);
+ *
+ * PARAMETERS:
+ *    NONE
+ *
+ * FUNCTION:
+ *    This function gets the number of frames the overview covers (the same
+ *    as the "data" chunk).
+ *
+ * RETURNS:
+ *    The number of frames
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Load()
+ ******************************************************************************/
+uint32_t RIFFWavOverview::GetFrames(void)
+{
+    return Header.Frames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    RIFFWavOverview::Get
+ *
+ * SYNOPSIS:
+ *    void RIFFWavOverview::Get(unsigned Channel,uint32_t StartFrame,
+ *              uint32_t Frames,unsigned Pixels,struct RIFFWavPeak *Peaks);
+ *
+ * PARAMETERS:
+ *    Channel [I] -- The channel to get
+ *    StartFrame [I] -- The first frame to draw
+ *    Frames [I] -- The number of frames to draw
+ *    Pixels [I] -- The number of pixels to draw them in
+ *    Peaks [O] -- 'Pixels' peaks.  Each is the min, max (-1.0 to 1.0) and
+ *                 RMS (0.0 to 1.0) of the frames under that pixel.  Pixels
+ *                 past the end of the samples are all 0.
+ *
+ * FUNCTION:
+ *    This function works out what to draw for a part of a channel.  It uses
+ *    the least detailed level that still has a point for every pixel so it
+ *    only looks at a few points for each pixel, no matter how many frames
+ *    are under it.  When a pixel is less than one point of the most
+ *    detailed level the point it is in is used.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Load()
+ ******************************************************************************/
+void RIFFWavOverview::Get(unsigned Channel,uint32_t StartFrame,
+        uint32_t Frames,unsigned Pixels,struct RIFFWavPeak *Peaks)
+{
+    const uint16_t *Point;
+    uint64_t PointFrames;
+    uint32_t Points;
+    uint64_t First;
+    uint64_t Last;
+    uint64_t Start;
+    uint64_t End;
+    uint64_t Count;
+    uint64_t Weight;
+    double FramesPerPixel;
+    double SumSquares;
+    double RMS;
+    int16_t Min;
+    int16_t Max;
+    unsigned Level;
+    unsigned Width;
+    unsigned p;
+
+    memset(Peaks,0x00,Pixels*sizeof(struct RIFFWavPeak));
+    if(Levels.empty() || Channel>=Header.Channels || Pixels==0)
+        return;
+
+    /* Find the level with points just smaller than a pixel */
+    FramesPerPixel=(double)Frames/Pixels;
+    Level=0;
+    PointFrames=Header.BaseFrames;
+    while(Level+1<Levels.size() && PointFrames*Header.Factor<=FramesPerPixel)
+    {
+        PointFrames*=Header.Factor;
+        Level++;
+    }
+    Points=WAV_OverviewPoints(Header.Frames,PointFrames);
+    Width=Header.Channels*3;
+
+    for(p=0;p<Pixels;p++)
+    {
+        Start=StartFrame+(uint64_t)(p*FramesPerPixel);
+        End=StartFrame+(uint64_t)((p+1)*FramesPerPixel);
+        if(Start>=Header.Frames)
+            break;
+        if(End>Header.Frames)
+            End=Header.Frames;
+
+        First=Start/PointFrames;
+        Last=(End+PointFrames-1)/PointFrames;
+        if(Last<=First)
+            Last=First+1;
+        if(Last>Points)
+            Last=Points;
+
+        Min=32767;
+        Max=-32768;
+        SumSquares=0;
+        Count=0;
+        for(;First<Last;First++)
+        {
+            Point=&Levels[Level][First*Width+Channel*3];
+            if((int16_t)Point[0]<Min)
+                Min=(int16_t)Point[0];
+            if((int16_t)Point[1]>Max)
+                Max=(int16_t)Point[1];
+
+            Weight=PointFrames;
+            if(First==Points-1)
+                Weight=Header.Frames-First*PointFrames;
+            RMS=Point[2]/65535.0;
+            SumSquares+=RMS*RMS*Weight;
+            Count+=Weight;
+        }
+
+        Peaks[p].Min=Min/32768.0f;
+        Peaks[p].Max=Max/32768.0f;
+        Peaks[p].RMS=sqrt(SumSquares/Count);
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    WAV_OverviewPoints
+ *
+ * SYNOPSIS:
+ *    static uint32_t WAV_OverviewPoints(uint32_t Frames,uint64_t PointFrames);
+ *
+ * PARAMETERS:
+ *    Frames [I] -- The number of frames in the file
+ *    PointFrames [I] -- The number of frames in each point of a level
+ *
+ * FUNCTION:
+ *    This function works out how many points are in a level of the
+ *    overview.
+ *
+ * RETURNS:
+ *    The number of points
+ *
+ * SEE ALSO:
+ *    RIFFWavOverview::Load()
+ ******************************************************************************/
+static uint32_t WAV_OverviewPoints(uint32_t Frames,uint64_t PointFrames)
+{
+    return (Frames+PointFrames-1)/PointFrames;
+}
+
+/*******************************************************************************
+ * NAME:
+ *    WAV_UnpackInt
+ *
+ * SYNOPSIS:
+ *    static void WAV_UnpackInt(const uint8_t *In,int32_t *Out,uint32_t Count,
+ *              unsigned Bytes,bool BigEndian);
+ *
+ * PARAMETERS:
+ *    In [I] -- The samples from RIFFWavReader::ReadBlock()
+ *    Out [O] -- The samples as full range int32's
+ *    Count [I] -- The number of samples
+ *    Bytes [I] -- The bytes in each sample (1 - 4)
+ *    BigEndian [I] -- The byte order of 3 byte samples
+ *
+ * FUNCTION:
+ *    This function converts int samples to int32's, shifting them up so
+ *    the top bit of the sample is the top bit of the int32.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    WAV_IntToFloat()
+ ******************************************************************************/
+static void WAV_UnpackInt(const uint8_t *In,int32_t *Out,uint32_t Count,
+        unsigned Bytes,bool BigEndian)
+{
+    switch(Bytes)
+    {
+        case 1:
+            WAV_Unpack8(In,Out,Count);
+        break;
+        case 2:
+            WAV_Unpack16(In,Out,Count);
+        break;
+        case 3:
+            WAV_Unpack24(In,Out,Count,BigEndian);
+        break;
+        case 4:
+            WAV_Unpack32(In,Out,Count);
+        break;
+    }
+}
+
+/*******************************************************************************
+ * NAME:
+ *    WAV_Unpack8 / WAV_Unpack16 / WAV_Unpack24 / WAV_Unpack32 /
+ *    WAV_IntToFloat / WAV_FloatToInt / WAV_Interleave / WAV_Dither /
+ *    WAV_RoundInt / WAV_PackInt
+ *
+ * SYNOPSIS:
+ *    static void WAV_Unpack8(const uint8_t *In,int32_t *Out,uint32_t Count);
+ *    static void WAV_Unpack16(const uint8_t *In,int32_t *Out,uint32_t Count);
+ *    static void WAV_Unpack24(const uint8_t *In,int32_t *Out,uint32_t Count,
+ *              bool BigEndian);
+ *    static void WAV_Unpack32(const uint8_t *In,int32_t *Out,uint32_t Count);
+ *    static void WAV_IntToFloat(const int32_t *In,float *Out,uint32_t Count);
+ *    static void WAV_FloatToInt(const float *In,int32_t *Out,uint32_t Count,
+ *              unsigned Bits);
+ *    template <typename T> static void WAV_Interleave(
+ *              const T * const *Planes,uint32_t Start,unsigned Channels,
+ *              T *Out,uint32_t Frames);
+ *    static void WAV_Dither(float *Data,uint32_t Count,float LSB,
+ *              uint32_t *State);
+ *    static void WAV_RoundInt(int32_t *Data,uint32_t Count,unsigned Bits);
+ *    static void WAV_PackInt(const int32_t *In,uint8_t *Out,uint32_t Count,
+ *              unsigned Bytes,bool BigEndian);
+ *
+ * PARAMETERS:
+ *    In [I] -- The samples to convert
+ *    Out [O] -- The converted samples
+ *    Data [I/O] -- The samples to change in place
+ *    Count [I] -- The number of samples
+ *    BigEndian [I] -- The byte order of the 3 byte samples
+ *    Bits [I] -- The number of bits to convert to
+ *    Planes [I] -- A pointer to the samples for each channel
+ *    Start [I] -- The first sample in each of 'Planes' to use
+ *    Channels [I] -- The number of channels
+ *    Frames [I] -- The number of samples to take from each channel
+ *    LSB [I] -- The size of 1 bit of the int samples (as a float)
+ *    State [I/O] -- 8 random number seeds
+ *    Bytes [I] -- The bytes to pack each sample into (2 - 4)
+ *
+ * FUNCTION:
+ *    These are the conversion kernels:
+ *      WAV_Unpack8() -- Unsigned 8 bit to int32
+ *      WAV_Unpack16() -- int16 (CPU byte order) to int32
+ *      WAV_Unpack24() -- Packed 3 byte to int32
+ *      WAV_Unpack32() -- int32 (CPU byte order) to int32
+ *      WAV_IntToFloat() -- Full range int32 to -1.0 to 1.0
+ *      WAV_FloatToInt() -- -1.0 to 1.0 to a 'Bits' int (clipped and
+ *                          rounded)
+ *      WAV_Interleave() -- One buffer for each channel to one buffer with
+ *                          the channels interleaved
+ *      WAV_Dither() -- Adds TPDF dither (+-1 LSB)
+ *      WAV_RoundInt() -- Full range int32 to a 'Bits' int (rounded and
+ *                        clipped)
+ *      WAV_PackInt() -- A 'Bytes' int to 2 (CPU byte order), 3 (packed in
+ *                       'BigEndian' byte order) or 4 (CPU byte order) bytes
+ *
+ *    The unpacked samples are all full range int32's (the top bit of the
+ *    sample is the top bit of the int32).
+ *
+ *    They do as much as they can with SSE2 / SSSE3 / AVX2 (picked when the
+ *    program runs) or NEON and then do the rest one sample at a time.
+ *
+ * RETURNS:
+ *    NONE
+ *
+ * SEE ALSO:
+ *    WAV_UnpackInt()
+ ******************************************************************************/
+#if WAV_X86
+/* Byte order for _mm_shuffle_epi8() to turn 4 packed 3 byte samples into 4
+   int32's (with the low byte 0) */
+static const uint8_t m_Unpack24LE[16]=
+{
+    0x80,0,1,2, 0x80,3,4,5, 0x80,6,7,8, 0x80,9,10,11
+};
+static const uint8_t m_Unpack24BE[16]=
+{
+    0x80,2,1,0, 0x80,5,4,3, 0x80,8,7,6, 0x80,11,10,9
+};
+
+/* And back (the low 3 bytes of 4 int32's to 12 packed bytes) */
+static const uint8_t m_Pack24LE[16]=
+{
+    0,1,2, 4,5,6, 8,9,10, 12,13,14, 0x80,0x80,0x80,0x80
+};
+static const uint8_t m_Pack24BE[16]=
+{
+    2,1,0, 6,5,4, 10,9,8, 14,13,12, 0x80,0x80,0x80,0x80
+};
+
+static int WAV_SIMDLevel(void)
+{
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return 3;
+    if(__builtin_cpu_supports("ssse3"))
+        return 2;
+    if(__builtin_cpu_supports("sse2"))
+        return 1;
+    return 0;
+}
+
+static int WAV_Level(void)
+{
+    static const int Level=WAV_SIMDLevel();
+    return Level;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_Unpack8SSE2(const uint8_t *In,int32_t *Out,uint32_t Count)
+{
+    __m128i Zero;
+    __m128i Flip;
+    __m128i Vec;
+    __m128i Lo;
+    __m128i Hi;
+    uint32_t r;
+
+    Zero=_mm_setzero_si128();
+    Flip=_mm_set1_epi8((char)0x80);
+    for(r=0;r+16<=Count;r+=16)
+    {
+        /* Flipping the top bit makes it signed, then move it to the top */
+        Vec=_mm_xor_si128(_mm_loadu_si128((const __m128i *)&In[r]),Flip);
+        Lo=_mm_unpacklo_epi8(Zero,Vec);
+        Hi=_mm_unpackhi_epi8(Zero,Vec);
+        _mm_storeu_si128((__m128i *)&Out[r],_mm_unpacklo_epi16(Zero,Lo));
+        _mm_storeu_si128((__m128i *)&Out[r+4],_mm_unpackhi_epi16(Zero,Lo));
+        _mm_storeu_si128((__m128i *)&Out[r+8],_mm_unpacklo_epi16(Zero,Hi));
+        _mm_storeu_si128((__m128i *)&Out[r+12],_mm_unpackhi_epi16(Zero,Hi));
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_Unpack16SSE2(const uint8_t *In,int32_t *Out,
+        uint32_t Count)
+{
+    __m128i Zero;
+    __m128i Vec;
+    uint32_t r;
+
+    Zero=_mm_setzero_si128();
+    for(r=0;r+8<=Count;r+=8)
+    {
+        Vec=_mm_loadu_si128((const __m128i *)&In[r*2]);
+        _mm_storeu_si128((__m128i *)&Out[r],_mm_unpacklo_epi16(Zero,Vec));
+        _mm_storeu_si128((__m128i *)&Out[r+4],_mm_unpackhi_epi16(Zero,Vec));
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static uint32_t WAV_Unpack16AVX2(const uint8_t *In,int32_t *Out,
+        uint32_t Count)
+{
+    __m256i Vec;
+    uint32_t r;
+
+    for(r=0;r+8<=Count;r+=8)
+    {
+        Vec=_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&In[r*2]));
+        _mm256_storeu_si256((__m256i *)&Out[r],_mm256_slli_epi32(Vec,16));
+    }
+    return r;
+}
+
+__attribute__((target("ssse3")))
+static uint32_t WAV_Unpack24SSSE3(const uint8_t *In,int32_t *Out,
+        uint32_t Count,bool BigEndian)
+{
+    __m128i Mask;
+    __m128i Vec;
+    uint32_t r;
+
+    Mask=_mm_loadu_si128((const __m128i *)(BigEndian?m_Unpack24BE:
+            m_Unpack24LE));
+
+    /* Each load is 16 bytes but only 12 are used, so stop before we read
+       past the end */
+    for(r=0;r+6<=Count;r+=4)
+    {
+        Vec=_mm_loadu_si128((const __m128i *)&In[r*3]);
+        _mm_storeu_si128((__m128i *)&Out[r],_mm_shuffle_epi8(Vec,Mask));
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_IntToFloatSSE2(const int32_t *In,float *Out,
+        uint32_t Count)
+{
+    __m128 Scale;
+    __m128 Vec;
+    uint32_t r;
+
+    Scale=_mm_set1_ps(WAV_INT_TO_FLOAT);
+    for(r=0;r+4<=Count;r+=4)
+    {
+        Vec=_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&In[r]));
+        _mm_storeu_ps(&Out[r],_mm_mul_ps(Vec,Scale));
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static uint32_t WAV_IntToFloatAVX2(const int32_t *In,float *Out,
+        uint32_t Count)
+{
+    __m256 Scale;
+    __m256 Vec;
+    uint32_t r;
+
+    Scale=_mm256_set1_ps(WAV_INT_TO_FLOAT);
+    for(r=0;r+8<=Count;r+=8)
+    {
+        Vec=_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&In[r]));
+        _mm256_storeu_ps(&Out[r],_mm256_mul_ps(Vec,Scale));
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_FloatToIntSSE2(const float *In,int32_t *Out,
+        uint32_t Count,float Scale,float Max)
+{
+    __m128 VScale;
+    __m128 VMin;
+    __m128 VMax;
+    __m128 Vec;
+    uint32_t r;
+
+    /* max() gives the 2nd arg for NaN so NaN ends up as the min */
+    VScale=_mm_set1_ps(Scale);
+    VMin=_mm_set1_ps(-Scale);
+    VMax=_mm_set1_ps(Max);
+    for(r=0;r+4<=Count;r+=4)
+    {
+        Vec=_mm_mul_ps(_mm_loadu_ps(&In[r]),VScale);
+        Vec=_mm_min_ps(_mm_max_ps(Vec,VMin),VMax);
+        _mm_storeu_si128((__m128i *)&Out[r],_mm_cvtps_epi32(Vec));
+    }
+    return r;
+}
+
+__attribute__((target("avx2")))
+static uint32_t WAV_FloatToIntAVX2(const float *In,int32_t *Out,
+        uint32_t Count,float Scale,float Max)
+{
+    __m256 VScale;
+    __m256 VMin;
+    __m256 VMax;
+    __m256 Vec;
+    uint32_t r;
+
+    VScale=_mm256_set1_ps(Scale);
+    VMin=_mm256_set1_ps(-Scale);
+    VMax=_mm256_set1_ps(Max);
+    for(r=0;r+8<=Count;r+=8)
+    {
+        Vec=_mm256_mul_ps(_mm256_loadu_ps(&In[r]),VScale);
+        Vec=_mm256_min_ps(_mm256_max_ps(Vec,VMin),VMax);
+        _mm256_storeu_si256((__m256i *)&Out[r],_mm256_cvtps_epi32(Vec));
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_Interleave2SSE2(const float *Left,const float *Right,
+        float *Out,uint32_t Frames)
+{
+    __m128 L;
+    __m128 R;
+    uint32_t r;
+
+    for(r=0;r+4<=Frames;r+=4)
+    {
+        L=_mm_loadu_ps(&Left[r]);
+        R=_mm_loadu_ps(&Right[r]);
+        _mm_storeu_ps(&Out[r*2],_mm_unpacklo_ps(L,R));
+        _mm_storeu_ps(&Out[r*2+4],_mm_unpackhi_ps(L,R));
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_DitherSSE2(float *Data,uint32_t Count,float LSB,
+        uint32_t *State)
+{
+    __m128i S1;
+    __m128i S2;
+    __m128i One;
+    __m128 Noise;
+    __m128 Scale;
+    uint32_t r;
+
+    S1=_mm_loadu_si128((const __m128i *)&State[0]);
+    S2=_mm_loadu_si128((const __m128i *)&State[4]);
+    One=_mm_set1_epi32(0x3F800000);
+    Scale=_mm_set1_ps(LSB);
+    for(r=0;r+4<=Count;r+=4)
+    {
+        /* xorshift32 in each lane */
+        S1=_mm_xor_si128(S1,_mm_slli_epi32(S1,13));
+        S1=_mm_xor_si128(S1,_mm_srli_epi32(S1,17));
+        S1=_mm_xor_si128(S1,_mm_slli_epi32(S1,5));
+        S2=_mm_xor_si128(S2,_mm_slli_epi32(S2,13));
+        S2=_mm_xor_si128(S2,_mm_srli_epi32(S2,17));
+        S2=_mm_xor_si128(S2,_mm_slli_epi32(S2,5));
+
+        /* The top 23 bits as a float 1.0 - 2.0, and 2 of those subtracted
+           is a triangle from -1.0 to 1.0 */
+        Noise=_mm_sub_ps(
+                _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(S1,9),One)),
+                _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(S2,9),One)));
+        _mm_storeu_ps(&Data[r],_mm_add_ps(_mm_loadu_ps(&Data[r]),
+                _mm_mul_ps(Noise,Scale)));
+    }
+    _mm_storeu_si128((__m128i *)&State[0],S1);
+    _mm_storeu_si128((__m128i *)&State[4],S2);
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_RoundIntSSE2(int32_t *Data,uint32_t Count,unsigned Bits)
+{
+    __m128i Vec;
+    __m128i Half;
+    __m128i Max;
+    __m128i Over;
+    __m128i One;
+    uint32_t r;
+
+    One=_mm_set1_epi32(1);
+    Max=_mm_set1_epi32((1<<(Bits-1))-1);
+    for(r=0;r+4<=Count;r+=4)
+    {
+        /* Shift down and add the bit that was shifted out to round, the
+           only thing that can go over is the biggest value rounding up */
+        Vec=_mm_loadu_si128((const __m128i *)&Data[r]);
+        Half=_mm_and_si128(_mm_srli_epi32(Vec,31-Bits),One);
+        Vec=_mm_add_epi32(_mm_srai_epi32(Vec,32-Bits),Half);
+        Over=_mm_cmpgt_epi32(Vec,Max);
+        Vec=_mm_or_si128(_mm_and_si128(Over,Max),_mm_andnot_si128(Over,Vec));
+        _mm_storeu_si128((__m128i *)&Data[r],Vec);
+    }
+    return r;
+}
+
+__attribute__((target("sse2")))
+static uint32_t WAV_Pack16SSE2(const int32_t *In,uint8_t *Out,uint32_t Count)
+{
+    __m128i Lo;
+    __m128i Hi;
+    uint32_t r;
+
+    for(r=0;r+8<=Count;r+=8)
+    {
+        Lo=_mm_loadu_si128((const __m128i *)&In[r]);
+        Hi=_mm_loadu_si128((const __m128i *)&In[r+4]);
+        _mm_storeu_si128((__m128i *)&Out[r*2],_mm_packs_epi32(Lo,Hi));
+    }
+    return r;
+}
+
+__attribute__((target("ssse3")))
+static uint32_t WAV_Pack24SSSE3(const int32_t *In,uint8_t *Out,
+        uint32_t Count,bool BigEndian)
+{
+    __m128i Mask;
+    __m128i Vec;
+    uint32_t r;
+
+    Mask=_mm_loadu_si128((const __m128i *)(BigEndian?m_Pack24BE:m_Pack24LE));
+
+    /* Each store is 16 bytes but only 12 are kept (the next store writes
+       over the rest), so stop before we write past the end */
+    for(r=0;r+6<=Count;r+=4)
+    {
+        Vec=_mm_loadu_si128((const __m128i *)&In[r]);
+        _mm_storeu_si128((__m128i *)&Out[r*3],_mm_shuffle_epi8(Vec,Mask));
+    }
+    return r;
+}
+#endif
+
+static void WAV_Unpack8(const uint8_t *In,int32_t *Out,uint32_t Count)
+{
+    uint32_t r;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=1)
+        r=WAV_Unpack8SSE2(In,Out,Count);
+#endif
+
+    for(;r<Count;r++)
+        Out[r]=(int32_t)((uint32_t)(In[r]^0x80)<<24);
+}
+
+static void WAV_Unpack16(const uint8_t *In,int32_t *Out,uint32_t Count)
+{
+    int16_t Sample;
+    uint32_t r;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=3)
+        r=WAV_Unpack16AVX2(In,Out,Count);
+    else if(WAV_Level()>=1)
+        r=WAV_Unpack16SSE2(In,Out,Count);
+#elif WAV_NEON
+    int16x8_t Vec;
+
+    for(;r+8<=Count;r+=8)
+    {
+        Vec=vld1q_s16((const int16_t *)&In[r*2]);
+        vst1q_s32(&Out[r],vshll_n_s16(vget_low_s16(Vec),16));
+        vst1q_s32(&Out[r+4],vshll_n_s16(vget_high_s16(Vec),16));
+    }
+#endif
+
+    for(;r<Count;r++)
+    {
+        memcpy(&Sample,&In[r*2],sizeof(Sample));
+        Out[r]=(int32_t)((uint32_t)(uint16_t)Sample<<16);
+    }
+}
+
+static void WAV_Unpack24(const uint8_t *In,int32_t *Out,uint32_t Count,
+        bool BigEndian)
+{
+    const uint8_t *Sample;
+    uint32_t r;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=2)
+        r=WAV_Unpack24SSSE3(In,Out,Count,BigEndian);
+#endif
+
+    for(;r<Count;r++)
+    {
+        Sample=&In[r*3];
+        if(BigEndian)
+        {
+            Out[r]=(int32_t)((uint32_t)Sample[0]<<24 |
+                    (uint32_t)Sample[1]<<16 | (uint32_t)Sample[2]<<8);
+        }
+        else
+        {
+            Out[r]=(int32_t)((uint32_t)Sample[2]<<24 |
+                    (uint32_t)Sample[1]<<16 | (uint32_t)Sample[0]<<8);
+        }
+    }
+}
+
+static void WAV_Unpack32(const uint8_t *In,int32_t *Out,uint32_t Count)
+{
+    memcpy(Out,In,(size_t)Count*sizeof(int32_t));
+}
+
+static void WAV_IntToFloat(const int32_t *In,float *Out,uint32_t Count)
+{
+    uint32_t r;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=3)
+        r=WAV_IntToFloatAVX2(In,Out,Count);
+    else if(WAV_Level()>=1)
+        r=WAV_IntToFloatSSE2(In,Out,Count);
+#elif WAV_NEON
+    for(;r+4<=Count;r+=4)
+        vst1q_f32(&Out[r],vcvtq_n_f32_s32(vld1q_s32(&In[r]),31));
+#endif
+
+    for(;r<Count;r++)
+        Out[r]=(float)In[r]*WAV_INT_TO_FLOAT;
+}
+
+static void WAV_FloatToInt(const float *In,int32_t *Out,uint32_t Count,
+        unsigned Bits)
+{
+    float Scale;
+    float Max;
+    float Value;
+    uint32_t r;
+
+    /* 2^31-1 isn't a float so 32 bits stops at the float below it */
+    Scale=(float)(1U<<(Bits-1));
+    Max=Bits<32?Scale-1:WAV_FLOAT_INT_MAX;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=3)
+        r=WAV_FloatToIntAVX2(In,Out,Count,Scale,Max);
+    else if(WAV_Level()>=1)
+        r=WAV_FloatToIntSSE2(In,Out,Count,Scale,Max);
+#elif WAV_NEON
+    float32x4_t VScale;
+    float32x4_t VMin;
+    float32x4_t VMax;
+    float32x4_t Vec;
+
+    VScale=vdupq_n_f32(Scale);
+    VMin=vdupq_n_f32(-Scale);
+    VMax=vdupq_n_f32(Max);
+    for(;r+4<=Count;r+=4)
+    {
+        Vec=vmulq_f32(vld1q_f32(&In[r]),VScale);
+        Vec=vminq_f32(vmaxnmq_f32(Vec,VMin),VMax);
+        vst1q_s32(&Out[r],vcvtnq_s32_f32(Vec));
+    }
+#endif
+
+    /* Done the same way as the vector code (NaN is the min) */
+    for(;r<Count;r++)
+    {
+        Value=In[r]*Scale;
+        if(!(Value>-Scale))
+            Value=-Scale;
+        else if(Value>Max)
+            Value=Max;
+        Out[r]=(int32_t)lrintf(Value);
+    }
+}
+
+static uint32_t WAV_Interleave2(const void *Left,const void *Right,void *Out,
+        uint32_t Frames)
+{
+    uint32_t r;
+
+    /* Only moves the bits around, so this works for int32's too */
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=1)
+    {
+        r=WAV_Interleave2SSE2((const float *)Left,(const float *)Right,
+                (float *)Out,Frames);
+    }
+#elif WAV_NEON
+    float32x4x2_t Vec;
+
+    for(;r+4<=Frames;r+=4)
+    {
+        Vec.val[0]=vld1q_f32((const float *)Left+r);
+        Vec.val[1]=vld1q_f32((const float *)Right+r);
+        vst2q_f32((float *)Out+r*2,Vec);
+    }
+#endif
+    return r;
+}
+
+template <typename T>
+static void WAV_Interleave(const T * const *Planes,uint32_t Start,
+        unsigned Channels,T *Out,uint32_t Frames)
+{
+    uint32_t r;
+    unsigned c;
+
+    if(Channels==1)
+    {
+        memcpy(Out,Planes[0]+Start,(size_t)Frames*sizeof(T));
+        return;
+    }
+
+    r=0;
+    if(Channels==2)
+        r=WAV_Interleave2(Planes[0]+Start,Planes[1]+Start,Out,Frames);
+
+    for(;r<Frames;r++)
+        for(c=0;c<Channels;c++)
+            Out[r*Channels+c]=Planes[c][Start+r];
+}
+
+static void WAV_Dither(float *Data,uint32_t Count,float LSB,uint32_t *State)
+{
+    uint32_t Bits[2];
+    float Noise[2];
+    uint32_t r;
+    unsigned a;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=1)
+        r=WAV_DitherSSE2(Data,Count,LSB,State);
+#endif
+
+    /* The same as the vector code but only using the 1st lane */
+    for(;r<Count;r++)
+    {
+        for(a=0;a<2;a++)
+        {
+            State[a*4]^=State[a*4]<<13;
+            State[a*4]^=State[a*4]>>17;
+            State[a*4]^=State[a*4]<<5;
+            Bits[a]=State[a*4]>>9 | 0x3F800000;
+            memcpy(&Noise[a],&Bits[a],sizeof(float));
+        }
+        Data[r]+=(Noise[0]-Noise[1])*LSB;
+    }
+}
+
+static void WAV_RoundInt(int32_t *Data,uint32_t Count,unsigned Bits)
+{
+    int32_t Max;
+    int32_t Value;
+    uint32_t r;
+
+    if(Bits>=32)
+        return;
+
+    Max=(1<<(Bits-1))-1;
+
+    r=0;
+#if WAV_X86
+    if(WAV_Level()>=1)
+        r=WAV_RoundIntSSE2(Data,Count,Bits);
+#endif
+
+    for(;r<Count;r++)
+    {
+        Value=(Data[r]>>(32-Bits))+((uint32_t)Data[r]>>(31-Bits)&1);
+        Data[r]=Value>Max?Max:Value;
+    }
+}
+
+static void WAV_PackInt(const int32_t *In,uint8_t *Out,uint32_t Count,
+        unsigned Bytes,bool BigEndian)
+{
+    int16_t Sample;
+    uint8_t *Dest;
+    uint32_t r;
+
+    r=0;
+    switch(Bytes)
+    {
+        case 2:
+#if WAV_X86
+            if(WAV_Level()>=1)
+                r=WAV_Pack16SSE2(In,Out,Count);
+#elif WAV_NEON
+            for(;r+8<=Count;r+=8)
+            {
+                vst1q_s16((int16_t *)&Out[r*2],vcombine_s16(
+                        vmovn_s32(vld1q_s32(&In[r])),
+                        vmovn_s32(vld1q_s32(&In[r+4]))));
+            }
+#endif
+            for(;r<Count;r++)
+            {
+                Sample=(int16_t)In[r];
+                memcpy(&Out[r*2],&Sample,sizeof(Sample));
+            }
+        break;
+        case 3:
+#if WAV_X86
+            if(WAV_Level()>=2)
+                r=WAV_Pack24SSSE3(In,Out,Count,BigEndian);
+#endif
+            for(;r<Count;r++)
+            {
+                Dest=&Out[r*3];
+                if(BigEndian)
+                {
+                    Dest[0]=In[r]>>16;
+                    Dest[1]=In[r]>>8;
+                    Dest[2]=In[r];
+                }
+                else
+                {
+                    Dest[0]=In[r];
+                    Dest[1]=In[r]>>8;
+                    Dest[2]=In[r]>>16;
+                }
+            }
+        break;
+        case 4:
+            memcpy(Out,In,(size_t)Count*sizeof(int32_t));
+        break;
+    }
+}
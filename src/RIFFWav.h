@@ -0,0 +1,222 @@
+/*******************************************************************************
+ * FILENAME: RIFFWav.h
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This has classes for reading and writing the samples in WAV files (the
+ *    "fmt " and "data" chunks of a "WAVE" form) converted to / from float or
+ *    int32.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * HISTORY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *       Created
+ *
+ *******************************************************************************/
+#ifndef __RIFFWAV_H_
+#define __RIFFWAV_H_
+
+/***  HEADER FILES TO INCLUDE          ***/
+#include "RIFF.h"
+#include "RIFFLPCM.h"
+#include <vector>
+#include <stdint.h>
+
+/***  DEFINES                          ***/
+#define RIFFWAV_FORM_TYPE               "WAVE"
+#define RIFFWAV_DEFAULT_BLOCK_FRAMES    4096
+#define RIFFWAV_FMT_SIZE_PCM            16      // "fmt " chunk sizes
+#define RIFFWAV_FMT_SIZE_FLOAT          18
+#define RIFFWAV_FMT_SIZE_EXTENSIBLE     40
+
+#define RIFFWAV_OVERVIEW_CHUNK_ID       "OVRV"
+#define RIFFWAV_OVERVIEW_BASE_FRAMES    256     // Frames in a level 0 point
+#define RIFFWAV_OVERVIEW_FACTOR         4       // Points merged for each level
+
+/* The format tags used in the "fmt " chunk */
+#define RIFFWAV_FORMAT_PCM              0x0001
+#define RIFFWAV_FORMAT_FLOAT            0x0003
+#define RIFFWAV_FORMAT_EXTENSIBLE       0xFFFE
+
+/***  MACROS                           ***/
+
+/***  TYPE DEFINITIONS                 ***/
+/* The "fmt " chunk.  Only PCM files have up to 'BitsPerSample', the rest is
+   WAVE_FORMAT_EXTENSIBLE */
+struct RIFFWavFmt
+{
+    uint16_t AudioFormat;
+    uint16_t NumChannels;
+    uint32_t SampleRate;
+    uint32_t ByteRate;
+    uint16_t BlockAlign;
+    uint16_t BitsPerSample;
+    uint16_t ExtraSize;
+    uint16_t ValidBitsPerSample;
+    uint32_t ChannelMask;
+    uint16_t SubFormat;                 // The format tag from the GUID
+    uint8_t SubFormatGUID[14];          // The rest of the GUID
+};
+
+RIFF_STRUCT(RIFFWavFmt,RIFF_FIELD(RIFFWavFmt,AudioFormat),
+        RIFF_FIELD(RIFFWavFmt,NumChannels),
+        RIFF_FIELD(RIFFWavFmt,SampleRate),
+        RIFF_FIELD(RIFFWavFmt,ByteRate),
+        RIFF_FIELD(RIFFWavFmt,BlockAlign),
+        RIFF_FIELD(RIFFWavFmt,BitsPerSample),
+        RIFF_FIELD(RIFFWavFmt,ExtraSize),
+        RIFF_FIELD(RIFFWavFmt,ValidBitsPerSample),
+        RIFF_FIELD(RIFFWavFmt,ChannelMask),
+        RIFF_FIELD(RIFFWavFmt,SubFormat),
+        RIFF_FIELD(RIFFWavFmt,SubFormatGUID));
+
+struct RIFFWavFormat
+{
+    unsigned Channels;
+    uint32_t SampleRate;
+    unsigned BitsPerSample;             // Bits stored for each sample
+    unsigned ValidBits;                 // Bits that are used (<= BitsPerSample)
+    unsigned BlockAlign;                // Bytes in one frame
+    uint32_t ChannelMask;               // 0 if the file didn't give one
+    bool Float;                         // IEEE float samples
+    bool BigEndian;                     // Sample byte order
+    bool Lossless;                      // Samples are in an "LPCM" chunk
+    uint32_t Frames;                    // Frames in the file
+};
+
+/* The start of the "OVRV" chunk.  After it are the levels (level 0 first),
+   each a point for each 'BaseFrames' * 'Factor'^level frames.  Each point has
+   Min, Max (int16) and RMS (uint16) for each channel. */
+struct RIFFWavOverviewHeader
+{
+    uint16_t Version;
+    uint16_t Channels;
+    uint32_t BaseFrames;
+    uint16_t Factor;
+    uint16_t Levels;
+    uint32_t Frames;
+};
+
+RIFF_STRUCT(RIFFWavOverviewHeader,RIFF_FIELD(RIFFWavOverviewHeader,Version),
+        RIFF_FIELD(RIFFWavOverviewHeader,Channels),
+        RIFF_FIELD(RIFFWavOverviewHeader,BaseFrames),
+        RIFF_FIELD(RIFFWavOverviewHeader,Factor),
+        RIFF_FIELD(RIFFWavOverviewHeader,Levels),
+        RIFF_FIELD(RIFFWavOverviewHeader,Frames));
+
+struct RIFFWavPeak
+{
+    float Min;
+    float Max;
+    float RMS;
+};
+
+/***  CLASS DEFINITIONS                ***/
+class RIFFWavWriter
+{
+    public:
+        RIFFWavWriter();
+        ~RIFFWavWriter();
+        void SetDither(bool On);
+        void SetLossless(bool On);
+        void SetOverview(bool On,uint32_t BaseFrames=0);
+        void Open(class RIFF &RIFF,unsigned Channels,uint32_t SampleRate,
+                unsigned BitsPerSample,bool Float=false,
+                uint32_t BlockFrames=0);
+        void WriteFloat(const float * const *Planes,uint32_t Frames);
+        void WriteInt(const int32_t * const *Planes,uint32_t Frames);
+        void Close(void);
+
+    private:
+        class RIFF *File;
+        struct RIFFWavFormat Format;
+        uint32_t BlockFrames;
+        bool Dither;
+        bool Lossless;
+        uint32_t DitherState[8];
+        class RIFFLPCMWriter LPCM;
+        std::vector<uint8_t> Raw;           // Samples as they go in the file
+        std::vector<int32_t> IntWork;
+        std::vector<float> FloatWork;
+
+        /* Overview */
+        bool Overview;
+        uint32_t OverviewBase;
+        uint32_t OverviewUsed;              // Frames in the point being made
+        std::vector<double> OverviewPoint;  // Min, Max, Sum of squares
+        std::vector<double> OverviewPoints; // Level 0 so far
+
+        void WriteBlock(uint32_t Frames);
+        void AddOverview(const float *Samples,uint32_t Frames);
+        void WriteOverview(void);
+};
+
+class RIFFWavOverview
+{
+    public:
+        RIFFWavOverview();
+        ~RIFFWavOverview();
+        bool Load(class RIFF &RIFF);
+        void Load(class RIFF &RIFF,uint32_t ChunkSize);
+        unsigned GetChannels(void);
+        uint32_t GetFrames(void);
+        void Get(unsigned Channel,uint32_t StartFrame,uint32_t Frames,
+                unsigned Pixels,struct RIFFWavPeak *Peaks);
+
+    private:
+        struct RIFFWavOverviewHeader Header;
+        std::vector<std::vector<uint16_t> > Levels;
+};
+
+class RIFFWavReader
+{
+    public:
+        RIFFWavReader();
+        ~RIFFWavReader();
+        void Open(class RIFF &RIFF,uint32_t BlockFrames=0);
+        const struct RIFFWavFormat &GetFormat(void);
+        uint32_t ReadFloat(float *Samples,uint32_t Frames);
+        uint32_t ReadInt(int32_t *Samples,uint32_t Frames);
+        uint32_t GetFramePos(void);
+        void SeekToFrame(uint32_t Frame);
+
+    private:
+        class RIFF *File;
+        struct RIFFWavFormat Format;
+        uint32_t BlockFrames;
+        uint32_t FramePos;
+        class RIFFLPCMReader LPCM;
+        std::vector<uint8_t> Raw;           // Samples as they are in the file
+        std::vector<int32_t> IntWork;
+        std::vector<float> FloatWork;
+
+        uint32_t ReadBlock(uint32_t Frames);
+};
+
+/***  GLOBAL VARIABLE DEFINITIONS      ***/
+
+/***  EXTERNAL FUNCTION PROTOTYPES     ***/
+
+#endif
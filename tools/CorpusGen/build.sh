@@ -0,0 +1 @@
+g++ -O2 -I ../../src ../../src/RIFF.cpp ../../src/RIFFIO.cpp main.cpp -o corpusgen
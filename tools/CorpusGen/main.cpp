@@ -0,0 +1,805 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is a tool that makes test files for benchmarking and stress
+ *    testing.  All the files come from a seed so the same command always
+ *    makes the same file.
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#include "RIFF.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+/*** DEFINES                  ***/
+#define POOL_SIZE               (1024*1024)
+#define WAV_FRAMES_PER_WRITE    4096
+#define MAX_CHUNK_SIZE          0xFFFF0000
+
+/*** MACROS                   ***/
+
+/*** TYPE DEFINITIONS         ***/
+typedef enum
+{
+    e_Dist_Fixed,
+    e_Dist_Uniform,
+    e_Dist_Exp
+} e_DistType;
+
+struct SizeDist
+{
+    e_DistType Type;
+    uint32_t A;
+    uint32_t B;
+};
+
+struct CorpusOptions
+{
+    uint64_t Seed;
+    bool IFF;
+    e_RIFFIOType IOType;
+
+    /* wav */
+    unsigned Channels;
+    unsigned Rate;
+    unsigned Bits;
+    double Seconds;
+
+    /* avi */
+    unsigned Streams;
+    uint32_t Frames;
+    struct SizeDist VideoSize;
+    struct SizeDist AudioSize;
+
+    /* tree */
+    unsigned Depth;
+    unsigned Fanout;
+
+    /* junk / odd / tree */
+    uint32_t Chunks;
+    struct SizeDist Size;
+    struct SizeDist JunkSize;
+    unsigned JunkPercent;
+};
+
+struct IndexEntry
+{
+    char ChunkID[4];
+    uint32_t Flags;
+    uint32_t Offset;
+    uint32_t Size;
+};
+
+/*** FUNCTION PROTOTYPES      ***/
+static void ShowHelp(void);
+static void DefaultOptions(struct CorpusOptions &Opts);
+static bool ParseOption(int argc,char **argv,int &arg,
+        struct CorpusOptions &Opts);
+static bool ParseDist(const char *Str,struct SizeDist &Dist);
+static bool MakeFile(const char *Type,const char *Filename,
+        const struct CorpusOptions &Opts);
+static void MakeStandard(const char *Dir,unsigned Scale,uint64_t Seed);
+static void WriteWAV(const char *Filename,const struct CorpusOptions &Opts);
+static void WriteAVI(const char *Filename,const struct CorpusOptions &Opts);
+static void WriteTree(const char *Filename,const struct CorpusOptions &Opts);
+static void WriteTreeLevel(class RIFF &RIFF,const struct CorpusOptions &Opts,
+        unsigned Depth);
+static void WriteJunk(const char *Filename,const struct CorpusOptions &Opts);
+static void WriteOdd(const char *Filename,const struct CorpusOptions &Opts);
+static void WriteChunk(class RIFF &RIFF,const char *ChunkID,uint32_t Size);
+static void WriteBlock(class RIFF &RIFF,const char *ChunkID,const void *Data,
+        uint32_t Size);
+static void WriteJunkChunk(class RIFF &RIFF,uint32_t Size);
+static void SeedRandom(uint64_t Seed);
+static uint64_t Random(void);
+static uint32_t RandomRange(uint32_t Min,uint32_t Max);
+static uint32_t PickSize(const struct SizeDist &Dist);
+static void Put16(uint8_t *Dest,uint16_t Value);
+static void Put32(uint8_t *Dest,uint32_t Value);
+
+/*** VARIABLE DEFINITIONS     ***/
+static uint64_t m_RandomState;
+static uint8_t m_Pool[POOL_SIZE];
+static uint64_t m_ChunksWritten;
+static uint64_t m_BytesWritten;
+
+int main(int argc,char **argv)
+{
+    struct CorpusOptions Opts;
+    unsigned Scale;
+    int arg;
+
+    if(argc<3)
+    {
+        ShowHelp();
+        return 1;
+    }
+
+    try
+    {
+        if(strcmp(argv[1],"standard")==0)
+        {
+            Scale=1;
+            DefaultOptions(Opts);
+            for(arg=3;arg<argc;arg++)
+            {
+                if(strcmp(argv[arg],"--scale")==0 && arg+1<argc)
+                    Scale=strtoul(argv[++arg],NULL,10);
+                else if(strcmp(argv[arg],"--seed")==0 && arg+1<argc)
+                    Opts.Seed=strtoull(argv[++arg],NULL,10);
+                else
+                    break;
+            }
+            if(arg<argc || Scale==0)
+            {
+                ShowHelp();
+                return 1;
+            }
+            MakeStandard(argv[2],Scale,Opts.Seed);
+            return 0;
+        }
+
+        DefaultOptions(Opts);
+        for(arg=3;arg<argc;arg++)
+            if(!ParseOption(argc,argv,arg,Opts))
+                break;
+        if(arg<argc)
+        {
+            printf("Bad option: %s\n",argv[arg]);
+            ShowHelp();
+            return 1;
+        }
+
+        if(!MakeFile(argv[1],argv[2],Opts))
+        {
+            ShowHelp();
+            return 1;
+        }
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+        return 1;
+    }
+    catch(const char *Err)
+    {
+        printf("ERR:%s\n",Err);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void ShowHelp(void)
+{
+    printf("USAGE:\n");
+    printf("    corpusgen type filename [options]\n");
+    printf("    corpusgen standard dir [--scale N] [--seed N]\n");
+    printf("WHERE:\n");
+    printf("    type -- What kind of file to make:\n");
+    printf("         wav -- A multichannel WAV (WAVE_FORMAT_EXTENSIBLE)\n");
+    printf("         avi -- An AVI like file with lots of small interleaved\n");
+    printf("                chunks in a 'movi' group and an 'idx1' index\n");
+    printf("         tree -- Groups nested --depth deep with --fanout groups\n");
+    printf("                 in each\n");
+    printf("         junk -- Data chunks mixed with lots of 'JUNK' chunks\n");
+    printf("         odd -- Chunks that are all an odd size (so they are all\n");
+    printf("                padded)\n");
+    printf("    standard -- Make the standard set of files in 'dir'.  --scale\n");
+    printf("                makes the files bigger\n");
+    printf("OPTIONS:\n");
+    printf("    --seed N -- Random seed (default 1)\n");
+    printf("    --iff -- Make an IFF file instead of a RIFF file\n");
+    printf("    --io buffered/mmap/direct -- How to write the file\n");
+    printf("    --channels N, --rate N, --bits 16/24/32, --seconds N -- wav\n");
+    printf("    --streams N, --frames N, --video-size D, --audio-size D -- avi\n");
+    printf("    --depth N, --fanout N -- tree\n");
+    printf("    --chunks N -- Number of chunks for junk / odd\n");
+    printf("    --size D -- Size of the data chunks for tree / junk / odd\n");
+    printf("    --junk-size D, --junk-percent N -- junk\n");
+    printf("SIZES:\n");
+    printf("    D can be 'N' (always N bytes), 'MIN-MAX' (random between MIN\n");
+    printf("    and MAX) or 'exp:MEAN' (exponential with an average of MEAN)\n");
+}
+
+static void DefaultOptions(struct CorpusOptions &Opts)
+{
+    Opts.Seed=1;
+    Opts.IFF=false;
+    Opts.IOType=e_RIFFIO_Buffered;
+    Opts.Channels=8;
+    Opts.Rate=48000;
+    Opts.Bits=24;
+    Opts.Seconds=10;
+    Opts.Streams=2;
+    Opts.Frames=10000;
+    ParseDist("16-256",Opts.VideoSize);
+    ParseDist("4-64",Opts.AudioSize);
+    Opts.Depth=8;
+    Opts.Fanout=3;
+    Opts.Chunks=10000;
+    ParseDist("1-1024",Opts.Size);
+    ParseDist("1024-65536",Opts.JunkSize);
+    Opts.JunkPercent=50;
+}
+
+static bool ParseOption(int argc,char **argv,int &arg,
+        struct CorpusOptions &Opts)
+{
+    const char *Opt;
+    const char *Value;
+
+    Opt=argv[arg];
+    if(strcmp(Opt,"--iff")==0)
+    {
+        Opts.IFF=true;
+        return true;
+    }
+
+    if(arg+1>=argc)
+        return false;
+    Value=argv[arg+1];
+
+    if(strcmp(Opt,"--seed")==0)
+        Opts.Seed=strtoull(Value,NULL,10);
+    else if(strcmp(Opt,"--io")==0)
+    {
+        if(strcmp(Value,"buffered")==0)
+            Opts.IOType=e_RIFFIO_Buffered;
+        else if(strcmp(Value,"mmap")==0)
+            Opts.IOType=e_RIFFIO_MMap;
+        else if(strcmp(Value,"direct")==0)
+            Opts.IOType=e_RIFFIO_Direct;
+        else
+            return false;
+    }
+    else if(strcmp(Opt,"--channels")==0)
+        Opts.Channels=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--rate")==0)
+        Opts.Rate=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--bits")==0)
+        Opts.Bits=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--seconds")==0)
+        Opts.Seconds=atof(Value);
+    else if(strcmp(Opt,"--streams")==0)
+        Opts.Streams=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--frames")==0)
+        Opts.Frames=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--depth")==0)
+        Opts.Depth=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--fanout")==0)
+        Opts.Fanout=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--chunks")==0)
+        Opts.Chunks=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--junk-percent")==0)
+        Opts.JunkPercent=strtoul(Value,NULL,10);
+    else if(strcmp(Opt,"--video-size")==0)
+        return ParseDist(Value,Opts.VideoSize) && ++arg;
+    else if(strcmp(Opt,"--audio-size")==0)
+        return ParseDist(Value,Opts.AudioSize) && ++arg;
+    else if(strcmp(Opt,"--size")==0)
+        return ParseDist(Value,Opts.Size) && ++arg;
+    else if(strcmp(Opt,"--junk-size")==0)
+        return ParseDist(Value,Opts.JunkSize) && ++arg;
+    else
+        return false;
+
+    arg++;
+    return true;
+}
+
+static bool ParseDist(const char *Str,struct SizeDist &Dist)
+{
+    char *End;
+
+    if(strncmp(Str,"exp:",4)==0)
+    {
+        Dist.Type=e_Dist_Exp;
+        Dist.A=strtoul(Str+4,&End,10);
+        Dist.B=0;
+        return End!=Str+4 && *End==0 && Dist.A>0;
+    }
+
+    Dist.A=strtoul(Str,&End,10);
+    if(End==Str)
+        return false;
+    if(*End==0)
+    {
+        Dist.Type=e_Dist_Fixed;
+        Dist.B=Dist.A;
+        return true;
+    }
+    if(*End!='-')
+        return false;
+
+    Str=End+1;
+    Dist.Type=e_Dist_Uniform;
+    Dist.B=strtoul(Str,&End,10);
+    return End!=Str && *End==0 && Dist.B>=Dist.A;
+}
+
+static bool MakeFile(const char *Type,const char *Filename,
+        const struct CorpusOptions &Opts)
+{
+    unsigned r;
+
+    SeedRandom(Opts.Seed);
+    for(r=0;r<POOL_SIZE;r+=8)
+    {
+        uint64_t Value=Random();
+        memcpy(&m_Pool[r],&Value,8);
+    }
+    m_ChunksWritten=0;
+    m_BytesWritten=0;
+
+    if(strcmp(Type,"wav")==0)
+        WriteWAV(Filename,Opts);
+    else if(strcmp(Type,"avi")==0)
+        WriteAVI(Filename,Opts);
+    else if(strcmp(Type,"tree")==0)
+        WriteTree(Filename,Opts);
+    else if(strcmp(Type,"junk")==0)
+        WriteJunk(Filename,Opts);
+    else if(strcmp(Type,"odd")==0)
+        WriteOdd(Filename,Opts);
+    else
+        return false;
+
+    printf("%s: %llu chunks, %llu bytes of chunk data\n",Filename,
+            (unsigned long long)m_ChunksWritten,
+            (unsigned long long)m_BytesWritten);
+    return true;
+}
+
+/* The standard set of files the benchmarks are run against */
+static void MakeStandard(const char *Dir,unsigned Scale,uint64_t Seed)
+{
+    struct CorpusOptions Opts;
+    std::string Base;
+
+    Base=std::string(Dir)+"/";
+
+    DefaultOptions(Opts);
+    Opts.Seed=Seed;
+    Opts.Seconds=60.0*Scale;
+    MakeFile("wav",(Base+"multichannel.wav").c_str(),Opts);
+
+    DefaultOptions(Opts);
+    Opts.Seed=Seed;
+    Opts.Frames=100000*Scale;
+    MakeFile("avi",(Base+"tiny_chunks.avi").c_str(),Opts);
+
+    DefaultOptions(Opts);
+    Opts.Seed=Seed;
+    Opts.Depth=16;
+    Opts.Fanout=2;
+    ParseDist("exp:64",Opts.Size);
+    MakeFile("tree",(Base+"deep_tree.riff").c_str(),Opts);
+    Opts.IFF=true;
+    MakeFile("tree",(Base+"deep_tree.iff").c_str(),Opts);
+
+    DefaultOptions(Opts);
+    Opts.Seed=Seed;
+    Opts.Chunks=10000*Scale;
+    Opts.JunkPercent=75;
+    ParseDist("512-8192",Opts.JunkSize);
+    MakeFile("junk",(Base+"junk.riff").c_str(),Opts);
+
+    DefaultOptions(Opts);
+    Opts.Seed=Seed;
+    Opts.Chunks=100000*Scale;
+    ParseDist("1-255",Opts.Size);
+    MakeFile("odd",(Base+"odd.riff").c_str(),Opts);
+    Opts.IFF=true;
+    MakeFile("odd",(Base+"odd.iff").c_str(),Opts);
+}
+
+static void WriteWAV(const char *Filename,const struct CorpusOptions &Opts)
+{
+    class RIFF RIFF(Opts.IFF);
+    uint8_t fmtblock[40];
+    std::vector<uint8_t> Block;
+    std::vector<double> Freq;
+    uint64_t Frames;
+    uint64_t Frame;
+    uint32_t BlockAlign;
+    uint32_t Bytes;
+    unsigned Count;
+    unsigned f;
+    unsigned c;
+    uint8_t *Out;
+    double Sample;
+    int32_t Value;
+
+    if(Opts.Channels<1 || Opts.Channels>32 || Opts.Rate==0 ||
+            (Opts.Bits!=16 && Opts.Bits!=24 && Opts.Bits!=32))
+    {
+        throw("Bad wav format");
+    }
+
+    BlockAlign=Opts.Channels*(Opts.Bits/8);
+    Frames=(uint64_t)(Opts.Seconds*Opts.Rate);
+    if(Frames*BlockAlign>MAX_CHUNK_SIZE)
+        throw("Too many seconds for one wav file");
+
+    /* Each channel gets its own tone */
+    for(c=0;c<Opts.Channels;c++)
+        Freq.push_back(110.0*(c+1)+RandomRange(0,100));
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"WAVE",Opts.IOType);
+
+    /* WAVE_FORMAT_EXTENSIBLE */
+    memset(fmtblock,0,sizeof(fmtblock));
+    Put16(&fmtblock[0],0xFFFE);
+    Put16(&fmtblock[2],Opts.Channels);
+    Put32(&fmtblock[4],Opts.Rate);
+    Put32(&fmtblock[8],Opts.Rate*BlockAlign);
+    Put16(&fmtblock[12],BlockAlign);
+    Put16(&fmtblock[14],Opts.Bits);
+    Put16(&fmtblock[16],22);
+    Put16(&fmtblock[18],Opts.Bits);
+    Put32(&fmtblock[20],Opts.Channels>=32?0xFFFFFFFF:
+            (1U<<Opts.Channels)-1);
+    /* KSDATAFORMAT_SUBTYPE_PCM */
+    memcpy(&fmtblock[24],"\x01\x00\x00\x00\x00\x00\x10\x00"
+            "\x80\x00\x00\xAA\x00\x38\x9B\x71",16);
+    WriteBlock(RIFF,"fmt ",fmtblock,sizeof(fmtblock));
+
+    RIFF.StartDataBlock("data");
+    Block.resize(WAV_FRAMES_PER_WRITE*BlockAlign);
+    for(Frame=0;Frame<Frames;Frame+=Count)
+    {
+        Count=WAV_FRAMES_PER_WRITE;
+        if(Frames-Frame<Count)
+            Count=Frames-Frame;
+
+        Out=Block.data();
+        for(f=0;f<Count;f++)
+        {
+            for(c=0;c<Opts.Channels;c++)
+            {
+                Sample=0.5*sin(2*M_PI*Freq[c]*(Frame+f)/Opts.Rate);
+                Sample+=((int32_t)(Random()&0xFFFF)-0x8000)/2000000.0;
+                switch(Opts.Bits)
+                {
+                    case 16:
+                        Value=(int32_t)(Sample*32767);
+                        Put16(Out,Value);
+                        Out+=2;
+                    break;
+                    case 24:
+                        Value=(int32_t)(Sample*8388607);
+                        Out[0]=Value;
+                        Out[1]=Value>>8;
+                        Out[2]=Value>>16;
+                        Out+=3;
+                    break;
+                    case 32:
+                        Value=(int32_t)(Sample*2147483647.0);
+                        Put32(Out,Value);
+                        Out+=4;
+                    break;
+                }
+            }
+        }
+        Bytes=Count*BlockAlign;
+        RIFF.Write(Block.data(),Bytes);
+        m_BytesWritten+=Bytes;
+    }
+    RIFF.EndDataBlock();
+    m_ChunksWritten++;
+
+    RIFF.Close();
+}
+
+static void WriteAVI(const char *Filename,const struct CorpusOptions &Opts)
+{
+    class RIFF RIFF(Opts.IFF);
+    std::vector<struct IndexEntry> Index;
+    struct IndexEntry Entry;
+    uint8_t Header[56];
+    uint8_t Format[40];
+    uint32_t MoviPos;
+    uint32_t Size;
+    uint32_t f;
+    unsigned s;
+    char ChunkID[5];
+
+    if(Opts.Streams<1 || Opts.Streams>99)
+        throw("Bad number of streams");
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"AVI ",Opts.IOType);
+
+    RIFF.StartGroup("hdrl");
+        memset(Header,0,sizeof(Header));
+        Put32(&Header[0],40000);                    // MicroSecPerFrame
+        Put32(&Header[12],0x10);                    // AVIF_HASINDEX
+        Put32(&Header[16],Opts.Frames);             // TotalFrames
+        Put32(&Header[24],Opts.Streams);            // Streams
+        Put32(&Header[32],320);                     // Width
+        Put32(&Header[36],240);                     // Height
+        WriteBlock(RIFF,"avih",Header,sizeof(Header));
+
+        for(s=0;s<Opts.Streams;s++)
+        {
+            RIFF.StartGroup("strl");
+                memset(Header,0,sizeof(Header));
+                memcpy(&Header[0],s==0?"vids":"auds",4);
+                Put32(&Header[20],1);               // Scale
+                Put32(&Header[24],s==0?25:48000);   // Rate
+                Put32(&Header[32],Opts.Frames);     // Length
+                WriteBlock(RIFF,"strh",Header,sizeof(Header));
+
+                memset(Format,0,sizeof(Format));
+                if(s==0)
+                {
+                    /* BITMAPINFOHEADER */
+                    Put32(&Format[0],40);
+                    Put32(&Format[4],320);
+                    Put32(&Format[8],240);
+                    Put16(&Format[12],1);
+                    Put16(&Format[14],24);
+                    Size=40;
+                }
+                else
+                {
+                    /* WAVEFORMATEX */
+                    Put16(&Format[0],1);
+                    Put16(&Format[2],2);
+                    Put32(&Format[4],48000);
+                    Put32(&Format[8],48000*4);
+                    Put16(&Format[12],4);
+                    Put16(&Format[14],16);
+                    Size=18;
+                }
+                WriteBlock(RIFF,"strf",Format,Size);
+            RIFF.EndGroup();
+        }
+    RIFF.EndGroup();
+
+    /* The offsets in idx1 are from the 'movi' */
+    MoviPos=4;
+    Index.reserve((size_t)Opts.Frames*Opts.Streams);
+    RIFF.StartGroup("movi");
+    for(f=0;f<Opts.Frames;f++)
+    {
+        for(s=0;s<Opts.Streams;s++)
+        {
+            snprintf(ChunkID,sizeof(ChunkID),"%02u%s",s%100,s==0?"dc":"wb");
+            Size=PickSize(s==0?Opts.VideoSize:Opts.AudioSize);
+
+            memcpy(Entry.ChunkID,ChunkID,4);
+            Entry.Flags=(s==0 && f%25==0)?0x10:0;   // AVIIF_KEYFRAME
+            Entry.Offset=MoviPos;
+            Entry.Size=Size;
+            Index.push_back(Entry);
+
+            WriteChunk(RIFF,ChunkID,Size);
+            MoviPos+=8+Size+(Size&1);
+        }
+    }
+    RIFF.EndGroup();
+
+    RIFF.StartDataBlock("idx1");
+    for(f=0;f<Index.size();f++)
+    {
+        memcpy(&Header[0],Index[f].ChunkID,4);
+        Put32(&Header[4],Index[f].Flags);
+        Put32(&Header[8],Index[f].Offset);
+        Put32(&Header[12],Index[f].Size);
+        RIFF.Write(Header,16);
+    }
+    RIFF.EndDataBlock();
+    m_ChunksWritten++;
+    m_BytesWritten+=Index.size()*16;
+
+    RIFF.Close();
+}
+
+static void WriteTree(const char *Filename,const struct CorpusOptions &Opts)
+{
+    class RIFF RIFF(Opts.IFF);
+
+    if(Opts.Fanout<1)
+        throw("Bad fanout");
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"TREE",Opts.IOType);
+    WriteTreeLevel(RIFF,Opts,Opts.Depth);
+    RIFF.Close();
+}
+
+/* Each level has a 'META' chunk then --fanout groups (or data chunks at the
+   bottom) */
+static void WriteTreeLevel(class RIFF &RIFF,const struct CorpusOptions &Opts,
+        unsigned Depth)
+{
+    unsigned r;
+
+    WriteChunk(RIFF,"META",PickSize(Opts.Size));
+    for(r=0;r<Opts.Fanout;r++)
+    {
+        if(Depth==0)
+        {
+            WriteChunk(RIFF,"LEAF",PickSize(Opts.Size));
+            continue;
+        }
+
+        RIFF.StartGroup("NODE");
+        WriteTreeLevel(RIFF,Opts,Depth-1);
+        RIFF.EndGroup();
+    }
+}
+
+static void WriteJunk(const char *Filename,const struct CorpusOptions &Opts)
+{
+    class RIFF RIFF(Opts.IFF);
+    uint32_t r;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"JUNK",Opts.IOType);
+    for(r=0;r<Opts.Chunks;r++)
+    {
+        if(RandomRange(0,99)<Opts.JunkPercent)
+            WriteJunkChunk(RIFF,PickSize(Opts.JunkSize));
+        else
+            WriteChunk(RIFF,"DATA",PickSize(Opts.Size));
+    }
+    RIFF.Close();
+}
+
+static void WriteOdd(const char *Filename,const struct CorpusOptions &Opts)
+{
+    class RIFF RIFF(Opts.IFF);
+    static const char *IDs[]={"ODD1","ODD2","ODD3","ODD4"};
+    uint32_t r;
+
+    RIFF.Open(Filename,e_RIFFOpen_Write,"ODDS",Opts.IOType);
+    for(r=0;r<Opts.Chunks;r++)
+        WriteChunk(RIFF,IDs[r%4],PickSize(Opts.Size)|1);
+    RIFF.Close();
+}
+
+/* Writes a chunk full of random data */
+static void WriteChunk(class RIFF &RIFF,const char *ChunkID,uint32_t Size)
+{
+    uint32_t Offset;
+    uint32_t Bytes;
+    uint32_t Left;
+
+    RIFF.StartDataBlock(ChunkID);
+
+    /* Start somewhere random in the pool so chunks don't all look the same */
+    Offset=RandomRange(0,POOL_SIZE-1);
+    for(Left=Size;Left>0;Left-=Bytes)
+    {
+        Bytes=POOL_SIZE-Offset;
+        if(Bytes>Left)
+            Bytes=Left;
+        RIFF.Write(&m_Pool[Offset],Bytes);
+        Offset=0;
+    }
+    RIFF.EndDataBlock();
+
+    m_ChunksWritten++;
+    m_BytesWritten+=Size;
+}
+
+static void WriteBlock(class RIFF &RIFF,const char *ChunkID,const void *Data,
+        uint32_t Size)
+{
+    RIFF.StartDataBlock(ChunkID);
+    RIFF.Write(Data,Size);
+    RIFF.EndDataBlock();
+
+    m_ChunksWritten++;
+    m_BytesWritten+=Size;
+}
+
+static void WriteJunkChunk(class RIFF &RIFF,uint32_t Size)
+{
+    static const uint8_t Zeros[4096]={0};
+    uint32_t Bytes;
+    uint32_t Left;
+
+    RIFF.StartDataBlock("JUNK");
+    for(Left=Size;Left>0;Left-=Bytes)
+    {
+        Bytes=Left;
+        if(Bytes>sizeof(Zeros))
+            Bytes=sizeof(Zeros);
+        RIFF.Write(Zeros,Bytes);
+    }
+    RIFF.EndDataBlock();
+
+    m_ChunksWritten++;
+    m_BytesWritten+=Size;
+}
+
+/* xorshift64* so the files are the same on every platform */
+static void SeedRandom(uint64_t Seed)
+{
+    m_RandomState=Seed*0x9E3779B97F4A7C15ULL+1;
+}
+
+static uint64_t Random(void)
+{
+    m_RandomState^=m_RandomState>>12;
+    m_RandomState^=m_RandomState<<25;
+    m_RandomState^=m_RandomState>>27;
+    return m_RandomState*0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t RandomRange(uint32_t Min,uint32_t Max)
+{
+    return Min+(uint32_t)(Random()%((uint64_t)Max-Min+1));
+}
+
+static uint32_t PickSize(const struct SizeDist &Dist)
+{
+    double u;
+    double Size;
+
+    switch(Dist.Type)
+    {
+        case e_Dist_Fixed:
+            return Dist.A;
+        case e_Dist_Uniform:
+            return RandomRange(Dist.A,Dist.B);
+        case e_Dist_Exp:
+            u=(Random()>>11)*(1.0/9007199254740992.0);
+            Size=-log(1.0-u)*Dist.A;
+            if(Size<1)
+                return 1;
+            if(Size>MAX_CHUNK_SIZE)
+                return MAX_CHUNK_SIZE;
+            return (uint32_t)Size;
+    }
+    return Dist.A;
+}
+
+static void Put16(uint8_t *Dest,uint16_t Value)
+{
+    Dest[0]=Value;
+    Dest[1]=Value>>8;
+}
+
+static void Put32(uint8_t *Dest,uint32_t Value)
+{
+    Dest[0]=Value;
+    Dest[1]=Value>>8;
+    Dest[2]=Value>>16;
+    Dest[3]=Value>>24;
+}
@@ -0,0 +1,377 @@
+/*******************************************************************************
+ * FILENAME: main.cpp
+ *
+ * PROJECT:
+ *    Simple RIFF
+ *
+ * FILE DESCRIPTION:
+ *    This is a tool that rewrites a file with its metadata and index chunks
+ *    moved to the front, for files that where written without room saved
+ *    for them (see RIFF::ReserveFront()).
+ *
+ * COPYRIGHT:
+ *    Copyright 2021 Paul Hutchinson
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a
+ *    copy of this software and associated documentation files (the "Software"),
+ *    to deal in the Software without restriction, including without limitation
+ *    the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *    and/or sell copies of the Software, and to permit persons to whom the
+ *    Software is furnished to do so, subject to the following conditions:
+ *
+ *    The above copyright notice and this permission notice shall be included
+ *    in all copies or substantial portions of the Software.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * CREATED BY:
+ *    Paul Hutchinson (18 Oct 2026)
+ *
+ ******************************************************************************/
+
+/*** HEADER FILES TO INCLUDE  ***/
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS       64      // 64 bit ftello() on 32 bit hosts
+#endif
+#include "RIFF.h"
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/*** DEFINES                  ***/
+#define COPY_SIZE               (1024*1024)
+
+/*** MACROS                   ***/
+#ifdef _WIN32
+#define FAST_FSEEK(f,o,w)       _fseeki64(f,o,w)
+#define FAST_FTELL(f)           _ftelli64(f)
+#else
+#define FAST_FSEEK(f,o,w)       fseeko(f,o,w)
+#define FAST_FTELL(f)           ftello(f)
+#endif
+
+/*** TYPE DEFINITIONS         ***/
+struct FaststartInfo
+{
+    bool IFF;
+    char FormType[5];
+    bool HasChecksums;
+    uint64_t FileSize;
+    uint64_t FormSize;
+};
+
+/*** FUNCTION PROTOTYPES      ***/
+static void ShowHelp(void);
+static bool LoadInfo(const char *Filename,struct FaststartInfo &Info);
+static bool Faststart(const char *InFilename,const char *OutFilename,
+        const std::vector<std::string> &IDs);
+static void CopyPass(class RIFF &Out,const char *InFilename,
+        const struct FaststartInfo &Info,const std::vector<std::string> &IDs,
+        bool Front);
+static void CopyGroup(class RIFF &Out,class RIFF &In,const char *ListID);
+static void CopyChunk(class RIFF &Out,class RIFF &In,const char *ChunkID,
+        uint32_t Size,const uint8_t *Head=NULL,uint32_t HeadBytes=0);
+static bool MatchID(const char *ChunkID,const std::vector<std::string> &IDs);
+
+/*** VARIABLE DEFINITIONS     ***/
+static uint8_t m_CopyBuffer[COPY_SIZE];
+static uint64_t m_ChunksMoved;
+static uint64_t m_BytesMoved;
+static uint64_t m_BytesDropped;
+
+int main(int argc,char **argv)
+{
+    std::vector<std::string> IDs;
+    int arg;
+
+    if(argc<3)
+    {
+        ShowHelp();
+        return 1;
+    }
+
+    for(arg=3;arg<argc;arg++)
+    {
+        if(strlen(argv[arg])!=4)
+        {
+            printf("Bad chunk ID: %s\n",argv[arg]);
+            ShowHelp();
+            return 1;
+        }
+        IDs.push_back(argv[arg]);
+    }
+    if(IDs.empty())
+    {
+        IDs.push_back("INFO");
+        IDs.push_back("idx1");
+        IDs.push_back("ix??");
+        IDs.push_back("OVRV");
+    }
+
+    if(strcmp(argv[1],argv[2])==0)
+    {
+        printf("The output file can't be the input file\n");
+        return 1;
+    }
+
+    try
+    {
+        if(!Faststart(argv[1],argv[2],IDs))
+            return 1;
+    }
+    catch(e_RIFFErrorType err)
+    {
+        printf("Error:%d, %s\n",err,RIFF::Error2Str(err));
+        return 1;
+    }
+
+    printf("Moved %llu chunks (%llu bytes) to the front, dropped %llu bytes "
+            "of JUNK / CSUM\n",(unsigned long long)m_ChunksMoved,
+            (unsigned long long)m_BytesMoved,
+            (unsigned long long)m_BytesDropped);
+
+    return 0;
+}
+
+static void ShowHelp(void)
+{
+    printf("USAGE:\n");
+    printf("    faststart infile outfile [ChunkID ...]\n");
+    printf("WHERE:\n");
+    printf("    infile -- The RIFF or IFF file to read\n");
+    printf("    outfile -- Where to write the file with the chunks moved\n");
+    printf("    ChunkID -- The data blocks / groups (at the top level) to move\n");
+    printf("               to the front.  '?' matches any letter.  The\n");
+    printf("               default is: INFO idx1 ix?? OVRV\n");
+    printf("NOTES:\n");
+    printf("    'JUNK' chunks at the top level are dropped.  The checksums\n");
+    printf("    ('CSUM') are made again if the file had them.  Only files\n");
+    printf("    with one form can be rewritten.\n");
+}
+
+/* Reads the form header with stdio to find out what kind of file it is,
+   then looks at the top level chunks for checksums */
+static bool LoadInfo(const char *Filename,struct FaststartInfo &Info)
+{
+    FILE *In;
+    uint8_t Header[12];
+    char ChunkID[5];
+    uint32_t Size;
+    class RIFF RIFF;
+
+    In=fopen(Filename,"rb");
+    if(In==NULL)
+    {
+        printf("Failed to open %s\n",Filename);
+        return false;
+    }
+    if(fread(Header,sizeof(Header),1,In)!=1)
+    {
+        printf("%s is not a RIFF or IFF file\n",Filename);
+        fclose(In);
+        return false;
+    }
+    if(FAST_FSEEK(In,0,SEEK_END)!=0)
+    {
+        printf("Failed to read %s\n",Filename);
+        fclose(In);
+        return false;
+    }
+    Info.FileSize=FAST_FTELL(In);
+    fclose(In);
+
+    if(memcmp(Header,"RIFF",4)==0)
+    {
+        Info.IFF=false;
+        Info.FormSize=Header[4] | Header[5]<<8 | Header[6]<<16 |
+                (uint32_t)Header[7]<<24;
+    }
+    else if(memcmp(Header,"FORM",4)==0)
+    {
+        Info.IFF=true;
+        Info.FormSize=(uint32_t)Header[4]<<24 | Header[5]<<16 |
+                Header[6]<<8 | Header[7];
+    }
+    else
+    {
+        printf("%s is not a RIFF or IFF file\n",Filename);
+        return false;
+    }
+    memcpy(Info.FormType,&Header[8],4);
+    Info.FormType[4]=0;
+
+    /* NextForm() files have more forms after the first one */
+    if(Info.FormSize+8+(Info.FormSize&1)<Info.FileSize)
+    {
+        printf("%s has more than one form\n",Filename);
+        return false;
+    }
+
+    RIFF.SetIFFMode(Info.IFF);
+    RIFF.Open(Filename,e_RIFFOpen_Read,Info.FormType);
+    Info.HasChecksums=false;
+    while(RIFF.ReadNextDataBlock(ChunkID,&Size))
+        if(strcmp(ChunkID,"CSUM")==0)
+            Info.HasChecksums=true;
+    RIFF.Close();
+
+    return true;
+}
+
+static bool Faststart(const char *InFilename,const char *OutFilename,
+        const std::vector<std::string> &IDs)
+{
+    struct FaststartInfo Info;
+    class RIFF Out;
+
+    if(!LoadInfo(InFilename,Info))
+        return false;
+
+    m_ChunksMoved=0;
+    m_BytesMoved=0;
+    m_BytesDropped=0;
+
+    /* The old checksums have the old offsets, so make new ones */
+    Out.SetIFFMode(Info.IFF);
+    Out.SetChecksums(Info.HasChecksums);
+    Out.Open(OutFilename,e_RIFFOpen_Write,Info.FormType);
+    CopyPass(Out,InFilename,Info,IDs,true);
+    CopyPass(Out,InFilename,Info,IDs,false);
+    Out.Close();
+
+    return true;
+}
+
+/* Copies the top level chunks that match (or don't match) 'IDs' */
+static void CopyPass(class RIFF &Out,const char *InFilename,
+        const struct FaststartInfo &Info,const std::vector<std::string> &IDs,
+        bool Front)
+{
+    class RIFF In(Info.IFF);
+    char ChunkID[5];
+    char RealID[5];
+    uint8_t PackHeader[RIFF_PACK_HEADER_SIZE];
+    uint32_t HeadBytes;
+    uint32_t RealSize;
+    uint32_t Size;
+    e_RIFFDataType DataType;
+    bool Move;
+
+    /* Compressed chunks are copied as is */
+    In.SetDecompress(false);
+    In.Open(InFilename,e_RIFFOpen_Read,Info.FormType);
+    while(In.ReadNextDataBlock(ChunkID,&Size,DataType))
+    {
+        if(strcmp(ChunkID,"JUNK")==0 || strcmp(ChunkID,"CSUM")==0)
+        {
+            if(Front)
+                m_BytesDropped+=8+Size+(Size&1);
+            continue;
+        }
+
+        /* Match compressed chunks on the real chunk ID in the header */
+        strcpy(RealID,ChunkID);
+        HeadBytes=0;
+        if(DataType!=e_RIFFData_Group &&
+                strcmp(ChunkID,RIFF_PACK_CHUNK_ID)==0 &&
+                Size>=sizeof(PackHeader))
+        {
+            In.Read(PackHeader,sizeof(PackHeader));
+            HeadBytes=sizeof(PackHeader);
+            RIFF_ReadPackHeader(PackHeader,Size,Info.IFF,RealID,&RealSize);
+            RealID[4]=0;
+        }
+
+        Move=MatchID(RealID,IDs);
+        if(Move!=Front)
+            continue;
+
+        if(DataType==e_RIFFData_Group)
+        {
+            In.StartReadingGroup();
+            CopyGroup(Out,In,ChunkID);
+            In.DoneReadingGroup();
+        }
+        else
+        {
+            CopyChunk(Out,In,ChunkID,Size,PackHeader,HeadBytes);
+        }
+
+        if(Front)
+        {
+            m_ChunksMoved++;
+            m_BytesMoved+=8+Size+(Size&1);
+        }
+    }
+    In.Close();
+}
+
+static void CopyGroup(class RIFF &Out,class RIFF &In,const char *ListID)
+{
+    char ChunkID[5];
+    uint32_t Size;
+    e_RIFFDataType DataType;
+
+    Out.StartGroup(ListID);
+    while(In.ReadNextDataBlock(ChunkID,&Size,DataType))
+    {
+        if(DataType==e_RIFFData_Group)
+        {
+            In.StartReadingGroup();
+            CopyGroup(Out,In,ChunkID);
+            In.DoneReadingGroup();
+        }
+        else
+        {
+            CopyChunk(Out,In,ChunkID,Size);
+        }
+    }
+    Out.EndGroup();
+}
+
+/* 'Head' is the first 'HeadBytes' of the chunk if they were already read */
+static void CopyChunk(class RIFF &Out,class RIFF &In,const char *ChunkID,
+        uint32_t Size,const uint8_t *Head,uint32_t HeadBytes)
+{
+    uint32_t Bytes;
+    uint32_t Left;
+
+    Out.StartDataBlock(ChunkID);
+    if(HeadBytes>0)
+        Out.Write(Head,HeadBytes);
+    for(Left=Size-HeadBytes;Left>0;Left-=Bytes)
+    {
+        Bytes=Left;
+        if(Bytes>sizeof(m_CopyBuffer))
+            Bytes=sizeof(m_CopyBuffer);
+        In.Read(m_CopyBuffer,Bytes);
+        Out.Write(m_CopyBuffer,Bytes);
+    }
+    Out.EndDataBlock();
+}
+
+/* Checks 'ChunkID' against the IDs to move ('?' matches anything) */
+static bool MatchID(const char *ChunkID,const std::vector<std::string> &IDs)
+{
+    size_t r;
+    unsigned c;
+
+    for(r=0;r<IDs.size();r++)
+    {
+        for(c=0;c<4;c++)
+            if(IDs[r][c]!='?' && IDs[r][c]!=ChunkID[c])
+                break;
+        if(c==4)
+            return true;
+    }
+    return false;
+}